@@ -0,0 +1,20 @@
+#version 410
+
+in vec3 Position;
+in vec3 Normal;
+in vec2 TexCoord;
+
+uniform vec4 LightPosition; // カメラ座標系
+uniform vec3 Kd;
+
+layout (location = 0) out vec4 FragColor;
+
+void main() {
+  vec3 n = normalize(Normal);
+  vec3 s = normalize(LightPosition.xyz - Position);
+  vec3 v = normalize(-Position);
+  vec3 h = normalize(v + s);
+  float diffuse = max(dot(s, n), 0.0);
+  float specular = diffuse > 0.0 ? pow(max(dot(h, n), 0.0), 64.0) : 0.0;
+  FragColor = vec4(Kd * (0.1 + diffuse) + vec3(0.3 * specular), 1.0);
+}
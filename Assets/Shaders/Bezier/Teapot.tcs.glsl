@@ -0,0 +1,57 @@
+#version 410
+
+layout (vertices = 16) out;
+
+uniform mat4 ModelViewMatrix;
+uniform mat4 ProjectionMatrix;
+uniform vec2 ViewportSize;   // 描画先の大きさ [px]
+uniform float PixelsPerEdge; // 分割後の辺の長さの目標 [px]
+uniform float MaxTessLevel;
+
+vec2 ToScreen(vec4 clip) {
+  return clip.xy / max(clip.w, 1e-4) * 0.5 * ViewportSize;
+}
+
+// パッチの境界の制御点を結んだ折れ線の、画面上の長さから分割数を決めます。
+// 隣のパッチと同じ値になるよう、向きによらない順で足し合わせます。
+float EdgeLevel(vec2 a, vec2 b, vec2 c, vec2 d) {
+  float len = (distance(a, b) + distance(c, d)) + distance(b, c);
+  return clamp(len / PixelsPerEdge, 1.0, MaxTessLevel);
+}
+
+void main() {
+  gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+  if (gl_InvocationID != 0) {
+    return;
+  }
+
+  mat4 mvp = ProjectionMatrix * ModelViewMatrix;
+  vec4 clip[16];
+  vec2 screen[16];
+  // 凸包性から、全ての制御点が同じ面の外にあればパッチは見えません。
+  ivec3 less = ivec3(0);
+  ivec3 greater = ivec3(0);
+  for (int i = 0; i < 16; i++) {
+    clip[i] = mvp * gl_in[i].gl_Position;
+    screen[i] = ToScreen(clip[i]);
+    less += ivec3(lessThan(clip[i].xyz, vec3(-clip[i].w)));
+    greater += ivec3(greaterThan(clip[i].xyz, vec3(clip[i].w)));
+  }
+  if (any(equal(less, ivec3(16))) || any(equal(greater, ivec3(16)))) {
+    gl_TessLevelOuter[0] = 0.0;
+    gl_TessLevelOuter[1] = 0.0;
+    gl_TessLevelOuter[2] = 0.0;
+    gl_TessLevelOuter[3] = 0.0;
+    gl_TessLevelInner[0] = 0.0;
+    gl_TessLevelInner[1] = 0.0;
+    return;
+  }
+
+  // 制御点は [u * 4 + v] の順に並んでいます。
+  gl_TessLevelOuter[0] = EdgeLevel(screen[0], screen[1], screen[2], screen[3]);
+  gl_TessLevelOuter[1] = EdgeLevel(screen[0], screen[4], screen[8], screen[12]);
+  gl_TessLevelOuter[2] = EdgeLevel(screen[12], screen[13], screen[14], screen[15]);
+  gl_TessLevelOuter[3] = EdgeLevel(screen[3], screen[7], screen[11], screen[15]);
+  gl_TessLevelInner[0] = max(gl_TessLevelOuter[1], gl_TessLevelOuter[3]);
+  gl_TessLevelInner[1] = max(gl_TessLevelOuter[0], gl_TessLevelOuter[2]);
+}
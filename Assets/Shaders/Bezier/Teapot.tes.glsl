@@ -0,0 +1,57 @@
+#version 410
+
+// Teapot の三角形と同じ向きになるよう、(u, v) 平面で時計回りにします。
+layout (quads, fractional_odd_spacing, cw) in;
+
+uniform mat4 ModelViewMatrix;
+uniform mat4 ProjectionMatrix;
+
+out vec3 Position;
+out vec3 Normal;
+out vec2 TexCoord;
+
+// 3 次のバーンスタイン基底関数とその導関数
+void Basis(float t, out vec4 b, out vec4 db) {
+  float t1 = 1.0 - t;
+  b = vec4(t1 * t1 * t1, 3.0 * t1 * t1 * t, 3.0 * t1 * t * t, t * t * t);
+  db = vec4(-3.0 * t1 * t1, -6.0 * t * t1 + 3.0 * t1 * t1,
+            -3.0 * t * t + 6.0 * t * t1, 3.0 * t * t);
+}
+
+void Evaluate(float u, float v, out vec3 p, out vec3 du, out vec3 dv) {
+  vec4 bu, dbu, bv, dbv;
+  Basis(u, bu, dbu);
+  Basis(v, bv, dbv);
+  p = vec3(0.0);
+  du = vec3(0.0);
+  dv = vec3(0.0);
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      vec3 cp = gl_in[i * 4 + j].gl_Position.xyz;
+      p += cp * bu[i] * bv[j];
+      du += cp * dbu[i] * bv[j];
+      dv += cp * bu[i] * dbv[j];
+    }
+  }
+}
+
+void main() {
+  float u = gl_TessCoord.x;
+  float v = gl_TessCoord.y;
+
+  vec3 p, du, dv;
+  Evaluate(u, v, p, du, dv);
+  vec3 n = cross(dv, du);
+  // 蓋の頂上などの縮退した辺では、少し内側の法線を使います。
+  if (dot(n, n) < 1e-12) {
+    vec3 q;
+    Evaluate(clamp(u, 1e-3, 1.0 - 1e-3), clamp(v, 1e-3, 1.0 - 1e-3), q, du, dv);
+    n = cross(dv, du);
+  }
+
+  vec4 viewPos = ModelViewMatrix * vec4(p, 1.0);
+  Position = viewPos.xyz;
+  Normal = normalize(mat3(ModelViewMatrix) * n);
+  TexCoord = vec2(u, v);
+  gl_Position = ProjectionMatrix * viewPos;
+}
@@ -0,0 +1,8 @@
+#version 410
+
+// 制御点はそのまま制御シェーダーに渡します。
+layout (location = 0) in vec3 VertexPosition;
+
+void main() {
+  gl_Position = vec4(VertexPosition, 1.0);
+}
@@ -0,0 +1,20 @@
+#version 410
+
+layout (location = 0) in vec3 VertexPosition;
+layout (location = 1) in vec3 VertexNormal;
+layout (location = 2) in vec2 VertexTexCoord;
+
+uniform mat4 ModelViewMatrix;
+uniform mat4 ProjectionMatrix;
+
+out vec3 Position;
+out vec3 Normal;
+out vec2 TexCoord;
+
+void main() {
+  vec4 viewPos = ModelViewMatrix * vec4(VertexPosition, 1.0);
+  Position = viewPos.xyz;
+  Normal = normalize(mat3(ModelViewMatrix) * VertexNormal);
+  TexCoord = VertexTexCoord;
+  gl_Position = ProjectionMatrix * viewPos;
+}
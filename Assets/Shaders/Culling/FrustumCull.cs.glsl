@@ -0,0 +1,86 @@
+#version 430
+
+// DrawList::Cull から定義されなければ既定値を使います。
+#ifndef LOCAL_SIZE_X
+#define LOCAL_SIZE_X 64
+#endif
+
+layout (local_size_x = LOCAL_SIZE_X) in;
+
+#define OBJECT_BLOCK_COMPUTE
+#include "../Include/ObjectBlock.glsl"
+
+// NOTE: DrawList::Command, DrawList::CullInput と同じ並びにしてください。
+struct DrawCommand {
+    uint count;
+    uint instanceCount;
+    uint firstIndex;
+    int baseVertex;
+    uint baseInstance;
+};
+struct CullInput {
+    vec4 boundsMin; // モデル座標系の AABB (w が 0 でなければカリングしません)
+    vec4 boundsMax;
+    DrawCommand command;
+    uint batch;      // 描画をまとめた範囲の番号
+    uint batchFirst; // その範囲の先頭
+    uint pad;
+};
+
+// StorageBinding::kCullInputs
+layout (std430) readonly buffer CullInputs {
+    CullInput Inputs[];
+};
+// StorageBinding::kCullOutputs
+layout (std430) writeonly buffer CullOutputs {
+    DrawCommand Outputs[];
+};
+// StorageBinding::kDrawCounts
+layout (std430) buffer DrawCounts {
+    uint Counts[];
+};
+
+uniform vec4 Planes[6]; // ワールド座標系の視錐台の平面 (法線は内向き)
+uniform int InputCount;
+uniform bool IsCompact; // false であれば詰めずに、外れたものの instanceCount を 0 にします。
+
+bool IsVisible(CullInput src) {
+    if (src.boundsMin.w != 0.0) {
+        return true;
+    }
+
+    // AABB をワールド座標系に移し、各平面に最も近い頂点が外側にあれば見えません。
+    const mat4 model = Objects[src.command.baseInstance].model;
+    const vec3 center = 0.5 * (src.boundsMin.xyz + src.boundsMax.xyz);
+    const vec3 extent = 0.5 * (src.boundsMax.xyz - src.boundsMin.xyz);
+    const vec3 c = (model * vec4(center, 1.0)).xyz;
+    const vec3 e = abs(model[0].xyz) * extent.x + abs(model[1].xyz) * extent.y +
+                   abs(model[2].xyz) * extent.z;
+    for (int i = 0; i < 6; i++) {
+        const vec3 n = Planes[i].xyz;
+        if (dot(n, c) + dot(abs(n), e) + Planes[i].w < 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void main() {
+    const uint idx = gl_GlobalInvocationID.x;
+    if (idx >= uint(InputCount)) {
+        return;
+    }
+
+    const CullInput src = Inputs[idx];
+    const bool isVisible = IsVisible(src);
+    if (IsCompact) {
+        if (isVisible) {
+            const uint slot = atomicAdd(Counts[src.batch], 1u);
+            Outputs[src.batchFirst + slot] = src.command;
+        }
+    } else {
+        DrawCommand command = src.command;
+        command.instanceCount = isVisible ? command.instanceCount : 0u;
+        Outputs[idx] = command;
+    }
+}
@@ -0,0 +1,17 @@
+#version 410
+
+in vec3 Position;
+in vec3 Normal;
+
+layout (location=1) out vec3 PositionData;
+layout (location=2) out vec3 NormalData;
+layout (location=3) out vec3 ColorData;
+
+#include "../Include/ObjectBlock.glsl"
+
+void main() {
+    // 位置情報、法線情報、色情報をGBufferに詰め込みます。
+    PositionData = Position;
+    NormalData = normalize(Normal);
+    ColorData = MaterialKd;
+}
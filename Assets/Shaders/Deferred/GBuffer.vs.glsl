@@ -0,0 +1,21 @@
+#version 410
+
+layout (location=0) in vec3 VertexPosition;
+layout (location=1) in vec3 VertexNormal;
+
+out vec3 Position;
+out vec3 Normal;
+
+#include "../Include/FrameBlock.glsl"
+
+#define OBJECT_BLOCK_VERTEX
+#include "../Include/ObjectBlock.glsl"
+
+void main() {
+    PassObjectIndex();
+    mat4 mv = ViewMatrix * ModelMatrix;
+    Position = vec3(mv * vec4(VertexPosition, 1.0));
+    Normal = normalize(mat3(mv) * VertexNormal);
+
+    gl_Position = ProjectionMatrix * mv * vec4(VertexPosition, 1.0);
+}
@@ -0,0 +1,12 @@
+// NOTE: Common/Scene/UniformBlocks.h の構造体と同じ並びにしてください。
+
+// フレームごとのデータ (UniformBinding::kFrame)
+layout(std140) uniform FrameBlock {
+    mat4 ViewMatrix;
+    mat4 ProjectionMatrix;
+    mat4 ShadowMatrix;  // バイアス * ライトのビュー射影行列
+    vec4 LightPosition; // カメラ座標系から見たライトの位置
+    vec3 LightLa;       // Ambient Light (環境光)の強さ
+    vec3 LightLd;       // Diffuse Light (拡散光)の強さ
+    vec3 LightLs;       // Specular Light (鏡面反射光)の強さ
+};
@@ -0,0 +1,57 @@
+// NOTE: Common/Scene/UniformBlocks.h の構造体と同じ並びにしてください。
+
+// #version の直後に移されるため、DRAW_LIST に関わらず有効にします。(未対応であれば警告だけです)
+#extension GL_ARB_shader_storage_buffer_object : enable
+
+#ifdef DRAW_LIST
+
+// DrawList でまとめて描画する場合は、全オブジェクトのデータを一つの配列から引きます。
+// (StorageBinding::kObjects, 並びは ObjectBlock と同じです)
+struct ObjectData {
+    mat4 model;
+    vec3 ka;
+    vec3 kd;
+    vec3 ks;
+    float shininess;
+};
+layout(std430) readonly buffer ObjectBuffer {
+    ObjectData Objects[];
+};
+
+#if defined(OBJECT_BLOCK_COMPUTE)
+// 計算シェーダーでは Objects を直接引きます。
+#elif defined(OBJECT_BLOCK_VERTEX)
+// コマンドの baseInstance + gl_InstanceID (GeometryArena::kDrawIndexLocation)
+layout (location=15) in uint DrawIndex;
+flat out uint ObjectIndex;
+void PassObjectIndex() { ObjectIndex = DrawIndex; }
+#define OBJECT_INDEX DrawIndex
+#else
+flat in uint ObjectIndex;
+#define OBJECT_INDEX ObjectIndex
+#endif
+
+#ifndef OBJECT_BLOCK_COMPUTE
+#define ModelMatrix (Objects[OBJECT_INDEX].model)
+#define MaterialKa (Objects[OBJECT_INDEX].ka)
+#define MaterialKd (Objects[OBJECT_INDEX].kd)
+#define MaterialKs (Objects[OBJECT_INDEX].ks)
+#define MaterialShininess (Objects[OBJECT_INDEX].shininess)
+#endif
+
+#else
+
+// オブジェクトごとのデータ (UniformBinding::kObject)
+layout(std140) uniform ObjectBlock {
+    mat4 ModelMatrix;
+    vec3 MaterialKa;         // Ambient reflectivity (環境光の反射係数)
+    vec3 MaterialKd;         // Diffsue reflectivity (拡散光の反射係数)
+    vec3 MaterialKs;         // Specular reflectivity (鏡面反射光の反射係数)
+    float MaterialShininess; // Specular shininess factor (鏡面反射の強さの係数)
+};
+
+#ifdef OBJECT_BLOCK_VERTEX
+void PassObjectIndex() {}
+#endif
+
+#endif
@@ -0,0 +1,13 @@
+#version 410
+
+in vec3 Normal;
+flat in vec3 Color;
+
+layout (location=0) out vec4 FragColor;
+
+uniform vec3 LightDirection; // ワールド座標系での光の向き (光源へ向かう単位ベクトル)
+
+void main() {
+    float diffuse = max(dot(normalize(Normal), LightDirection), 0.0);
+    FragColor = vec4(Color * (0.15 + 0.85 * diffuse), 1.0);
+}
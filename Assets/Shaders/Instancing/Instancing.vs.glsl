@@ -0,0 +1,29 @@
+#version 410
+
+layout (location=0) in vec3 VertexPosition;
+layout (location=1) in vec3 VertexNormal;
+
+#ifdef INSTANCED
+// InstanceBuffer (除数 1 で 1 インスタンスごとに進みます)
+layout (location=8) in mat4 InstanceModel;
+layout (location=12) in uint InstanceMaterial;
+#define MATERIAL_INDEX int(InstanceMaterial)
+#else
+// オブジェクトごとに描画する場合は、描画の前にユニフォームで渡します。
+uniform mat4 InstanceModel;
+uniform int InstanceMaterial;
+#define MATERIAL_INDEX InstanceMaterial
+#endif
+
+const int kMaterialsNum = 8;
+uniform vec3 MaterialColors[kMaterialsNum];
+uniform mat4 ViewProjection;
+
+out vec3 Normal;
+flat out vec3 Color;
+
+void main() {
+    Normal = normalize(mat3(InstanceModel) * VertexNormal);
+    Color = MaterialColors[MATERIAL_INDEX % kMaterialsNum];
+    gl_Position = ViewProjection * InstanceModel * vec4(VertexPosition, 1.0);
+}
@@ -1,6 +1,11 @@
 #version 430
 
-layout (local_size_x = 1000) in;
+// シーン側から定義されなければ既定値を使います。
+#ifndef LOCAL_SIZE_X
+#define LOCAL_SIZE_X 1000
+#endif
+
+layout (local_size_x = LOCAL_SIZE_X) in;
 
 // black hole #1
 uniform float Gravity1 = 1000.0;
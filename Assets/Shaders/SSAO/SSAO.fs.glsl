@@ -1,7 +1,11 @@
 #version 410
 
-const int kKernelSize = 64;
-const vec2 kRandScale = vec2(1280.0 / 4.0, 720.0 / 4.0);
+// シーン側から定義されなければ既定値を使います。
+#ifndef KERNEL_SIZE
+#define KERNEL_SIZE 64
+#endif
+
+const int kKernelSize = KERNEL_SIZE;
 
 in vec2 TexCoord;
 
@@ -14,10 +18,11 @@ uniform sampler2D RandRotTex;
 uniform mat4 ProjectionMatrix;
 uniform vec3 SampleKernel[kKernelSize];
 uniform float Radius = 0.55;
+uniform vec2 RandScale = vec2(1280.0 / 4.0, 720.0 / 4.0); // 画面サイズ / ノイズテクスチャのサイズ
 
 void main() {
     // ランダムに接座標空間->カメラ座標空間変換行列を生成します。
-    vec3 randDir = normalize(texture(RandRotTex, TexCoord.xy * kRandScale).xyz);
+    vec3 randDir = normalize(texture(RandRotTex, TexCoord.xy * RandScale).xyz);
     vec3 n = normalize(texture(NormalTex, TexCoord.xy).xyz);
     vec3 bitang = cross(n, randDir);
     if (length(bitang) < 0.0001) {  // nとrandDirが平行であれば、nはx-y平面に存在します。
@@ -8,19 +8,9 @@ in vec3 Normal;
 
 layout(location=0) out vec4 FragColor;
 
-uniform struct LightInfo {
-    vec4 Position;  // カメラ座標系から見たライトの位置
-    vec3 La;        // Ambient Light (環境光)の強さ
-    vec3 Ld;        // Diffuse Light (拡散光)の強さ
-    vec3 Ls;        // Specular Light (鏡面反射光)の強さ 
-} Light;
-
-uniform struct MaterialInfo {
-    vec3 Ka;  // Ambient reflectivity (環境光の反射係数)
-    vec3 Kd;  // Diffsue reflectivity (拡散光の反射係数)
-    vec3 Ks;  // Specular reflectivity (鏡面反射光の反射係数)
-    float Shininess;  // Specular shininess factor (鏡面反射の強さの係数)
-} Material;
+#include "../../Include/FrameBlock.glsl"
+
+#include "../../Include/ObjectBlock.glsl"
 
 uniform sampler2DArrayShadow ShadowMaps;
 uniform int CascadesNum;
@@ -37,14 +27,14 @@ vec4 GammaCorrection(vec4 color) {
 
 vec3 PhongDSModel(vec3 pos, vec3 n) {
     // Phong Shading Equation
-    vec3 s = normalize(vec3(Light.Position.xyz - pos));
+    vec3 s = normalize(vec3(LightPosition.xyz - pos));
     float sDotN = max(dot(s, n), 0.0);
-    vec3 diff = Light.Ld * Material.Kd  * sDotN;
+    vec3 diff = LightLd * MaterialKd  * sDotN;
     vec3 spec = vec3(0.0);
     if (sDotN > 0.0) {
         vec3 v = normalize(-pos.xyz);
         vec3 r = reflect(-s, n);
-        spec = Light.Ls * Material.Ks * pow(max(dot(r, v), 0.0), Material.Shininess);
+        spec = LightLs * MaterialKs * pow(max(dot(r, v), 0.0), MaterialShininess);
     }
     return diff + spec;
 }
@@ -92,7 +82,7 @@ vec4 ShadowIndicator(int idx) {
 }
 
 void ShadeWithShadow() {
-    vec3 amb = Light.La * Material.Ka;
+    vec3 amb = LightLa * MaterialKa;
     vec3 diffSpec = PhongDSModel(Position, Normal);
 
     // 該当するシャドウマップを探します。
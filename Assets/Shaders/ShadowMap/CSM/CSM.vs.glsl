@@ -9,12 +9,15 @@ layout (location=2) in vec2 VertexTexCoord;
 out vec3 Position;
 out vec3 Normal;
 
-uniform mat4 ModelViewMatrix;
-uniform mat3 NormalMatrix;
-uniform mat4 MVP;
+#include "../../Include/FrameBlock.glsl"
+
+#define OBJECT_BLOCK_VERTEX
+#include "../../Include/ObjectBlock.glsl"
 
 void main() {
-    Position = vec3(ModelViewMatrix * vec4(VertexPosition, 1.0));
-    Normal = normalize(NormalMatrix * VertexNormal);
-    gl_Position = MVP * vec4(VertexPosition, 1.0);
+    PassObjectIndex();
+    mat4 mv = ViewMatrix * ModelMatrix;
+    Position = vec3(mv * vec4(VertexPosition, 1.0));
+    Normal = normalize(mat3(mv) * VertexNormal);
+    gl_Position = ProjectionMatrix * mv * vec4(VertexPosition, 1.0);
 }
@@ -8,19 +8,9 @@ layout(location=0) out vec4 FragColor;
 
 const float kGamma = 2.2;
 
-uniform struct LightInfo {
-    vec4 Position;  // カメラ座標系から見たライトの位置
-    vec3 La;        // Ambient Light (環境光)の強さ
-    vec3 Ld;        // Diffuse Light (拡散光)の強さ
-    vec3 Ls;        // Specular Light (鏡面反射光)の強さ 
-} Light;
+#include "../../Include/FrameBlock.glsl"
 
-uniform struct MaterialInfo {
-    vec3 Ka;  // Ambient reflectivity (環境光の反射係数)
-    vec3 Kd;  // Diffsue reflectivity (拡散光の反射係数)
-    vec3 Ks;  // Specular reflectivity (鏡面反射光の反射係数)
-    float Shininess;  // Specular shininess factor (鏡面反射の強さの係数)
-} Material;
+#include "../../Include/ObjectBlock.glsl"
 
 uniform sampler2DShadow ShadowMap;
 uniform bool IsPCF = true;
@@ -32,20 +22,20 @@ vec4 GammaCorrection(vec4 color) {
 
 vec3 PhongDSModel(vec3 pos, vec3 n) {
     // Phong Shading Equation
-    vec3 s = normalize(vec3(Light.Position.xyz - pos));
+    vec3 s = normalize(vec3(LightPosition.xyz - pos));
     float sDotN = max(dot(s, n), 0.0);
-    vec3 diff = Light.Ld * Material.Kd  * sDotN;
+    vec3 diff = LightLd * MaterialKd  * sDotN;
     vec3 spec = vec3(0.0);
     if (sDotN > 0.0) {
         vec3 v = normalize(-pos.xyz);
         vec3 r = reflect(-s, n);
-        spec = Light.Ls * Material.Ks * pow(max(dot(r, v), 0.0), Material.Shininess);
+        spec = LightLs * MaterialKs * pow(max(dot(r, v), 0.0), MaterialShininess);
     }
     return diff + spec;
 }
 
 void ShadeWithShadow() {
-    vec3 amb = Light.La * Material.Ka;
+    vec3 amb = LightLa * MaterialKa;
     vec3 diffSpec = PhongDSModel(Position, Normal);
 
     float shadow = 1.0;
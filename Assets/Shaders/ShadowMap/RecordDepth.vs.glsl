@@ -4,8 +4,13 @@ layout (location=0) in vec3 VertexPosition;
 layout (location=1) in vec3 VertexNormal;
 layout (location=2) in vec2 VertexTexCoord;
 
-uniform mat4 MVP;
+#define OBJECT_BLOCK_VERTEX
+#include "../Include/ObjectBlock.glsl"
+
+// ライト (カスケード) ごとのビュー射影行列
+uniform mat4 ViewProjection;
 
 void main() {
-    gl_Position = MVP * vec4(VertexPosition, 1.0);
+    PassObjectIndex();
+    gl_Position = ViewProjection * ModelMatrix * vec4(VertexPosition, 1.0);
 }
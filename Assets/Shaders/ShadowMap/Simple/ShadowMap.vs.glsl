@@ -8,16 +8,18 @@ out vec3 Position;
 out vec3 Normal;
 out vec4 ShadowCoord;
 
-uniform mat4 ModelViewMatrix;
-uniform mat3 NormalMatrix;
-uniform mat4 MVP;
-uniform mat4 ShadowMatrix;
+#include "../../Include/FrameBlock.glsl"
+
+#define OBJECT_BLOCK_VERTEX
+#include "../../Include/ObjectBlock.glsl"
 
 void main() {
-    Position = vec3(ModelViewMatrix * vec4(VertexPosition, 1.0));
-    Normal = normalize(NormalMatrix * VertexNormal);
+    PassObjectIndex();
+    mat4 mv = ViewMatrix * ModelMatrix;
+    Position = vec3(mv * vec4(VertexPosition, 1.0));
+    Normal = normalize(mat3(mv) * VertexNormal);
     // ShadowMatrixモデルはモデル座標系からシャドウマップ座標系に変換します。
-    ShadowCoord = ShadowMatrix * vec4(VertexPosition, 1.0);
+    ShadowCoord = ShadowMatrix * ModelMatrix * vec4(VertexPosition, 1.0);
 
-    gl_Position = MVP * vec4(VertexPosition, 1.0);
+    gl_Position = ProjectionMatrix * mv * vec4(VertexPosition, 1.0);
 }
@@ -0,0 +1,650 @@
+/**
+ * @brief  Block compression (BC1/BC3/BC5/BC7)
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Image/BlockCompression.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace BlockCompression {
+
+//*--------------------------------------------------------------------------------
+// Types
+//*--------------------------------------------------------------------------------
+
+using Vec4 = std::array<float, 4>;
+using Texels = std::array<Vec4, kBlockTexels>;
+using Indices = std::array<int, kBlockTexels>;
+
+/**< @brief リトルエンディアンでビットを詰めます。(出力先は 0 で初期化しておきます) */
+struct BitWriter {
+  std::uint8_t *out;
+  int pos = 0;
+
+  void Write(std::uint32_t value, int bits) {
+    for (int i = 0; i < bits; i++, pos++) {
+      if ((value >> i) & 1u) {
+        out[pos >> 3] |= static_cast<std::uint8_t>(1u << (pos & 7));
+      }
+    }
+  }
+};
+
+struct BitReader {
+  const std::uint8_t *in;
+  int pos = 0;
+
+  std::uint32_t Read(int bits) {
+    std::uint32_t value = 0;
+    for (int i = 0; i < bits; i++, pos++) {
+      value |= static_cast<std::uint32_t>((in[pos >> 3] >> (pos & 7)) & 1u)
+               << i;
+    }
+    return value;
+  }
+};
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+static float Clamp255(float v) { return std::clamp(v, 0.0f, 255.0f); }
+
+static Texels ToTexels(const std::uint8_t *rgba) {
+  Texels px{};
+  for (int t = 0; t < kBlockTexels; t++) {
+    for (int c = 0; c < 4; c++) {
+      px[t][c] = static_cast<float>(rgba[t * 4 + c]);
+    }
+  }
+  return px;
+}
+
+static float Distance(const Vec4 &a, const Vec4 &b, int channels) {
+  float d = 0.0f;
+  for (int c = 0; c < channels; c++) {
+    d += (a[c] - b[c]) * (a[c] - b[c]);
+  }
+  return d;
+}
+
+/**
+ * @brief 各 texel に最も近いパレットのインデックスを選びます。
+ * @return 誤差の二乗和
+ */
+static float SelectIndices(const Texels &px, int channels, const Vec4 *palette,
+                           int count, Indices &indices) {
+  float total = 0.0f;
+  for (int t = 0; t < kBlockTexels; t++) {
+    float best = std::numeric_limits<float>::max();
+    for (int i = 0; i < count; i++) {
+      const float d = Distance(px[t], palette[i], channels);
+      if (d < best) {
+        best = d;
+        indices[t] = i;
+      }
+    }
+    total += best;
+  }
+  return total;
+}
+
+/**
+ * @brief 主成分の方向に射影した両端を端点の初期値にします。
+ */
+static void FitEndpoints(const Texels &px, int channels, Vec4 &e0, Vec4 &e1) {
+  Vec4 mean{};
+  for (const auto &p : px) {
+    for (int c = 0; c < channels; c++) {
+      mean[c] += p[c] / static_cast<float>(kBlockTexels);
+    }
+  }
+  std::array<Vec4, 4> cov{};
+  for (const auto &p : px) {
+    for (int i = 0; i < channels; i++) {
+      for (int j = 0; j < channels; j++) {
+        cov[i][j] += (p[i] - mean[i]) * (p[j] - mean[j]);
+      }
+    }
+  }
+
+  // 分散の最も大きいチャンネルから始めて、冪乗法で主軸を求めます。
+  int start = 0;
+  for (int c = 1; c < channels; c++) {
+    if (cov[c][c] > cov[start][start]) {
+      start = c;
+    }
+  }
+  e0 = mean;
+  e1 = mean;
+  if (cov[start][start] <= 0.0f) {
+    return;
+  }
+  Vec4 axis = cov[start];
+  for (int iter = 0; iter < 8; iter++) {
+    Vec4 next{};
+    float len = 0.0f;
+    for (int i = 0; i < channels; i++) {
+      for (int j = 0; j < channels; j++) {
+        next[i] += cov[i][j] * axis[j];
+      }
+      len += next[i] * next[i];
+    }
+    if (len <= 0.0f) {
+      break;
+    }
+    len = std::sqrt(len);
+    for (int c = 0; c < channels; c++) {
+      axis[c] = next[c] / len;
+    }
+  }
+
+  float tmin = std::numeric_limits<float>::max();
+  float tmax = std::numeric_limits<float>::lowest();
+  for (const auto &p : px) {
+    float t = 0.0f;
+    for (int c = 0; c < channels; c++) {
+      t += (p[c] - mean[c]) * axis[c];
+    }
+    tmin = std::min(tmin, t);
+    tmax = std::max(tmax, t);
+  }
+  for (int c = 0; c < channels; c++) {
+    e0[c] = Clamp255(mean[c] + axis[c] * tmin);
+    e1[c] = Clamp255(mean[c] + axis[c] * tmax);
+  }
+}
+
+/**
+ * @brief インデックスを固定し、誤差が最小になる端点を最小二乗法で求め直します。
+ * @param weights インデックスごとの e1 側の重み [0, 1]
+ */
+static bool RefineEndpoints(const Texels &px, int channels,
+                            const Indices &indices, const float *weights,
+                            Vec4 &e0, Vec4 &e1) {
+  float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+  Vec4 ax{}, bx{};
+  for (int t = 0; t < kBlockTexels; t++) {
+    const float b = weights[indices[t]];
+    const float a = 1.0f - b;
+    aa += a * a;
+    ab += a * b;
+    bb += b * b;
+    for (int c = 0; c < channels; c++) {
+      ax[c] += a * px[t][c];
+      bx[c] += b * px[t][c];
+    }
+  }
+  const float det = aa * bb - ab * ab;
+  if (std::abs(det) < 1.0e-6f) {
+    return false;
+  }
+  for (int c = 0; c < channels; c++) {
+    e0[c] = Clamp255((ax[c] * bb - bx[c] * ab) / det);
+    e1[c] = Clamp255((bx[c] * aa - ax[c] * ab) / det);
+  }
+  return true;
+}
+
+//*--------------------------------------------------------------------------------
+// BC1 color block
+//*--------------------------------------------------------------------------------
+
+static std::uint16_t To565(const Vec4 &c) {
+  const auto r = static_cast<std::uint16_t>(std::lround(c[0] * 31.0f / 255.0f));
+  const auto g = static_cast<std::uint16_t>(std::lround(c[1] * 63.0f / 255.0f));
+  const auto b = static_cast<std::uint16_t>(std::lround(c[2] * 31.0f / 255.0f));
+  return static_cast<std::uint16_t>((r << 11) | (g << 5) | b);
+}
+
+static Vec4 From565(std::uint16_t v) {
+  const int r = (v >> 11) & 31;
+  const int g = (v >> 5) & 63;
+  const int b = v & 31;
+  return {static_cast<float>((r << 3) | (r >> 2)),
+          static_cast<float>((g << 2) | (g >> 4)),
+          static_cast<float>((b << 3) | (b >> 2)), 255.0f};
+}
+
+static std::array<Vec4, 4> BuildColorPalette(std::uint16_t c0, std::uint16_t c1,
+                                             bool isFourColor) {
+  std::array<Vec4, 4> palette{From565(c0), From565(c1), Vec4{}, Vec4{}};
+  for (int c = 0; c < 3; c++) {
+    const int a = static_cast<int>(palette[0][c]);
+    const int b = static_cast<int>(palette[1][c]);
+    if (isFourColor) {
+      palette[2][c] = static_cast<float>((2 * a + b) / 3);
+      palette[3][c] = static_cast<float>((a + 2 * b) / 3);
+    } else {
+      palette[2][c] = static_cast<float>((a + b) / 2);
+    }
+  }
+  palette[2][3] = 255.0f;
+  palette[3][3] = isFourColor ? 255.0f : 0.0f;
+  return palette;
+}
+
+static void EncodeColor(const Texels &px, std::uint8_t *out) {
+  // インデックスごとの c1 側の重み
+  static constexpr float kWeights[4] = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+
+  std::uint16_t bestC0 = 0, bestC1 = 0;
+  Indices best{};
+  float bestError = std::numeric_limits<float>::max();
+  const auto Try = [&](const Vec4 &e0, const Vec4 &e1) {
+    std::uint16_t c0 = To565(e0);
+    std::uint16_t c1 = To565(e1);
+    if (c0 < c1) {
+      std::swap(c0, c1);
+    }
+    Indices indices{};
+    float error = 0.0f;
+    if (c0 == c1) {
+      error = SelectIndices(px, 3, BuildColorPalette(c0, c1, true).data(), 1,
+                            indices);
+    } else {
+      error = SelectIndices(px, 3, BuildColorPalette(c0, c1, true).data(), 4,
+                            indices);
+    }
+    if (error < bestError) {
+      bestError = error;
+      bestC0 = c0;
+      bestC1 = c1;
+      best = indices;
+    }
+  };
+
+  Vec4 e0{}, e1{};
+  FitEndpoints(px, 3, e0, e1);
+  Try(e0, e1);
+  for (int iter = 0; iter < 2 && bestC0 != bestC1; iter++) {
+    e0 = From565(bestC0);
+    e1 = From565(bestC1);
+    if (!RefineEndpoints(px, 3, best, kWeights, e0, e1)) {
+      break;
+    }
+    Try(e0, e1);
+  }
+
+  out[0] = static_cast<std::uint8_t>(bestC0 & 0xFF);
+  out[1] = static_cast<std::uint8_t>(bestC0 >> 8);
+  out[2] = static_cast<std::uint8_t>(bestC1 & 0xFF);
+  out[3] = static_cast<std::uint8_t>(bestC1 >> 8);
+  std::uint32_t bits = 0;
+  for (int t = 0; t < kBlockTexels; t++) {
+    bits |= static_cast<std::uint32_t>(best[t]) << (t * 2);
+  }
+  for (int i = 0; i < 4; i++) {
+    out[4 + i] = static_cast<std::uint8_t>(bits >> (i * 8));
+  }
+}
+
+static void DecodeColor(const std::uint8_t *in, bool forceFourColor,
+                        std::uint8_t *rgba) {
+  const auto c0 = static_cast<std::uint16_t>(in[0] | (in[1] << 8));
+  const auto c1 = static_cast<std::uint16_t>(in[2] | (in[3] << 8));
+  const auto palette = BuildColorPalette(c0, c1, forceFourColor || c0 > c1);
+  const std::uint32_t bits = static_cast<std::uint32_t>(in[4]) |
+                             (static_cast<std::uint32_t>(in[5]) << 8) |
+                             (static_cast<std::uint32_t>(in[6]) << 16) |
+                             (static_cast<std::uint32_t>(in[7]) << 24);
+  for (int t = 0; t < kBlockTexels; t++) {
+    const auto &color = palette[(bits >> (t * 2)) & 3u];
+    for (int c = 0; c < 4; c++) {
+      rgba[t * 4 + c] = static_cast<std::uint8_t>(color[c]);
+    }
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// BC4 single channel block (BC3 のアルファ、BC5 の各チャンネル)
+//*--------------------------------------------------------------------------------
+
+static std::array<int, 8> BuildSinglePalette(int a0, int a1) {
+  std::array<int, 8> palette{a0, a1};
+  if (a0 > a1) {
+    for (int i = 1; i < 7; i++) {
+      palette[static_cast<std::size_t>(i + 1)] = ((7 - i) * a0 + i * a1) / 7;
+    }
+  } else {
+    for (int i = 1; i < 5; i++) {
+      palette[static_cast<std::size_t>(i + 1)] = ((5 - i) * a0 + i * a1) / 5;
+    }
+    palette[6] = 0;
+    palette[7] = 255;
+  }
+  return palette;
+}
+
+static void EncodeSingle(const Texels &px, int channel, std::uint8_t *out) {
+  int lo = 255, hi = 0;
+  for (const auto &p : px) {
+    lo = std::min(lo, static_cast<int>(p[channel]));
+    hi = std::max(hi, static_cast<int>(p[channel]));
+  }
+  out[0] = static_cast<std::uint8_t>(hi);
+  out[1] = static_cast<std::uint8_t>(lo);
+  std::fill(out + 2, out + 8, std::uint8_t{0});
+  if (hi == lo) {
+    return;
+  }
+
+  const auto palette = BuildSinglePalette(hi, lo);
+  BitWriter writer{out + 2};
+  for (const auto &p : px) {
+    const int value = static_cast<int>(p[channel]);
+    std::uint32_t index = 0;
+    int best = std::numeric_limits<int>::max();
+    for (std::uint32_t i = 0; i < palette.size(); i++) {
+      const int d = std::abs(palette[i] - value);
+      if (d < best) {
+        best = d;
+        index = i;
+      }
+    }
+    writer.Write(index, 3);
+  }
+}
+
+static void DecodeSingle(const std::uint8_t *in, int channel,
+                         std::uint8_t *rgba) {
+  const auto palette = BuildSinglePalette(in[0], in[1]);
+  BitReader reader{in + 2};
+  for (int t = 0; t < kBlockTexels; t++) {
+    rgba[t * 4 + channel] =
+        static_cast<std::uint8_t>(palette[reader.Read(3)]);
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// BC7 mode 6
+//*--------------------------------------------------------------------------------
+
+static constexpr std::array<int, 16> kBC7Weights{0,  4,  9,  13, 17, 21, 26, 30,
+                                                 34, 38, 43, 47, 51, 55, 60, 64};
+
+/**< @brief 7bit の値と共有の P ビットで表した端点 */
+struct Mode6Endpoint {
+  std::array<int, 4> q{};
+  int p = 0;
+
+  int Expand(int c) const { return (q[static_cast<std::size_t>(c)] << 1) | p; }
+};
+
+static Mode6Endpoint QuantizeMode6(const Vec4 &e) {
+  Mode6Endpoint best{};
+  float bestError = std::numeric_limits<float>::max();
+  for (int p = 0; p < 2; p++) {
+    Mode6Endpoint ep{};
+    ep.p = p;
+    float error = 0.0f;
+    for (int c = 0; c < 4; c++) {
+      const long q = std::lround((e[c] - static_cast<float>(p)) * 0.5f);
+      ep.q[static_cast<std::size_t>(c)] = static_cast<int>(std::clamp(q, 0L, 127L));
+      const float d = static_cast<float>(ep.Expand(c)) - e[c];
+      error += d * d;
+    }
+    if (error < bestError) {
+      bestError = error;
+      best = ep;
+    }
+  }
+  return best;
+}
+
+static std::array<Vec4, 16> BuildMode6Palette(const Mode6Endpoint &e0,
+                                              const Mode6Endpoint &e1) {
+  std::array<Vec4, 16> palette{};
+  for (std::size_t i = 0; i < palette.size(); i++) {
+    const int w = kBC7Weights[i];
+    for (int c = 0; c < 4; c++) {
+      palette[i][c] = static_cast<float>(
+          ((64 - w) * e0.Expand(c) + w * e1.Expand(c) + 32) >> 6);
+    }
+  }
+  return palette;
+}
+
+static void EncodeBC7(const Texels &px, std::uint8_t *out) {
+  static const auto kWeights = [] {
+    std::array<float, 16> weights{};
+    for (std::size_t i = 0; i < weights.size(); i++) {
+      weights[i] = static_cast<float>(kBC7Weights[i]) / 64.0f;
+    }
+    return weights;
+  }();
+
+  Mode6Endpoint best0{}, best1{};
+  Indices best{};
+  float bestError = std::numeric_limits<float>::max();
+  const auto Try = [&](const Vec4 &e0, const Vec4 &e1) {
+    const Mode6Endpoint q0 = QuantizeMode6(e0);
+    const Mode6Endpoint q1 = QuantizeMode6(e1);
+    Indices indices{};
+    const float error =
+        SelectIndices(px, 4, BuildMode6Palette(q0, q1).data(), 16, indices);
+    if (error < bestError) {
+      bestError = error;
+      best0 = q0;
+      best1 = q1;
+      best = indices;
+    }
+  };
+
+  Vec4 e0{}, e1{};
+  FitEndpoints(px, 4, e0, e1);
+  Try(e0, e1);
+  for (int iter = 0; iter < 2; iter++) {
+    if (!RefineEndpoints(px, 4, best, kWeights.data(), e0, e1)) {
+      break;
+    }
+    Try(e0, e1);
+  }
+
+  // 先頭のインデックスは最上位ビットを省略するため、0 になるよう端点を入れ替えます。
+  if (best[0] & 8) {
+    std::swap(best0, best1);
+    for (auto &index : best) {
+      index = 15 - index;
+    }
+  }
+
+  std::fill(out, out + 16, std::uint8_t{0});
+  BitWriter writer{out};
+  writer.Write(1u << 6, 7);
+  for (int c = 0; c < 4; c++) {
+    writer.Write(static_cast<std::uint32_t>(best0.q[static_cast<std::size_t>(c)]), 7);
+    writer.Write(static_cast<std::uint32_t>(best1.q[static_cast<std::size_t>(c)]), 7);
+  }
+  writer.Write(static_cast<std::uint32_t>(best0.p), 1);
+  writer.Write(static_cast<std::uint32_t>(best1.p), 1);
+  for (int t = 0; t < kBlockTexels; t++) {
+    writer.Write(static_cast<std::uint32_t>(best[t]), t == 0 ? 3 : 4);
+  }
+}
+
+static bool DecodeBC7(const std::uint8_t *in, std::uint8_t *rgba) {
+  if ((in[0] & 0x7F) != 0x40) {
+    return false;
+  }
+  BitReader reader{in, 7};
+  Mode6Endpoint e0{}, e1{};
+  for (std::size_t c = 0; c < 4; c++) {
+    e0.q[c] = static_cast<int>(reader.Read(7));
+    e1.q[c] = static_cast<int>(reader.Read(7));
+  }
+  e0.p = static_cast<int>(reader.Read(1));
+  e1.p = static_cast<int>(reader.Read(1));
+  const auto palette = BuildMode6Palette(e0, e1);
+  for (int t = 0; t < kBlockTexels; t++) {
+    const auto &color = palette[reader.Read(t == 0 ? 3 : 4)];
+    for (int c = 0; c < 4; c++) {
+      rgba[t * 4 + c] = static_cast<std::uint8_t>(color[c]);
+    }
+  }
+  return true;
+}
+
+//*--------------------------------------------------------------------------------
+// Format
+//*--------------------------------------------------------------------------------
+
+std::size_t GetBlockBytes(BlockFormat format) {
+  return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+std::size_t ComputeLevelBytes(BlockFormat format, int width, int height) {
+  const auto bx = static_cast<std::size_t>((width + kBlockDim - 1) / kBlockDim);
+  const auto by = static_cast<std::size_t>((height + kBlockDim - 1) / kBlockDim);
+  return bx * by * GetBlockBytes(format);
+}
+
+const char *ToString(BlockFormat format) {
+  switch (format) {
+  case BlockFormat::BC1:
+    return "bc1";
+  case BlockFormat::BC3:
+    return "bc3";
+  case BlockFormat::BC5:
+    return "bc5";
+  case BlockFormat::BC7:
+    return "bc7";
+  }
+  return "";
+}
+
+std::optional<BlockFormat> FromString(std::string_view name) {
+  for (const auto format : {BlockFormat::BC1, BlockFormat::BC3,
+                            BlockFormat::BC5, BlockFormat::BC7}) {
+    if (name == ToString(format)) {
+      return format;
+    }
+  }
+  return std::nullopt;
+}
+
+//*--------------------------------------------------------------------------------
+// Block
+//*--------------------------------------------------------------------------------
+
+void EncodeBlock(BlockFormat format, const std::uint8_t *rgba,
+                 std::uint8_t *out) {
+  const Texels px = ToTexels(rgba);
+  switch (format) {
+  case BlockFormat::BC1:
+    EncodeColor(px, out);
+    break;
+  case BlockFormat::BC3:
+    EncodeSingle(px, 3, out);
+    EncodeColor(px, out + 8);
+    break;
+  case BlockFormat::BC5:
+    EncodeSingle(px, 0, out);
+    EncodeSingle(px, 1, out + 8);
+    break;
+  case BlockFormat::BC7:
+    EncodeBC7(px, out);
+    break;
+  }
+}
+
+bool DecodeBlock(BlockFormat format, const std::uint8_t *in,
+                 std::uint8_t *rgba) {
+  switch (format) {
+  case BlockFormat::BC1:
+    DecodeColor(in, false, rgba);
+    return true;
+  case BlockFormat::BC3:
+    DecodeColor(in + 8, true, rgba);
+    DecodeSingle(in, 3, rgba);
+    return true;
+  case BlockFormat::BC5:
+    DecodeSingle(in, 0, rgba);
+    DecodeSingle(in + 8, 1, rgba);
+    for (int t = 0; t < kBlockTexels; t++) {
+      rgba[t * 4 + 2] = 0;
+      rgba[t * 4 + 3] = 255;
+    }
+    return true;
+  case BlockFormat::BC7:
+    return DecodeBC7(in, rgba);
+  }
+  return false;
+}
+
+//*--------------------------------------------------------------------------------
+// Level
+//*--------------------------------------------------------------------------------
+
+void EncodeBlockRows(BlockFormat format, const std::uint8_t *rgba, int width,
+                     int height, int begin, int end, std::uint8_t *out) {
+  const int blocksX = (width + kBlockDim - 1) / kBlockDim;
+  const std::size_t blockBytes = GetBlockBytes(format);
+  std::array<std::uint8_t, kBlockTexels * 4> block{};
+  for (int by = begin; by < end; by++) {
+    for (int bx = 0; bx < blocksX; bx++) {
+      // 端の不完全なブロックは境界の texel を繰り返して埋めます。
+      for (int y = 0; y < kBlockDim; y++) {
+        const int sy = std::min(by * kBlockDim + y, height - 1);
+        for (int x = 0; x < kBlockDim; x++) {
+          const int sx = std::min(bx * kBlockDim + x, width - 1);
+          const std::uint8_t *src =
+              rgba + (static_cast<std::size_t>(sy) * static_cast<std::size_t>(width) +
+                      static_cast<std::size_t>(sx)) * 4;
+          std::copy(src, src + 4, block.begin() + (y * kBlockDim + x) * 4);
+        }
+      }
+      EncodeBlock(format, block.data(),
+                  out + (static_cast<std::size_t>(by) * static_cast<std::size_t>(blocksX) +
+                         static_cast<std::size_t>(bx)) * blockBytes);
+    }
+  }
+}
+
+std::vector<std::uint8_t> Encode(BlockFormat format, const std::uint8_t *rgba,
+                                 int width, int height) {
+  std::vector<std::uint8_t> out(ComputeLevelBytes(format, width, height));
+  EncodeBlockRows(format, rgba, width, height, 0,
+                  (height + kBlockDim - 1) / kBlockDim, out.data());
+  return out;
+}
+
+std::optional<std::vector<std::uint8_t>>
+Decode(BlockFormat format, const std::uint8_t *data, int width, int height) {
+  const int blocksX = (width + kBlockDim - 1) / kBlockDim;
+  const int blocksY = (height + kBlockDim - 1) / kBlockDim;
+  const std::size_t blockBytes = GetBlockBytes(format);
+  std::vector<std::uint8_t> rgba(static_cast<std::size_t>(width) *
+                                 static_cast<std::size_t>(height) * 4);
+  std::array<std::uint8_t, kBlockTexels * 4> block{};
+  for (int by = 0; by < blocksY; by++) {
+    for (int bx = 0; bx < blocksX; bx++) {
+      const std::uint8_t *in =
+          data + (static_cast<std::size_t>(by) * static_cast<std::size_t>(blocksX) +
+                  static_cast<std::size_t>(bx)) * blockBytes;
+      if (!DecodeBlock(format, in, block.data())) {
+        return std::nullopt;
+      }
+      for (int y = 0; y < kBlockDim && by * kBlockDim + y < height; y++) {
+        for (int x = 0; x < kBlockDim && bx * kBlockDim + x < width; x++) {
+          const std::size_t dst =
+              (static_cast<std::size_t>(by * kBlockDim + y) * static_cast<std::size_t>(width) +
+               static_cast<std::size_t>(bx * kBlockDim + x)) * 4;
+          std::copy(block.begin() + (y * kBlockDim + x) * 4,
+                    block.begin() + (y * kBlockDim + x) * 4 + 4,
+                    rgba.begin() + static_cast<std::ptrdiff_t>(dst));
+        }
+      }
+    }
+  }
+  return rgba;
+}
+
+} // namespace BlockCompression
@@ -0,0 +1,92 @@
+/**
+ * @brief  Block compression (BC1/BC3/BC5/BC7)
+ * @note   4x4 texel のブロック単位で 8bit RGBA を圧縮、展開します。
+ * GL を使わないので、オフラインのクッカーからも使えます。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef BLOCK_COMPRESSION_H
+#define BLOCK_COMPRESSION_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+// ********************************************************************************
+// Enum
+// ********************************************************************************
+
+/**
+ * @brief ブロック圧縮の形式
+ * @note BC1 は不透明 (アルファを持たない) 4 色モードのみで圧縮します。
+ * BC7 の圧縮はモード 6 (1 サブセット、RGBA、4bit インデックス) のみを使います。
+ */
+enum struct BlockFormat {
+  BC1, // RGB    8 byte/block
+  BC3, // RGBA  16 byte/block
+  BC5, // RG    16 byte/block (法線マップ向け)
+  BC7, // RGBA  16 byte/block
+};
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace BlockCompression {
+
+static constexpr int kBlockDim = 4;
+static constexpr int kBlockTexels = kBlockDim * kBlockDim;
+
+std::size_t GetBlockBytes(BlockFormat format);
+
+/**< @brief 1 レベル分の大きさ (端の不完全なブロックも 1 ブロックとして数えます) */
+std::size_t ComputeLevelBytes(BlockFormat format, int width, int height);
+
+const char *ToString(BlockFormat format);
+std::optional<BlockFormat> FromString(std::string_view name);
+
+/**
+ * @brief 1 ブロックを圧縮します。
+ * @param rgba 4x4 texel の RGBA (行優先)
+ */
+void EncodeBlock(BlockFormat format, const std::uint8_t *rgba,
+                 std::uint8_t *out);
+
+/**
+ * @brief 1 ブロックを展開します。
+ * @return 対応していないブロック (BC7 のモード 6 以外) であれば false
+ */
+bool DecodeBlock(BlockFormat format, const std::uint8_t *in,
+                 std::uint8_t *rgba);
+
+/**
+ * @brief ブロックの行 [begin, end) を圧縮します。
+ * @param out レベル全体の出力先 (ComputeLevelBytes の大きさ)
+ * @note 行ごとに独立しているので、呼び出し側で並列に処理できます。
+ */
+void EncodeBlockRows(BlockFormat format, const std::uint8_t *rgba, int width,
+                     int height, int begin, int end, std::uint8_t *out);
+
+/**< @brief 1 レベル全体を圧縮します。 */
+std::vector<std::uint8_t> Encode(BlockFormat format, const std::uint8_t *rgba,
+                                 int width, int height);
+
+/**
+ * @brief 1 レベル全体を 8bit RGBA に展開します。
+ * @return 展開できないブロックがあれば std::nullopt
+ */
+std::optional<std::vector<std::uint8_t>>
+Decode(BlockFormat format, const std::uint8_t *data, int width, int height);
+
+} // namespace BlockCompression
+
+#endif
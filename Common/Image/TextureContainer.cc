@@ -0,0 +1,433 @@
+/**
+ * @brief  Compressed texture container (KTX2 / DDS)
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Image/TextureContainer.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+namespace TextureContainer {
+
+//*--------------------------------------------------------------------------------
+// Constant
+//*--------------------------------------------------------------------------------
+
+static constexpr std::array<std::uint8_t, 12> kKTX2Identifier{
+    0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+static constexpr std::size_t kKTX2HeaderBytes = 80;
+static constexpr std::size_t kKTX2LevelIndexBytes = 24;
+
+static constexpr std::uint32_t kDDSMagic = 0x20534444; // "DDS "
+static constexpr std::size_t kDDSHeaderBytes = 124;
+static constexpr std::size_t kDDSDX10HeaderBytes = 20;
+
+static constexpr std::uint32_t MakeFourCC(char a, char b, char c, char d) {
+  return static_cast<std::uint32_t>(a) | (static_cast<std::uint32_t>(b) << 8) |
+         (static_cast<std::uint32_t>(c) << 16) |
+         (static_cast<std::uint32_t>(d) << 24);
+}
+
+/**< @brief 形式ごとの識別子 */
+struct FormatInfo {
+  BlockFormat format;
+  bool isSRGB;
+  std::uint32_t vkFormat;
+  std::uint32_t dxgiFormat;
+};
+
+static constexpr std::array<FormatInfo, 7> kFormats{{
+    {BlockFormat::BC1, false, 131, 71}, // VK_FORMAT_BC1_RGB_UNORM_BLOCK
+    {BlockFormat::BC1, true, 132, 72},
+    {BlockFormat::BC3, false, 137, 77},
+    {BlockFormat::BC3, true, 138, 78},
+    {BlockFormat::BC5, false, 141, 83},
+    {BlockFormat::BC7, false, 145, 98},
+    {BlockFormat::BC7, true, 146, 99},
+}};
+
+static const FormatInfo *FindFormat(BlockFormat format, bool isSRGB) {
+  for (const auto &info : kFormats) {
+    if (info.format == format && info.isSRGB == isSRGB) {
+      return &info;
+    }
+  }
+  // BC5 には sRGB が無いので線形として扱います。
+  return isSRGB ? FindFormat(format, false) : nullptr;
+}
+
+//*--------------------------------------------------------------------------------
+// Byte helper
+//*--------------------------------------------------------------------------------
+
+static void PutU32(std::vector<std::uint8_t> &out, std::uint32_t v) {
+  for (int i = 0; i < 4; i++) {
+    out.emplace_back(static_cast<std::uint8_t>(v >> (i * 8)));
+  }
+}
+
+static void SetU32(std::vector<std::uint8_t> &out, std::size_t offset,
+                   std::uint32_t v) {
+  for (std::size_t i = 0; i < 4; i++) {
+    out[offset + i] = static_cast<std::uint8_t>(v >> (i * 8));
+  }
+}
+
+static void SetU64(std::vector<std::uint8_t> &out, std::size_t offset,
+                   std::uint64_t v) {
+  SetU32(out, offset, static_cast<std::uint32_t>(v));
+  SetU32(out, offset + 4, static_cast<std::uint32_t>(v >> 32));
+}
+
+static void Align(std::vector<std::uint8_t> &out, std::size_t alignment) {
+  while (out.size() % alignment != 0) {
+    out.emplace_back(0);
+  }
+}
+
+static std::uint64_t Get(const std::vector<std::uint8_t> &bytes,
+                         std::size_t offset, std::size_t size) {
+  std::uint64_t v = 0;
+  for (std::size_t i = 0; i < size; i++) {
+    v |= static_cast<std::uint64_t>(bytes[offset + i]) << (i * 8);
+  }
+  return v;
+}
+
+static std::uint32_t GetU32(const std::vector<std::uint8_t> &bytes,
+                            std::size_t offset) {
+  return static_cast<std::uint32_t>(Get(bytes, offset, 4));
+}
+
+static std::uint64_t GetU64(const std::vector<std::uint8_t> &bytes,
+                            std::size_t offset) {
+  return Get(bytes, offset, 8);
+}
+
+static std::string GetExtension(const std::string &path) {
+  std::string ext = std::filesystem::path(path).extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+  return ext;
+}
+
+/**
+ * @brief レベルの大きさを確かめて取り出します。
+ */
+static std::optional<std::string>
+ReadLevel(const std::vector<std::uint8_t> &bytes, std::uint64_t offset,
+          std::uint64_t length, int level, CompressedTexture &out) {
+  const int w = std::max(1, out.width >> level);
+  const int h = std::max(1, out.height >> level);
+  if (length != BlockCompression::ComputeLevelBytes(out.format, w, h)) {
+    return "Invalid size of level " + std::to_string(level);
+  }
+  if (offset > bytes.size() || length > bytes.size() - offset) {
+    return "Level " + std::to_string(level) + " is out of range";
+  }
+  const auto begin = bytes.begin() + static_cast<std::ptrdiff_t>(offset);
+  out.levels.emplace_back(begin, begin + static_cast<std::ptrdiff_t>(length));
+  return std::nullopt;
+}
+
+//*--------------------------------------------------------------------------------
+// KTX2
+//*--------------------------------------------------------------------------------
+
+/**
+ * @brief Khronos Data Format の Basic Descriptor Block を作ります。
+ */
+static std::vector<std::uint8_t> MakeDFD(BlockFormat format, bool isSRGB) {
+  struct Sample {
+    std::uint32_t bitOffset;
+    std::uint32_t bitLength; // ビット数 - 1
+    std::uint32_t channel;
+  };
+  std::uint32_t model = 0;
+  std::vector<Sample> samples{};
+  switch (format) {
+  case BlockFormat::BC1:
+    model = 128; // KHR_DF_MODEL_BC1A
+    samples = {{0, 63, 0}};
+    break;
+  case BlockFormat::BC3:
+    model = 130; // KHR_DF_MODEL_BC3
+    samples = {{0, 63, 15 | 0x10}, {64, 63, 0}}; // アルファは常に線形
+    break;
+  case BlockFormat::BC5:
+    model = 132; // KHR_DF_MODEL_BC5
+    samples = {{0, 63, 0}, {64, 63, 1}};
+    break;
+  case BlockFormat::BC7:
+    model = 134; // KHR_DF_MODEL_BC7
+    samples = {{0, 127, 0}};
+    break;
+  }
+  const auto blockSize = static_cast<std::uint32_t>(24 + 16 * samples.size());
+  const std::uint32_t transfer = isSRGB ? 2 : 1; // KHR_DF_TRANSFER_SRGB : LINEAR
+
+  std::vector<std::uint8_t> dfd;
+  PutU32(dfd, 4 + blockSize); // dfdTotalSize
+  PutU32(dfd, 0);             // vendorId, descriptorType
+  PutU32(dfd, 2 | (blockSize << 16));
+  PutU32(dfd, model | (1u << 8) | (transfer << 16)); // primaries: BT709
+  PutU32(dfd, 3 | (3u << 8));                        // 4x4 texel block
+  PutU32(dfd, static_cast<std::uint32_t>(BlockCompression::GetBlockBytes(format)));
+  PutU32(dfd, 0);
+  for (const auto &sample : samples) {
+    PutU32(dfd, sample.bitOffset | (sample.bitLength << 16) |
+                    (sample.channel << 24));
+    PutU32(dfd, 0);
+    PutU32(dfd, 0);
+    PutU32(dfd, 0xFFFFFFFF);
+  }
+  return dfd;
+}
+
+std::vector<std::uint8_t> SerializeKTX2(const CompressedTexture &texture) {
+  const FormatInfo *info = FindFormat(texture.format, texture.isSRGB);
+  const auto levelCount = static_cast<std::uint32_t>(texture.levels.size());
+
+  std::vector<std::uint8_t> out(kKTX2Identifier.begin(), kKTX2Identifier.end());
+  PutU32(out, info->vkFormat);
+  PutU32(out, 1); // typeSize
+  PutU32(out, static_cast<std::uint32_t>(texture.width));
+  PutU32(out, static_cast<std::uint32_t>(texture.height));
+  PutU32(out, 0); // pixelDepth
+  PutU32(out, 0); // layerCount
+  PutU32(out, 1); // faceCount
+  PutU32(out, levelCount);
+  PutU32(out, 0); // supercompressionScheme
+
+  const std::size_t indexOffset = out.size();
+  out.resize(kKTX2HeaderBytes + kKTX2LevelIndexBytes * levelCount);
+
+  const auto dfdOffset = static_cast<std::uint32_t>(out.size());
+  const auto dfd = MakeDFD(info->format, info->isSRGB);
+  out.insert(out.end(), dfd.begin(), dfd.end());
+
+  const auto kvdOffset = static_cast<std::uint32_t>(out.size());
+  static constexpr char kKey[] = "KTXorientation";
+  static constexpr char kValue[] = "ru";
+  PutU32(out, sizeof(kKey) + sizeof(kValue));
+  out.insert(out.end(), kKey, kKey + sizeof(kKey));
+  out.insert(out.end(), kValue, kValue + sizeof(kValue));
+  Align(out, 4);
+  const auto kvdLength = static_cast<std::uint32_t>(out.size()) - kvdOffset;
+
+  SetU32(out, indexOffset + 0, dfdOffset);
+  SetU32(out, indexOffset + 4, static_cast<std::uint32_t>(dfd.size()));
+  SetU32(out, indexOffset + 8, kvdOffset);
+  SetU32(out, indexOffset + 12, kvdLength);
+
+  // レベルのデータは小さいものから順に、ブロックの大きさに揃えて並べます。
+  const std::size_t alignment = BlockCompression::GetBlockBytes(texture.format);
+  for (std::size_t level = texture.levels.size(); level-- > 0;) {
+    Align(out, alignment);
+    const std::size_t entry = kKTX2HeaderBytes + kKTX2LevelIndexBytes * level;
+    const auto &data = texture.levels[level];
+    SetU64(out, entry + 0, out.size());
+    SetU64(out, entry + 8, data.size());
+    SetU64(out, entry + 16, data.size());
+    out.insert(out.end(), data.begin(), data.end());
+  }
+  return out;
+}
+
+std::optional<std::string> ParseKTX2(const std::vector<std::uint8_t> &bytes,
+                                     CompressedTexture &out) {
+  if (bytes.size() < kKTX2HeaderBytes ||
+      !std::equal(kKTX2Identifier.begin(), kKTX2Identifier.end(),
+                  bytes.begin())) {
+    return std::string("Not a KTX2 file");
+  }
+  const std::uint32_t vkFormat = GetU32(bytes, 12);
+  const auto it = std::find_if(
+      kFormats.begin(), kFormats.end(),
+      [vkFormat](const FormatInfo &info) { return info.vkFormat == vkFormat; });
+  if (it == kFormats.end()) {
+    return "Unsupported vkFormat " + std::to_string(vkFormat);
+  }
+  if (GetU32(bytes, 28) > 1 || GetU32(bytes, 32) > 1 ||
+      GetU32(bytes, 36) != 1) {
+    return std::string("Only 2D textures are supported");
+  }
+  if (GetU32(bytes, 44) != 0) {
+    return std::string("Supercompression is not supported");
+  }
+
+  out.format = it->format;
+  out.isSRGB = it->isSRGB;
+  out.width = static_cast<int>(GetU32(bytes, 20));
+  out.height = static_cast<int>(std::max(1u, GetU32(bytes, 24)));
+  out.levels.clear();
+  const std::uint32_t levelCount = std::max(1u, GetU32(bytes, 40));
+  if (bytes.size() < kKTX2HeaderBytes + kKTX2LevelIndexBytes * levelCount) {
+    return std::string("Truncated level index");
+  }
+  for (std::uint32_t level = 0; level < levelCount; level++) {
+    const std::size_t entry = kKTX2HeaderBytes + kKTX2LevelIndexBytes * level;
+    if (auto msg = ReadLevel(bytes, GetU64(bytes, entry),
+                             GetU64(bytes, entry + 8),
+                             static_cast<int>(level), out)) {
+      return msg;
+    }
+  }
+  return std::nullopt;
+}
+
+//*--------------------------------------------------------------------------------
+// DDS
+//*--------------------------------------------------------------------------------
+
+std::vector<std::uint8_t> SerializeDDS(const CompressedTexture &texture) {
+  static constexpr std::uint32_t kFlags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 |
+                                          0x80000; // CAPS ... LINEARSIZE
+  static constexpr std::uint32_t kFourCCFlag = 0x4;
+  static constexpr std::uint32_t kCapsTexture = 0x1000;
+  static constexpr std::uint32_t kCapsMipmap = 0x8 | 0x400000;
+  static constexpr std::uint32_t kDimensionTexture2D = 3;
+
+  const FormatInfo *info = FindFormat(texture.format, texture.isSRGB);
+  const auto levelCount = static_cast<std::uint32_t>(texture.levels.size());
+
+  std::vector<std::uint8_t> out;
+  PutU32(out, kDDSMagic);
+  PutU32(out, kDDSHeaderBytes);
+  PutU32(out, kFlags);
+  PutU32(out, static_cast<std::uint32_t>(texture.height));
+  PutU32(out, static_cast<std::uint32_t>(texture.width));
+  PutU32(out, static_cast<std::uint32_t>(texture.levels.front().size()));
+  PutU32(out, 0); // depth
+  PutU32(out, levelCount);
+  out.resize(out.size() + 11 * 4); // reserved
+  PutU32(out, 32);                 // pixel format
+  PutU32(out, kFourCCFlag);
+  PutU32(out, MakeFourCC('D', 'X', '1', '0'));
+  out.resize(out.size() + 5 * 4); // bit count, masks
+  PutU32(out, kCapsTexture | (levelCount > 1 ? kCapsMipmap : 0));
+  out.resize(out.size() + 4 * 4); // caps2, caps3, caps4, reserved
+
+  PutU32(out, info->dxgiFormat);
+  PutU32(out, kDimensionTexture2D);
+  PutU32(out, 0); // miscFlag
+  PutU32(out, 1); // arraySize
+  PutU32(out, 0); // miscFlags2
+
+  for (const auto &data : texture.levels) {
+    out.insert(out.end(), data.begin(), data.end());
+  }
+  return out;
+}
+
+std::optional<std::string> ParseDDS(const std::vector<std::uint8_t> &bytes,
+                                    CompressedTexture &out) {
+  if (bytes.size() < 4 + kDDSHeaderBytes || GetU32(bytes, 0) != kDDSMagic) {
+    return std::string("Not a DDS file");
+  }
+  out.height = static_cast<int>(GetU32(bytes, 12));
+  out.width = static_cast<int>(GetU32(bytes, 16));
+  const std::uint32_t levelCount = std::max(1u, GetU32(bytes, 28));
+  const std::uint32_t fourCC = GetU32(bytes, 84);
+  std::size_t offset = 4 + kDDSHeaderBytes;
+
+  out.isSRGB = false;
+  if (fourCC == MakeFourCC('D', 'X', 'T', '1')) {
+    out.format = BlockFormat::BC1;
+  } else if (fourCC == MakeFourCC('D', 'X', 'T', '5')) {
+    out.format = BlockFormat::BC3;
+  } else if (fourCC == MakeFourCC('A', 'T', 'I', '2') ||
+             fourCC == MakeFourCC('B', 'C', '5', 'U')) {
+    out.format = BlockFormat::BC5;
+  } else if (fourCC == MakeFourCC('D', 'X', '1', '0')) {
+    if (bytes.size() < offset + kDDSDX10HeaderBytes) {
+      return std::string("Truncated DX10 header");
+    }
+    const std::uint32_t dxgiFormat = GetU32(bytes, offset);
+    const auto it = std::find_if(kFormats.begin(), kFormats.end(),
+                                 [dxgiFormat](const FormatInfo &info) {
+                                   return info.dxgiFormat == dxgiFormat;
+                                 });
+    if (it == kFormats.end()) {
+      return "Unsupported DXGI format " + std::to_string(dxgiFormat);
+    }
+    if (GetU32(bytes, offset + 4) != 3 || GetU32(bytes, offset + 12) > 1) {
+      return std::string("Only 2D textures are supported");
+    }
+    out.format = it->format;
+    out.isSRGB = it->isSRGB;
+    offset += kDDSDX10HeaderBytes;
+  } else {
+    return std::string("Unsupported DDS pixel format");
+  }
+
+  out.levels.clear();
+  for (std::uint32_t level = 0; level < levelCount; level++) {
+    const std::size_t length = BlockCompression::ComputeLevelBytes(
+        out.format, std::max(1, out.width >> level),
+        std::max(1, out.height >> level));
+    if (auto msg = ReadLevel(bytes, offset, length, static_cast<int>(level),
+                             out)) {
+      return msg;
+    }
+    offset += length;
+  }
+  return std::nullopt;
+}
+
+//*--------------------------------------------------------------------------------
+// File
+//*--------------------------------------------------------------------------------
+
+bool IsSupportedPath(const std::string &path) {
+  const std::string ext = GetExtension(path);
+  return ext == ".ktx2" || ext == ".dds";
+}
+
+std::optional<std::string> Read(const std::string &path,
+                                CompressedTexture &out) {
+  std::ifstream infile(path, std::ios::in | std::ios::binary);
+  if (!infile) {
+    return "Can't open file : " + path;
+  }
+  const std::vector<std::uint8_t> bytes(
+      (std::istreambuf_iterator<char>(infile)),
+      std::istreambuf_iterator<char>());
+
+  const auto msg = GetExtension(path) == ".dds" ? ParseDDS(bytes, out)
+                                                 : ParseKTX2(bytes, out);
+  if (msg) {
+    return msg.value() + " : " + path;
+  }
+  return std::nullopt;
+}
+
+std::optional<std::string> Write(const std::string &path,
+                                 const CompressedTexture &texture) {
+  if (texture.levels.empty() ||
+      FindFormat(texture.format, texture.isSRGB) == nullptr) {
+    return "Nothing to write : " + path;
+  }
+  const auto bytes = GetExtension(path) == ".dds" ? SerializeDDS(texture)
+                                                  : SerializeKTX2(texture);
+  std::ofstream outfile(path, std::ios::out | std::ios::binary);
+  if (!outfile) {
+    return "Can't open file : " + path;
+  }
+  outfile.write(reinterpret_cast<const char *>(bytes.data()),
+                static_cast<std::streamsize>(bytes.size()));
+  if (!outfile) {
+    return "Failed to write : " + path;
+  }
+  return std::nullopt;
+}
+
+} // namespace TextureContainer
@@ -0,0 +1,70 @@
+/**
+ * @brief  Compressed texture container (KTX2 / DDS)
+ * @note   ブロック圧縮済みのテクスチャを全てのレベルごと読み書きします。
+ * 対応しているのは 2D、1 レイヤー、超圧縮 (supercompression) なしのファイルです。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef TEXTURE_CONTAINER_H
+#define TEXTURE_CONTAINER_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Image/BlockCompression.h"
+
+// ********************************************************************************
+// Struct(s)
+// ********************************************************************************
+
+/**< @brief ブロック圧縮されたテクスチャ */
+struct CompressedTexture {
+  BlockFormat format = BlockFormat::BC7;
+  bool isSRGB = false;
+  int width = 0;
+  int height = 0;
+  std::vector<std::vector<std::uint8_t>> levels{}; // レベル 0 から順に格納
+};
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace TextureContainer {
+
+/**< @brief 拡張子が .ktx2 か .dds であれば true */
+bool IsSupportedPath(const std::string &path);
+
+/**
+ * @brief 拡張子から形式を選んで読み込みます。
+ * @return 失敗した場合はエラーメッセージ
+ */
+std::optional<std::string> Read(const std::string &path,
+                                CompressedTexture &out);
+
+/**
+ * @brief 拡張子から形式を選んで書き込みます。
+ * @note KTX2 には行が下から上に並んでいること (KTXorientation "ru") を記録します。
+ */
+std::optional<std::string> Write(const std::string &path,
+                                 const CompressedTexture &texture);
+
+std::optional<std::string> ParseKTX2(const std::vector<std::uint8_t> &bytes,
+                                     CompressedTexture &out);
+std::optional<std::string> ParseDDS(const std::vector<std::uint8_t> &bytes,
+                                    CompressedTexture &out);
+std::vector<std::uint8_t> SerializeKTX2(const CompressedTexture &texture);
+std::vector<std::uint8_t> SerializeDDS(const CompressedTexture &texture);
+
+} // namespace TextureContainer
+
+#endif
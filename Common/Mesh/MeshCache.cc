@@ -0,0 +1,309 @@
+/**
+ * @brief  Binary mesh cache
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Mesh/MeshCache.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string_view>
+
+namespace MeshCache {
+
+//*--------------------------------------------------------------------------------
+// Constant
+//*--------------------------------------------------------------------------------
+
+static constexpr std::uint64_t kHashSeed = 0xcbf29ce484222325ull;
+static constexpr std::uint64_t kHashPrime = 0x100000001b3ull;
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+/**< @brief FNV-1a */
+static std::uint64_t Hash(const std::uint8_t *data, std::size_t size,
+                          std::uint64_t hash = kHashSeed) {
+  for (std::size_t i = 0; i < size; i++) {
+    hash ^= data[i];
+    hash *= kHashPrime;
+  }
+  return hash;
+}
+
+static std::uint64_t AlignUp(std::uint64_t value) {
+  return (value + kAlignment - 1) / kAlignment * kAlignment;
+}
+
+static bool IsInside(std::uint64_t offset, std::uint64_t bytes,
+                     std::uint64_t fileSize) {
+  return offset % kAlignment == 0 && offset <= fileSize &&
+         bytes <= fileSize - offset;
+}
+
+/**< @brief ヘッダーの内容がファイルの大きさと矛盾しないか */
+static bool IsConsistent(const Header &h, std::uint64_t fileSize) {
+  const std::uint64_t indexSize =
+      h.indexType == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  const GLuint stride = TriangleMesh::GetLayoutStride(h.layout);
+  return (h.indexType == GL_UNSIGNED_SHORT || h.indexType == GL_UNSIGNED_INT) &&
+         h.indexBytes == std::uint64_t{h.indexCount} * indexSize &&
+         stride != 0 &&
+         h.vertexBytes == std::uint64_t{h.vertexCount} * stride &&
+         IsInside(h.submeshOffset,
+                  std::uint64_t{h.submeshCount} * sizeof(TriangleMesh::Submesh),
+                  fileSize) &&
+         h.lodCount > 0 &&
+         IsInside(h.lodOffset,
+                  std::uint64_t{h.lodCount} * sizeof(TriangleMesh::LodLevel),
+                  fileSize) &&
+         IsInside(h.clusterOffset,
+                  std::uint64_t{h.clusterCount} * sizeof(TriangleMesh::Cluster),
+                  fileSize) &&
+         IsInside(h.vertexOffset, h.vertexBytes, fileSize) &&
+         IsInside(h.indexOffset, h.indexBytes, fileSize);
+}
+
+/**< @brief 範囲が [0, indexCount) に収まるか */
+template <typename Range>
+static bool AreRangesInside(const std::vector<Range> &ranges,
+                            std::uint32_t indexCount) {
+  return std::all_of(ranges.begin(), ranges.end(), [&](const Range &range) {
+    return std::uint64_t{range.firstIndex} + range.indexCount <= indexCount;
+  });
+}
+
+/**< @brief 全てのインデックスが頂点の数より小さいか */
+template <typename Index>
+static bool AreIndicesInside(const std::uint8_t *data, std::uint32_t count,
+                             std::uint32_t vertexCount) {
+  for (std::uint32_t i = 0; i < count; i++) {
+    Index index = 0;
+    std::memcpy(&index, data + sizeof(Index) * i, sizeof(Index));
+    if (index >= vertexCount) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//*--------------------------------------------------------------------------------
+// Entry
+//*--------------------------------------------------------------------------------
+
+TriangleMesh::Streams Entry::GetStreams() const {
+  TriangleMesh::Streams streams{};
+  streams.layout = header_.layout;
+  streams.indexType = header_.indexType;
+  streams.vertexCount = header_.vertexCount;
+  streams.indexCount = header_.indexCount;
+  streams.vertices = file_.Data() + header_.vertexOffset;
+  streams.vertexBytes = static_cast<std::size_t>(header_.vertexBytes);
+  streams.indices = file_.Data() + header_.indexOffset;
+  streams.indexBytes = static_cast<std::size_t>(header_.indexBytes);
+  return streams;
+}
+
+std::vector<TriangleMesh::Submesh> Entry::GetSubmeshes() const {
+  std::vector<TriangleMesh::Submesh> submeshes(header_.submeshCount);
+  std::memcpy(submeshes.data(), file_.Data() + header_.submeshOffset,
+              submeshes.size() * sizeof(TriangleMesh::Submesh));
+  return submeshes;
+}
+
+std::vector<TriangleMesh::LodLevel> Entry::GetLods() const {
+  std::vector<TriangleMesh::LodLevel> lods(header_.lodCount);
+  std::memcpy(lods.data(), file_.Data() + header_.lodOffset,
+              lods.size() * sizeof(TriangleMesh::LodLevel));
+  return lods;
+}
+
+std::vector<TriangleMesh::Cluster> Entry::GetClusters() const {
+  std::vector<TriangleMesh::Cluster> clusters(header_.clusterCount);
+  std::memcpy(clusters.data(), file_.Data() + header_.clusterOffset,
+              clusters.size() * sizeof(TriangleMesh::Cluster));
+  return clusters;
+}
+
+AABB Entry::GetAABB() const {
+  AABB bbox{};
+  bbox.mini = glm::vec3(header_.bboxMin[0], header_.bboxMin[1],
+                        header_.bboxMin[2]);
+  bbox.maxi = glm::vec3(header_.bboxMax[0], header_.bboxMax[1],
+                        header_.bboxMax[2]);
+  return bbox;
+}
+
+MeshOptimizer::Report Entry::GetReport() const {
+  MeshOptimizer::Report report{};
+  report.before = {header_.acmr[0], header_.atvr[0]};
+  report.after = {header_.acmr[1], header_.atvr[1]};
+  return report;
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+bool IsEnabled() { return std::getenv(kDisableEnv) == nullptr; }
+
+std::optional<std::uint64_t> HashFile(const std::string &path,
+                                      std::uint64_t *size) {
+  MappedFile file{};
+  if (!file.Open(path)) {
+    return std::nullopt;
+  }
+  if (size != nullptr) {
+    *size = file.Size();
+  }
+  return Hash(file.Data(), file.Size());
+}
+
+std::filesystem::path GetPath(const std::string &sourcePath) {
+  const char *env = std::getenv(kDirEnv);
+  const std::filesystem::path dir(env != nullptr ? env : kDefaultDir);
+
+  std::error_code ec;
+  auto absolute = std::filesystem::weakly_canonical(sourcePath, ec);
+  if (ec) {
+    absolute = std::filesystem::path(sourcePath);
+  }
+  const std::string key = absolute.generic_string();
+  std::uint64_t hash =
+      Hash(reinterpret_cast<const std::uint8_t *>(key.data()), key.size());
+
+  static constexpr const char *kDigits = "0123456789abcdef";
+  std::string name(16, '0');
+  for (int i = 15; i >= 0; i--, hash >>= 4) {
+    name[static_cast<std::size_t>(i)] = kDigits[hash & 0xf];
+  }
+  return dir / (absolute.stem().string() + "_" + name + ".mesh");
+}
+
+std::optional<Entry> Load(const std::string &sourcePath,
+                          std::uint64_t sourceHash, std::uint64_t sourceSize,
+                          std::uint32_t loaderVersion, std::uint32_t cookFlags) {
+  Entry entry{};
+  if (!entry.file_.Open(GetPath(sourcePath).string()) ||
+      entry.file_.Size() < sizeof(Header)) {
+    return std::nullopt;
+  }
+  std::memcpy(&entry.header_, entry.file_.Data(), sizeof(Header));
+  const Header &h = entry.header_;
+  if (h.magic != kMagic || h.version != kFileVersion ||
+      h.loaderVersion != loaderVersion || h.cookFlags != cookFlags ||
+      h.sourceHash != sourceHash ||
+      h.sourceSize != sourceSize || !IsConsistent(h, entry.file_.Size())) {
+    return std::nullopt;
+  }
+
+  // 途中で切れたり壊れたりしたファイルを転送して範囲外を読まないよう、中身も確かめます。
+  const std::vector<TriangleMesh::Cluster> clusters = entry.GetClusters();
+  const bool isSubmeshInside =
+      std::all_of(clusters.begin(), clusters.end(),
+                  [&h](const TriangleMesh::Cluster &cluster) {
+                    return cluster.submesh < h.submeshCount;
+                  });
+  const std::uint8_t *indices = entry.file_.Data() + h.indexOffset;
+  const bool isIndexInside =
+      h.indexType == GL_UNSIGNED_SHORT
+          ? AreIndicesInside<GLushort>(indices, h.indexCount, h.vertexCount)
+          : AreIndicesInside<GLuint>(indices, h.indexCount, h.vertexCount);
+  if (!AreRangesInside(entry.GetSubmeshes(), h.indexCount) ||
+      !AreRangesInside(entry.GetLods(), h.indexCount) ||
+      !AreRangesInside(clusters, h.indexCount) || !isSubmeshInside ||
+      !isIndexInside) {
+    return std::nullopt;
+  }
+  return entry;
+}
+
+std::optional<std::string>
+Save(const std::string &sourcePath, std::uint64_t sourceHash,
+     std::uint64_t sourceSize, std::uint32_t loaderVersion,
+     std::uint32_t cookFlags, const TriangleMesh::Streams &streams,
+     const std::vector<TriangleMesh::Submesh> &submeshes,
+     const std::vector<TriangleMesh::LodLevel> &lods,
+     const std::vector<TriangleMesh::Cluster> &clusters, const AABB &bbox,
+     const MeshOptimizer::Report &report) {
+  Header h{};
+  h.loaderVersion = loaderVersion;
+  h.cookFlags = cookFlags;
+  h.layout = streams.layout;
+  h.sourceHash = sourceHash;
+  h.sourceSize = sourceSize;
+  h.indexType = streams.indexType;
+  h.vertexCount = streams.vertexCount;
+  h.indexCount = streams.indexCount;
+  h.submeshCount = static_cast<std::uint32_t>(submeshes.size());
+  h.submeshOffset = AlignUp(sizeof(Header));
+  h.lodCount = static_cast<std::uint32_t>(lods.size());
+  h.lodOffset = AlignUp(h.submeshOffset +
+                        submeshes.size() * sizeof(TriangleMesh::Submesh));
+  h.clusterCount = static_cast<std::uint32_t>(clusters.size());
+  h.clusterOffset =
+      AlignUp(h.lodOffset + lods.size() * sizeof(TriangleMesh::LodLevel));
+  h.vertexOffset = AlignUp(h.clusterOffset +
+                           clusters.size() * sizeof(TriangleMesh::Cluster));
+  h.vertexBytes = streams.vertexBytes;
+  h.indexOffset = AlignUp(h.vertexOffset + h.vertexBytes);
+  h.indexBytes = streams.indexBytes;
+  for (int i = 0; i < 3; i++) {
+    h.bboxMin[i] = bbox.mini[i];
+    h.bboxMax[i] = bbox.maxi[i];
+  }
+  h.acmr[0] = report.before.acmr;
+  h.acmr[1] = report.after.acmr;
+  h.atvr[0] = report.before.atvr;
+  h.atvr[1] = report.after.atvr;
+
+  const std::filesystem::path path = GetPath(sourcePath);
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  std::filesystem::path temp = path;
+  temp += ".tmp";
+
+  {
+    std::ofstream ofs(temp, std::ios::out | std::ios::binary);
+    if (!ofs) {
+      return "Can't open file : " + temp.string();
+    }
+    const auto write = [&ofs](std::uint64_t offset, const void *data,
+                              std::uint64_t bytes) {
+      static const char kZeros[kAlignment] = {};
+      const auto pos = static_cast<std::uint64_t>(ofs.tellp());
+      ofs.write(kZeros, static_cast<std::streamsize>(offset - pos));
+      ofs.write(static_cast<const char *>(data),
+                static_cast<std::streamsize>(bytes));
+    };
+    write(0, &h, sizeof(h));
+    write(h.submeshOffset, submeshes.data(),
+          submeshes.size() * sizeof(TriangleMesh::Submesh));
+    write(h.lodOffset, lods.data(),
+          lods.size() * sizeof(TriangleMesh::LodLevel));
+    write(h.clusterOffset, clusters.data(),
+          clusters.size() * sizeof(TriangleMesh::Cluster));
+    write(h.vertexOffset, streams.vertices, h.vertexBytes);
+    write(h.indexOffset, streams.indices, h.indexBytes);
+    if (!ofs) {
+      ofs.close();
+      std::filesystem::remove(temp, ec);
+      return "Failed to write : " + temp.string();
+    }
+  }
+
+  std::filesystem::rename(temp, path, ec);
+  if (ec) {
+    std::filesystem::remove(temp, ec);
+    return "Failed to rename : " + path.string();
+  }
+  return std::nullopt;
+}
+
+} // namespace MeshCache
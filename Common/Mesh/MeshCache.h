@@ -0,0 +1,121 @@
+/**
+ * @brief  Binary mesh cache
+ * @note   CookBuffers で作った頂点とインデックスをそのままファイルに保存し、
+ * 次回はファイルをメモリにマップして、解析もコピーもせずに glBufferData に渡します。
+ * 元のファイルの内容のハッシュ、読み込み処理のバージョン、CookBuffers に渡した処理が
+ * 一致しなければ作り直します。
+ *
+ * ファイルの構成 (各ブロックは kAlignment バイト境界から始まります)
+ * Header | Submesh[submeshCount] | LodLevel[lodCount] | Cluster[clusterCount] |
+ * 頂点データ | インデックスデータ
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Geometry/AABB.h"
+#include "Mesh/MeshOptimizer.h"
+#include "Primitive/TriangleMesh.h"
+#include "Utils/MappedFile.h"
+
+namespace MeshCache {
+
+/**< @brief キャッシュの保存先を変更する環境変数 */
+static constexpr const char *kDirEnv = "REGL_MESH_CACHE_DIR";
+/**< @brief 設定されていればキャッシュを使わない環境変数 */
+static constexpr const char *kDisableEnv = "REGL_NO_MESH_CACHE";
+static constexpr const char *kDefaultDir = "./MeshCache";
+
+static constexpr std::uint32_t kMagic = 0x434d4752; // "RGMC"
+static constexpr std::uint32_t kFileVersion = 4;
+static constexpr std::uint64_t kAlignment = 16;
+
+/**< @brief キャッシュファイルの先頭に置くヘッダー */
+struct Header {
+  std::uint32_t magic = kMagic;
+  std::uint32_t version = kFileVersion;
+  std::uint32_t loaderVersion = 0; // 読み込み処理のバージョン
+  std::uint32_t layout = 0;        // TriangleMesh::LayoutFlag
+  std::uint32_t cookFlags = 0;     // TriangleMesh::CookFlag
+  std::uint32_t reserved = 0;
+  std::uint64_t sourceHash = 0;    // 元のファイルの内容のハッシュ
+  std::uint64_t sourceSize = 0;
+  std::uint32_t indexType = 0;
+  std::uint32_t vertexCount = 0;
+  std::uint32_t indexCount = 0;
+  std::uint32_t submeshCount = 0;
+  std::uint64_t submeshOffset = 0;
+  std::uint32_t lodCount = 0;
+  std::uint32_t clusterCount = 0;
+  std::uint64_t lodOffset = 0;
+  std::uint64_t clusterOffset = 0;
+  std::uint64_t vertexOffset = 0;
+  std::uint64_t vertexBytes = 0;
+  std::uint64_t indexOffset = 0;
+  std::uint64_t indexBytes = 0;
+  float bboxMin[3] = {};
+  float bboxMax[3] = {};
+  float acmr[2] = {}; // 並べ替え前後
+  float atvr[2] = {}; // 並べ替え前後
+};
+
+/**< @brief マップしたキャッシュファイル */
+class Entry {
+public:
+  /**< @brief マップした領域を指すので、Entry より長く使わないでください。 */
+  TriangleMesh::Streams GetStreams() const;
+  std::vector<TriangleMesh::Submesh> GetSubmeshes() const;
+  std::vector<TriangleMesh::LodLevel> GetLods() const;
+  std::vector<TriangleMesh::Cluster> GetClusters() const;
+  AABB GetAABB() const;
+  MeshOptimizer::Report GetReport() const;
+
+private:
+  friend std::optional<Entry> Load(const std::string &, std::uint64_t,
+                                   std::uint64_t, std::uint32_t,
+                                   std::uint32_t);
+  MappedFile file_{};
+  Header header_{};
+};
+
+/**< @brief キャッシュを使うか */
+bool IsEnabled();
+
+/**
+ * @brief ファイルの内容をハッシュします。
+ * @return 読み込めなかった場合は std::nullopt
+ */
+std::optional<std::uint64_t> HashFile(const std::string &path,
+                                      std::uint64_t *size = nullptr);
+
+/**< @brief 元のファイルのパスに対応するキャッシュファイルのパス */
+std::filesystem::path GetPath(const std::string &sourcePath);
+
+/**
+ * @brief キャッシュファイルをマップします。
+ * @return 無いか、古いか、壊れている場合は std::nullopt
+ */
+std::optional<Entry> Load(const std::string &sourcePath,
+                          std::uint64_t sourceHash, std::uint64_t sourceSize,
+                          std::uint32_t loaderVersion, std::uint32_t cookFlags);
+
+/**
+ * @brief キャッシュファイルを書き込みます。
+ * @note 一時ファイルに書いてから置き換えるので、途中で失敗しても壊れたファイルは残りません。
+ * @return 失敗した場合はエラーメッセージ
+ */
+std::optional<std::string>
+Save(const std::string &sourcePath, std::uint64_t sourceHash,
+     std::uint64_t sourceSize, std::uint32_t loaderVersion,
+     std::uint32_t cookFlags, const TriangleMesh::Streams &streams,
+     const std::vector<TriangleMesh::Submesh> &submeshes,
+     const std::vector<TriangleMesh::LodLevel> &lods,
+     const std::vector<TriangleMesh::Cluster> &clusters, const AABB &bbox,
+     const MeshOptimizer::Report &report);
+
+} // namespace MeshCache
@@ -0,0 +1,373 @@
+/**
+ * @brief  Mesh optimizer
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Mesh/MeshOptimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+namespace MeshOptimizer {
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+static constexpr std::uint32_t kInvalid = std::numeric_limits<std::uint32_t>::max();
+
+/**< @brief 計測用の FIFO キャッシュ */
+class FIFOCache {
+public:
+  FIFOCache(std::size_t vertexCount, std::size_t size)
+      : timestamps_(vertexCount, 0), size_(size) {}
+
+  void Reset() { time_ += size_ + 1; }
+
+  /**< @brief 頂点を参照し、キャッシュに無ければ true を返します。 */
+  bool Touch(std::uint32_t v) {
+    if (time_ - timestamps_[v] < size_ && timestamps_[v] != 0) {
+      return false;
+    }
+    timestamps_[v] = ++time_;
+    return true;
+  }
+
+  int TouchTriangle(const std::uint32_t *tri) {
+    return static_cast<int>(Touch(tri[0])) + static_cast<int>(Touch(tri[1])) +
+           static_cast<int>(Touch(tri[2]));
+  }
+
+private:
+  std::vector<std::size_t> timestamps_;
+  std::size_t size_;
+  std::size_t time_ = 0;
+};
+
+//*--------------------------------------------------------------------------------
+// Analyze
+//*--------------------------------------------------------------------------------
+
+CacheStats AnalyzeVertexCache(const std::vector<std::uint32_t> &indices,
+                              std::size_t vertexCount, std::size_t cacheSize) {
+  CacheStats stats{};
+  if (indices.empty() || vertexCount == 0) {
+    return stats;
+  }
+  FIFOCache cache(vertexCount, cacheSize);
+  std::size_t misses = 0;
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    misses += static_cast<std::size_t>(cache.TouchTriangle(&indices[i]));
+  }
+  stats.acmr = static_cast<float>(misses) /
+               static_cast<float>(indices.size() / 3);
+  stats.atvr = static_cast<float>(misses) / static_cast<float>(vertexCount);
+  return stats;
+}
+
+//*--------------------------------------------------------------------------------
+// Vertex cache (Forsyth)
+//*--------------------------------------------------------------------------------
+
+namespace Forsyth {
+static constexpr std::size_t kCacheSize = 32;
+static constexpr float kCacheDecayPower = 1.5f;
+static constexpr float kLastTriScore = 0.75f;
+static constexpr float kValenceBoostScale = 2.0f;
+static constexpr float kValenceBoostPower = 0.5f;
+
+/**
+ * @brief キャッシュ内の位置と残りの三角形数から頂点のスコアを求めます。
+ * @param cachePos キャッシュに無ければ -1
+ */
+static float Score(int cachePos, std::uint32_t remaining) {
+  if (remaining == 0) {
+    return -1.0f;
+  }
+  float score = 0.0f;
+  if (cachePos >= 0) {
+    if (cachePos < 3) {
+      // 直前の三角形の頂点は、同じ三角形ばかり続けないよう少し低めにします。
+      score = kLastTriScore;
+    } else {
+      const float scaler = 1.0f / static_cast<float>(kCacheSize - 3);
+      score = std::pow(1.0f - static_cast<float>(cachePos - 3) * scaler,
+                       kCacheDecayPower);
+    }
+  }
+  // 残りの少ない頂点を優先し、取り残される三角形を減らします。
+  return score + kValenceBoostScale *
+                     std::pow(static_cast<float>(remaining), -kValenceBoostPower);
+}
+} // namespace Forsyth
+
+std::vector<std::uint32_t>
+OptimizeVertexCache(const std::vector<std::uint32_t> &indices,
+                    std::size_t vertexCount) {
+  const std::size_t triCount = indices.size() / 3;
+  if (triCount == 0 || vertexCount == 0) {
+    return indices;
+  }
+
+  // 頂点ごとに隣接する三角形の一覧を作ります。
+  std::vector<std::uint32_t> remaining(vertexCount, 0);
+  for (std::size_t i = 0; i < triCount * 3; i++) {
+    remaining[indices[i]]++;
+  }
+  std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    offsets[v + 1] = offsets[v] + remaining[v];
+  }
+  std::vector<std::uint32_t> adjacency(triCount * 3);
+  {
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < triCount * 3; i++) {
+      adjacency[fill[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+    }
+  }
+
+  std::vector<int> cachePos(vertexCount, -1);
+  std::vector<float> vertexScore(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    vertexScore[v] = Forsyth::Score(-1, remaining[v]);
+  }
+  std::vector<float> triScore(triCount);
+  std::vector<bool> isEmitted(triCount, false);
+  std::uint32_t best = 0;
+  for (std::size_t t = 0; t < triCount; t++) {
+    triScore[t] = vertexScore[indices[t * 3 + 0]] +
+                  vertexScore[indices[t * 3 + 1]] +
+                  vertexScore[indices[t * 3 + 2]];
+    if (triScore[t] > triScore[best]) {
+      best = static_cast<std::uint32_t>(t);
+    }
+  }
+
+  std::vector<std::uint32_t> out;
+  out.reserve(triCount * 3);
+  std::vector<std::uint32_t> cache;
+  std::vector<std::uint32_t> next;
+  cache.reserve(Forsyth::kCacheSize + 3);
+  next.reserve(Forsyth::kCacheSize + 3);
+  std::size_t cursor = 0;
+
+  for (std::size_t emitted = 0; emitted < triCount; emitted++) {
+    if (best == kInvalid) {
+      // キャッシュ内の頂点から辿れる三角形が無くなったら、未出力の先頭から再開します。
+      while (isEmitted[cursor]) {
+        cursor++;
+      }
+      best = static_cast<std::uint32_t>(cursor);
+    }
+
+    const std::uint32_t *tri = &indices[best * 3];
+    out.insert(out.end(), tri, tri + 3);
+    isEmitted[best] = true;
+
+    // 出力した三角形を隣接リストの末尾に寄せて、残りの数を減らします。
+    for (int k = 0; k < 3; k++) {
+      const std::uint32_t v = tri[k];
+      const std::uint32_t begin = offsets[v];
+      const std::uint32_t end = begin + remaining[v];
+      for (std::uint32_t a = begin; a < end; a++) {
+        if (adjacency[a] == best) {
+          std::swap(adjacency[a], adjacency[end - 1]);
+          remaining[v]--;
+          break;
+        }
+      }
+    }
+
+    // 出力した三角形の頂点をキャッシュの先頭に置きます。
+    next.assign(tri, tri + 3);
+    for (const std::uint32_t v : cache) {
+      if (v != tri[0] && v != tri[1] && v != tri[2]) {
+        next.emplace_back(v);
+      }
+    }
+    for (std::size_t i = Forsyth::kCacheSize; i < next.size(); i++) {
+      cachePos[next[i]] = -1;
+    }
+
+    // スコアの変化を隣接する三角形に伝えます。
+    for (std::size_t i = 0; i < next.size(); i++) {
+      const std::uint32_t v = next[i];
+      if (i < Forsyth::kCacheSize) {
+        cachePos[v] = static_cast<int>(i);
+      }
+      const float score = Forsyth::Score(cachePos[v], remaining[v]);
+      const float delta = score - vertexScore[v];
+      vertexScore[v] = score;
+      for (std::uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+        triScore[adjacency[a]] += delta;
+      }
+    }
+    next.resize(std::min(next.size(), Forsyth::kCacheSize));
+    cache.swap(next);
+
+    // キャッシュ内の頂点を使う三角形から、次に出力するものを選びます。
+    best = kInvalid;
+    float bestScore = std::numeric_limits<float>::lowest();
+    for (const std::uint32_t v : cache) {
+      for (std::uint32_t a = offsets[v]; a < offsets[v] + remaining[v]; a++) {
+        const std::uint32_t t = adjacency[a];
+        if (triScore[t] > bestScore) {
+          bestScore = triScore[t];
+          best = t;
+        }
+      }
+    }
+  }
+  return out;
+}
+
+//*--------------------------------------------------------------------------------
+// Overdraw
+//*--------------------------------------------------------------------------------
+
+std::vector<std::uint32_t>
+OptimizeOverdraw(const std::vector<std::uint32_t> &indices,
+                 const std::vector<float> &positions, float threshold) {
+  const std::size_t triCount = indices.size() / 3;
+  const std::size_t vertexCount = positions.size() / 3;
+  if (triCount == 0 || vertexCount == 0) {
+    return indices;
+  }
+
+  // 全ての頂点がキャッシュに無い三角形から、新しいクラスタを始めます。(hard boundary)
+  FIFOCache cache(vertexCount, kFIFOSize);
+  std::vector<std::size_t> hard;
+  for (std::size_t t = 0; t < triCount; t++) {
+    if (cache.TouchTriangle(&indices[t * 3]) == 3) {
+      hard.emplace_back(t);
+    }
+  }
+  hard.emplace_back(triCount);
+  if (hard.front() != 0) {
+    hard.insert(hard.begin(), 0);
+  }
+
+  // クラスタ内の ACMR が元の threshold 倍以下に収まるところでさらに分けます。(soft boundary)
+  std::vector<std::size_t> clusters;
+  for (std::size_t h = 0; h + 1 < hard.size(); h++) {
+    const std::size_t begin = hard[h];
+    const std::size_t end = hard[h + 1];
+    if (begin == end) {
+      continue;
+    }
+    cache.Reset();
+    std::size_t misses = 0;
+    for (std::size_t t = begin; t < end; t++) {
+      misses += static_cast<std::size_t>(cache.TouchTriangle(&indices[t * 3]));
+    }
+    const float target = static_cast<float>(misses) /
+                         static_cast<float>(end - begin) * threshold;
+
+    cache.Reset();
+    misses = 0;
+    std::size_t start = begin;
+    clusters.emplace_back(begin);
+    for (std::size_t t = begin; t < end; t++) {
+      misses += static_cast<std::size_t>(cache.TouchTriangle(&indices[t * 3]));
+      const float acmr =
+          static_cast<float>(misses) / static_cast<float>(t + 1 - start);
+      if (t + 1 < end && acmr <= target) {
+        start = t + 1;
+        clusters.emplace_back(start);
+        cache.Reset();
+        misses = 0;
+      }
+    }
+  }
+  clusters.emplace_back(triCount);
+
+  // メッシュの重心からクラスタの重心への向きとクラスタの法線の内積でソートします。
+  const auto Position = [&positions](std::uint32_t v) {
+    return glm::vec3(positions[v * 3 + 0], positions[v * 3 + 1],
+                     positions[v * 3 + 2]);
+  };
+  struct Cluster {
+    std::size_t begin;
+    std::size_t end;
+    glm::vec3 centroid;
+    glm::vec3 normal;
+    float area;
+    float sortKey;
+  };
+  std::vector<Cluster> sorted;
+  glm::vec3 meshCentroid(0.0f);
+  float meshArea = 0.0f;
+  for (std::size_t c = 0; c + 1 < clusters.size(); c++) {
+    Cluster cluster{clusters[c], clusters[c + 1], glm::vec3(0.0f),
+                    glm::vec3(0.0f), 0.0f, 0.0f};
+    for (std::size_t t = cluster.begin; t < cluster.end; t++) {
+      const glm::vec3 p0 = Position(indices[t * 3 + 0]);
+      const glm::vec3 p1 = Position(indices[t * 3 + 1]);
+      const glm::vec3 p2 = Position(indices[t * 3 + 2]);
+      const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+      const float area = glm::length(n);
+      cluster.centroid += (p0 + p1 + p2) * (area / 3.0f);
+      cluster.normal += n;
+      cluster.area += area;
+    }
+    meshCentroid += cluster.centroid;
+    meshArea += cluster.area;
+    if (cluster.area > 0.0f) {
+      cluster.centroid /= cluster.area;
+    }
+    sorted.emplace_back(cluster);
+  }
+  if (meshArea > 0.0f) {
+    meshCentroid /= meshArea;
+  }
+  for (auto &cluster : sorted) {
+    const float len = glm::length(cluster.normal);
+    cluster.sortKey =
+        len > 0.0f ? glm::dot(cluster.centroid - meshCentroid,
+                              cluster.normal / len)
+                   : 0.0f;
+  }
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const Cluster &lhs, const Cluster &rhs) {
+                     return lhs.sortKey > rhs.sortKey;
+                   });
+
+  std::vector<std::uint32_t> out;
+  out.reserve(triCount * 3);
+  for (const auto &cluster : sorted) {
+    out.insert(out.end(), indices.begin() + static_cast<std::ptrdiff_t>(cluster.begin * 3),
+               indices.begin() + static_cast<std::ptrdiff_t>(cluster.end * 3));
+  }
+  return out;
+}
+
+//*--------------------------------------------------------------------------------
+// Vertex fetch
+//*--------------------------------------------------------------------------------
+
+std::vector<std::uint32_t> OptimizeVertexFetch(std::vector<std::uint32_t> &indices,
+                                               std::size_t vertexCount) {
+  std::vector<std::uint32_t> remap(vertexCount, kInvalid);
+  std::uint32_t next = 0;
+  for (auto &index : indices) {
+    if (remap[index] == kInvalid) {
+      remap[index] = next++;
+    }
+    index = remap[index];
+  }
+  for (auto &v : remap) {
+    if (v == kInvalid) {
+      v = next++;
+    }
+  }
+  return remap;
+}
+
+} // namespace MeshOptimizer
@@ -0,0 +1,105 @@
+/**
+ * @brief  Mesh optimizer
+ * @note   三角形リストのインデックスと頂点を GPU が効率よく処理できる順に並べ替えます。
+ * 1. 頂点キャッシュ (Forsyth の線形時間アルゴリズム)
+ * 2. オーバードロー (キャッシュ効率を保つクラスタを、視点に依存しない向きでソート)
+ * 3. 頂点フェッチ (インデックスで最初に参照される順に頂点を並べ直す)
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace MeshOptimizer {
+
+/**< @brief 計測に使う FIFO キャッシュの大きさ */
+static constexpr std::size_t kFIFOSize = 16;
+
+/**< @brief クラスタを分ける際に許す ACMR の悪化の割合 */
+static constexpr float kOverdrawThreshold = 1.05f;
+
+/**
+ * @brief 頂点キャッシュの効率
+ * @note ACMR: 三角形あたりの頂点シェーダー実行数 (0.5 付近が理想、最悪 3.0)
+ * ATVR: 頂点数あたりの頂点シェーダー実行数 (1.0 が理想)
+ */
+struct CacheStats {
+  float acmr = 0.0f;
+  float atvr = 0.0f;
+};
+
+/**< @brief 最適化前後の効率 */
+struct Report {
+  CacheStats before{};
+  CacheStats after{};
+};
+
+/**
+ * @brief FIFO キャッシュを模して ACMR と ATVR を求めます。
+ */
+CacheStats AnalyzeVertexCache(const std::vector<std::uint32_t> &indices,
+                              std::size_t vertexCount,
+                              std::size_t cacheSize = kFIFOSize);
+
+/**
+ * @brief 頂点キャッシュに残っている頂点を使う三角形から順に並べ替えます。
+ * @ref https://tomforsyth1000.github.io/papers/fast_vert_cache_opt.html
+ */
+std::vector<std::uint32_t>
+OptimizeVertexCache(const std::vector<std::uint32_t> &indices,
+                    std::size_t vertexCount);
+
+/**
+ * @brief 外側を向いたクラスタから描画されるように並べ替えます。
+ * @param indices OptimizeVertexCache で並べ替えたインデックス
+ * @param positions xyz の並んだ頂点座標
+ * @param threshold クラスタ内の ACMR が元の何倍まで悪化してよいか
+ * @ref Sander, Nehab, Barczak. "Fast Triangle Reordering for Vertex Locality
+ * and Reduced Overdraw" (SIGGRAPH 2007)
+ */
+std::vector<std::uint32_t>
+OptimizeOverdraw(const std::vector<std::uint32_t> &indices,
+                 const std::vector<float> &positions,
+                 float threshold = kOverdrawThreshold);
+
+/**
+ * @brief インデックスで最初に参照される順に頂点の番号を振り直します。
+ * @return 元の頂点番号から新しい頂点番号への対応 (参照されない頂点は末尾に回します)
+ */
+std::vector<std::uint32_t> OptimizeVertexFetch(std::vector<std::uint32_t> &indices,
+                                               std::size_t vertexCount);
+
+/**
+ * @brief OptimizeVertexFetch の対応に従って頂点属性を並べ替えます。
+ * @param components 1 頂点あたりの要素数
+ */
+template <typename T>
+void RemapVertices(const std::vector<std::uint32_t> &remap,
+                   std::size_t components, std::vector<T> &attribs) {
+  std::vector<T> remapped(attribs.size());
+  for (std::size_t v = 0; v < remap.size(); v++) {
+    for (std::size_t c = 0; c < components; c++) {
+      remapped[remap[v] * components + c] = attribs[v * components + c];
+    }
+  }
+  attribs.swap(remapped);
+}
+
+} // namespace MeshOptimizer
+
+#endif
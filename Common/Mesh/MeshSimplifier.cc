@@ -0,0 +1,345 @@
+/**
+ * @brief  Mesh simplifier
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Mesh/MeshSimplifier.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+
+namespace MeshSimplifier {
+
+//*--------------------------------------------------------------------------------
+// Quadric
+//*--------------------------------------------------------------------------------
+
+/**< @brief 平面までの距離の二乗の和を表す対称 4x4 行列 (上三角の 10 要素) と重み */
+struct Quadric {
+  double a[10] = {};
+  double weight = 0.0;
+
+  void AddPlane(const glm::dvec3 &n, double d, double w) {
+    const double p[4] = {n.x, n.y, n.z, d};
+    int k = 0;
+    for (int i = 0; i < 4; i++) {
+      for (int j = i; j < 4; j++) {
+        a[k++] += w * p[i] * p[j];
+      }
+    }
+    weight += w;
+  }
+
+  Quadric &operator+=(const Quadric &rhs) {
+    for (int i = 0; i < 10; i++) {
+      a[i] += rhs.a[i];
+    }
+    weight += rhs.weight;
+    return *this;
+  }
+
+  /**< @brief 重みで割った、平面までの距離の二乗の平均 */
+  double Evaluate(const glm::dvec3 &v) const {
+    const double x = v.x, y = v.y, z = v.z;
+    const double e = a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z +
+                     2.0 * a[3] * x + a[4] * y * y + 2.0 * a[5] * y * z +
+                     2.0 * a[6] * y + a[7] * z * z + 2.0 * a[8] * z + a[9];
+    return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+  }
+};
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+struct Collapse {
+  std::uint32_t from;
+  std::uint32_t to;
+  double cost;
+};
+
+struct PositionHash {
+  std::size_t operator()(const std::array<std::uint32_t, 3> &bits) const {
+    std::size_t seed = 0;
+    for (const auto b : bits) {
+      seed ^= b + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+    }
+    return seed;
+  }
+};
+
+static std::uint64_t EdgeKey(std::uint32_t a, std::uint32_t b) {
+  return a < b ? (static_cast<std::uint64_t>(a) << 32) | b
+               : (static_cast<std::uint64_t>(b) << 32) | a;
+}
+
+/**
+ * @brief 位置が同じ頂点を一つの頂点 (最初に現れた頂点) にまとめます。
+ * @param wedges 同じ位置を持つ頂点の数
+ */
+static std::vector<std::uint32_t>
+ComputeCanonical(const std::vector<float> &positions,
+                 std::vector<std::uint32_t> &wedges) {
+  const std::size_t vertexCount = positions.size() / 3;
+  std::vector<std::uint32_t> canonical(vertexCount);
+  wedges.assign(vertexCount, 0);
+  std::unordered_map<std::array<std::uint32_t, 3>, std::uint32_t, PositionHash>
+      table;
+  table.reserve(vertexCount);
+  for (std::uint32_t v = 0; v < vertexCount; v++) {
+    std::array<std::uint32_t, 3> bits{};
+    std::memcpy(bits.data(), &positions[v * 3], sizeof(bits));
+    const auto [it, isInserted] = table.try_emplace(bits, v);
+    canonical[v] = it->second;
+    wedges[it->second]++;
+  }
+  return canonical;
+}
+
+static glm::dvec3 GetPosition(const std::vector<float> &positions,
+                              std::uint32_t v) {
+  return glm::dvec3(positions[v * 3 + 0], positions[v * 3 + 1],
+                    positions[v * 3 + 2]);
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+std::vector<std::uint32_t> Simplify(const std::vector<std::uint32_t> &indices,
+                                    const std::vector<float> &positions,
+                                    std::size_t targetIndexCount,
+                                    float *outError) {
+  const std::size_t vertexCount = positions.size() / 3;
+  std::vector<std::uint32_t> wedges;
+  const std::vector<std::uint32_t> canonical =
+      ComputeCanonical(positions, wedges);
+
+  // 位置で見て縮退している三角形は最初に取り除きます。
+  std::vector<std::uint32_t> tris;
+  tris.reserve(indices.size());
+  for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+    const std::uint32_t c0 = canonical[indices[i + 0]];
+    const std::uint32_t c1 = canonical[indices[i + 1]];
+    const std::uint32_t c2 = canonical[indices[i + 2]];
+    if (c0 != c1 && c1 != c2 && c2 != c0) {
+      tris.insert(tris.end(), indices.begin() + i, indices.begin() + i + 3);
+    }
+  }
+
+  // 1 つの三角形にしか使われない辺 (境界) と 3 つ以上の三角形に使われる辺の頂点は固定します。
+  std::vector<bool> isLocked(vertexCount, false);
+  {
+    std::unordered_map<std::uint64_t, std::uint32_t> edgeUses;
+    edgeUses.reserve(tris.size());
+    for (std::size_t i = 0; i < tris.size(); i += 3) {
+      for (int k = 0; k < 3; k++) {
+        edgeUses[EdgeKey(canonical[tris[i + k]],
+                         canonical[tris[i + (k + 1) % 3]])]++;
+      }
+    }
+    for (const auto &[key, uses] : edgeUses) {
+      if (uses != 2) {
+        isLocked[key >> 32] = true;
+        isLocked[key & 0xFFFFFFFFu] = true;
+      }
+    }
+    for (std::size_t v = 0; v < vertexCount; v++) {
+      if (wedges[v] > 1) {
+        isLocked[v] = true;
+      }
+    }
+  }
+
+  std::vector<Quadric> quadrics(vertexCount);
+  for (std::size_t i = 0; i < tris.size(); i += 3) {
+    const std::uint32_t c[3] = {canonical[tris[i + 0]], canonical[tris[i + 1]],
+                                canonical[tris[i + 2]]};
+    const glm::dvec3 p0 = GetPosition(positions, c[0]);
+    const glm::dvec3 n =
+        glm::cross(GetPosition(positions, c[1]) - p0,
+                   GetPosition(positions, c[2]) - p0);
+    const double area2 = glm::length(n);
+    if (area2 <= 0.0) {
+      continue;
+    }
+    const glm::dvec3 unit = n / area2;
+    for (const std::uint32_t v : c) {
+      quadrics[v].AddPlane(unit, -glm::dot(unit, p0), area2 * 0.5);
+    }
+  }
+
+  std::vector<std::uint32_t> parent(vertexCount);
+  for (std::uint32_t v = 0; v < vertexCount; v++) {
+    parent[v] = v;
+  }
+  const auto find = [&parent](std::uint32_t v) {
+    while (parent[v] != v) {
+      parent[v] = parent[parent[v]];
+      v = parent[v];
+    }
+    return v;
+  };
+
+  double maxError = 0.0;
+  std::vector<std::uint32_t> offsets(vertexCount + 1);
+  std::vector<std::uint32_t> adjacency;
+  std::vector<Collapse> collapses;
+  std::vector<bool> isTouched(vertexCount);
+
+  while (tris.size() > targetIndexCount) {
+    const std::size_t triCount = tris.size() / 3;
+
+    // 頂点ごとの三角形の一覧
+    std::fill(offsets.begin(), offsets.end(), 0);
+    for (const std::uint32_t v : tris) {
+      offsets[canonical[v] + 1]++;
+    }
+    for (std::size_t v = 0; v < vertexCount; v++) {
+      offsets[v + 1] += offsets[v];
+    }
+    adjacency.resize(tris.size());
+    {
+      std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+      for (std::size_t i = 0; i < tris.size(); i++) {
+        adjacency[cursor[canonical[tris[i]]]++] =
+            static_cast<std::uint32_t>(i / 3);
+      }
+    }
+
+    // 辺ごとに誤差の小さい向きを選び、誤差の小さい順に並べます。
+    collapses.clear();
+    for (std::size_t i = 0; i < tris.size(); i += 3) {
+      for (int k = 0; k < 3; k++) {
+        const std::uint32_t a = canonical[tris[i + k]];
+        const std::uint32_t b = canonical[tris[i + (k + 1) % 3]];
+        if (a > b) {
+          continue; // 向かい合う三角形と二重に数えないように
+        }
+        Quadric q = quadrics[a];
+        q += quadrics[b];
+        Collapse best{a, b, -1.0};
+        if (!isLocked[a] && wedges[b] == 1) {
+          best.cost = q.Evaluate(GetPosition(positions, b));
+        }
+        if (!isLocked[b] && wedges[a] == 1) {
+          const double cost = q.Evaluate(GetPosition(positions, a));
+          if (best.cost < 0.0 || cost < best.cost) {
+            best = Collapse{b, a, cost};
+          }
+        }
+        if (best.cost >= 0.0) {
+          collapses.emplace_back(best);
+        }
+      }
+    }
+    if (collapses.empty()) {
+      break;
+    }
+    std::sort(collapses.begin(), collapses.end(),
+              [](const Collapse &lhs, const Collapse &rhs) {
+                return lhs.cost < rhs.cost;
+              });
+
+    // 一度の走査では、縮約した頂点の周りの頂点を再び動かしません。
+    std::fill(isTouched.begin(), isTouched.end(), false);
+    const std::size_t needed = triCount - targetIndexCount / 3;
+    std::size_t removed = 0;
+    std::size_t applied = 0;
+    for (const Collapse &collapse : collapses) {
+      const std::uint32_t a = collapse.from;
+      const std::uint32_t b = collapse.to;
+      if (isTouched[a] || isTouched[b]) {
+        continue;
+      }
+
+      // 向きが反転する三角形ができる縮約は行いません。
+      const glm::dvec3 pb = GetPosition(positions, b);
+      bool isFlipped = false;
+      std::size_t shared = 0;
+      for (std::uint32_t j = offsets[a]; j < offsets[a + 1]; j++) {
+        const std::uint32_t t = adjacency[j];
+        std::uint32_t c[3];
+        for (int k = 0; k < 3; k++) {
+          c[k] = canonical[tris[t * 3 + k]];
+        }
+        if (c[0] == b || c[1] == b || c[2] == b) {
+          shared++;
+          continue;
+        }
+        glm::dvec3 p[3];
+        for (int k = 0; k < 3; k++) {
+          p[k] = GetPosition(positions, c[k]);
+        }
+        const glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+        for (int k = 0; k < 3; k++) {
+          if (c[k] == a) {
+            p[k] = pb;
+          }
+        }
+        const glm::dvec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+        if (glm::dot(before, after) <= 0.0) {
+          isFlipped = true;
+          break;
+        }
+      }
+      if (isFlipped) {
+        continue;
+      }
+
+      parent[a] = b;
+      quadrics[b] += quadrics[a];
+      for (std::uint32_t j = offsets[a]; j < offsets[a + 1]; j++) {
+        const std::uint32_t t = adjacency[j];
+        for (int k = 0; k < 3; k++) {
+          isTouched[canonical[tris[t * 3 + k]]] = true;
+        }
+      }
+      maxError = std::max(maxError, std::sqrt(collapse.cost));
+      removed += shared;
+      applied++;
+      if (removed >= needed) {
+        break;
+      }
+    }
+    if (applied == 0) {
+      break;
+    }
+
+    // 縮約を反映して、縮退した三角形を取り除きます。
+    // 縮約先は継ぎ目の無い頂点なので、その頂点の番号をそのまま使えます。
+    std::size_t write = 0;
+    for (std::size_t i = 0; i < tris.size(); i += 3) {
+      std::uint32_t v[3];
+      std::uint32_t c[3];
+      for (int k = 0; k < 3; k++) {
+        const std::uint32_t from = canonical[tris[i + k]];
+        const std::uint32_t to = find(from);
+        v[k] = to == from ? tris[i + k] : to;
+        c[k] = to;
+      }
+      if (c[0] == c[1] || c[1] == c[2] || c[2] == c[0]) {
+        continue;
+      }
+      for (int k = 0; k < 3; k++) {
+        tris[write++] = v[k];
+      }
+    }
+    tris.resize(write);
+  }
+
+  if (outError != nullptr) {
+    *outError = static_cast<float>(maxError);
+  }
+  return tris;
+}
+
+} // namespace MeshSimplifier
@@ -0,0 +1,30 @@
+/**
+ * @brief  Mesh simplifier
+ * @note   二次誤差 (Quadric Error Metrics) を使った辺の縮約で三角形を減らします。
+ * 縮約先は辺のもう一方の既存の頂点に限るので (half-edge collapse)、
+ * 結果のインデックスは元の頂点バッファをそのまま参照できます。
+ * 境界の頂点と、位置が同じで属性の異なる頂点 (UV や法線の継ぎ目) は動かしません。
+ * @ref Garland, Heckbert. "Surface Simplification Using Quadric Error Metrics"
+ * (SIGGRAPH 1997)
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace MeshSimplifier {
+
+/**
+ * @brief 三角形の数が targetIndexCount / 3 以下になるまで辺を縮約します。
+ * @param positions xyz の並んだ頂点座標
+ * @param outError 縮約で生じた誤差 (元の面からの距離の二乗平均平方根の最大値)
+ * @return 縮約後のインデックス。動かせる頂点が無くなった場合は目標より多く残ります。
+ */
+std::vector<std::uint32_t> Simplify(const std::vector<std::uint32_t> &indices,
+                                    const std::vector<float> &positions,
+                                    std::size_t targetIndexCount,
+                                    float *outError = nullptr);
+
+} // namespace MeshSimplifier
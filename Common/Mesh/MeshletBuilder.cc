@@ -0,0 +1,308 @@
+/**
+ * @brief  Meshlet builder
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Mesh/MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace MeshletBuilder {
+
+//*--------------------------------------------------------------------------------
+// Constant
+//*--------------------------------------------------------------------------------
+
+/**< @brief 法線の広がりがこれより大きければ (cos が小さければ) コーンを使いません。 */
+static constexpr float kMinConeDot = 0.1f;
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+static glm::vec3 GetPosition(const std::vector<float> &positions,
+                             std::uint32_t v) {
+  return glm::vec3(positions[v * 3 + 0], positions[v * 3 + 1],
+                   positions[v * 3 + 2]);
+}
+
+/**
+ * @brief Ritter の方法で境界球を求めます。
+ * @note 座標軸方向に最も離れた 2 点から始め、外にある点を含むように広げます。
+ */
+static glm::vec4 ComputeSphere(const std::vector<glm::vec3> &points) {
+  if (points.empty()) {
+    return glm::vec4(0.0f);
+  }
+  std::size_t lo[3] = {0, 0, 0};
+  std::size_t hi[3] = {0, 0, 0};
+  for (std::size_t i = 0; i < points.size(); i++) {
+    for (int c = 0; c < 3; c++) {
+      if (points[i][c] < points[lo[c]][c]) {
+        lo[c] = i;
+      }
+      if (points[i][c] > points[hi[c]][c]) {
+        hi[c] = i;
+      }
+    }
+  }
+  int axis = 0;
+  float maxSpan = -1.0f;
+  for (int c = 0; c < 3; c++) {
+    const float span = glm::length(points[hi[c]] - points[lo[c]]);
+    if (span > maxSpan) {
+      maxSpan = span;
+      axis = c;
+    }
+  }
+
+  glm::vec3 center = (points[lo[axis]] + points[hi[axis]]) * 0.5f;
+  float radius = maxSpan * 0.5f;
+  for (const glm::vec3 &p : points) {
+    const float d = glm::length(p - center);
+    if (d > radius) {
+      const float newRadius = (radius + d) * 0.5f;
+      center += (p - center) * ((newRadius - radius) / d);
+      radius = newRadius;
+    }
+  }
+  return glm::vec4(center, radius);
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+Bounds ComputeBounds(const std::uint32_t *indices, std::size_t indexCount,
+                     const std::vector<float> &positions) {
+  Bounds bounds{};
+  std::vector<glm::vec3> points;
+  std::vector<glm::vec3> normals;
+  points.reserve(indexCount);
+  normals.reserve(indexCount / 3);
+  glm::vec3 axis(0.0f);
+  for (std::size_t i = 0; i + 2 < indexCount; i += 3) {
+    const glm::vec3 p0 = GetPosition(positions, indices[i + 0]);
+    const glm::vec3 p1 = GetPosition(positions, indices[i + 1]);
+    const glm::vec3 p2 = GetPosition(positions, indices[i + 2]);
+    points.insert(points.end(), {p0, p1, p2});
+    const glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+    const float len = glm::length(n);
+    // 面積の無い三角形は裏向きの判定に影響しません。
+    if (len > 0.0f) {
+      normals.emplace_back(n / len);
+      axis += n / len;
+    }
+  }
+  bounds.sphere = ComputeSphere(points);
+
+  // 法線の平均を軸とし、軸と最も離れた法線との角度からコーンを作ります。
+  const float axisLen = glm::length(axis);
+  if (normals.empty() || axisLen <= 0.0f) {
+    bounds.coneAxis = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    bounds.coneApex = glm::vec4(glm::vec3(bounds.sphere), 0.0f);
+    return bounds;
+  }
+  axis /= axisLen;
+  float minDot = 1.0f;
+  for (const glm::vec3 &n : normals) {
+    minDot = std::min(minDot, glm::dot(n, axis));
+  }
+  if (minDot <= kMinConeDot) {
+    bounds.coneAxis = glm::vec4(axis, 1.0f);
+    bounds.coneApex = glm::vec4(glm::vec3(bounds.sphere), 0.0f);
+    return bounds;
+  }
+
+  // 全ての三角形の平面の裏側に入るまで、中心から軸の逆向きに頂点を下げます。
+  const glm::vec3 center(bounds.sphere);
+  float maxT = 0.0f;
+  std::size_t k = 0;
+  for (std::size_t i = 0; i + 2 < indexCount; i += 3) {
+    const glm::vec3 p0 = GetPosition(positions, indices[i]);
+    const glm::vec3 n = glm::cross(GetPosition(positions, indices[i + 1]) - p0,
+                                   GetPosition(positions, indices[i + 2]) - p0);
+    if (glm::length(n) <= 0.0f) {
+      continue;
+    }
+    const glm::vec3 &unit = normals[k++];
+    const float t = glm::dot(center - p0, unit) / glm::dot(axis, unit);
+    maxT = std::max(maxT, t);
+  }
+  bounds.coneApex = glm::vec4(center - axis * maxT, 0.0f);
+  // 視線と軸のなす角の余弦が、コーンの半角の正弦以上であれば全て裏向きです。
+  bounds.coneAxis =
+      glm::vec4(axis, std::sqrt(std::max(0.0f, 1.0f - minDot * minDot)));
+  return bounds;
+}
+
+Result Build(const std::vector<std::uint32_t> &indices,
+             const std::vector<float> &positions, std::size_t maxVertices,
+             std::size_t maxTriangles) {
+  Result result{};
+  const std::size_t vertexCount = positions.size() / 3;
+  const std::size_t triCount = indices.size() / 3;
+  if (triCount == 0) {
+    return result;
+  }
+  maxVertices = std::clamp<std::size_t>(maxVertices, 3, 256);
+  maxTriangles = std::max<std::size_t>(maxTriangles, 1);
+
+  // 頂点ごとの三角形の一覧
+  std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+  for (std::size_t i = 0; i < triCount * 3; i++) {
+    offsets[indices[i] + 1]++;
+  }
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    offsets[v + 1] += offsets[v];
+  }
+  std::vector<std::uint32_t> adjacency(triCount * 3);
+  {
+    std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < triCount * 3; i++) {
+      adjacency[cursor[indices[i]]++] = static_cast<std::uint32_t>(i / 3);
+    }
+  }
+
+  // 頂点ごとの、まだクラスターに入っていない三角形の数
+  std::vector<std::uint32_t> live(vertexCount);
+  for (std::size_t v = 0; v < vertexCount; v++) {
+    live[v] = offsets[v + 1] - offsets[v];
+  }
+
+  std::vector<bool> isUsed(triCount, false);
+  std::vector<std::int32_t> local(vertexCount, -1);
+  std::vector<std::uint32_t> candidates;
+  std::vector<std::uint32_t> frontier;
+  Meshlet meshlet{};
+  glm::vec3 centroidSum(0.0f);
+
+  const auto triangleCentroid = [&](std::size_t t) {
+    return (GetPosition(positions, indices[t * 3 + 0]) +
+            GetPosition(positions, indices[t * 3 + 1]) +
+            GetPosition(positions, indices[t * 3 + 2])) /
+           3.0f;
+  };
+
+  const auto finish = [&]() {
+    if (meshlet.triangleCount == 0) {
+      return;
+    }
+    for (std::uint32_t i = 0; i < meshlet.vertexCount; i++) {
+      local[result.vertices[meshlet.vertexOffset + i]] = -1;
+    }
+    result.bounds.emplace_back(ComputeBounds(
+        result.indices.data() + meshlet.triangleOffset * 3,
+        meshlet.triangleCount * 3, positions));
+    result.meshlets.emplace_back(meshlet);
+    meshlet = Meshlet{};
+    meshlet.vertexOffset = static_cast<std::uint32_t>(result.vertices.size());
+    meshlet.triangleOffset =
+        static_cast<std::uint32_t>(result.triangles.size());
+    centroidSum = glm::vec3(0.0f);
+    // 残った候補は次のクラスターの種にします。
+    frontier.swap(candidates);
+    candidates.clear();
+  };
+
+  const auto add = [&](std::size_t t) {
+    std::uint32_t packed = 0;
+    for (int k = 0; k < 3; k++) {
+      const std::uint32_t v = indices[t * 3 + k];
+      live[v]--;
+      if (local[v] < 0) {
+        local[v] = static_cast<std::int32_t>(meshlet.vertexCount++);
+        result.vertices.emplace_back(v);
+        centroidSum += GetPosition(positions, v);
+        for (std::uint32_t j = offsets[v]; j < offsets[v + 1]; j++) {
+          if (!isUsed[adjacency[j]]) {
+            candidates.emplace_back(adjacency[j]);
+          }
+        }
+      }
+      packed |= static_cast<std::uint32_t>(local[v]) << (8 * k);
+      result.indices.emplace_back(v);
+    }
+    result.triangles.emplace_back(packed);
+    meshlet.triangleCount++;
+    isUsed[t] = true;
+  };
+
+  std::size_t seed = 0;
+  for (;;) {
+    if (meshlet.triangleCount == maxTriangles) {
+      finish();
+    }
+
+    // 新しく増える頂点が少なく、残りの三角形が少ない頂点 (閉じかけた角) を使い、
+    // 中心に近い三角形を選びます。
+    std::size_t best = triCount;
+    if (meshlet.triangleCount > 0) {
+      const glm::vec3 center =
+          centroidSum / static_cast<float>(meshlet.vertexCount);
+      std::size_t bestNew = 4;
+      std::uint32_t bestLive = std::numeric_limits<std::uint32_t>::max();
+      float bestDist = std::numeric_limits<float>::max();
+      std::size_t write = 0;
+      for (const std::uint32_t t : candidates) {
+        if (isUsed[t]) {
+          continue;
+        }
+        candidates[write++] = t;
+        std::size_t newVerts = 0;
+        std::uint32_t liveSum = 0;
+        for (int k = 0; k < 3; k++) {
+          newVerts += local[indices[t * 3 + k]] < 0 ? 1 : 0;
+          liveSum += live[indices[t * 3 + k]];
+        }
+        if (meshlet.vertexCount + newVerts > maxVertices ||
+            newVerts > bestNew ||
+            (newVerts == bestNew && liveSum > bestLive)) {
+          continue;
+        }
+        const glm::vec3 d = triangleCentroid(t) - center;
+        const float dist = glm::dot(d, d);
+        if (newVerts < bestNew || liveSum < bestLive || dist < bestDist) {
+          best = t;
+          bestNew = newVerts;
+          bestLive = liveSum;
+          bestDist = dist;
+        }
+      }
+      candidates.resize(write);
+      if (best == triCount) {
+        finish();
+      }
+    }
+
+    // 前のクラスターに隣接する三角形のうち、元の並び順で最初のものから始めます。
+    // 隣接する三角形が無くなれば、次に使われていない三角形から始めます。
+    if (best == triCount) {
+      for (const std::uint32_t t : frontier) {
+        if (!isUsed[t] && t < best) {
+          best = t;
+        }
+      }
+      frontier.clear();
+    }
+    if (best == triCount) {
+      while (seed < triCount && isUsed[seed]) {
+        seed++;
+      }
+      if (seed == triCount) {
+        break;
+      }
+      best = seed;
+    }
+    add(best);
+  }
+  finish();
+  return result;
+}
+
+} // namespace MeshletBuilder
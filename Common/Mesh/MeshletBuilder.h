@@ -0,0 +1,96 @@
+/**
+ * @brief  Meshlet builder
+ * @note   三角形リストを、頂点と三角形の数に上限のある小さなクラスター (メッシュレット) に分けます。
+ * クラスターごとに境界球と法線コーンを持つので、描画の前に CPU やコンピュートシェーダーで
+ * 視錐台の外や裏向きのクラスターをまとめて取り除けます。
+ * 上限はメッシュシェーダーで一般的な 64 頂点、124 三角形 (126 を 4 の倍数に切り下げ) です。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef MESHLET_BUILDER_H
+#define MESHLET_BUILDER_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace MeshletBuilder {
+
+static constexpr std::size_t kMaxVertices = 64;
+static constexpr std::size_t kMaxTriangles = 124;
+
+/**
+ * @brief 境界球と法線コーン
+ * @note vec4 を 3 つ並べただけなので、std430 のバッファにそのまま置けます。
+ * coneAxis.w (cutoff) が 1 の場合、コーンが広すぎて裏向きの判定には使えません。
+ */
+struct Bounds {
+  glm::vec4 sphere{0.0f};   // xyz: 中心, w: 半径
+  glm::vec4 coneApex{0.0f}; // xyz: コーンの頂点, w: 未使用
+  glm::vec4 coneAxis{0.0f}; // xyz: 法線の平均の向き, w: cutoff
+};
+static_assert(sizeof(Bounds) == sizeof(float) * 12,
+              "Bounds must be tightly packed.");
+
+/**< @brief メッシュレットが参照する範囲 */
+struct Meshlet {
+  std::uint32_t vertexOffset = 0;   // Result::vertices での先頭
+  std::uint32_t vertexCount = 0;    // kMaxVertices 以下
+  std::uint32_t triangleOffset = 0; // Result::triangles と並べ替えたインデックスでの先頭の三角形
+  std::uint32_t triangleCount = 0;  // kMaxTriangles 以下
+};
+
+struct Result {
+  std::vector<Meshlet> meshlets{};
+  std::vector<Bounds> bounds{};        // meshlets と同じ順
+  std::vector<std::uint32_t> vertices{}; // メッシュレット内の番号から元の頂点番号
+  /**< @brief 三角形ごとにメッシュレット内の頂点番号を 8 ビットずつ詰めたもの */
+  std::vector<std::uint32_t> triangles{};
+  /**< @brief メッシュレットの順に並べ替えた元のインデックス */
+  std::vector<std::uint32_t> indices{};
+};
+
+/**
+ * @brief メッシュレットに分けます。
+ * @note 元の並び順の三角形から始め、頂点を共有する三角形のうち新しく増える頂点が少なく、
+ * 中心に近いものを上限まで加えていきます。
+ * @param positions xyz の並んだ頂点座標
+ */
+Result Build(const std::vector<std::uint32_t> &indices,
+             const std::vector<float> &positions,
+             std::size_t maxVertices = kMaxVertices,
+             std::size_t maxTriangles = kMaxTriangles);
+
+/**
+ * @brief 三角形の集まりの境界球 (Ritter) と法線コーンを求めます。
+ */
+Bounds ComputeBounds(const std::uint32_t *indices, std::size_t indexCount,
+                     const std::vector<float> &positions);
+
+/**
+ * @brief 視点からクラスターの全ての三角形が裏向きに見えるか判定します。
+ * @param eye バウンドと同じ座標系の視点の位置
+ */
+static inline bool IsBackfacing(const Bounds &bounds, const glm::vec3 &eye) {
+  const glm::vec3 dir = glm::vec3(bounds.coneApex) - eye;
+  const float len = glm::length(dir);
+  return len > 0.0f &&
+         glm::dot(dir, glm::vec3(bounds.coneAxis)) >= bounds.coneAxis.w * len;
+}
+
+} // namespace MeshletBuilder
+
+#endif
@@ -1,8 +1,14 @@
 #include "ObjMesh.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
-#define TINYOBJLOADER_IMPLEMENTATION
-#include <tiny_obj_loader/tiny_obj_loader.h>
+#include <unordered_map>
+
+#include "Mesh/MeshCache.h"
+#include "Mesh/ObjParser.h"
 
 namespace Impl {
 
@@ -12,7 +18,10 @@ namespace Impl {
  * https://github.com/tinyobjloader/tinyobjloader/blob/master/examples/viewer/viewer.cc
  */
 namespace Normal {
-static void Calc(float N[3], float v0[3], float v1[3], float v2[3]) {
+/**
+ * @brief 面の法線を正規化せずに求めます。(長さは面積の 2 倍なので、足し合わせると面積で重み付けされます)
+ */
+static void CalcWeighted(float N[3], float v0[3], float v1[3], float v2[3]) {
   float v10[3];
   v10[0] = v1[0] - v0[0];
   v10[1] = v1[1] - v0[1];
@@ -26,7 +35,9 @@ static void Calc(float N[3], float v0[3], float v1[3], float v2[3]) {
   N[0] = v10[1] * v20[2] - v10[2] * v20[1];
   N[1] = v10[2] * v20[0] - v10[0] * v20[2];
   N[2] = v10[0] * v20[1] - v10[1] * v20[0];
+}
 
+static void Normalize(float N[3]) {
   float len2 = N[0] * N[0] + N[1] * N[1] + N[2] * N[2];
   if (len2 > 0.0f) {
     float len = sqrtf(len2);
@@ -36,68 +47,64 @@ static void Calc(float N[3], float v0[3], float v1[3], float v2[3]) {
     N[2] /= len;
   }
 }
+} // namespace Normal
 
-static void Compute(const tinyobj::attrib_t &attrib,
-                    const std::vector<tinyobj::shape_t> &shapes,
-                    std::vector<GLfloat> &normals) {
-  // Shapeの数だけループする。
-  const size_t ssize = shapes.size();
-  for (size_t s = 0; s < ssize; s++) {
-
-    // 面f(ポリゴン)の数だけループする。
-    for (size_t f = 0; f < shapes[s].mesh.indices.size() / 3; f++) {
-      const tinyobj::index_t idx0 = shapes[s].mesh.indices[3 * f + 0];
-      const tinyobj::index_t idx1 = shapes[s].mesh.indices[3 * f + 1];
-      const tinyobj::index_t idx2 = shapes[s].mesh.indices[3 * f + 2];
-
-      // 面fを構成する頂点の数だけループする。
-      float v[3][3];
-      for (int k = 0; k < 3; k++) {
-        const int f0 = idx0.vertex_index;
-        const int f1 = idx1.vertex_index;
-        const int f2 = idx2.vertex_index;
-        assert(f0 >= 0);
-        assert(f1 >= 0);
-        assert(f2 >= 0);
-
-        v[0][k] = attrib.vertices[3 * f0 + k];
-        v[1][k] = attrib.vertices[3 * f1 + k];
-        v[2][k] = attrib.vertices[3 * f2 + k];
-      }
-      float n[3][3];
-      Calc(n[0], v[0], v[1], v[2]);
-      n[1][0] = n[0][0];
-      n[1][1] = n[0][1];
-      n[1][2] = n[0][2];
-      n[2][0] = n[0][0];
-      n[2][1] = n[0][1];
-      n[2][2] = n[0][2];
-      for (int k = 0; k < 3; k++) {
-        normals.emplace_back(n[k][0]);
-        normals.emplace_back(n[k][1]);
-        normals.emplace_back(n[k][2]);
-      }
-    }
+/**
+ * @brief 頂点の溶接に関する実装
+ * @note 面の角ごとの (位置, 法線, テクスチャ座標) のインデックスが同じであれば、
+ * 同じ頂点として共有します。法線が無い角は (位置, テクスチャ座標) で共有し、
+ * 共有した面の法線を面積で重み付けして足し合わせた滑らかな法線を使います。
+ */
+namespace Weld {
+struct Key {
+  int position;
+  int normal;
+  int texCoord;
+
+  bool operator==(const Key &rhs) const {
+    return position == rhs.position && normal == rhs.normal &&
+           texCoord == rhs.texCoord;
   }
-}
-} // namespace Normal
+};
+
+struct KeyHash {
+  std::size_t operator()(const Key &key) const {
+    std::size_t seed = 0;
+    const auto Combine = [&seed](std::size_t v) {
+      seed ^= v + 0x9E3779B9 + (seed << 6) + (seed >> 2);
+    };
+    Combine(std::hash<int>{}(key.position));
+    Combine(std::hash<int>{}(key.normal));
+    Combine(std::hash<int>{}(key.texCoord));
+    return seed;
+  }
+};
+} // namespace Weld
 } // namespace Impl
 
-ObjMesh::ObjMesh(const std::string &path) {
-  tinyobj::attrib_t attrib;
-  std::vector<tinyobj::shape_t> shapes;
-  std::vector<tinyobj::material_t> materials;
-  std::string warn, err;
-
-  const bool isSuccess =
-      tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.c_str());
-  if (!warn.empty()) {
-    std::cout << warn << std::endl;
-  }
-  if (!err.empty()) {
-    std::cerr << err << std::endl;
+ObjMesh::ObjMesh(const std::string &path, std::uint32_t cookFlags) {
+  // 前回と同じファイルであれば、保存しておいた頂点とインデックスをそのまま転送します。
+  std::uint64_t sourceSize = 0;
+  const auto sourceHash = MeshCache::IsEnabled()
+                              ? MeshCache::HashFile(path, &sourceSize)
+                              : std::nullopt;
+  if (sourceHash) {
+    if (const auto entry = MeshCache::Load(path, sourceHash.value(),
+                                           sourceSize, kLoaderVersion,
+                                           cookFlags)) {
+      bbox_ = entry->GetAABB();
+      report_ = entry->GetReport();
+      submeshes_ = entry->GetSubmeshes();
+      lods_ = entry->GetLods();
+      clusters_ = entry->GetClusters();
+      UploadBuffers(entry->GetStreams());
+      return;
+    }
   }
-  if (!isSuccess) {
+
+  ObjParser::Result obj{};
+  if (const auto msg = ObjParser::Load(path, obj)) {
+    std::cerr << msg.value() << std::endl;
     assert(false);
     return;
   }
@@ -106,59 +113,98 @@ ObjMesh::ObjMesh(const std::string &path) {
   std::vector<GLfloat> positions;
   std::vector<GLfloat> normals;
   std::vector<GLfloat> texCoords;
+  std::vector<Submesh> submeshes;
+  std::unordered_map<Impl::Weld::Key, GLuint, Impl::Weld::KeyHash> welded;
+  std::vector<bool> isGenerated; // 法線を面から生成する頂点か
+
+  const bool hasTexCoords = !obj.texCoords.empty();
 
   // Shapeの数だけループする。
-  const size_t ssize = shapes.size();
-  for (size_t s = 0; s < ssize; s++) {
+  for (const auto &shape : obj.shapes) {
+    const GLuint firstIndex = static_cast<GLuint>(indices.size());
 
-    // 面f(ポリゴン)の数だけループする。
-    const size_t fsize = shapes[s].mesh.num_face_vertices.size();
-    size_t indexOffset = 0;
-    for (size_t f = 0; f < fsize; f++) {
+    // 面f(三角形)の数だけループする。(ObjParser で三角形に分割されています)
+    const size_t fv = 3;
+    for (size_t indexOffset = 0; indexOffset < shape.indices.size();
+         indexOffset += fv) {
+
+      // 法線が無い頂点には面の法線を足し合わせます。
+      float v[3][3];
+      for (size_t k = 0; k < 3; k++) {
+        const int vi = shape.indices[indexOffset + k].position;
+        for (size_t c = 0; c < 3; c++) {
+          v[k][c] = obj.positions[3 * static_cast<size_t>(vi) + c];
+        }
+      }
+      float faceNormal[3];
+      Impl::Normal::CalcWeighted(faceNormal, v[0], v[1], v[2]);
 
       // 面fを構成する頂点の数だけループする。
-      const size_t fv = shapes[s].mesh.num_face_vertices[f];
-      for (size_t v = 0; v < fv; v++) {
-        const tinyobj::index_t idx = shapes[s].mesh.indices[indexOffset + v];
-        indices.emplace_back(indexOffset + v);
-
-        const tinyobj::real_t vx = attrib.vertices[3 * idx.vertex_index + 0];
-        const tinyobj::real_t vy = attrib.vertices[3 * idx.vertex_index + 1];
-        const tinyobj::real_t vz = attrib.vertices[3 * idx.vertex_index + 2];
+      for (size_t k = 0; k < fv; k++) {
+        const ObjParser::Index idx = shape.indices[indexOffset + k];
+        const bool hasNormal = idx.normal >= 0;
+        const Impl::Weld::Key key{idx.position, hasNormal ? idx.normal : -1,
+                                  hasTexCoords ? idx.texCoord : -1};
+
+        const auto [it, isInserted] =
+            welded.try_emplace(key, static_cast<GLuint>(positions.size() / 3));
+        indices.emplace_back(it->second);
+        if (!isInserted) {
+          if (!hasNormal) {
+            for (size_t c = 0; c < 3; c++) {
+              normals[3 * it->second + c] += faceNormal[c];
+            }
+          }
+          continue;
+        }
+        isGenerated.push_back(!hasNormal);
+
+        const float vx = v[k][0];
+        const float vy = v[k][1];
+        const float vz = v[k][2];
         positions.emplace_back(vx);
         positions.emplace_back(vy);
         positions.emplace_back(vz);
-        bbox_.Merge(vx, vy, vz);
-
-        if (!attrib.normals.empty()) {
-          const tinyobj::real_t nx = attrib.normals[3 * idx.normal_index + 0];
-          const tinyobj::real_t ny = attrib.normals[3 * idx.normal_index + 1];
-          const tinyobj::real_t nz = attrib.normals[3 * idx.normal_index + 2];
-          normals.emplace_back(nx);
-          normals.emplace_back(ny);
-          normals.emplace_back(nz);
-        }
 
-        if (!attrib.texcoords.empty()) {
-          const tinyobj::real_t tx =
-              attrib.texcoords[2 * idx.texcoord_index + 0];
-          const tinyobj::real_t ty =
-              attrib.texcoords[2 * idx.texcoord_index + 1];
-          texCoords.emplace_back(tx);
-          texCoords.emplace_back(ty);
+        const size_t ni = static_cast<size_t>(idx.normal);
+        normals.emplace_back(hasNormal ? obj.normals[3 * ni + 0]
+                                       : faceNormal[0]);
+        normals.emplace_back(hasNormal ? obj.normals[3 * ni + 1]
+                                       : faceNormal[1]);
+        normals.emplace_back(hasNormal ? obj.normals[3 * ni + 2]
+                                       : faceNormal[2]);
+
+        if (hasTexCoords) {
+          const size_t ti = static_cast<size_t>(std::max(idx.texCoord, 0));
+          texCoords.emplace_back(obj.texCoords[2 * ti + 0]);
+          texCoords.emplace_back(obj.texCoords[2 * ti + 1]);
         }
       }
-      indexOffset += fv;
+    }
+    const GLuint indexCount = static_cast<GLuint>(indices.size()) - firstIndex;
+    if (indexCount > 0) {
+      submeshes.push_back({firstIndex, indexCount});
     }
   }
-
-  // 法線情報が取得できなかった場合は生成します。
-  // もう一度ループを回すようにしてあるので時間かかるかもしれません。
-  if (attrib.normals.empty()) {
-    Impl::Normal::Compute(attrib, shapes, normals);
+  for (size_t i = 0; i < isGenerated.size(); i++) {
+    if (isGenerated[i]) {
+      Impl::Normal::Normalize(&normals[3 * i]);
+    }
   }
 
   const auto optTexCoords =
       texCoords.empty() ? std::nullopt : std::make_optional(texCoords);
-  InitBuffers(indices, positions, normals, optTexCoords);
+  const CookedMesh cooked =
+      CookBuffers(indices, positions, normals, optTexCoords, std::nullopt,
+                  submeshes, cookFlags);
+  UploadBuffers(cooked.View());
+  if (sourceHash) {
+    if (const auto msg = MeshCache::Save(path, sourceHash.value(), sourceSize,
+                                         kLoaderVersion, cookFlags,
+                                         cooked.View(),
+                                         submeshes_, lods_, clusters_, bbox_,
+                                         report_)) {
+      std::cerr << msg.value() << std::endl;
+    }
+  }
 }
@@ -2,6 +2,7 @@
 
 #include "GLInclude.h"
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -9,5 +10,15 @@
 
 class ObjMesh : public TriangleMesh {
 public:
-  explicit ObjMesh(const std::string &path);
+  /**
+   * @brief メッシュキャッシュのキーに含めるバージョン
+   * @note 溶接、並べ替え、頂点の形式など、転送する内容が変わる修正をしたら上げてください。
+   */
+  static constexpr std::uint32_t kLoaderVersion = 5;
+
+  /**
+   * @param cookFlags CookFlag の組み合わせ (キャッシュのキーにも含めます)
+   */
+  explicit ObjMesh(const std::string &path,
+                   std::uint32_t cookFlags = kCookOptimize);
 };
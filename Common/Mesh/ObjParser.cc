@@ -0,0 +1,420 @@
+/**
+ * @brief  Wavefront OBJ parser
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Mesh/ObjParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "Utils/MappedFile.h"
+
+namespace ObjParser {
+
+//*--------------------------------------------------------------------------------
+// Constant
+//*--------------------------------------------------------------------------------
+
+/**< @brief これより小さいチャンクには分けません */
+static constexpr std::size_t kMinChunkBytes = 256 * 1024;
+/**< @brief スレッドごとのチャンク数 (負荷の偏りをならすため) */
+static constexpr std::size_t kChunksPerThread = 4;
+
+static constexpr int kAbsent = INT_MIN;
+
+//*--------------------------------------------------------------------------------
+// Chunk
+//*--------------------------------------------------------------------------------
+
+/**
+ * @brief 結合前の面の角
+ * @note 負のインデックスはチャンク内の属性の数からの相対値として残し、
+ * 結合時にそれまでのチャンクの属性の数を足して解決します。
+ */
+struct RawIndex {
+  int value[3] = {kAbsent, kAbsent, kAbsent}; // 位置, テクスチャ座標, 法線
+  std::uint8_t relativeMask = 0;
+};
+
+struct ShapeStart {
+  std::size_t firstCorner = 0;
+  std::string name{};
+};
+
+struct Chunk {
+  std::string_view text{};
+  std::vector<float> attribs[3]{}; // 位置, テクスチャ座標, 法線
+  std::vector<RawIndex> corners{};
+  std::vector<ShapeStart> starts{};
+  std::size_t lines = 0;
+  std::size_t errorLine = 0;
+  std::optional<std::string> error{};
+};
+
+static constexpr int kComponents[3] = {3, 2, 3};
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+static bool IsSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+static const char *SkipSpace(const char *p, const char *end) {
+  while (p < end && IsSpace(*p)) {
+    p++;
+  }
+  return p;
+}
+
+/**
+ * @brief strtof で浮動小数点数を読みます。
+ * @note 表せない値は strtof と同じく、非正規化数か 0、または ±inf になります。
+ */
+static const char *ParseFloatSlow(const char *p, const char *end, float &out) {
+  char buf[64];
+  const std::size_t n = std::min<std::size_t>(
+      sizeof(buf) - 1,
+      static_cast<std::size_t>(std::find_if(p, end, IsSpace) - p));
+  std::memcpy(buf, p, n);
+  buf[n] = '\0';
+  char *last = nullptr;
+  out = std::strtof(buf, &last);
+  return last == buf ? nullptr : p + (last - buf);
+}
+
+/**
+ * @brief 浮動小数点数を読みます。
+ * @note 標準ライブラリが浮動小数点数の from_chars を持たない場合は strtof を使います。
+ * from_chars が範囲外 (1e-50 などの小さすぎる値や 1e40 などの大きすぎる値) とした場合も、
+ * ファイル全体を失敗にせず strtof の結果を使います。
+ */
+static const char *ParseFloat(const char *p, const char *end, float &out) {
+  p = SkipSpace(p, end);
+  if (p < end && *p == '+') {
+    p++;
+  }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+  const auto [ptr, ec] = std::from_chars(p, end, out);
+  if (ec == std::errc::result_out_of_range) {
+    return ParseFloatSlow(p, end, out);
+  }
+  return ec == std::errc() ? ptr : nullptr;
+#else
+  return ParseFloatSlow(p, end, out);
+#endif
+}
+
+static const char *ParseInt(const char *p, const char *end, int &out) {
+  if (p < end && *p == '+') {
+    p++;
+  }
+  const auto [ptr, ec] = std::from_chars(p, end, out);
+  return ec == std::errc() ? ptr : nullptr;
+}
+
+/**
+ * @brief "v"、"v/t"、"v//n"、"v/t/n" を読みます。
+ */
+static const char *ParseCorner(const char *p, const char *end,
+                               const Chunk &chunk, RawIndex &out) {
+  for (int k = 0; k < 3; k++) {
+    if (k > 0) {
+      if (p >= end || *p != '/') {
+        break;
+      }
+      p++;
+      if (p < end && *p == '/') {
+        continue; // v//n
+      }
+      if (p >= end || IsSpace(*p)) {
+        break;
+      }
+    }
+    int value = 0;
+    p = ParseInt(p, end, value);
+    if (p == nullptr || value == 0) {
+      return nullptr;
+    }
+    if (value > 0) {
+      out.value[k] = value - 1;
+    } else {
+      const auto count =
+          static_cast<int>(chunk.attribs[k].size() / kComponents[k]);
+      out.value[k] = count + value;
+      out.relativeMask |= static_cast<std::uint8_t>(1u << k);
+    }
+  }
+  return p;
+}
+
+static std::optional<std::string> ParseLine(const char *p, const char *end,
+                                            Chunk &chunk) {
+  p = SkipSpace(p, end);
+  if (p == end || *p == '#') {
+    return std::nullopt;
+  }
+  const char *keyEnd = p;
+  while (keyEnd < end && !IsSpace(*keyEnd)) {
+    keyEnd++;
+  }
+  const std::string_view key(p, static_cast<std::size_t>(keyEnd - p));
+  p = keyEnd;
+
+  const auto parseAttrib = [&](int k,
+                               int required) -> std::optional<std::string> {
+    float values[3] = {};
+    for (int c = 0; c < kComponents[k]; c++) {
+      const char *next = ParseFloat(p, end, values[c]);
+      if (next == nullptr) {
+        if (c < required) {
+          return "Invalid number in '" + std::string(key) + "'";
+        }
+        break;
+      }
+      p = next;
+    }
+    chunk.attribs[k].insert(chunk.attribs[k].end(), values,
+                            values + kComponents[k]);
+    return std::nullopt;
+  };
+
+  if (key == "v") {
+    return parseAttrib(0, 3);
+  }
+  if (key == "vt") {
+    return parseAttrib(1, 1);
+  }
+  if (key == "vn") {
+    return parseAttrib(2, 3);
+  }
+  if (key == "f") {
+    RawIndex first{}, prev{};
+    int count = 0;
+    for (p = SkipSpace(p, end); p < end; p = SkipSpace(p, end)) {
+      RawIndex corner{};
+      p = ParseCorner(p, end, chunk, corner);
+      if (p == nullptr) {
+        return std::string("Invalid face index");
+      }
+      if (count == 0) {
+        first = corner;
+      } else if (count >= 2) {
+        chunk.corners.insert(chunk.corners.end(), {first, prev, corner});
+      }
+      prev = corner;
+      count++;
+    }
+    if (count < 3) {
+      return std::string("Face must have 3+ vertices");
+    }
+    return std::nullopt;
+  }
+  if (key == "o" || key == "g") {
+    p = SkipSpace(p, end);
+    const char *nameEnd = end;
+    while (nameEnd > p && IsSpace(nameEnd[-1])) {
+      nameEnd--;
+    }
+    chunk.starts.push_back(
+        {chunk.corners.size(),
+         std::string(p, static_cast<std::size_t>(nameEnd - p))});
+  }
+  return std::nullopt;
+}
+
+static void ParseChunk(Chunk &chunk) {
+  const char *p = chunk.text.data();
+  const char *end = p + chunk.text.size();
+  while (p < end) {
+    const char *lineEnd =
+        static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (lineEnd == nullptr) {
+      lineEnd = end;
+    }
+    if (auto msg = ParseLine(p, lineEnd, chunk)) {
+      chunk.error = std::move(msg);
+      chunk.errorLine = chunk.lines;
+      return;
+    }
+    chunk.lines++;
+    p = lineEnd + 1;
+  }
+}
+
+/**
+ * @brief threads 個のスレッドで func(0) ... func(count - 1) を実行します。
+ */
+template <typename Func>
+static void RunParallel(std::size_t count, unsigned threads, Func &&func) {
+  if (threads <= 1 || count <= 1) {
+    for (std::size_t i = 0; i < count; i++) {
+      func(i);
+    }
+    return;
+  }
+  std::atomic<std::size_t> next{0};
+  const auto worker = [&] {
+    for (std::size_t i = next++; i < count; i = next++) {
+      func(i);
+    }
+  };
+  std::vector<std::thread> workers;
+  const std::size_t n = std::min<std::size_t>(threads, count);
+  for (std::size_t t = 1; t < n; t++) {
+    workers.emplace_back(worker);
+  }
+  worker();
+  for (auto &w : workers) {
+    w.join();
+  }
+}
+
+static std::vector<Chunk> Split(std::string_view text, unsigned threads) {
+  const std::size_t wanted = std::max<std::size_t>(
+      1, std::min<std::size_t>(threads * kChunksPerThread,
+                               text.size() / kMinChunkBytes));
+  std::vector<Chunk> chunks;
+  std::size_t begin = 0;
+  for (std::size_t i = 1; i <= wanted && begin < text.size(); i++) {
+    std::size_t end = text.size() * i / wanted;
+    if (end < begin) {
+      end = begin;
+    }
+    // 行の途中で切らないよう、次の改行の後ろまで進めます。
+    const std::size_t newline = text.find('\n', end);
+    end = (i == wanted || newline == std::string_view::npos) ? text.size()
+                                                              : newline + 1;
+    Chunk chunk{};
+    chunk.text = text.substr(begin, end - begin);
+    chunks.emplace_back(std::move(chunk));
+    begin = end;
+  }
+  return chunks;
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+std::optional<std::string> Parse(std::string_view text, Result &out,
+                                 unsigned threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  out = Result{};
+
+  std::vector<Chunk> chunks = Split(text, threads);
+  RunParallel(chunks.size(), threads,
+              [&chunks](std::size_t i) { ParseChunk(chunks[i]); });
+
+  // 属性と角の数の累積和から、各チャンクの書き込み先を決めます。
+  std::size_t lines = 0;
+  std::vector<std::size_t> attribOffsets[3];
+  std::vector<std::size_t> cornerOffsets;
+  std::size_t attribTotals[3] = {};
+  std::size_t cornerTotal = 0;
+  for (const Chunk &chunk : chunks) {
+    if (chunk.error) {
+      return "line " + std::to_string(lines + chunk.errorLine + 1) + ": " +
+             chunk.error.value();
+    }
+    lines += chunk.lines;
+    for (int k = 0; k < 3; k++) {
+      attribOffsets[k].push_back(attribTotals[k]);
+      attribTotals[k] += chunk.attribs[k].size();
+    }
+    cornerOffsets.push_back(cornerTotal);
+    cornerTotal += chunk.corners.size();
+  }
+
+  std::vector<float> *outAttribs[3] = {&out.positions, &out.texCoords,
+                                       &out.normals};
+  for (int k = 0; k < 3; k++) {
+    outAttribs[k]->resize(attribTotals[k]);
+  }
+  std::vector<Index> corners(cornerTotal);
+  std::atomic<bool> isOutOfRange{false};
+
+  RunParallel(chunks.size(), threads, [&](std::size_t i) {
+    const Chunk &chunk = chunks[i];
+    int bases[3] = {};
+    int totals[3] = {};
+    for (int k = 0; k < 3; k++) {
+      std::copy(chunk.attribs[k].begin(), chunk.attribs[k].end(),
+                outAttribs[k]->begin() +
+                    static_cast<std::ptrdiff_t>(attribOffsets[k][i]));
+      bases[k] = static_cast<int>(attribOffsets[k][i] / kComponents[k]);
+      totals[k] = static_cast<int>(attribTotals[k] / kComponents[k]);
+    }
+    Index *dst = corners.data() + cornerOffsets[i];
+    for (const RawIndex &raw : chunk.corners) {
+      int resolved[3];
+      for (int k = 0; k < 3; k++) {
+        resolved[k] = raw.value[k];
+        if (resolved[k] == kAbsent) {
+          resolved[k] = -1;
+          continue;
+        }
+        if (raw.relativeMask & (1u << k)) {
+          resolved[k] += bases[k];
+        }
+        if (resolved[k] < 0 || resolved[k] >= totals[k]) {
+          isOutOfRange = true;
+          resolved[k] = -1;
+        }
+      }
+      *dst++ = Index{resolved[0], resolved[1], resolved[2]};
+    }
+  });
+  if (isOutOfRange) {
+    out = Result{};
+    return std::string("Face index out of range");
+  }
+
+  // o と g の位置で三角形を shape に分けます。
+  Shape shape{};
+  std::size_t shapeBegin = 0;
+  const auto closeShape = [&](std::size_t shapeEnd) {
+    if (shapeEnd > shapeBegin) {
+      shape.indices.assign(
+          corners.begin() + static_cast<std::ptrdiff_t>(shapeBegin),
+          corners.begin() + static_cast<std::ptrdiff_t>(shapeEnd));
+      out.shapes.emplace_back(std::move(shape));
+    }
+    shape = Shape{};
+    shapeBegin = shapeEnd;
+  };
+  for (std::size_t i = 0; i < chunks.size(); i++) {
+    for (ShapeStart &start : chunks[i].starts) {
+      closeShape(cornerOffsets[i] + start.firstCorner);
+      shape.name = std::move(start.name);
+    }
+  }
+  closeShape(corners.size());
+  return std::nullopt;
+}
+
+std::optional<std::string> Load(const std::string &path, Result &out,
+                                unsigned threads) {
+  MappedFile file{};
+  if (!file.Open(path)) {
+    return "Can't open file : " + path;
+  }
+  const std::string_view text(reinterpret_cast<const char *>(file.Data()),
+                              file.Size());
+  if (auto msg = Parse(text, out, threads)) {
+    return path + ":" + msg.value();
+  }
+  return std::nullopt;
+}
+
+} // namespace ObjParser
@@ -0,0 +1,55 @@
+/**
+ * @brief  Wavefront OBJ parser
+ * @note   ファイルを行の境界で分割し、チャンクごとに並列に解析してから結合します。
+ * 数値は std::from_chars で読むのでロケールに依存しません。
+ * 扱うのは v / vt / vn / f / o / g だけで、マテリアルなどは読み飛ばします。
+ * 4 頂点以上の面は凸多角形とみなして扇形に三角形分割します。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ObjParser {
+
+/**< @brief 面の角が参照する属性の番号 (0 始まり、無ければ -1) */
+struct Index {
+  int position = -1;
+  int texCoord = -1;
+  int normal = -1;
+};
+
+/**< @brief o か g で区切られた三角形の集まり */
+struct Shape {
+  std::string name{};
+  std::vector<Index> indices{}; // 三角形ごとに 3 つずつ
+};
+
+struct Result {
+  std::vector<float> positions{}; // xyz
+  std::vector<float> texCoords{}; // uv
+  std::vector<float> normals{};   // xyz
+  std::vector<Shape> shapes{};    // 三角形の無い shape は含みません
+};
+
+/**
+ * @brief 文字列を解析します。
+ * @param threads 0 であれば std::thread::hardware_concurrency() を使います。
+ * @return 失敗した場合はエラーメッセージ
+ */
+std::optional<std::string> Parse(std::string_view text, Result &out,
+                                 unsigned threads = 0);
+
+/**
+ * @brief ファイルを読み込んで解析します。
+ * @return 失敗した場合はエラーメッセージ
+ */
+std::optional<std::string> Load(const std::string &path, Result &out,
+                                unsigned threads = 0);
+
+} // namespace ObjParser
@@ -0,0 +1,66 @@
+#include "InstanceBuffer.h"
+
+#include <algorithm>
+#include <boost/assert.hpp>
+
+InstanceBuffer::~InstanceBuffer() {
+  if (buffer_ != 0) {
+    glDeleteBuffers(1, &buffer_);
+  }
+}
+
+void InstanceBuffer::OnInit(std::size_t capacity) {
+  capacity_ = capacity;
+  glGenBuffers(1, &buffer_);
+  glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+  glBufferData(GL_ARRAY_BUFFER,
+               static_cast<GLsizeiptr>(sizeof(Instance) * capacity_), nullptr,
+               GL_STREAM_DRAW);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::Update(const Instance *instances, std::size_t count) {
+  count_ = count;
+
+  glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+  if (count_ > capacity_) {
+    // 足りないときだけ倍々で確保し直します。それ以外は同じ領域へ書き込みます。
+    capacity_ = std::max(count_, capacity_ * 2);
+    glBufferData(GL_ARRAY_BUFFER,
+                 static_cast<GLsizeiptr>(sizeof(Instance) * capacity_),
+                 nullptr, GL_STREAM_DRAW);
+  }
+  if (count_ > 0) {
+    glBufferSubData(GL_ARRAY_BUFFER, 0,
+                    static_cast<GLsizeiptr>(sizeof(Instance) * count_),
+                    instances);
+  }
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::Attach() const {
+  // VAO は GeometryArena で他のメッシュと共有しているので、描画のたびに割り当て、
+  // 描画が終わったら Detach で元に戻します。
+  glBindBuffer(GL_ARRAY_BUFFER, buffer_);
+  for (GLuint i = 0; i < 4; i++) {
+    const std::size_t offset = sizeof(glm::vec4) * i;
+    glVertexAttribPointer(kModelLocation + i, 4, GL_FLOAT, GL_FALSE,
+                          sizeof(Instance),
+                          reinterpret_cast<const void *>(offset));
+    glVertexAttribDivisor(kModelLocation + i, 1);
+    glEnableVertexAttribArray(kModelLocation + i);
+  }
+  glVertexAttribIPointer(
+      kMaterialLocation, 1, GL_UNSIGNED_INT, sizeof(Instance),
+      reinterpret_cast<const void *>(offsetof(Instance, material)));
+  glVertexAttribDivisor(kMaterialLocation, 1);
+  glEnableVertexAttribArray(kMaterialLocation);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBuffer::Detach() {
+  for (GLuint i = kModelLocation; i <= kMaterialLocation; i++) {
+    glDisableVertexAttribArray(i);
+    glVertexAttribDivisor(i, 0);
+  }
+}
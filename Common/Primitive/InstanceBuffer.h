@@ -0,0 +1,57 @@
+#pragma once
+
+#include "GLInclude.h"
+
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+
+/**
+ * @brief インスタンスごとの頂点属性 (モデル行列とマテリアルの番号) のバッファ
+ * @note TriangleMesh::RenderInstanced で描画する直前に VAO の kModelLocation 〜
+ * kMaterialLocation へ除数 1 で割り当て、描画後に外します。シェーダーでは
+ *   layout (location=8) in mat4 InstanceModel;
+ *   layout (location=12) in uint InstanceMaterial;
+ * として受け取ります。
+ */
+class InstanceBuffer : private boost::noncopyable {
+public:
+  /**< @brief モデル行列の列 (4 つの location を使います) */
+  static constexpr GLuint kModelLocation = 8;
+  static constexpr GLuint kMaterialLocation = 12;
+
+  /**< @brief 1 インスタンス分のデータ (80 バイト) */
+  struct Instance {
+    glm::mat4 model{1.0f};
+    GLuint material = 0;
+    GLuint reserved[3] = {};
+  };
+  static_assert(sizeof(Instance) == 80, "Instance must be tightly packed.");
+
+  InstanceBuffer() = default;
+  ~InstanceBuffer();
+
+  /**
+   * @param capacity 最初に確保するインスタンスの数
+   */
+  void OnInit(std::size_t capacity);
+
+  /**
+   * @brief インスタンスのデータを転送します。
+   * @note 容量を超えたときだけ領域を確保し直し、それ以外は glBufferSubData で書き込みます。
+   */
+  void Update(const Instance *instances, std::size_t count);
+
+  /**< @brief バインド中の VAO にインスタンスの属性を割り当てます。 */
+  void Attach() const;
+  /**< @brief Attach で割り当てた属性を無効にし、除数を 0 に戻します。 */
+  static void Detach();
+
+  GLuint GetHandle() const { return buffer_; }
+  std::size_t GetCount() const { return count_; }
+  std::size_t GetCapacity() const { return capacity_; }
+
+private:
+  GLuint buffer_ = 0;
+  std::size_t count_ = 0;
+  std::size_t capacity_ = 0;
+};
@@ -0,0 +1,103 @@
+#include "TeapotPatches.h"
+#include "TeapotData.h"
+
+#include <vector>
+
+#include "Graphics/GLState.h"
+
+namespace Impl {
+
+/**
+ * @brief 制御点の生成に関する実装
+ * @note Teapot::GeneratePatches と同じ順に、反転したパッチも含めて 32 枚並べます。
+ * 法線はテッセレーション評価シェーダーで cross(dv, du) として求めます。
+ */
+namespace Patch {
+static void Append(int patchNum, bool reverseV, const glm::mat3 &reflect,
+                   std::vector<GLfloat> &points) {
+  for (int u = 0; u < 4; u++) {
+    for (int v = 0; v < 4; v++) {
+      const int cp =
+          TeapotData::patchdata[patchNum][u * 4 + (reverseV ? 3 - v : v)];
+      const glm::vec3 p =
+          reflect * glm::vec3(TeapotData::cpdata[cp][0],
+                              TeapotData::cpdata[cp][1],
+                              TeapotData::cpdata[cp][2]);
+      points.insert(points.end(), {p.x, p.y, p.z});
+    }
+  }
+}
+
+static void AppendReflect(int patchNum, bool reflectX, bool reflectY,
+                          std::vector<GLfloat> &points) {
+  Append(patchNum, false, glm::mat3(1.0f), points);
+  if (reflectX) {
+    Append(patchNum, true,
+           glm::mat3(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f),
+                     glm::vec3(0.0f, 0.0f, 1.0f)),
+           points);
+  }
+  if (reflectY) {
+    Append(patchNum, true,
+           glm::mat3(glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.0f, -1.0f, 0.0f),
+                     glm::vec3(0.0f, 0.0f, 1.0f)),
+           points);
+  }
+  if (reflectX && reflectY) {
+    Append(patchNum, false,
+           glm::mat3(glm::vec3(-1.0f, 0.0f, 0.0f),
+                     glm::vec3(0.0f, -1.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f)),
+           points);
+  }
+}
+} // namespace Patch
+
+} // namespace Impl
+
+TeapotPatches::TeapotPatches(const glm::mat4 &lidTransform) {
+  std::vector<GLfloat> points;
+  points.reserve(kPatchNum * kPatchVertices * 3);
+
+  // 縁、胴、蓋、底は x と y で、取っ手と注ぎ口は y だけで反転します。
+  for (int patchNum = 0; patchNum < 10; patchNum++) {
+    Impl::Patch::AppendReflect(patchNum, patchNum < 6, true, points);
+  }
+
+  // 蓋 (12 枚目から 20 枚目) を動かします。ベジェ曲面はアフィン変換で不変です。
+  for (std::size_t i = 12 * kPatchVertices * 3; i < 20 * kPatchVertices * 3;
+       i += 3) {
+    const glm::vec4 p =
+        lidTransform * glm::vec4(points[i], points[i + 1], points[i + 2], 1.0f);
+    points[i] = p.x;
+    points[i + 1] = p.y;
+    points[i + 2] = p.z;
+  }
+
+  bufferSize_ = static_cast<GLsizeiptr>(points.size() * sizeof(GLfloat));
+  GLState::Get().BindVertexArray(0);
+  glGenBuffers(1, &vbo_);
+  glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+  glBufferData(GL_ARRAY_BUFFER, bufferSize_, points.data(), GL_STATIC_DRAW);
+
+  glGenVertexArrays(1, &vao_);
+  GLState::Get().BindVertexArray(vao_);
+  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glEnableVertexAttribArray(0);
+  GLState::Get().BindVertexArray(0);
+}
+
+TeapotPatches::~TeapotPatches() {
+  if (vbo_ != 0) {
+    glDeleteBuffers(1, &vbo_);
+  }
+  if (vao_ != 0) {
+    GLState::DeleteVertexArrays(1, &vao_);
+  }
+}
+
+void TeapotPatches::Render() const {
+  // 次の描画で同じ VAO であればバインドは省略されるので、0 に戻しません。
+  GLState::Get().BindVertexArray(vao_);
+  glPatchParameteri(GL_PATCH_VERTICES, kPatchVertices);
+  glDrawArrays(GL_PATCHES, 0, kPatchNum * kPatchVertices);
+}
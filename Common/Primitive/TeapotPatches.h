@@ -0,0 +1,34 @@
+#pragma once
+
+#include "GLInclude.h"
+
+#include "Drawable.h"
+
+/**
+ * @brief ティーポットの 32 枚の双三次ベジェパッチを、制御点のまま GL_PATCHES で描画します。
+ * @note 頂点バッファは制御点 (32 * 16 個) だけなので、分割数に依らず 6 KiB です。
+ * 分割はテッセレーション制御シェーダー (Assets/Shaders/Bezier/Teapot.tcs.glsl など) で
+ * 画面上の辺の長さから決めます。パッチの並びと向きは Teapot と同じです。
+ */
+class TeapotPatches : public Drawable {
+public:
+  static constexpr GLint kPatchVertices = 16;
+  static constexpr GLsizei kPatchNum = 32;
+
+  explicit TeapotPatches(const glm::mat4 &lidTransform);
+  virtual ~TeapotPatches() override;
+
+  TeapotPatches(const TeapotPatches &) = delete;
+  TeapotPatches &operator=(const TeapotPatches &) = delete;
+
+  /**< @brief テッセレーションシェーダーを含むプログラムを使用してから呼び出してください。 */
+  virtual void Render() const override;
+
+  /**< @brief 頂点バッファのバイト数 */
+  GLsizeiptr GetBufferSize() const { return bufferSize_; }
+
+private:
+  GLuint vao_ = 0;
+  GLuint vbo_ = 0;
+  GLsizeiptr bufferSize_ = 0;
+};
@@ -1,108 +1,437 @@
 #include "TriangleMesh.h"
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iostream>
 
+#include "Graphics/GLState.h"
+#include "Graphics/VertexLayout.h"
+#include "Mesh/MeshOptimizer.h"
+#include "Mesh/MeshSimplifier.h"
+
+namespace Impl {
+
+/**< @brief 16 ビットのインデックスで参照できる頂点数 */
+static constexpr std::size_t kMaxShortVertices = 65536;
+
+/**
+ * @brief 詳細度の生成に関する実装
+ * @note 一つ前の詳細度の三角形を半分に減らすことを繰り返します (100/50/25/12.5%)。
+ * 境界や継ぎ目が多く、あまり減らせなくなった時点で打ち切ります。
+ */
+namespace Lod {
+static constexpr std::size_t kMaxLevels = 4;
+/**< @brief これより三角形の少ないメッシュには詳細度を作りません。 */
+static constexpr std::size_t kMinTriangles = 256;
+/**< @brief 一つ前の詳細度に対する三角形の数の比の目標 */
+static constexpr float kReduction = 0.5f;
+/**< @brief 三角形の数の比がこれより大きければ打ち切ります。 */
+static constexpr float kMaxRatio = 0.9f;
+/**< @brief 視点がメッシュに近すぎる場合に距離を打ち切る値 */
+static constexpr float kMinDistance = 1e-4f;
+} // namespace Lod
+
+/**
+ * @brief 頂点属性の形式の選択
+ * @note 属性の有無と値の範囲から形式を選び、対応する VertexLayout で詰め込みます。
+ * - 位置: 16 ビット浮動小数点数の誤差が AABB の対角線の 1/4096 以下なら Half4
+ * - 法線と接線: 10 ビットの正規化整数
+ * - テクスチャ座標: [0, 1] に収まれば 16 ビットの正規化整数
+ */
+namespace Layout {
+static bool IsHalfPrecise(const std::vector<GLfloat> &positions) {
+  if (positions.empty()) {
+    return false;
+  }
+  glm::vec3 lo(positions[0], positions[1], positions[2]);
+  glm::vec3 hi = lo;
+  float maxError = 0.0f;
+  for (std::size_t i = 0; i < positions.size(); i += 3) {
+    const glm::vec3 v(positions[i], positions[i + 1], positions[i + 2]);
+    lo = glm::min(lo, v);
+    hi = glm::max(hi, v);
+    for (int c = 0; c < 3; c++) {
+      const float h = glm::unpackHalf1x16(glm::packHalf1x16(v[c]));
+      maxError = std::max(maxError, std::abs(h - v[c]));
+    }
+  }
+  return maxError <= glm::length(hi - lo) / 4096.0f;
+}
+
+static bool IsUnitRange(const std::vector<GLfloat> &texCoords) {
+  return std::all_of(texCoords.begin(), texCoords.end(),
+                     [](float t) { return t >= 0.0f && t <= 1.0f; });
+}
+
+template <typename... Attribs> struct List {};
+
+template <typename... Attribs, typename Func>
+static void VisitTangent(std::uint32_t layout, List<Attribs...>, Func &&func) {
+  if (layout & TriangleMesh::kTangent) {
+    func(VertexLayout<Attribs...,
+                      Attribute<3, VertexFormat::Snorm10x3Sign>>{});
+  } else {
+    func(VertexLayout<Attribs...>{});
+  }
+}
+
+template <typename... Attribs, typename Func>
+static void VisitTexCoord(std::uint32_t layout, List<Attribs...>, Func &&func) {
+  if (layout & TriangleMesh::kUnormTexCoord) {
+    VisitTangent(layout,
+                 List<Attribs..., Attribute<2, VertexFormat::Unorm16x2>>{},
+                 func);
+  } else if (layout & TriangleMesh::kFloatTexCoord) {
+    VisitTangent(layout,
+                 List<Attribs..., Attribute<2, VertexFormat::Float2>>{}, func);
+  } else {
+    VisitTangent(layout, List<Attribs...>{}, func);
+  }
+}
+
+template <typename... Attribs, typename Func>
+static void VisitNormal(std::uint32_t layout, List<Attribs...>, Func &&func) {
+  if (layout & TriangleMesh::kNormal) {
+    VisitTexCoord(layout,
+                  List<Attribs..., Attribute<1, VertexFormat::Snorm10x3>>{},
+                  func);
+  } else {
+    VisitTexCoord(layout, List<Attribs...>{}, func);
+  }
+}
+
+/**
+ * @brief フラグに対応する VertexLayout を func に渡します。
+ */
+template <typename Func> static void Visit(std::uint32_t layout, Func &&func) {
+  if (layout & TriangleMesh::kHalfPosition) {
+    VisitNormal(layout, List<Attribute<0, VertexFormat::Half4>>{}, func);
+  } else {
+    VisitNormal(layout, List<Attribute<0, VertexFormat::Float3>>{}, func);
+  }
+}
+} // namespace Layout
+
+} // namespace Impl
+
+TriangleMesh::Streams TriangleMesh::CookedMesh::View() const {
+  Streams streams{};
+  streams.layout = layout;
+  streams.indexType = indexType;
+  streams.vertexCount = vertexCount;
+  streams.indexCount = indexCount;
+  streams.vertices = vertices.data();
+  streams.vertexBytes = vertices.size();
+  streams.indices = indices.data();
+  streams.indexBytes = indices.size();
+  return streams;
+}
+
 TriangleMesh::~TriangleMesh() { DestroyBuffers(); }
 
 void TriangleMesh::InitBuffers(
     const std::vector<GLuint> &indices, const std::vector<GLfloat> &points,
     const std::optional<std::vector<GLfloat>> &normals,
     const std::optional<std::vector<GLfloat>> &texCoords,
-    const std::optional<std::vector<GLfloat>> &tangents) {
-  if (!buffers_.empty()) {
-    DestroyBuffers();
+    const std::optional<std::vector<GLfloat>> &tangents,
+    const std::vector<Submesh> &submeshes, std::uint32_t cookFlags) {
+  UploadBuffers(CookBuffers(indices, points, normals, texCoords, tangents,
+                            submeshes, cookFlags)
+                    .View());
+}
+
+TriangleMesh::CookedMesh TriangleMesh::CookBuffers(
+    const std::vector<GLuint> &indices, const std::vector<GLfloat> &points,
+    const std::optional<std::vector<GLfloat>> &normals,
+    const std::optional<std::vector<GLfloat>> &texCoords,
+    const std::optional<std::vector<GLfloat>> &tangents,
+    const std::vector<Submesh> &submeshes, std::uint32_t cookFlags) {
+  const bool isOptimize = (cookFlags & kCookOptimize) != 0;
+  const bool isLods = (cookFlags & kCookLods) != 0;
+  const bool isMeshlets = (cookFlags & kCookMeshlets) != 0;
+  submeshes_ = submeshes;
+  if (submeshes_.empty()) {
+    submeshes_.push_back({0, static_cast<GLuint>(indices.size())});
   }
 
-  nVerts_ = static_cast<GLuint>(indices.size());
-  GLuint indexBuf = 0, posBuf = 0, normBuf = 0, tcBuf = 0, tangentBuf = 0;
+  // kCookOptimize の場合は、頂点キャッシュ、オーバードロー、頂点フェッチの順に並べ替えます。
+  // 描画範囲をまたがないよう、三角形の並べ替えは描画範囲ごとに行います。
+  std::vector<GLuint> el = indices;
+  std::vector<GLfloat> p = points;
+  std::optional<std::vector<GLfloat>> n = normals;
+  std::optional<std::vector<GLfloat>> tc = texCoords;
+  std::optional<std::vector<GLfloat>> tang = tangents;
+  {
+    const std::size_t vertexCount = p.size() / 3;
+    report_ = MeshOptimizer::Report{};
+    if (isOptimize) {
+      report_.before = MeshOptimizer::AnalyzeVertexCache(el, vertexCount);
+    }
+    clusters_.clear();
+    for (std::size_t i = 0; i < submeshes_.size(); i++) {
+      const Submesh &submesh = submeshes_[i];
+      const auto first = el.begin() + submesh.firstIndex;
+      std::vector<GLuint> range(first, first + submesh.indexCount);
+      if (isOptimize) {
+        range = MeshOptimizer::OptimizeVertexCache(range, vertexCount);
+        range = MeshOptimizer::OptimizeOverdraw(range, p);
+      }
+      if (!isMeshlets) {
+        std::copy(range.begin(), range.end(), first);
+        continue;
+      }
 
-  glGenBuffers(1, &indexBuf);
-  buffers_.emplace_back(indexBuf);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuf);
-  glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint),
-               indices.data(), GL_STATIC_DRAW);
+      // 並べ替えた順を種にしてクラスターに分け、クラスターの順に並べ直します。
+      // クラスターの中は、クラスター内の頂点番号で頂点キャッシュの順に並べ替えます。
+      auto meshlets = MeshletBuilder::Build(range, p);
+      for (std::size_t m = 0; m < meshlets.meshlets.size(); m++) {
+        const auto &meshlet = meshlets.meshlets[m];
+        std::vector<GLuint> localEl(meshlet.triangleCount * 3);
+        for (std::size_t t = 0; t < meshlet.triangleCount; t++) {
+          const GLuint packed = meshlets.triangles[meshlet.triangleOffset + t];
+          for (std::size_t k = 0; k < 3; k++) {
+            localEl[t * 3 + k] = (packed >> (8 * k)) & 0xFFu;
+          }
+        }
+        localEl =
+            MeshOptimizer::OptimizeVertexCache(localEl, meshlet.vertexCount);
+        for (std::size_t e = 0; e < localEl.size(); e++) {
+          meshlets.indices[meshlet.triangleOffset * 3 + e] =
+              meshlets.vertices[meshlet.vertexOffset + localEl[e]];
+        }
 
-  glGenBuffers(1, &posBuf);
-  buffers_.emplace_back(posBuf);
-  glBindBuffer(GL_ARRAY_BUFFER, posBuf);
-  glBufferData(GL_ARRAY_BUFFER, points.size() * sizeof(GLfloat), points.data(),
-               GL_STATIC_DRAW);
+        Cluster cluster{};
+        cluster.firstIndex = submesh.firstIndex + meshlet.triangleOffset * 3;
+        cluster.indexCount = meshlet.triangleCount * 3;
+        cluster.submesh = static_cast<GLuint>(i);
+        cluster.bounds = meshlets.bounds[m];
+        clusters_.emplace_back(cluster);
+      }
+      std::copy(meshlets.indices.begin(), meshlets.indices.end(), first);
+    }
 
-  if (normals) {
-    glGenBuffers(1, &normBuf);
-    buffers_.emplace_back(normBuf);
-    glBindBuffer(GL_ARRAY_BUFFER, normBuf);
-    glBufferData(GL_ARRAY_BUFFER, normals.value().size() * sizeof(GLfloat),
-                 normals.value().data(), GL_STATIC_DRAW);
-  }
+    // 詳細度は同じ頂点を参照するので、インデックスを後ろに追加するだけです。
+    lods_.clear();
+    lods_.push_back({0, static_cast<GLuint>(el.size()), 0.0f});
+    if (isLods && el.size() / 3 >= Impl::Lod::kMinTriangles) {
+      std::vector<GLuint> prev = el;
+      float error = 0.0f;
+      while (lods_.size() < Impl::Lod::kMaxLevels) {
+        const auto target = static_cast<std::size_t>(
+            static_cast<float>(prev.size() / 3) * Impl::Lod::kReduction);
+        float levelError = 0.0f;
+        std::vector<GLuint> level =
+            MeshSimplifier::Simplify(prev, p, target * 3, &levelError);
+        if (level.empty() ||
+            static_cast<float>(level.size()) >
+                static_cast<float>(prev.size()) * Impl::Lod::kMaxRatio) {
+          break;
+        }
+        if (isOptimize) {
+          level = MeshOptimizer::OptimizeVertexCache(level, vertexCount);
+        }
+        error = std::max(error, levelError);
+        lods_.push_back({static_cast<GLuint>(el.size()),
+                         static_cast<GLuint>(level.size()), error});
+        el.insert(el.end(), level.begin(), level.end());
+        prev = std::move(level);
+      }
+    }
 
+    if (isOptimize) {
+      const auto remap = MeshOptimizer::OptimizeVertexFetch(el, vertexCount);
+      MeshOptimizer::RemapVertices(remap, 3, p);
+      if (n) {
+        MeshOptimizer::RemapVertices(remap, 3, n.value());
+      }
+      if (tc) {
+        MeshOptimizer::RemapVertices(remap, 2, tc.value());
+      }
+      if (tang) {
+        MeshOptimizer::RemapVertices(remap, 4, tang.value());
+      }
+      report_.after = MeshOptimizer::AnalyzeVertexCache(
+          std::vector<GLuint>(el.begin(), el.begin() + lods_[0].indexCount),
+          vertexCount);
+    }
+  }
 
-  if (texCoords) {
-    glGenBuffers(1, &tcBuf);
-    buffers_.emplace_back(tcBuf);
-    glBindBuffer(GL_ARRAY_BUFFER, tcBuf);
-    glBufferData(GL_ARRAY_BUFFER, texCoords.value().size() * sizeof(GLfloat),
-                 texCoords.value().data(), GL_STATIC_DRAW);
+  bbox_.Reset();
+  for (std::size_t i = 0; i + 2 < p.size(); i += 3) {
+    bbox_.Merge(p[i], p[i + 1], p[i + 2]);
   }
 
-  if (tangents) {
-    glGenBuffers(1, &tangentBuf);
-    buffers_.emplace_back(tangentBuf);
-    glBindBuffer(GL_ARRAY_BUFFER, tangentBuf);
-    glBufferData(GL_ARRAY_BUFFER, tangents.value().size() * sizeof(GLfloat),
-                 tangents.value().data(), GL_STATIC_DRAW);
+  CookedMesh cooked{};
+  cooked.vertexCount = static_cast<GLuint>(p.size() / 3);
+  cooked.indexCount = static_cast<GLuint>(el.size());
+
+  // 全ての頂点番号が 16 ビットに収まれば、インデックスも 16 ビットで持ちます。
+  if (cooked.vertexCount <= Impl::kMaxShortVertices) {
+    cooked.indexType = GL_UNSIGNED_SHORT;
+    const std::vector<GLushort> shortEl(el.begin(), el.end());
+    const auto *bytes = reinterpret_cast<const std::uint8_t *>(shortEl.data());
+    cooked.indices.assign(bytes, bytes + shortEl.size() * sizeof(GLushort));
+  } else {
+    cooked.indexType = GL_UNSIGNED_INT;
+    const auto *bytes = reinterpret_cast<const std::uint8_t *>(el.data());
+    cooked.indices.assign(bytes, bytes + el.size() * sizeof(GLuint));
   }
 
-  glGenVertexArrays(1, &vao_);
-  glBindVertexArray(vao_);
-  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuf);
+  if (Impl::Layout::IsHalfPrecise(p)) {
+    cooked.layout |= kHalfPosition;
+  }
+  if (n) {
+    cooked.layout |= kNormal;
+  }
+  if (tc) {
+    cooked.layout |= Impl::Layout::IsUnitRange(tc.value()) ? kUnormTexCoord
+                                                           : kFloatTexCoord;
+  }
+  if (tang) {
+    cooked.layout |= kTangent;
+  }
 
-  // Position
-  glBindBuffer(GL_ARRAY_BUFFER, posBuf);
-  glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, 0);
-  glEnableVertexAttribArray(0); // Vertex position
+  const float *sources[] = {p.data(), n ? n.value().data() : nullptr,
+                            tc ? tc.value().data() : nullptr,
+                            tang ? tang.value().data() : nullptr};
+  Impl::Layout::Visit(cooked.layout, [&](auto layout) {
+    using Type = decltype(layout);
+    std::array<const float *, Type::kCount> inputs{};
+    for (std::size_t i = 0; i < Type::kCount; i++) {
+      inputs[i] = sources[Type::kLocations[i]];
+    }
+    cooked.vertices = Type::Pack(cooked.vertexCount, inputs);
+  });
+  return cooked;
+}
 
-  // Normal
-  if (normals) {
-    glBindBuffer(GL_ARRAY_BUFFER, normBuf);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(1); // Normal
+GLuint TriangleMesh::GetLayoutStride(std::uint32_t layout) {
+  constexpr std::uint32_t kKnown =
+      kHalfPosition | kNormal | kUnormTexCoord | kFloatTexCoord | kTangent;
+  if ((layout & ~kKnown) != 0 ||
+      ((layout & kUnormTexCoord) && (layout & kFloatTexCoord))) {
+    return 0;
   }
+  GLuint stride = 0;
+  Impl::Layout::Visit(layout, [&](auto type) {
+    stride = static_cast<GLuint>(decltype(type)::kStride);
+  });
+  return stride;
+}
 
-  // Tex Coord
-  if (texCoords) {
-    glBindBuffer(GL_ARRAY_BUFFER, tcBuf);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(2); // Tex Coord
+void TriangleMesh::UploadBuffers(const Streams &streams) {
+  if (alloc_.IsValid()) {
+    DestroyBuffers();
   }
 
-  // Tangent
-  if (tangents) {
-    glBindBuffer(GL_ARRAY_BUFFER, tangentBuf);
-    glVertexAttribPointer(3, 4, GL_FLOAT, GL_FALSE, 0, 0);
-    glEnableVertexAttribArray(3); // Tangents
+  if (lods_.empty()) {
+    lods_.push_back({0, streams.indexCount, 0.0f});
+  }
+  nVerts_ = lods_[0].indexCount;
+  nUniqueVerts_ = streams.vertexCount;
+  indexType_ = streams.indexType;
+  if (streams.vertexCount == 0 || streams.indexCount == 0) {
+    return;
   }
 
-  glBindVertexArray(0);
+  // レイアウトのフラグが同じメッシュは GeometryArena の VAO を共有します。
+  GeometryArena::Layout layout{};
+  Impl::Layout::Visit(streams.layout, [&](auto type) {
+    using Type = decltype(type);
+    layout.key = streams.layout;
+    layout.stride = static_cast<GLsizei>(Type::kStride);
+    layout.setup = &Type::Setup;
+  });
+  vertexStride_ = static_cast<GLuint>(layout.stride);
+  alloc_ = GeometryArena::Get().Allocate(
+      layout, streams.vertices, static_cast<GLsizeiptr>(streams.vertexBytes),
+      streams.indices, static_cast<GLsizeiptr>(streams.indexBytes));
+  vao_ = alloc_.vao;
 }
 
 void TriangleMesh::DestroyBuffers() {
-  if (!buffers_.empty()) {
-    glDeleteBuffers(static_cast<GLsizei>(buffers_.size()), buffers_.data());
-    buffers_.clear();
+  if (alloc_.IsValid()) {
+    GeometryArena::Get().Free(alloc_);
+    alloc_ = GeometryArena::Allocation{};
   }
+  vao_ = 0;
+}
+
+GLuint TriangleMesh::GetFirstIndex() const {
+  const std::size_t indexSize =
+      indexType_ == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  return static_cast<GLuint>(alloc_.indexOffset /
+                             static_cast<GLsizeiptr>(indexSize));
+}
+
+void TriangleMesh::Render() const { RenderLod(0); }
+
+void TriangleMesh::Render(const LodView &view, const glm::mat4 &model) const {
+  RenderLod(SelectLod(view, model));
+}
 
-  if (vao_ != 0) {
-    glDeleteVertexArrays(1, &vao_);
-    vao_ = 0;
+void TriangleMesh::RenderLod(std::size_t level) const {
+  if (vao_ == 0 || level >= lods_.size()) {
+    return;
   }
+  const LodLevel &lod = lods_[level];
+  const std::size_t indexSize =
+      indexType_ == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  // 同じレイアウトのメッシュは VAO を共有するので、続けて描画してもバインドは省略されます。
+  GLState::Get().BindVertexArray(vao_);
+  glDrawElementsBaseVertex(
+      GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), indexType_,
+      reinterpret_cast<const void *>(alloc_.indexOffset +
+                                     lod.firstIndex * indexSize),
+      alloc_.baseVertex);
 }
 
-void TriangleMesh::Render() const {
-  if (vao_ == 0) {
+void TriangleMesh::RenderInstanced(const InstanceBuffer &instances,
+                                   GLsizei count, std::size_t level) const {
+  // 転送した数を超えて読まないようにします。
+  count = std::min(count, static_cast<GLsizei>(instances.GetCount()));
+  if (vao_ == 0 || level >= lods_.size() || count <= 0) {
     return;
   }
-  glBindVertexArray(vao_);
-  glDrawElements(GL_TRIANGLES, nVerts_, GL_UNSIGNED_INT, 0);
-  glBindVertexArray(0);
+  const LodLevel &lod = lods_[level];
+  const std::size_t indexSize =
+      indexType_ == GL_UNSIGNED_SHORT ? sizeof(GLushort) : sizeof(GLuint);
+  GLState::Get().BindVertexArray(vao_);
+  instances.Attach();
+  glDrawElementsInstancedBaseVertex(
+      GL_TRIANGLES, static_cast<GLsizei>(lod.indexCount), indexType_,
+      reinterpret_cast<const void *>(alloc_.indexOffset +
+                                     lod.firstIndex * indexSize),
+      count, alloc_.baseVertex);
+  // 共有している VAO を使う他のメッシュへインスタンスの属性を残さないようにします。
+  InstanceBuffer::Detach();
+}
+
+std::size_t TriangleMesh::SelectLod(const LodView &view,
+                                    const glm::mat4 &model) const {
+  if (lods_.size() <= 1) {
+    return 0;
+  }
+
+  // 誤差は境界球の最も視点に近い位置で投影します。
+  const float scale =
+      std::max({glm::length(glm::vec3(model[0])),
+                glm::length(glm::vec3(model[1])),
+                glm::length(glm::vec3(model[2]))});
+  const glm::vec3 center =
+      glm::vec3(model * glm::vec4((bbox_.mini + bbox_.maxi) * 0.5f, 1.0f));
+  const float radius = glm::length(bbox_.maxi - bbox_.mini) * 0.5f * scale;
+  const float distance = std::max(glm::length(view.eye - center) - radius,
+                                  Impl::Lod::kMinDistance);
+  const float pixelsPerError = scale * view.pixelsPerUnit / distance;
+
+  std::size_t level = 0;
+  while (level + 1 < lods_.size() &&
+         lods_[level + 1].error * pixelsPerError <= view.threshold) {
+    level++;
+  }
+  const int biased = static_cast<int>(level) + view.bias;
+  return static_cast<std::size_t>(
+      std::clamp(biased, 0, static_cast<int>(lods_.size()) - 1));
 }
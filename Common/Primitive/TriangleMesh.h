@@ -1,35 +1,171 @@
 #pragma once
 
 #include "GLInclude.h"
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 #include <vector>
 
 #include "Geometry/AABB.h"
+#include "Graphics/GeometryArena.h"
+#include "Mesh/MeshOptimizer.h"
+#include "Mesh/MeshletBuilder.h"
+#include "View/LodView.h"
 #include "Drawable.h"
+#include "InstanceBuffer.h"
 
 class TriangleMesh : public Drawable {
 public:
+  /**< @brief 頂点属性の有無と形式 */
+  enum LayoutFlag : std::uint32_t {
+    kHalfPosition = 1u << 0,  // 位置を 16 ビット浮動小数点数で持つ
+    kNormal = 1u << 1,        // 法線
+    kUnormTexCoord = 1u << 2, // テクスチャ座標 (16 ビットの正規化整数)
+    kFloatTexCoord = 1u << 3, // テクスチャ座標 (32 ビット浮動小数点数)
+    kTangent = 1u << 4,       // 接線
+  };
+
+  /**
+   * @brief CookBuffers で行う処理
+   * @note 既定では何もせず、頂点属性を詰め込むだけです。必要なものだけを指定してください。
+   */
+  enum CookFlag : std::uint32_t {
+    kCookOptimize = 1u << 0, // 頂点キャッシュ、オーバードロー、頂点フェッチの順に並べ替える
+    kCookLods = 1u << 1,     // 詳細度を作る (SelectLod や RenderLod で使う場合)
+    kCookMeshlets = 1u << 2, // クラスターに分け、インデックスをクラスターの順に並べ直す
+  };
+
+  /**< @brief 描画範囲 (OBJ の shape など) */
+  struct Submesh {
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+  };
+
+  /**
+   * @brief 詳細度 (LOD) ごとの描画範囲
+   * @note 全ての詳細度は同じ頂点バッファを参照し、インデックスバッファに順に並びます。
+   */
+  struct LodLevel {
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+    float error = 0.0f; // 元の形状からの誤差 (オブジェクト空間の距離)
+  };
+
+  /**
+   * @brief 最も細かい詳細度を分けたクラスター (メッシュレット)
+   * @note 描画範囲をまたがず、インデックスバッファでは連続して並びます。
+   * std430 のバッファにそのまま置けるよう 64 バイトにしています。
+   */
+  struct Cluster {
+    GLuint firstIndex = 0;
+    GLuint indexCount = 0;
+    GLuint submesh = 0; // 属する描画範囲
+    GLuint reserved = 0;
+    MeshletBuilder::Bounds bounds{};
+  };
+  static_assert(sizeof(Cluster) == 64, "Cluster must match the std430 layout.");
+
+  /**< @brief そのまま glBufferData に渡せる頂点とインデックス */
+  struct Streams {
+    std::uint32_t layout = 0; // LayoutFlag の組み合わせ
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLuint vertexCount = 0;
+    GLuint indexCount = 0;
+    const void *vertices = nullptr;
+    std::size_t vertexBytes = 0;
+    const void *indices = nullptr;
+    std::size_t indexBytes = 0;
+  };
+
+  /**< @brief CookBuffers で作った頂点とインデックス */
+  struct CookedMesh {
+    std::uint32_t layout = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    GLuint vertexCount = 0;
+    GLuint indexCount = 0;
+    std::vector<std::uint8_t> vertices{};
+    std::vector<std::uint8_t> indices{};
+
+    Streams View() const;
+  };
+
   virtual ~TriangleMesh() override;
+  /**< @brief 最も細かい詳細度で描画します。 */
   virtual void Render() const override;
+  /**< @brief 画面上の誤差が閾値以下になる最も粗い詳細度で描画します。 */
+  void Render(const LodView &view, const glm::mat4 &model) const;
+  /**< @brief 指定した詳細度で描画します。 */
+  void RenderLod(std::size_t level) const;
+  /**
+   * @brief instances の先頭 count 個を一回の描画の呼び出しで描画します。
+   * @param level 全インスタンスで共通の詳細度
+   */
+  void RenderInstanced(const InstanceBuffer &instances, GLsizei count,
+                       std::size_t level = 0) const;
+  /**< @brief 画面上の誤差から詳細度を選びます。 */
+  std::size_t SelectLod(const LodView &view, const glm::mat4 &model) const;
+  /**< @brief 同じレイアウトの他のメッシュと共有する VAO */
   GLuint GetVAO() const { return vao_; }
-  GLuint GetElementBuffer() const { return buffers_[0]; }
-  GLuint GetPositionBuffer() const { return buffers_[1]; }
-  GLuint GetNormalBuffer() const { return buffers_[2]; }
-  GLuint GetTcBuffer() const { return buffers_.size() > 3 ? buffers_[3] : 0; }
+  GLuint GetElementBuffer() const { return alloc_.indexBuffer; }
+  /**< @brief 全ての属性をインターリーブした頂点バッファ (他のメッシュと共有) */
+  GLuint GetVertexBuffer() const { return alloc_.vertexBuffer; }
+  /**< @brief GeometryArena から切り出した範囲 (baseVertex とインデックスの位置) */
+  const GeometryArena::Allocation &GetAllocation() const { return alloc_; }
+  /**< @brief インデックスバッファ内の、詳細度 0 の先頭のインデックスの番号 */
+  GLuint GetFirstIndex() const;
+  /**< @brief GL_UNSIGNED_SHORT か GL_UNSIGNED_INT */
+  GLenum GetIndexType() const { return indexType_; }
+  /**< @brief 1 頂点あたりのバイト数 */
+  GLuint GetVertexStride() const { return vertexStride_; }
+  /**< @brief LayoutFlag の組み合わせに対応する 1 頂点あたりのバイト数 (不正な組み合わせは 0) */
+  static GLuint GetLayoutStride(std::uint32_t layout);
   GLuint GetNumVers() const { return nVerts_; }
+  GLuint GetNumUniqueVerts() const { return nUniqueVerts_; }
+  const std::vector<Submesh> &GetSubmeshes() const { return submeshes_; }
+  /**< @brief 先頭が元の形状で、後ろほど粗くなります。(kCookLods でなければ一つだけです) */
+  const std::vector<LodLevel> &GetLods() const { return lods_; }
+  /**< @brief kCookMeshlets でなければ空です。 */
+  const std::vector<Cluster> &GetClusters() const { return clusters_; }
   AABB GetAABB() const { return bbox_; }
+  /**< @brief InitBuffers での並べ替え前後の頂点キャッシュの効率 (kCookOptimize の場合) */
+  const MeshOptimizer::Report &GetOptimizeReport() const { return report_; }
 
 protected:
   virtual void InitBuffers(
       const std::vector<GLuint> &indices, const std::vector<GLfloat> &points,
       const std::optional<std::vector<GLfloat>> &normals = std::nullopt,
       const std::optional<std::vector<GLfloat>> &texCoords = std::nullopt,
-      const std::optional<std::vector<GLfloat>> &tangents = std::nullopt);
+      const std::optional<std::vector<GLfloat>> &tangents = std::nullopt,
+      const std::vector<Submesh> &submeshes = {}, std::uint32_t cookFlags = 0);
+
+  /**
+   * @brief cookFlags で指定した処理と、頂点属性の詰め込みを行います。
+   * GL は呼び出しません。
+   * @param submeshes 空の場合は全体を一つの描画範囲とします。
+   * @param cookFlags CookFlag の組み合わせ
+   */
+  CookedMesh
+  CookBuffers(const std::vector<GLuint> &indices,
+              const std::vector<GLfloat> &points,
+              const std::optional<std::vector<GLfloat>> &normals,
+              const std::optional<std::vector<GLfloat>> &texCoords,
+              const std::optional<std::vector<GLfloat>> &tangents,
+              const std::vector<Submesh> &submeshes, std::uint32_t cookFlags);
+
+  /**< @brief GeometryArena に頂点とインデックスを転送します。 */
+  void UploadBuffers(const Streams &streams);
   virtual void DestroyBuffers();
 
-  GLuint vao_;                  // 頂点配列オブジェクト
-  GLuint nVerts_;               // 頂点数
-  std::vector<GLuint> buffers_; // 頂点バッファ
+  GLuint vao_ = 0;                    // 頂点配列オブジェクト (GeometryArena と共有)
+  GLuint nVerts_ = 0;                 // 最も細かい詳細度のインデックスの数
+  GLuint nUniqueVerts_ = 0;           // 頂点バッファの頂点数
+  GeometryArena::Allocation alloc_{}; // 頂点とインデックスの範囲
+  GLenum indexType_ = GL_UNSIGNED_INT; // インデックスの型
+  GLuint vertexStride_ = 0;            // 1 頂点あたりのバイト数
+  std::vector<Submesh> submeshes_{};   // 描画範囲 (最も細かい詳細度)
+  std::vector<LodLevel> lods_{};       // 詳細度ごとの描画範囲
+  std::vector<Cluster> clusters_{};    // 最も細かい詳細度のクラスター
 
   AABB bbox_; // AABB
+  MeshOptimizer::Report report_{};
 };
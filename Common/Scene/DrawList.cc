@@ -0,0 +1,583 @@
+/**
+ * @brief  Draw list
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Scene/DrawList.h"
+
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+
+#include "Graphics/GLState.h"
+#include "Graphics/GeometryArena.h"
+
+//*--------------------------------------------------------------------------------
+// Constant variables
+//*--------------------------------------------------------------------------------
+
+static constexpr GLuint kCullLocalSize = 64;
+
+//*--------------------------------------------------------------------------------
+// Special member functions
+//*--------------------------------------------------------------------------------
+
+DrawList::~DrawList() {
+  const GLuint buffers[] = {objectBuffer_, commandBuffer_, cullInputBuffer_,
+                            cullOutputBuffer_, drawCountBuffer_};
+  if (std::any_of(std::begin(buffers), std::end(buffers),
+                  [](GLuint buffer) { return buffer != 0; })) {
+    glDeleteBuffers(static_cast<GLsizei>(std::size(buffers)), buffers);
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// Static functions
+//*--------------------------------------------------------------------------------
+
+bool DrawList::IsIndirect() {
+#if !defined(__APPLE__)
+  return GLAD_GL_VERSION_4_3 != 0;
+#else
+  return false;
+#endif
+}
+
+bool DrawList::IsIndirectCount() {
+#if !defined(__APPLE__)
+  return GLAD_GL_VERSION_4_6 != 0;
+#else
+  return false;
+#endif
+}
+
+ShaderDefines DrawList::GetDefines() {
+  if (IsIndirect()) {
+    return {{"DRAW_LIST", ""}};
+  }
+  return {};
+}
+
+void DrawList::BindProgram(const ShaderProgram &prog) {
+  if (IsIndirect()) {
+    prog.BindStorageBlock("ObjectBuffer", StorageBinding::kObjects);
+  } else {
+    prog.BindUniformBlock("ObjectBlock", UniformBinding::kObject);
+  }
+}
+
+/**
+ * @brief FrustumCull.cs.glsl の IsVisible と同じ判定です。
+ */
+bool DrawList::IsVisible(const FrustumPlanes &planes, const Record &record) {
+  const AABB &bounds = record.bounds;
+  if (bounds.mini.x > bounds.maxi.x) {
+    return true;
+  }
+
+  const glm::mat4 &model = record.object.model;
+  const glm::vec3 center = 0.5f * (bounds.mini + bounds.maxi);
+  const glm::vec3 extent = 0.5f * (bounds.maxi - bounds.mini);
+  const glm::vec3 c = glm::vec3(model * glm::vec4(center, 1.0f));
+  const glm::vec3 e = glm::abs(glm::vec3(model[0])) * extent.x +
+                      glm::abs(glm::vec3(model[1])) * extent.y +
+                      glm::abs(glm::vec3(model[2])) * extent.z;
+  return std::all_of(planes.begin(), planes.end(), [&](const glm::vec4 &p) {
+    const glm::vec3 n = glm::vec3(p);
+    return glm::dot(n, c) + glm::dot(glm::abs(n), e) + p.w >= 0.0f;
+  });
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+void DrawList::OnInit(std::size_t capacity) {
+  BOOST_ASSERT_MSG(capacity <= GeometryArena::kMaxDrawIndices,
+                   "DrawList capacity exceeds the draw index buffer.");
+  capacity_ = std::min<std::size_t>(capacity, GeometryArena::kMaxDrawIndices);
+  records_.reserve(capacity_);
+
+  if (!IsIndirect()) {
+    objectRing_.OnInit(UniformBinding::kObject, capacity_);
+    return;
+  }
+
+  // glBindBufferRange のオフセットは GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT の倍数にします。
+  GLint align = 1;
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &align);
+  objectStride_ = static_cast<GLsizeiptr>(Std140::RoundUp(
+      sizeof(ObjectBlock) * capacity_, static_cast<std::size_t>(align)));
+
+  glGenBuffers(1, &objectBuffer_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer_);
+  glBufferData(GL_SHADER_STORAGE_BUFFER,
+               objectStride_ * static_cast<GLsizeiptr>(kFrames), nullptr,
+               GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  glGenBuffers(1, &commandBuffer_);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer_);
+  glBufferData(GL_DRAW_INDIRECT_BUFFER,
+               static_cast<GLsizeiptr>(sizeof(Command) * capacity_ * kFrames),
+               nullptr, GL_DYNAMIC_DRAW);
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void DrawList::Clear() {
+  records_.clear();
+  sorted_.clear();
+  batches_.clear();
+  isCulled_ = false;
+}
+
+void DrawList::Add(const TriangleMesh &mesh, const ObjectBlock &object,
+                   std::size_t lod) {
+  const auto &lods = mesh.GetLods();
+  if (mesh.GetVAO() == 0 || lod >= lods.size()) {
+    return;
+  }
+  BOOST_ASSERT_MSG(records_.size() < capacity_, "DrawList overflow.");
+  if (records_.size() >= capacity_) {
+    return;
+  }
+
+  Record record{};
+  record.vao = mesh.GetVAO();
+  record.indexType = mesh.GetIndexType();
+  record.command.count = lods[lod].indexCount;
+  record.command.instanceCount = 1;
+  record.command.firstIndex = mesh.GetFirstIndex() + lods[lod].firstIndex;
+  record.command.baseVertex = mesh.GetAllocation().baseVertex;
+  record.object = object;
+  record.bounds = mesh.GetAABB();
+  records_.emplace_back(record);
+}
+
+void DrawList::Upload() {
+  isCulled_ = false;
+  isCullInputUploaded_ = false;
+
+  // 同じ VAO とインデックスの型のものを一つにまとめます。(追加した順は保ちます。)
+  sorted_.resize(records_.size());
+  std::iota(sorted_.begin(), sorted_.end(), std::size_t{0});
+  std::stable_sort(sorted_.begin(), sorted_.end(),
+                   [this](std::size_t a, std::size_t b) {
+                     const Record &ra = records_[a];
+                     const Record &rb = records_[b];
+                     return ra.vao != rb.vao ? ra.vao < rb.vao
+                                             : ra.indexType < rb.indexType;
+                   });
+  batches_.clear();
+  for (std::size_t i = 0; i < sorted_.size(); i++) {
+    const Record &record = records_[sorted_[i]];
+    if (batches_.empty() || batches_.back().vao != record.vao ||
+        batches_.back().indexType != record.indexType) {
+      batches_.push_back({record.vao, record.indexType, i, 0});
+    }
+    batches_.back().count++;
+  }
+
+  if (!IsIndirect()) {
+    objectRing_.BeginFrame();
+    ringOffsets_.clear();
+    for (const std::size_t index : sorted_) {
+      ringOffsets_.emplace_back(objectRing_.Push(records_[index].object));
+    }
+    objectRing_.Flush();
+    return;
+  }
+
+  frame_ = (frame_ + 1) % kFrames;
+  std::vector<ObjectBlock> objects;
+  std::vector<Command> commands;
+  objects.reserve(sorted_.size());
+  commands.reserve(sorted_.size());
+  for (const std::size_t index : sorted_) {
+    Command command = records_[index].command;
+    command.baseInstance = static_cast<GLuint>(objects.size());
+    commands.emplace_back(command);
+    objects.emplace_back(records_[index].object);
+  }
+  if (objects.empty()) {
+    return;
+  }
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, objectBuffer_);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                  objectStride_ * static_cast<GLintptr>(frame_),
+                  static_cast<GLsizeiptr>(sizeof(ObjectBlock) * objects.size()),
+                  objects.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer_);
+  glBufferSubData(
+      GL_DRAW_INDIRECT_BUFFER,
+      static_cast<GLintptr>(sizeof(Command) * capacity_ * frame_),
+      static_cast<GLsizeiptr>(sizeof(Command) * commands.size()),
+      commands.data());
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void DrawList::Draw() const {
+  if (batches_.empty()) {
+    return;
+  }
+
+  if (!IsIndirect()) {
+    for (const Batch &batch : batches_) {
+      GLState::Get().BindVertexArray(batch.vao);
+      const std::size_t indexSize = batch.indexType == GL_UNSIGNED_SHORT
+                                        ? sizeof(GLushort)
+                                        : sizeof(GLuint);
+      for (std::size_t i = batch.first; i < batch.first + batch.count; i++) {
+        if (isCulled_ && !isVisible_[i]) {
+          continue;
+        }
+        const Command &command = records_[sorted_[i]].command;
+        objectRing_.Bind(ringOffsets_[i]);
+        glDrawElementsBaseVertex(
+            GL_TRIANGLES, static_cast<GLsizei>(command.count), batch.indexType,
+            reinterpret_cast<const void *>(command.firstIndex * indexSize),
+            command.baseVertex);
+      }
+    }
+    return;
+  }
+
+#if !defined(__APPLE__)
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, StorageBinding::kObjects,
+                    objectBuffer_,
+                    objectStride_ * static_cast<GLintptr>(frame_),
+                    static_cast<GLsizeiptr>(sizeof(ObjectBlock) *
+                                            records_.size()));
+  if (isCulled_) {
+    DrawCulled();
+    return;
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer_);
+  for (const Batch &batch : batches_) {
+    GLState::Get().BindVertexArray(batch.vao);
+    const std::size_t offset =
+        sizeof(Command) * (capacity_ * frame_ + batch.first);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType,
+                                reinterpret_cast<const void *>(offset),
+                                static_cast<GLsizei>(batch.count), 0);
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+}
+
+void DrawList::Cull(const glm::mat4 &viewProj) {
+  const FrustumPlanes planes = Frustum::ExtractPlanes(viewProj);
+  if (!IsIndirect()) {
+    // 世界座標の AABB はフレームごとに一度だけ求め、カスケードごとの Cull で使い回します。
+    if (!isCullInputUploaded_) {
+      UpdateWorldBounds();
+    }
+    Frustum frustum{};
+    frustum.SetupPlanes(viewProj);
+    isVisible_.resize(sorted_.size());
+    frustum.CullAABBs(worldBounds_.GetArrays(), isVisible_.data());
+    isCulled_ = true;
+    CheckCull(viewProj);
+    return;
+  }
+
+#if !defined(__APPLE__)
+  if (records_.empty() || (!cullProg_.IsLinked() && !CompileCullShader())) {
+    return;
+  }
+  if (!isCullInputUploaded_) {
+    UploadCullInputs();
+  }
+
+  // glMultiDrawElementsIndirectCount が使えれば、残ったコマンドを範囲の先頭から詰めて数えます。
+  const bool isCompact = IsIndirectCount();
+  if (isCompact) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawCountBuffer_);
+    glClearBufferSubData(
+        GL_SHADER_STORAGE_BUFFER, GL_R32UI,
+        drawCountStride_ * static_cast<GLintptr>(frame_),
+        static_cast<GLsizeiptr>(sizeof(GLuint) * batches_.size()),
+        GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  }
+
+  cullProg_.Use();
+  for (std::size_t i = 0; i < planes.size(); i++) {
+    cullProg_.SetUniform(cullUniforms_.planes[i], planes[i]);
+  }
+  cullProg_.SetUniform(cullUniforms_.inputCount,
+                       static_cast<int>(records_.size()));
+  cullProg_.SetUniform(cullUniforms_.isCompact, isCompact);
+
+  glBindBufferRange(GL_SHADER_STORAGE_BUFFER, StorageBinding::kObjects,
+                    objectBuffer_,
+                    objectStride_ * static_cast<GLintptr>(frame_),
+                    static_cast<GLsizeiptr>(sizeof(ObjectBlock) *
+                                            records_.size()));
+  glBindBufferRange(
+      GL_SHADER_STORAGE_BUFFER, StorageBinding::kCullInputs, cullInputBuffer_,
+      cullInputStride_ * static_cast<GLintptr>(frame_),
+      static_cast<GLsizeiptr>(sizeof(CullInput) * records_.size()));
+  glBindBufferRange(
+      GL_SHADER_STORAGE_BUFFER, StorageBinding::kCullOutputs, cullOutputBuffer_,
+      cullOutputStride_ * static_cast<GLintptr>(frame_),
+      static_cast<GLsizeiptr>(sizeof(Command) * records_.size()));
+  glBindBufferRange(
+      GL_SHADER_STORAGE_BUFFER, StorageBinding::kDrawCounts, drawCountBuffer_,
+      drawCountStride_ * static_cast<GLintptr>(frame_),
+      static_cast<GLsizeiptr>(sizeof(GLuint) * batches_.size()));
+
+  const auto groups = static_cast<GLuint>(
+      (records_.size() + kCullLocalSize - 1) / kCullLocalSize);
+  glDispatchCompute(groups, 1, 1);
+  // 書き出したコマンドと数を間接描画で読めるようにします。
+  glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+  isCulled_ = true;
+  CheckCull(viewProj);
+#endif
+}
+
+std::vector<DrawList::Command>
+DrawList::CullOnCpu(const glm::mat4 &viewProj) const {
+  const FrustumPlanes planes = Frustum::ExtractPlanes(viewProj);
+  std::vector<Command> commands;
+  for (const Batch &batch : batches_) {
+    for (std::size_t i = batch.first; i < batch.first + batch.count; i++) {
+      const Record &record = records_[sorted_[i]];
+      if (IsVisible(planes, record)) {
+        Command command = record.command;
+        command.baseInstance = static_cast<GLuint>(i);
+        commands.emplace_back(command);
+      }
+    }
+  }
+  return commands;
+}
+
+bool DrawList::VerifyCull(const glm::mat4 &viewProj) const {
+  const std::vector<Command> expected = CullOnCpu(viewProj);
+  if (!IsIndirect()) {
+    if (!isCulled_) {
+      return false;
+    }
+    return static_cast<std::size_t>(std::count(isVisible_.begin(),
+                                               isVisible_.end(), 1)) ==
+               expected.size() &&
+           std::all_of(expected.begin(), expected.end(),
+                       [this](const Command &c) {
+                         return isVisible_[c.baseInstance] != 0;
+                       });
+  }
+  if (!isCulled_) {
+    return false;
+  }
+
+  std::vector<Command> outputs(records_.size());
+  std::vector<GLuint> counts(batches_.size(), 0);
+  glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, cullOutputBuffer_);
+  glGetBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                     cullOutputStride_ * static_cast<GLintptr>(frame_),
+                     static_cast<GLsizeiptr>(sizeof(Command) * outputs.size()),
+                     outputs.data());
+  if (IsIndirectCount()) {
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, drawCountBuffer_);
+    glGetBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                       drawCountStride_ * static_cast<GLintptr>(frame_),
+                       static_cast<GLsizeiptr>(sizeof(GLuint) * counts.size()),
+                       counts.data());
+  }
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+  // 詰めた順は不定なので、範囲ごとに baseInstance で並べてから比べます。
+  std::vector<Command> actual;
+  for (std::size_t b = 0; b < batches_.size(); b++) {
+    const Batch &batch = batches_[b];
+    const std::size_t first = actual.size();
+    if (IsIndirectCount()) {
+      if (counts[b] > batch.count) {
+        return false;
+      }
+      actual.insert(actual.end(), outputs.begin() + batch.first,
+                    outputs.begin() + batch.first + counts[b]);
+    } else {
+      std::copy_if(outputs.begin() + batch.first,
+                   outputs.begin() + batch.first + batch.count,
+                   std::back_inserter(actual),
+                   [](const Command &c) { return c.instanceCount != 0; });
+    }
+    std::sort(actual.begin() + first, actual.end(),
+              [](const Command &a, const Command &b) {
+                return a.baseInstance < b.baseInstance;
+              });
+  }
+  return std::equal(expected.begin(), expected.end(), actual.begin(),
+                    actual.end(), [](const Command &a, const Command &b) {
+                      return a.count == b.count &&
+                             a.instanceCount == b.instanceCount &&
+                             a.firstIndex == b.firstIndex &&
+                             a.baseVertex == b.baseVertex &&
+                             a.baseInstance == b.baseInstance;
+                    });
+}
+
+/**
+ * @brief SetVerifyCull で有効にしたときだけ、Cull の結果を CullOnCpu と比べます。
+ * @note 間接描画では読み戻しで GPU を待つので、既定では調べません。
+ */
+void DrawList::CheckCull(const glm::mat4 &viewProj) const {
+  if (isVerifyCull_ && !VerifyCull(viewProj)) {
+    std::cerr << "Culling does not match the CPU reference." << std::endl;
+    BOOST_ASSERT_MSG(false, "Culling does not match the CPU reference.");
+  }
+}
+
+std::size_t DrawList::GetDrawCalls() const {
+  return IsIndirect() ? batches_.size() : records_.size();
+}
+
+bool DrawList::CompileCullShader() {
+  ShaderDefines defines = GetDefines();
+  defines.emplace_back("LOCAL_SIZE_X", std::to_string(kCullLocalSize));
+  if (const auto msg = cullProg_.CompileAndLink(
+          {{"./Assets/Shaders/Culling/FrustumCull.cs.glsl",
+            ShaderType::Compute}},
+          defines)) {
+    std::cerr << msg.value() << std::endl;
+    BOOST_ASSERT_MSG(false, "failed to compile or link!");
+    return false;
+  }
+  cullProg_.BindStorageBlock("ObjectBuffer", StorageBinding::kObjects);
+  cullProg_.BindStorageBlock("CullInputs", StorageBinding::kCullInputs);
+  cullProg_.BindStorageBlock("CullOutputs", StorageBinding::kCullOutputs);
+  cullProg_.BindStorageBlock("DrawCounts", StorageBinding::kDrawCounts);
+  for (std::size_t i = 0; i < cullUniforms_.planes.size(); i++) {
+    const std::string name = "Planes[" + std::to_string(i) + "]";
+    cullUniforms_.planes[i] = cullProg_.GetUniform<glm::vec4>(name.c_str());
+  }
+  cullUniforms_.inputCount = cullProg_.GetUniform<int>("InputCount");
+  cullUniforms_.isCompact = cullProg_.GetUniform<bool>("IsCompact");
+
+  // どれもフレームごとの領域を持ち、先頭を GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT に揃えます。
+  GLint align = 1;
+  glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &align);
+  const auto allocate = [align](GLuint &buffer, GLsizeiptr &stride,
+                                std::size_t size) {
+    stride = static_cast<GLsizeiptr>(
+        Std140::RoundUp(size, static_cast<std::size_t>(align)));
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER,
+                 stride * static_cast<GLsizeiptr>(kFrames), nullptr,
+                 GL_DYNAMIC_DRAW);
+  };
+  allocate(cullInputBuffer_, cullInputStride_, sizeof(CullInput) * capacity_);
+  allocate(cullOutputBuffer_, cullOutputStride_, sizeof(Command) * capacity_);
+  allocate(drawCountBuffer_, drawCountStride_, sizeof(GLuint) * capacity_);
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  return true;
+}
+
+/**
+ * @brief sorted_ の順に、モデル座標系の AABB を包む世界座標系の AABB を求めます。
+ * @note IsVisible と同じく中心と半径を変換するので、丸め誤差を除いて同じ判定になります。
+ * AABB を持たないメッシュは全体を覆う箱にして、常に残るようにします。
+ */
+void DrawList::UpdateWorldBounds() {
+  constexpr float kMax = std::numeric_limits<float>::max();
+  worldBounds_.Resize(sorted_.size());
+  for (std::size_t i = 0; i < sorted_.size(); i++) {
+    const Record &record = records_[sorted_[i]];
+    const AABB &bounds = record.bounds;
+    glm::vec3 mini(-kMax);
+    glm::vec3 maxi(kMax);
+    if (bounds.mini.x <= bounds.maxi.x) {
+      const glm::mat4 &model = record.object.model;
+      const glm::vec3 center = 0.5f * (bounds.mini + bounds.maxi);
+      const glm::vec3 extent = 0.5f * (bounds.maxi - bounds.mini);
+      const glm::vec3 c = glm::vec3(model * glm::vec4(center, 1.0f));
+      const glm::vec3 e = glm::abs(glm::vec3(model[0])) * extent.x +
+                          glm::abs(glm::vec3(model[1])) * extent.y +
+                          glm::abs(glm::vec3(model[2])) * extent.z;
+      mini = c - e;
+      maxi = c + e;
+    }
+    worldBounds_.minX[i] = mini.x;
+    worldBounds_.minY[i] = mini.y;
+    worldBounds_.minZ[i] = mini.z;
+    worldBounds_.maxX[i] = maxi.x;
+    worldBounds_.maxY[i] = maxi.y;
+    worldBounds_.maxZ[i] = maxi.z;
+  }
+  isCullInputUploaded_ = true;
+}
+
+void DrawList::UploadCullInputs() {
+  std::vector<CullInput> inputs;
+  inputs.reserve(sorted_.size());
+  for (std::size_t b = 0; b < batches_.size(); b++) {
+    const Batch &batch = batches_[b];
+    for (std::size_t i = batch.first; i < batch.first + batch.count; i++) {
+      const Record &record = records_[sorted_[i]];
+      CullInput input{};
+      const bool isEmpty = record.bounds.mini.x > record.bounds.maxi.x;
+      input.boundsMin = glm::vec4(isEmpty ? glm::vec3(0.0f) : record.bounds.mini,
+                                  isEmpty ? 1.0f : 0.0f);
+      input.boundsMax =
+          glm::vec4(isEmpty ? glm::vec3(0.0f) : record.bounds.maxi, 0.0f);
+      input.command = record.command;
+      input.command.baseInstance = static_cast<GLuint>(i);
+      input.batch = static_cast<std::uint32_t>(b);
+      input.batchFirst = static_cast<std::uint32_t>(batch.first);
+      inputs.emplace_back(input);
+    }
+  }
+
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, cullInputBuffer_);
+  glBufferSubData(GL_SHADER_STORAGE_BUFFER,
+                  cullInputStride_ * static_cast<GLintptr>(frame_),
+                  static_cast<GLsizeiptr>(sizeof(CullInput) * inputs.size()),
+                  inputs.data());
+  glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+  isCullInputUploaded_ = true;
+}
+
+void DrawList::DrawCulled() const {
+#if !defined(__APPLE__)
+  const bool isCount = IsIndirectCount();
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, cullOutputBuffer_);
+  if (isCount) {
+    glBindBuffer(GL_PARAMETER_BUFFER, drawCountBuffer_);
+  }
+  for (std::size_t b = 0; b < batches_.size(); b++) {
+    const Batch &batch = batches_[b];
+    GLState::Get().BindVertexArray(batch.vao);
+    const auto *offset = reinterpret_cast<const void *>(
+        cullOutputStride_ * static_cast<GLintptr>(frame_) +
+        static_cast<GLintptr>(sizeof(Command) * batch.first));
+    if (isCount) {
+      glMultiDrawElementsIndirectCount(
+          GL_TRIANGLES, batch.indexType, offset,
+          drawCountStride_ * static_cast<GLintptr>(frame_) +
+              static_cast<GLintptr>(sizeof(GLuint) * b),
+          static_cast<GLsizei>(batch.count), 0);
+    } else {
+      glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType, offset,
+                                  static_cast<GLsizei>(batch.count), 0);
+    }
+  }
+  if (isCount) {
+    glBindBuffer(GL_PARAMETER_BUFFER, 0);
+  }
+  glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+#endif
+}
@@ -0,0 +1,222 @@
+/**
+ * @brief  Draw list
+ * @note   (メッシュの範囲, モデル行列とマテリアル) の組を集め、オブジェクトごとのデータを
+ * 一つのシェーダーストレージバッファに転送して、VAO とインデックスの型が同じものを
+ * glMultiDrawElementsIndirect 一回で描画します。描画の呼び出しの数はオブジェクトの数に依りません。
+ * GL 4.3 未満 (macOS の 4.1) では、UniformRing の ObjectBlock を付け替えながら一つずつ描画します。
+ * Cull を呼ぶと、計算シェーダー (GL 4.3 未満では Frustum::CullAABBs) で各オブジェクトの AABB を
+ * 視錐台と比べ、残ったものだけを描画します。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef DRAW_LIST_H
+#define DRAW_LIST_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <array>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "Graphics/Shader.h"
+#include "Graphics/UniformBuffer.h"
+#include "Primitive/TriangleMesh.h"
+#include "Scene/UniformBlocks.h"
+#include "View/Frustum.h"
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief Draw List Class
+ * @code
+ *   prog.CompileAndLink(stages, DrawList::GetDefines());
+ *   DrawList::BindProgram(prog);
+ *   list.OnInit(kObjectsMax);
+ *
+ *   list.Clear();
+ *   list.Add(teapot_, object);
+ *   list.Upload();
+ *   prog.Use();
+ *   list.Draw();
+ * @endcode
+ * @note シェーダーは Assets/Shaders/Include/ObjectBlock.glsl を使い、頂点シェーダーでは
+ * OBJECT_BLOCK_VERTEX を定義してから読み込み、main の先頭で PassObjectIndex() を呼んでください。
+ */
+class DrawList : private boost::noncopyable {
+public:
+  /**< @brief GPU が読んでいる可能性のある領域に書き込まないよう、何フレーム分の領域を持つか */
+  static constexpr inline std::size_t kFrames = 3;
+
+  /**< @brief glMultiDrawElementsIndirect のコマンド */
+  struct Command {
+    GLuint count = 0;
+    GLuint instanceCount = 0;
+    GLuint firstIndex = 0;
+    GLint baseVertex = 0;
+    GLuint baseInstance = 0; // ObjectBuffer での番号
+  };
+  static_assert(sizeof(Command) == sizeof(GLuint) * 5,
+                "Command must match DrawElementsIndirectCommand.");
+
+  DrawList() = default;
+  ~DrawList();
+
+  /**< @brief 間接描画 (GL 4.3) を使えるか */
+  static bool IsIndirect();
+  /**< @brief 描画の数をバッファから読む glMultiDrawElementsIndirectCount (GL 4.6) を使えるか */
+  static bool IsIndirectCount();
+  /**< @brief シェーダーに渡す定義 (間接描画であれば DRAW_LIST) */
+  static ShaderDefines GetDefines();
+  /**< @brief リンク後にオブジェクトのデータを参照するブロックを結合ポイントに割り当てます。 */
+  static void BindProgram(const ShaderProgram &prog);
+
+  /**
+   * @param capacity 1フレームで追加できるオブジェクトの数
+   */
+  void OnInit(std::size_t capacity);
+
+  void Clear();
+
+  /**
+   * @brief オブジェクトを追加します。
+   * @param lod 描画する詳細度
+   */
+  void Add(const TriangleMesh &mesh, const ObjectBlock &object,
+           std::size_t lod = 0);
+
+  /**
+   * @brief VAO とインデックスの型で並べ替え、コマンドとオブジェクトのデータを転送します。
+   * @note Add の後、Draw の前にフレームごとに一度呼んでください。同じリストは何度でも Draw できます。
+   */
+  void Upload();
+
+  /**
+   * @brief ビュー射影行列の視錐台から外れるオブジェクトを描画しないようにします。
+   * @note 間接描画では計算シェーダーで判定し、残ったコマンドをバッファに詰めます。
+   * それ以外では世界座標の AABB を SoA に並べ、Frustum::CullAABBs でまとめて判定します。
+   * 使用中のプログラムが変わるので、Draw の前に描画するプログラムを Use し直してください。
+   * 結果は次の Cull か Upload まで有効です。(カスケードごとに Cull してから Draw できます)
+   */
+  void Cull(const glm::mat4 &viewProj);
+
+  /**
+   * @brief Cull の CPU での参照実装です。
+   * @return 残るコマンド (まとめた範囲の順, 範囲の中では baseInstance の順)
+   */
+  std::vector<Command> CullOnCpu(const glm::mat4 &viewProj) const;
+
+  /**
+   * @brief GPU で Cull した結果を読み戻し、CullOnCpu と一致するか調べます。
+   * @note GPU を待つので検証用です。
+   */
+  bool VerifyCull(const glm::mat4 &viewProj) const;
+  /**< @brief Cull のたびに VerifyCull で調べるか (既定では調べません) */
+  void SetVerifyCull(bool isVerify) { isVerifyCull_ = isVerify; }
+
+  /**< @brief 使用中のプログラムで描画します。 */
+  void Draw() const;
+
+  std::size_t GetObjectCount() const { return records_.size(); }
+  /**< @brief Draw 一回あたりの描画の呼び出しの数 */
+  std::size_t GetDrawCalls() const;
+
+private:
+  /**< @brief 一回の glMultiDrawElementsIndirect で描画する範囲 */
+  struct Batch {
+    GLuint vao = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    std::size_t first = 0; // sorted_ での先頭
+    std::size_t count = 0;
+  };
+
+  struct Record {
+    GLuint vao = 0;
+    GLenum indexType = GL_UNSIGNED_INT;
+    Command command{};
+    ObjectBlock object{};
+    AABB bounds{}; // モデル座標系
+  };
+
+  /**< @brief 計算シェーダーに渡すオブジェクトごとのデータ (std430) */
+  struct CullInput {
+    glm::vec4 boundsMin{}; // w が 0 でなければカリングしません。
+    glm::vec4 boundsMax{};
+    Command command{};
+    std::uint32_t batch = 0;
+    std::uint32_t batchFirst = 0;
+    std::uint32_t pad = 0;
+  };
+  static_assert(sizeof(CullInput) == 64,
+                "CullInput must match Assets/Shaders/Culling/FrustumCull.cs.glsl.");
+
+  /**< @brief Frustum::CullAABBs に渡す世界座標系の AABB (SoA, sorted_ の順) */
+  struct WorldBounds {
+    std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+    void Resize(std::size_t n) {
+      for (auto *v : {&minX, &minY, &minZ, &maxX, &maxY, &maxZ}) {
+        v->resize(n);
+      }
+    }
+    AABBArrays GetArrays() const {
+      return {minX.data(), minY.data(), minZ.data(),
+              maxX.data(), maxY.data(), maxZ.data(), minX.size()};
+    }
+  };
+
+  static bool IsVisible(const FrustumPlanes &planes, const Record &record);
+  void UpdateWorldBounds();
+  void CheckCull(const glm::mat4 &viewProj) const;
+  bool CompileCullShader();
+  void UploadCullInputs();
+  void DrawCulled() const;
+
+  std::size_t capacity_ = 0;
+  std::size_t frame_ = 0;
+  std::vector<Record> records_{};
+  std::vector<std::size_t> sorted_{}; // records_ の番号を並べ替えたもの
+  std::vector<Batch> batches_{};
+  bool isCulled_ = false;
+  bool isVerifyCull_ = false;
+
+  // 間接描画
+  GLuint objectBuffer_ = 0;
+  GLuint commandBuffer_ = 0;
+  GLsizeiptr objectStride_ = 0; // 1フレーム分の領域のバイト数 (オフセットの揃えを含む)
+
+  // 計算シェーダーによるカリング (最初の Cull で作ります)
+  ShaderProgram cullProg_{};
+  struct CullUniforms {
+    std::array<Uniform<glm::vec4>, 6> planes;
+    Uniform<int> inputCount;
+    Uniform<bool> isCompact;
+  } cullUniforms_{};
+  bool isCullInputUploaded_ = false; // このフレームの CullInput か worldBounds_ を用意したか
+  GLuint cullInputBuffer_ = 0;  // CullInput
+  GLuint cullOutputBuffer_ = 0; // 残ったコマンド
+  GLuint drawCountBuffer_ = 0;  // まとめた範囲ごとのコマンドの数
+  // それぞれ 1フレーム分の領域のバイト数 (オフセットの揃えを含む)
+  GLsizeiptr cullInputStride_ = 0;
+  GLsizeiptr cullOutputStride_ = 0;
+  GLsizeiptr drawCountStride_ = 0;
+
+  // 間接描画が使えない場合
+  UniformRing<ObjectBlock> objectRing_{};
+  std::vector<GLintptr> ringOffsets_{}; // sorted_ の順
+  WorldBounds worldBounds_{};
+  std::vector<std::uint8_t> isVisible_{}; // sorted_ の順 (Cull した場合)
+};
+
+#endif
@@ -0,0 +1,153 @@
+/**
+ * @brief  Render queue
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Scene/RenderQueue.h"
+
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <cmath>
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+namespace Impl {
+
+static constexpr std::uint64_t Mask(unsigned bits) {
+  return (std::uint64_t{1} << bits) - 1;
+}
+
+/**
+ * @brief [0, 1] の深度を kDepthBits ビットの整数にします。
+ */
+static std::uint64_t QuantizeDepth(float depth) {
+  const float d = std::clamp(std::isnan(depth) ? 0.0f : depth, 0.0f, 1.0f);
+  return static_cast<std::uint64_t>(
+      std::lround(static_cast<double>(d) *
+                  static_cast<double>(Mask(RenderQueue::kDepthBits))));
+}
+
+} // namespace Impl
+
+//*--------------------------------------------------------------------------------
+// Static functions
+//*--------------------------------------------------------------------------------
+
+std::uint64_t RenderQueue::MakeKey(const Item &item, Order order) {
+  BOOST_ASSERT_MSG(item.pass <= Impl::Mask(kPassBits) &&
+                       item.program <= Impl::Mask(kProgramBits) &&
+                       item.material <= Impl::Mask(kMaterialBits) &&
+                       item.mesh <= Impl::Mask(kMeshBits),
+                   "RenderQueue item id overflows its key field.");
+  const std::uint64_t pass = item.pass & Impl::Mask(kPassBits);
+  const std::uint64_t state =
+      ((item.program & Impl::Mask(kProgramBits))
+       << (kMaterialBits + kMeshBits)) |
+      ((item.material & Impl::Mask(kMaterialBits)) << kMeshBits) |
+      (item.mesh & Impl::Mask(kMeshBits));
+  const std::uint64_t depth = Impl::QuantizeDepth(item.depth);
+
+  static constexpr unsigned kStateBits =
+      kProgramBits + kMaterialBits + kMeshBits;
+  if (order == Order::BackToFront) {
+    // 奥のものほどキーが小さくなるよう深度を反転し、状態より優先します。
+    const std::uint64_t inverted = Impl::Mask(kDepthBits) - depth;
+    return (pass << (64 - kPassBits)) | (inverted << kStateBits) | state;
+  }
+  return (pass << (64 - kPassBits)) | (state << kDepthBits) | depth;
+}
+
+std::uint32_t RenderQueue::GetChanges(const Item *prev, const Item &item) {
+  if (prev == nullptr) {
+    return kPassChanged | kProgramChanged | kMaterialChanged | kMeshChanged;
+  }
+  std::uint32_t changes = 0;
+  changes |= prev->pass != item.pass ? kPassChanged : 0u;
+  changes |= prev->program != item.program ? kProgramChanged : 0u;
+  changes |= prev->material != item.material ? kMaterialChanged : 0u;
+  changes |= prev->mesh != item.mesh ? kMeshChanged : 0u;
+  return changes;
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+void RenderQueue::SetOrder(std::uint32_t pass, Order order) {
+  BOOST_ASSERT_MSG(pass < orders_.size(), "Pass id overflows its key field.");
+  if (pass < orders_.size()) {
+    orders_[pass] = order;
+  }
+}
+
+void RenderQueue::Clear() {
+  items_.clear();
+  entries_.clear();
+}
+
+void RenderQueue::Submit(const Item &item) {
+  const Order order = orders_[item.pass & Impl::Mask(kPassBits)];
+  entries_.push_back(
+      {MakeKey(item, order), static_cast<std::uint32_t>(items_.size())});
+  items_.emplace_back(item);
+}
+
+void RenderQueue::Sort() {
+  // 下位の 8 ビットから安定な計数ソートを繰り返します (LSD 基数ソート)。
+  // 全てのキーで同じ値の桁は並びが変わらないので飛ばします。
+  static constexpr unsigned kRadixBits = 8;
+  static constexpr std::size_t kBuckets = std::size_t{1} << kRadixBits;
+  scratch_.resize(entries_.size());
+  for (unsigned shift = 0; shift < 64; shift += kRadixBits) {
+    std::array<std::size_t, kBuckets> counts{};
+    for (const Entry &entry : entries_) {
+      counts[(entry.key >> shift) & (kBuckets - 1)]++;
+    }
+    if (std::any_of(counts.begin(), counts.end(), [this](std::size_t c) {
+          return c == entries_.size();
+        })) {
+      continue;
+    }
+
+    std::size_t offset = 0;
+    for (std::size_t &count : counts) {
+      const std::size_t c = count;
+      count = offset;
+      offset += c;
+    }
+    for (const Entry &entry : entries_) {
+      scratch_[counts[(entry.key >> shift) & (kBuckets - 1)]++] = entry;
+    }
+    entries_.swap(scratch_);
+  }
+}
+
+RenderQueue::Stats RenderQueue::GetStats() const {
+  Stats stats{};
+  stats.items = items_.size();
+  Execute([&stats](const Item &, std::uint32_t changes) {
+    stats.programChanges += (changes & kProgramChanged) != 0 ? 1 : 0;
+    stats.materialChanges += (changes & kMaterialChanged) != 0 ? 1 : 0;
+    stats.meshChanges += (changes & kMeshChanged) != 0 ? 1 : 0;
+  });
+  return stats;
+}
+
+RenderQueue::Stats RenderQueue::GetSubmissionStats() const {
+  Stats stats{};
+  stats.items = items_.size();
+  const Item *prev = nullptr;
+  for (const Item &item : items_) {
+    const std::uint32_t changes = GetChanges(prev, item);
+    stats.programChanges += (changes & kProgramChanged) != 0 ? 1 : 0;
+    stats.materialChanges += (changes & kMaterialChanged) != 0 ? 1 : 0;
+    stats.meshChanges += (changes & kMeshChanged) != 0 ? 1 : 0;
+    prev = &item;
+  }
+  return stats;
+}
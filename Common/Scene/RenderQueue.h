@@ -0,0 +1,132 @@
+/**
+ * @brief  Render queue
+ * @note   描画を (パス, プログラム, マテリアル, メッシュ, 量子化した深度) を詰めた 64 ビットの
+ * キーと共に受け取り、フレームごとに基数ソートしてから発行します。
+ * 不透明なパスでは状態の切り替えが少なくなる順に並べ、同じ状態の中では手前から描画して
+ * Early-Z で捨てられるフラグメントを増やします。半透明のパスでは奥から描画します。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef RENDER_QUEUE_H
+#define RENDER_QUEUE_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief Render Queue Class
+ * @code
+ *   queue.Clear();
+ *   queue.Submit({kOpaque, kPhong, material, kTeapot, depth, index});
+ *   queue.Sort();
+ *   queue.Execute([&](const RenderQueue::Item &item, std::uint32_t changes) {
+ *     if (changes & RenderQueue::kProgramChanged) { ... }
+ *     ...
+ *   });
+ * @endcode
+ */
+class RenderQueue {
+public:
+  /**
+   * @brief キーのビット数
+   * @note 不透明: [パス | プログラム | マテリアル | メッシュ | 深度] (上位から)
+   *       半透明: [パス | 反転した深度 | プログラム | マテリアル | メッシュ]
+   */
+  static constexpr inline unsigned kPassBits = 4;
+  static constexpr inline unsigned kProgramBits = 8;
+  static constexpr inline unsigned kMaterialBits = 12;
+  static constexpr inline unsigned kMeshBits = 16;
+  static constexpr inline unsigned kDepthBits = 24;
+  static_assert(kPassBits + kProgramBits + kMaterialBits + kMeshBits +
+                        kDepthBits ==
+                    64,
+                "Sort key must be 64 bits.");
+
+  /**< @brief パスの中での深度の順 */
+  enum class Order : std::uint8_t {
+    FrontToBack, // 不透明 (状態でまとめ、その中で手前から)
+    BackToFront, // 半透明 (深度を優先して奥から)
+  };
+
+  /**< @brief Execute に渡す、直前の描画から変わった状態 */
+  enum Change : std::uint32_t {
+    kPassChanged = 1u << 0,
+    kProgramChanged = 1u << 1,
+    kMaterialChanged = 1u << 2,
+    kMeshChanged = 1u << 3,
+  };
+
+  /**< @brief 描画一つ分 */
+  struct Item {
+    std::uint32_t pass = 0;
+    std::uint32_t program = 0;
+    std::uint32_t material = 0;
+    std::uint32_t mesh = 0;
+    float depth = 0.0f;        // [0, 1] (ニアクリップ面からファークリップ面まで)
+    std::uint32_t payload = 0; // 呼び出し側のデータの番号など
+  };
+
+  /**< @brief 状態を切り替えた回数 */
+  struct Stats {
+    std::size_t items = 0;
+    std::size_t programChanges = 0;
+    std::size_t materialChanges = 0;
+    std::size_t meshChanges = 0;
+  };
+
+  /**< @brief パスの深度の順を設定します。(既定は FrontToBack) */
+  void SetOrder(std::uint32_t pass, Order order);
+
+  void Clear();
+  void Submit(const Item &item);
+
+  /**< @brief キーで基数ソートします。キーが同じ描画は追加した順を保ちます。 */
+  void Sort();
+
+  /**
+   * @brief 並べ替えた順に draw(item, changes) を呼びます。
+   * @note changes は Change の組み合わせで、変わった状態だけを設定し直せば済みます。
+   */
+  template <typename F> void Execute(F &&draw) const {
+    const Item *prev = nullptr;
+    for (const Entry &entry : entries_) {
+      const Item &item = items_[entry.index];
+      draw(item, GetChanges(prev, item));
+      prev = &item;
+    }
+  }
+
+  /**< @brief 並べ替えた順で描画した場合の状態の切り替えの回数 */
+  Stats GetStats() const;
+  /**< @brief 追加した順で描画した場合の状態の切り替えの回数 */
+  Stats GetSubmissionStats() const;
+
+  static std::uint64_t MakeKey(const Item &item, Order order);
+  static std::uint32_t GetChanges(const Item *prev, const Item &item);
+
+private:
+  struct Entry {
+    std::uint64_t key = 0;
+    std::uint32_t index = 0; // items_ の番号
+  };
+
+  std::vector<Item> items_{};
+  std::vector<Entry> entries_{};
+  std::vector<Entry> scratch_{}; // 基数ソートの作業領域
+  std::array<Order, std::size_t{1} << kPassBits> orders_{};
+};
+
+#endif
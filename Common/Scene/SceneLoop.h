@@ -34,7 +34,12 @@ static inline int Run(App &app, std::unique_ptr<Scene> &&scene) {
         scene->OnResize(w, h);
       },
       [&scene](float t) { scene->OnUpdate(t); },
-      [&scene]() { scene->OnRender(); }, [&scene]() { scene->OnDestroy(); });
+      [&scene]() { scene->OnRender(); },
+      [&scene]() {
+        // GLState などを破棄する前に、シーンが持つ GL のオブジェクトを削除します。
+        scene->OnDestroy();
+        scene.reset();
+      });
 }
 } // namespace SceneLoop
 
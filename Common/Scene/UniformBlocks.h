@@ -0,0 +1,82 @@
+/**
+ * @brief  シーン共通のユニフォームブロック
+ * @note   Assets/Shaders/Include/FrameBlock.glsl, ObjectBlock.glsl と同じ並びにしてください。
+ */
+
+#ifndef UNIFORM_BLOCKS_H
+#define UNIFORM_BLOCKS_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include "Graphics/UniformBuffer.h"
+
+// ********************************************************************************
+// Constant variables
+// ********************************************************************************
+
+namespace UniformBinding {
+static constexpr GLuint kFrame = 0;  /**< フレームごとのデータ */
+static constexpr GLuint kObject = 1; /**< オブジェクトごとのデータ */
+} // namespace UniformBinding
+
+namespace StorageBinding {
+static constexpr GLuint kObjects = 0;     /**< DrawList の全オブジェクトのデータ */
+static constexpr GLuint kCullInputs = 1;  /**< DrawList::Cull の入力 */
+static constexpr GLuint kCullOutputs = 2; /**< DrawList::Cull が書き出すコマンド */
+static constexpr GLuint kDrawCounts = 3;  /**< DrawList::Cull が数えたコマンドの数 */
+} // namespace StorageBinding
+
+// ********************************************************************************
+// Structures
+// ********************************************************************************
+
+/**
+ * @brief フレームごとに一度だけ書き込むデータ
+ */
+struct FrameBlock {
+  glm::mat4 view{1.0f};
+  glm::mat4 proj{1.0f};
+  glm::mat4 shadow{1.0f};    // バイアス * ライトのビュー射影行列
+  glm::vec4 lightPosition{}; // カメラ座標系から見たライトの位置
+  alignas(16) glm::vec3 lightLa{};
+  alignas(16) glm::vec3 lightLd{};
+  alignas(16) glm::vec3 lightLs{};
+};
+static_assert(Std140::Verify(sizeof(FrameBlock),
+                             {
+                                 STD140_MEMBER(FrameBlock, view),
+                                 STD140_MEMBER(FrameBlock, proj),
+                                 STD140_MEMBER(FrameBlock, shadow),
+                                 STD140_MEMBER(FrameBlock, lightPosition),
+                                 STD140_MEMBER(FrameBlock, lightLa),
+                                 STD140_MEMBER(FrameBlock, lightLd),
+                                 STD140_MEMBER(FrameBlock, lightLs),
+                             }),
+              "FrameBlock does not match std140 layout.");
+
+/**
+ * @brief 描画するオブジェクトごとのデータ
+ * @note std430 の配列の要素としても同じ並びになるので、DrawList はそのまま転送します。
+ */
+struct ObjectBlock {
+  glm::mat4 model{1.0f};
+  alignas(16) glm::vec3 ka{};
+  alignas(16) glm::vec3 kd{};
+  alignas(16) glm::vec3 ks{};
+  float shininess = 1.0f;
+};
+static_assert(Std140::Verify(sizeof(ObjectBlock),
+                             {
+                                 STD140_MEMBER(ObjectBlock, model),
+                                 STD140_MEMBER(ObjectBlock, ka),
+                                 STD140_MEMBER(ObjectBlock, kd),
+                                 STD140_MEMBER(ObjectBlock, ks),
+                                 STD140_MEMBER(ObjectBlock, shininess),
+                             }),
+              "ObjectBlock does not match std140 layout.");
+
+#endif
@@ -0,0 +1,122 @@
+/**
+ * @brief  Memory mapped file
+ * @note   ファイルを読み込み専用でメモリにマップします。
+ * ファイルが空の場合は、Data() が nullptr、Size() が 0 のまま有効になります。
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class MappedFile {
+public:
+  MappedFile() = default;
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept { Swap(other); }
+  MappedFile &operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+      Close();
+      Swap(other);
+    }
+    return *this;
+  }
+  ~MappedFile() { Close(); }
+
+  /**
+   * @brief ファイルをマップします。
+   * @return 開けなかった場合は false
+   */
+  bool Open(const std::string &path) {
+    Close();
+#ifdef _WIN32
+    const HANDLE file =
+        CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+      return false;
+    }
+    LARGE_INTEGER size{};
+    if (!GetFileSizeEx(file, &size)) {
+      CloseHandle(file);
+      return false;
+    }
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (size_ > 0) {
+      const HANDLE mapping =
+          CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping != nullptr) {
+        data_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+      }
+    }
+    CloseHandle(file);
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      ::close(fd);
+      return false;
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+      void *data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      data_ = data == MAP_FAILED ? nullptr : data;
+    }
+    ::close(fd);
+#endif
+    isOpen_ = size_ == 0 || data_ != nullptr;
+    if (!isOpen_) {
+      size_ = 0;
+    }
+    return isOpen_;
+  }
+
+  void Close() {
+    if (data_ != nullptr) {
+#ifdef _WIN32
+      UnmapViewOfFile(data_);
+#else
+      ::munmap(data_, size_);
+#endif
+    }
+    data_ = nullptr;
+    size_ = 0;
+    isOpen_ = false;
+  }
+
+  bool IsOpen() const { return isOpen_; }
+  const std::uint8_t *Data() const {
+    return static_cast<const std::uint8_t *>(data_);
+  }
+  std::size_t Size() const { return size_; }
+
+private:
+  void Swap(MappedFile &other) {
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+    std::swap(isOpen_, other.isOpen_);
+  }
+
+  void *data_ = nullptr;
+  std::size_t size_ = 0;
+  bool isOpen_ = false;
+};
@@ -46,6 +46,7 @@ void Frustum::SetupCorners(const glm::vec3 &eyePt, const glm::vec3 &lookatPt,
 
   const auto kView = glm::lookAt(eyePt, lookatPt, upVec);
   const auto kProj = GetProjectionMatrix();
+  planes_ = ExtractPlanes(kProj * kView);
   const auto kInvVP = glm::inverse(kProj * kView);
   for (int i = 0; i < 8; i++) {
     const auto corner = kInvVP * glm::vec4(corners_[i], 1.0f);
@@ -70,6 +71,20 @@ BSphere Frustum::ComputeBSphere() const {
   return {center, radius};
 }
 
+/**
+ * @note Gribb & Hartmann の方法で、クリップ座標の各面 (-w <= x <= w など) を
+ * 行列の行の和と差として取り出します。
+ */
+FrustumPlanes Frustum::ExtractPlanes(const glm::mat4 &viewProj) {
+  const glm::mat4 m = glm::transpose(viewProj); // m[i] が i 行目
+  FrustumPlanes planes = {m[3] + m[0], m[3] - m[0], m[3] + m[1],
+                          m[3] - m[1], m[3] + m[2], m[3] - m[2]};
+  for (glm::vec4 &plane : planes) {
+    plane /= glm::length(glm::vec3(plane));
+  }
+  return planes;
+}
+
 glm::mat4 Frustum::GetProjectionMatrix() const {
   if (type_ == ProjectionType::Perspective) {
     return glm::perspective(fovy_, ar_, near_, far_);
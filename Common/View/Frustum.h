@@ -3,6 +3,8 @@
 #include "GLInclude.h"
 
 #include <array>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "Geometry/BSphere.h"
@@ -14,6 +16,40 @@ enum struct ProjectionType {
   Num,
 };
 
+/**
+ * @brief 視錐台の平面 (左, 右, 下, 上, 近, 遠)
+ * @note dot(xyz, p) + w >= 0 が内側で、xyz は正規化しています。
+ */
+using FrustumPlanes = std::array<glm::vec4, 6>;
+
+/**< @brief 一括カリングで使う命令セット */
+enum struct CullSimd {
+  Scalar,
+  SSE,  // 4 個ずつ
+  AVX2, // 8 個ずつ
+  Num,
+};
+
+/**< @brief 境界球の配列 (SoA) */
+struct SphereArrays {
+  const float *x = nullptr;
+  const float *y = nullptr;
+  const float *z = nullptr;
+  const float *radius = nullptr;
+  std::size_t count = 0;
+};
+
+/**< @brief AABB の配列 (SoA) */
+struct AABBArrays {
+  const float *minX = nullptr;
+  const float *minY = nullptr;
+  const float *minZ = nullptr;
+  const float *maxX = nullptr;
+  const float *maxY = nullptr;
+  const float *maxZ = nullptr;
+  std::size_t count = 0;
+};
+
 class Frustum {
 public:
   void SetupPerspective(float fovy, float aspectRatio, float near, float far);
@@ -22,6 +58,10 @@ public:
 
   void SetupCorners(const glm::vec3 &eyePt, const glm::vec3 &lookatPt,
                     const glm::vec3 &upVec);
+  /**< @brief ビュー射影行列から平面だけを設定します。 */
+  void SetupPlanes(const glm::mat4 &viewProj) {
+    planes_ = ExtractPlanes(viewProj);
+  }
 
   void SetNear(float n) { near_ = n; }
   float GetNear() const { return near_; }
@@ -33,6 +73,32 @@ public:
   glm::mat4 GetProjectionMatrix() const;
   glm::vec3 GetCorner(std::size_t idx) const { return corners_.at(idx); }
   BSphere ComputeBSphere() const;
+  const FrustumPlanes &GetPlanes() const { return planes_; }
+
+  /**
+   * @brief ビュー射影行列 (クリップ座標の z は [-w, w]) から平面を取り出します。
+   */
+  static FrustumPlanes ExtractPlanes(const glm::mat4 &viewProj);
+
+  /**
+   * @brief 視錐台と交わる球の visible を 1, それ以外を 0 にします。
+   * @param visible spheres.count 個の要素を持つ配列
+   * @return 交わる球の数
+   */
+  std::size_t CullSpheres(const SphereArrays &spheres, std::uint8_t *visible,
+                          CullSimd simd = GetBestSimd()) const;
+  /**
+   * @brief 視錐台と交わる AABB の visible を 1, それ以外を 0 にします。
+   * @return 交わる AABB の数
+   * @note 平面ごとに判定するため、視錐台の角の外側にある AABB は残ることがあります。
+   */
+  std::size_t CullAABBs(const AABBArrays &boxes, std::uint8_t *visible,
+                        CullSimd simd = GetBestSimd()) const;
+
+  /**< @brief 実行中の CPU で使える命令セットか */
+  static bool IsSupported(CullSimd simd);
+  /**< @brief 使える中で最も幅の広い命令セット */
+  static CullSimd GetBestSimd();
 
 private:
   ProjectionType type_;
@@ -70,4 +136,5 @@ private:
    *
    */
   std::array<glm::vec3, 8> corners_;
+  FrustumPlanes planes_{};
 };
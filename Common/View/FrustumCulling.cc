@@ -0,0 +1,288 @@
+/**
+ * @brief 視錐台による一括カリング
+ * @note 球と AABB の配列 (SoA) を SSE で 4 個ずつ、AVX2 で 8 個ずつ判定します。
+ * どの命令セットでも積和の順は同じにしているので、FMA に縮約されなければ結果はスカラー版と一致します。
+ */
+
+#include "View/Frustum.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__)
+#define FRUSTUM_CULLING_SSE 1
+#include <immintrin.h>
+#endif
+
+// AVX2 はコンパイラに有効にされていなければ、関数単位で有効にして実行時に選びます。
+#if defined(__AVX2__)
+#define FRUSTUM_CULLING_AVX2 1
+#define FRUSTUM_CULLING_AVX2_TARGET
+#elif defined(FRUSTUM_CULLING_SSE) && (defined(__GNUC__) || defined(__clang__))
+#define FRUSTUM_CULLING_AVX2 1
+#define FRUSTUM_CULLING_AVX2_TARGET __attribute__((target("avx2")))
+#endif
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+namespace Impl {
+
+/**
+ * @brief 平面ごとに、法線の向きに最も進んだ AABB の頂点 (p-vertex) の成分の配列を選びます。
+ */
+struct PVertex {
+  const float *x;
+  const float *y;
+  const float *z;
+};
+
+static std::array<PVertex, 6> SelectPVertices(const FrustumPlanes &planes,
+                                              const AABBArrays &boxes) {
+  std::array<PVertex, 6> pvs{};
+  for (std::size_t k = 0; k < planes.size(); k++) {
+    pvs[k].x = planes[k].x >= 0.0f ? boxes.maxX : boxes.minX;
+    pvs[k].y = planes[k].y >= 0.0f ? boxes.maxY : boxes.minY;
+    pvs[k].z = planes[k].z >= 0.0f ? boxes.maxZ : boxes.minZ;
+  }
+  return pvs;
+}
+
+static float Distance(const glm::vec4 &plane, float x, float y, float z) {
+  return plane.x * x + plane.y * y + plane.z * z + plane.w;
+}
+
+static std::size_t CullSpheresScalar(const FrustumPlanes &planes,
+                                     const SphereArrays &spheres,
+                                     std::size_t first, std::uint8_t *visible) {
+  std::size_t count = 0;
+  for (std::size_t i = first; i < spheres.count; i++) {
+    bool isInside = true;
+    for (const glm::vec4 &plane : planes) {
+      isInside &= Distance(plane, spheres.x[i], spheres.y[i], spheres.z[i]) >=
+                  -spheres.radius[i];
+    }
+    visible[i] = static_cast<std::uint8_t>(isInside);
+    count += isInside ? 1 : 0;
+  }
+  return count;
+}
+
+static std::size_t CullAABBsScalar(const FrustumPlanes &planes,
+                                   const AABBArrays &boxes, std::size_t first,
+                                   std::uint8_t *visible) {
+  const std::array<PVertex, 6> pvs = SelectPVertices(planes, boxes);
+  std::size_t count = 0;
+  for (std::size_t i = first; i < boxes.count; i++) {
+    bool isInside = true;
+    for (std::size_t k = 0; k < planes.size(); k++) {
+      isInside &=
+          Distance(planes[k], pvs[k].x[i], pvs[k].y[i], pvs[k].z[i]) >= 0.0f;
+    }
+    visible[i] = static_cast<std::uint8_t>(isInside);
+    count += isInside ? 1 : 0;
+  }
+  return count;
+}
+
+/**
+ * @brief movemask のビットを 1 バイトずつ書き出し、立っているビットの数を返します。
+ */
+static std::size_t StoreMask(int mask, std::size_t width,
+                             std::uint8_t *visible) {
+  std::size_t count = 0;
+  for (std::size_t j = 0; j < width; j++) {
+    const auto bit = static_cast<std::uint8_t>((mask >> j) & 1);
+    visible[j] = bit;
+    count += bit;
+  }
+  return count;
+}
+
+#if defined(FRUSTUM_CULLING_SSE)
+
+/**
+ * @return 判定した数 (4 の倍数)
+ */
+static std::size_t CullSpheresSSE(const FrustumPlanes &planes,
+                                  const SphereArrays &spheres,
+                                  std::uint8_t *visible, std::size_t &count) {
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  const std::size_t n = spheres.count & ~std::size_t{3};
+  for (std::size_t i = 0; i < n; i += 4) {
+    const __m128 x = _mm_loadu_ps(spheres.x + i);
+    const __m128 y = _mm_loadu_ps(spheres.y + i);
+    const __m128 z = _mm_loadu_ps(spheres.z + i);
+    const __m128 negR = _mm_xor_ps(_mm_loadu_ps(spheres.radius + i), sign);
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (const glm::vec4 &plane : planes) {
+      __m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), x),
+                            _mm_mul_ps(_mm_set1_ps(plane.y), y));
+      d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(plane.z), z));
+      d = _mm_add_ps(d, _mm_set1_ps(plane.w));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(d, negR));
+    }
+    count += StoreMask(_mm_movemask_ps(inside), 4, visible + i);
+  }
+  return n;
+}
+
+static std::size_t CullAABBsSSE(const FrustumPlanes &planes,
+                                const AABBArrays &boxes, std::uint8_t *visible,
+                                std::size_t &count) {
+  const std::array<PVertex, 6> pvs = SelectPVertices(planes, boxes);
+  const __m128 zero = _mm_setzero_ps();
+  const std::size_t n = boxes.count & ~std::size_t{3};
+  for (std::size_t i = 0; i < n; i += 4) {
+    __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    for (std::size_t k = 0; k < planes.size(); k++) {
+      const glm::vec4 &plane = planes[k];
+      __m128 d =
+          _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), _mm_loadu_ps(pvs[k].x + i)),
+                     _mm_mul_ps(_mm_set1_ps(plane.y), _mm_loadu_ps(pvs[k].y + i)));
+      d = _mm_add_ps(
+          d, _mm_mul_ps(_mm_set1_ps(plane.z), _mm_loadu_ps(pvs[k].z + i)));
+      d = _mm_add_ps(d, _mm_set1_ps(plane.w));
+      inside = _mm_and_ps(inside, _mm_cmpge_ps(d, zero));
+    }
+    count += StoreMask(_mm_movemask_ps(inside), 4, visible + i);
+  }
+  return n;
+}
+
+#endif
+
+#if defined(FRUSTUM_CULLING_AVX2)
+
+/**
+ * @return 判定した数 (8 の倍数)
+ */
+FRUSTUM_CULLING_AVX2_TARGET
+static std::size_t CullSpheresAVX2(const FrustumPlanes &planes,
+                                   const SphereArrays &spheres,
+                                   std::uint8_t *visible, std::size_t &count) {
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  const std::size_t n = spheres.count & ~std::size_t{7};
+  for (std::size_t i = 0; i < n; i += 8) {
+    const __m256 x = _mm256_loadu_ps(spheres.x + i);
+    const __m256 y = _mm256_loadu_ps(spheres.y + i);
+    const __m256 z = _mm256_loadu_ps(spheres.z + i);
+    const __m256 negR = _mm256_xor_ps(_mm256_loadu_ps(spheres.radius + i), sign);
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (const glm::vec4 &plane : planes) {
+      __m256 d = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), x),
+                               _mm256_mul_ps(_mm256_set1_ps(plane.y), y));
+      d = _mm256_add_ps(d, _mm256_mul_ps(_mm256_set1_ps(plane.z), z));
+      d = _mm256_add_ps(d, _mm256_set1_ps(plane.w));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, negR, _CMP_GE_OQ));
+    }
+    count += StoreMask(_mm256_movemask_ps(inside), 8, visible + i);
+  }
+  return n;
+}
+
+FRUSTUM_CULLING_AVX2_TARGET
+static std::size_t CullAABBsAVX2(const FrustumPlanes &planes,
+                                 const AABBArrays &boxes, std::uint8_t *visible,
+                                 std::size_t &count) {
+  const std::array<PVertex, 6> pvs = SelectPVertices(planes, boxes);
+  const __m256 zero = _mm256_setzero_ps();
+  const std::size_t n = boxes.count & ~std::size_t{7};
+  for (std::size_t i = 0; i < n; i += 8) {
+    __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+    for (std::size_t k = 0; k < planes.size(); k++) {
+      const glm::vec4 &plane = planes[k];
+      __m256 d = _mm256_add_ps(
+          _mm256_mul_ps(_mm256_set1_ps(plane.x), _mm256_loadu_ps(pvs[k].x + i)),
+          _mm256_mul_ps(_mm256_set1_ps(plane.y), _mm256_loadu_ps(pvs[k].y + i)));
+      d = _mm256_add_ps(
+          d, _mm256_mul_ps(_mm256_set1_ps(plane.z), _mm256_loadu_ps(pvs[k].z + i)));
+      d = _mm256_add_ps(d, _mm256_set1_ps(plane.w));
+      inside = _mm256_and_ps(inside, _mm256_cmp_ps(d, zero, _CMP_GE_OQ));
+    }
+    count += StoreMask(_mm256_movemask_ps(inside), 8, visible + i);
+  }
+  return n;
+}
+
+#endif
+
+} // namespace Impl
+
+//*--------------------------------------------------------------------------------
+// Static functions
+//*--------------------------------------------------------------------------------
+
+bool Frustum::IsSupported(CullSimd simd) {
+  switch (simd) {
+  case CullSimd::Scalar:
+    return true;
+  case CullSimd::SSE:
+#if defined(FRUSTUM_CULLING_SSE)
+    return true;
+#else
+    return false;
+#endif
+  case CullSimd::AVX2:
+#if defined(__AVX2__)
+    return true;
+#elif defined(FRUSTUM_CULLING_AVX2)
+    static const bool kHasAVX2 = __builtin_cpu_supports("avx2") != 0;
+    return kHasAVX2;
+#else
+    return false;
+#endif
+  default:
+    return false;
+  }
+}
+
+CullSimd Frustum::GetBestSimd() {
+  if (IsSupported(CullSimd::AVX2)) {
+    return CullSimd::AVX2;
+  }
+  return IsSupported(CullSimd::SSE) ? CullSimd::SSE : CullSimd::Scalar;
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+std::size_t Frustum::CullSpheres(const SphereArrays &spheres,
+                                 std::uint8_t *visible, CullSimd simd) const {
+  std::size_t count = 0;
+  std::size_t first = 0;
+  if (!IsSupported(simd)) {
+    simd = GetBestSimd();
+  }
+#if defined(FRUSTUM_CULLING_AVX2)
+  if (simd == CullSimd::AVX2) {
+    first = Impl::CullSpheresAVX2(planes_, spheres, visible, count);
+  }
+#endif
+#if defined(FRUSTUM_CULLING_SSE)
+  if (simd == CullSimd::SSE) {
+    first = Impl::CullSpheresSSE(planes_, spheres, visible, count);
+  }
+#endif
+  // 端数は 1 個ずつ判定します。
+  return count + Impl::CullSpheresScalar(planes_, spheres, first, visible);
+}
+
+std::size_t Frustum::CullAABBs(const AABBArrays &boxes, std::uint8_t *visible,
+                               CullSimd simd) const {
+  std::size_t count = 0;
+  std::size_t first = 0;
+  if (!IsSupported(simd)) {
+    simd = GetBestSimd();
+  }
+#if defined(FRUSTUM_CULLING_AVX2)
+  if (simd == CullSimd::AVX2) {
+    first = Impl::CullAABBsAVX2(planes_, boxes, visible, count);
+  }
+#endif
+#if defined(FRUSTUM_CULLING_SSE)
+  if (simd == CullSimd::SSE) {
+    first = Impl::CullAABBsSSE(planes_, boxes, visible, count);
+  }
+#endif
+  return count + Impl::CullAABBsScalar(planes_, boxes, first, visible);
+}
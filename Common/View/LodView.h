@@ -0,0 +1,33 @@
+/**
+ * @brief  詳細度 (LOD) の選択に使う視点の情報
+ */
+
+#pragma once
+
+#include "GLInclude.h"
+
+#include <cmath>
+
+#include "View/Camera.h"
+
+struct LodView {
+  glm::vec3 eye{0.0f};        // 視点の位置 (ワールド空間)
+  float pixelsPerUnit = 0.0f; // 視点から距離 1 の位置での 1 単位あたりのピクセル数
+  float threshold = 1.0f;     // 許容する画面上の誤差 [px]
+  int bias = 0; // 選んだ詳細度をいくつ粗くするか (シャドウパスなど)
+
+  /**
+   * @brief カメラの位置と垂直画角から作ります。
+   * @param viewportHeight 描画先の高さ [px]
+   */
+  static LodView FromCamera(const Camera &camera, int viewportHeight,
+                            float threshold = 1.0f, int bias = 0) {
+    LodView view{};
+    view.eye = camera.GetPosition();
+    view.pixelsPerUnit = static_cast<float>(viewportHeight) /
+                         (2.0f * std::tan(camera.GetFOVY() * 0.5f));
+    view.threshold = threshold;
+    view.bias = bias;
+    return view;
+  }
+};
@@ -12,13 +12,18 @@
 #include <boost/assert.hpp>
 #include <boost/noncopyable.hpp>
 #include <iostream>
+#include <optional>
 
 #include "Common.h"
 #include "GLInclude.h"
 
 #include "Debug.h"
 #include "GUI/GUI.h"
+#include "Graphics/GLState.h"
+#include "Graphics/ParallelShaderCompile.h"
+#include "Graphics/Sampler.h"
 #include "HID/KeyInput.h"
+#include "Headless.h"
 #include "Window.h"
 
 // ********************************************************************************
@@ -27,7 +32,19 @@
 
 class App : private boost::noncopyable {
 public:
-  App(const char *appName, int w = 1280, int h = 720, int samples = 0) {
+  App(const char *appName, int w = 1280, int h = 720, int samples = 0)
+      : App(appName, w, h, samples, Headless::GetFramesFromEnv()) {}
+
+  /**
+   * @param headlessFrames 指定されていればウィンドウを作らずにそのフレーム数だけ実行します。
+   */
+  App(const char *appName, int w, int h, int samples,
+      std::optional<int> headlessFrames) {
+    if (headlessFrames) {
+      InitHeadless(w, h, samples, headlessFrames.value());
+      return;
+    }
+
     if (glfwInit() == GL_FALSE) {
       BOOST_ASSERT_MSG(false, "glfw Initialization failed!");
       return;
@@ -44,6 +61,10 @@ public:
   }
 
   ~App() {
+    if (IsHeadless()) {
+      Headless::Destroy(headless_);
+      return;
+    }
     Window::Destroy(window_);
     glfwTerminate();
   }
@@ -52,44 +73,110 @@ public:
             typename Destroy>
   int Run(Initialize OnInit, Update OnUpdate, Render OnRender,
           Destroy OnDestroy) {
-    if (window_ == nullptr) {
+    if (window_ == nullptr && !isHeadlessReady_) {
       return EXIT_FAILURE;
     }
 
     OnInit(width_, height_);
 
-    while (!glfwWindowShouldClose(window_) &&
-           !glfwGetKey(window_, GLFW_KEY_ESCAPE)) {
+    for (frame_ = 0; IsRunning(); frame_++) {
 
 #if (!NDEBUG)
       Debug::CheckForOpenGLError(__FILE__, __LINE__);
 #endif
+      GLState::Get().BeginFrame();
       OnPreUpdate(window_);
-      OnUpdate(static_cast<float>(glfwGetTime()));
+      OnUpdate(static_cast<float>(GetTime()));
       OnRender();
 
-      glfwSwapBuffers(window_);
-      glfwPollEvents();
+      SwapBuffers();
     }
 
     OnDestroy();
     GUI::Destroy();
+    SamplerCache::Destroy();
+    GLState::Destroy();
 #if (!NDEBUG)
     Debug::CleanupInfo();
 #endif
     return EXIT_SUCCESS;
   }
 
+  bool IsHeadless() const { return maxFrames_.has_value(); }
+
+  /**
+   * @brief 現在のフレームを最後にメインループを抜けます。
+   */
+  void Quit() { isQuit_ = true; }
+
 private:
   GLFWwindow *window_ = nullptr;
   int width_;
   int height_;
 
+  Headless::Context headless_{};
+  std::optional<int> maxFrames_ = std::nullopt;
+  bool isHeadlessReady_ = false;
+  bool isQuit_ = false;
+  int frame_ = 0;
+
+  void InitHeadless(int w, int h, int samples, int frames) {
+    maxFrames_ = frames;
+    width_ = w;
+    height_ = h;
+
+    if (!Headless::Create(headless_, w, h, samples)) {
+      BOOST_ASSERT_MSG(false, "failed to create headless context!");
+      return;
+    }
+    if (!gladLoadGLLoader(Headless::GetLoader())) {
+      BOOST_ASSERT_MSG(false, "Something went wrong!");
+      return;
+    }
+    ParallelShaderCompile::OnInit(Headless::GetLoader());
+#if (!NDEBUG)
+    Debug::SetupInfo();
+#endif
+    GUI::InitHeadless(w, h);
+    isHeadlessReady_ = true;
+  }
+
+  bool IsRunning() const {
+    if (isQuit_) {
+      return false;
+    }
+    if (IsHeadless()) {
+      return frame_ < maxFrames_.value();
+    }
+    return !glfwWindowShouldClose(window_) &&
+           !glfwGetKey(window_, GLFW_KEY_ESCAPE);
+  }
+
+  double GetTime() const {
+    // ヘッドレスモードでは固定のタイムステップで時間を進めます。
+    if (IsHeadless()) {
+      return static_cast<double>(frame_) * Headless::kTimeStep;
+    }
+    return glfwGetTime();
+  }
+
+  void SwapBuffers() {
+    if (IsHeadless()) {
+      Headless::SwapBuffers(headless_);
+      return;
+    }
+    glfwSwapBuffers(window_);
+    glfwPollEvents();
+  }
+
   static void InitGlad() {
     // Initialize GLAD
     if (!gladLoadGL()) {
       BOOST_ASSERT_MSG(false, "Something went wrong!");
+      return;
     }
+    ParallelShaderCompile::OnInit(
+        reinterpret_cast<GLADloadproc>(glfwGetProcAddress));
   }
 
   static void OnPreUpdate(GLFWwindow *hwd) {
@@ -27,9 +27,32 @@ namespace GUI {
   io.IniFilename = nullptr;
 }
 
+/**
+ * @brief ウィンドウを持たない場合の初期化を行います。
+ * @note Platform backend は使わず、表示サイズは固定になります。
+ */
+[[maybe_unused]] static void InitHeadless(int w, int h) {
+  IMGUI_CHECKVERSION();
+  ImGui::CreateContext();
+  ImGui::StyleColorsClassic();
+  ImGui_ImplOpenGL3_Init();
+
+  ImGuiIO &io = ImGui::GetIO();
+  io.IniFilename = nullptr;
+  io.DisplaySize = ImVec2(static_cast<float>(w), static_cast<float>(h));
+}
+
+[[maybe_unused]] static bool HasPlatformBackend() {
+  return ImGui::GetIO().BackendPlatformName != nullptr;
+}
+
 [[maybe_unused]] static void NewFrame() {
   ImGui_ImplOpenGL3_NewFrame();
-  ImGui_ImplGlfw_NewFrame();
+  if (HasPlatformBackend()) {
+    ImGui_ImplGlfw_NewFrame();
+  } else {
+    ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+  }
   ImGui::NewFrame();
 }
 
@@ -41,7 +64,9 @@ namespace GUI {
 [[maybe_unused]] static void Destroy() {
   // Cleanup
   ImGui_ImplOpenGL3_Shutdown();
-  ImGui_ImplGlfw_Shutdown();
+  if (HasPlatformBackend()) {
+    ImGui_ImplGlfw_Shutdown();
+  }
   ImGui::DestroyContext();
 }
 
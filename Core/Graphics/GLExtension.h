@@ -0,0 +1,45 @@
+/**
+ * @brief  GL extension query
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef GL_EXTENSION_H
+#define GL_EXTENSION_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <cstring>
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace GLExtension {
+
+/**
+ * @brief 拡張がコンテキストで使えるか調べます。
+ * @note 読み込んだ glad に含まれていない拡張も調べられます。
+ */
+static inline bool Has(const char *name) {
+  GLint num = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &num);
+  for (GLint i = 0; i < num; i++) {
+    const auto *ext = reinterpret_cast<const char *>(
+        glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+    if (ext != nullptr && std::strcmp(ext, name) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace GLExtension
+
+#endif
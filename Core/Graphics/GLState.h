@@ -0,0 +1,343 @@
+/**
+ * @brief  GL state cache
+ * @note   バインド中のプログラム、VAO、テクスチャ、サンプラー、FBO、ビューポート、
+ * glEnable/glDisable の状態を保持し、変化しない呼び出しをドライバーに渡さずに捨てます。
+ * 追跡している状態を変更する場合は、このクラスを経由してください。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef GL_STATE_H
+#define GL_STATE_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Utils/Singleton.h"
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief GL State Cache Class
+ * @code
+ *   GLState::Get().BindVertexArray(vao);
+ *   GLState::Get().Enable(GL_DEPTH_TEST);
+ * @endcode
+ * @note GL を直接呼び出して状態を変更した場合は Invalidate() で捨ててください。
+ * 追跡しているオブジェクトは GLState::DeleteTextures などで削除してください。
+ */
+class GLState : public Singleton<GLState> {
+public:
+  static constexpr inline std::size_t kMaxTextureUnits = 32;
+
+  /**< @brief 発行した呼び出しと捨てた呼び出しの数 */
+  struct Counters {
+    std::uint64_t issued = 0;
+    std::uint64_t avoided = 0;
+  };
+
+  GLState() { Invalidate(); }
+
+  //*--------------------------------------------------------------------------------
+  // Program & Vertex Array
+  //*--------------------------------------------------------------------------------
+
+  void UseProgram(GLuint program) {
+    if (Filter(program_, program)) {
+      glUseProgram(program);
+    }
+  }
+
+  void BindVertexArray(GLuint vao) {
+    if (Filter(vao_, vao)) {
+      glBindVertexArray(vao);
+    }
+  }
+
+  //*--------------------------------------------------------------------------------
+  // Texture & Sampler
+  //*--------------------------------------------------------------------------------
+
+  void ActiveTexture(GLenum unit) {
+    if (Filter(activeUnit_, unit - GL_TEXTURE0)) {
+      glActiveTexture(unit);
+    }
+  }
+
+  /**< @brief アクティブなユニットにテクスチャをバインドします。 */
+  void BindTexture(GLenum target, GLuint texture) {
+    const int index = ToTargetIndex(target);
+    if (index < 0 || activeUnit_ >= kMaxTextureUnits) {
+      Issue();
+      glBindTexture(target, texture);
+      return;
+    }
+    if (Filter(textures_[activeUnit_][static_cast<std::size_t>(index)],
+               texture)) {
+      glBindTexture(target, texture);
+    }
+  }
+
+  void BindSampler(GLuint unit, GLuint sampler) {
+    if (unit >= kMaxTextureUnits) {
+      Issue();
+      glBindSampler(unit, sampler);
+      return;
+    }
+    if (Filter(samplers_[unit], sampler)) {
+      glBindSampler(unit, sampler);
+    }
+  }
+
+  //*--------------------------------------------------------------------------------
+  // Framebuffer & Viewport
+  //*--------------------------------------------------------------------------------
+
+  void BindFramebuffer(GLenum target, GLuint fbo) {
+    if (target == GL_FRAMEBUFFER) {
+      if (drawFBO_ == fbo && readFBO_ == fbo) {
+        Avoid();
+        return;
+      }
+      drawFBO_ = fbo;
+      readFBO_ = fbo;
+      Issue();
+      glBindFramebuffer(target, fbo);
+      return;
+    }
+    GLuint &cache = target == GL_READ_FRAMEBUFFER ? readFBO_ : drawFBO_;
+    if (Filter(cache, fbo)) {
+      glBindFramebuffer(target, fbo);
+    }
+  }
+
+  void Viewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+    const std::array<GLint, 4> viewport{x, y, w, h};
+    if (isViewportValid_ && viewport_ == viewport) {
+      Avoid();
+      return;
+    }
+    viewport_ = viewport;
+    isViewportValid_ = true;
+    Issue();
+    glViewport(x, y, w, h);
+  }
+
+  //*--------------------------------------------------------------------------------
+  // Capability
+  //*--------------------------------------------------------------------------------
+
+  void Enable(GLenum cap) { SetCapability(cap, true); }
+  void Disable(GLenum cap) { SetCapability(cap, false); }
+
+  //*--------------------------------------------------------------------------------
+  // Deletion
+  //*--------------------------------------------------------------------------------
+
+  // 削除されたオブジェクトは GL 側で 0 にバインドし直されるため、こちらも合わせます。
+  // (名前は再利用されるので、残しておくと新しいオブジェクトのバインドを捨ててしまいます。)
+  // 削除は下の静的関数から行い、Destroy の後はキャッシュを作り直さずに削除だけ行います。
+
+  static void DeleteProgram(GLuint program) {
+    if (IsExist()) {
+      Get().OnDeleteProgram(program);
+    }
+    glDeleteProgram(program);
+  }
+
+  static void DeleteVertexArrays(GLsizei n, const GLuint *vaos) {
+    if (IsExist()) {
+      for (GLsizei i = 0; i < n; i++) {
+        Get().OnDeleteVertexArray(vaos[i]);
+      }
+    }
+    glDeleteVertexArrays(n, vaos);
+  }
+
+  static void DeleteTextures(GLsizei n, const GLuint *textures) {
+    if (IsExist()) {
+      Get().OnDeleteTextures(n, textures);
+    }
+    glDeleteTextures(n, textures);
+  }
+
+  static void DeleteSamplers(GLsizei n, const GLuint *samplers) {
+    if (IsExist()) {
+      for (GLsizei i = 0; i < n; i++) {
+        Get().OnDeleteSampler(samplers[i]);
+      }
+    }
+    glDeleteSamplers(n, samplers);
+  }
+
+  static void DeleteFramebuffers(GLsizei n, const GLuint *fbos) {
+    if (IsExist()) {
+      for (GLsizei i = 0; i < n; i++) {
+        Get().OnDeleteFramebuffer(fbos[i]);
+      }
+    }
+    glDeleteFramebuffers(n, fbos);
+  }
+
+  void OnDeleteProgram(GLuint program) {
+    if (program_ == program) {
+      program_ = kUnknown;
+    }
+  }
+
+  void OnDeleteVertexArray(GLuint vao) {
+    if (vao_ == vao) {
+      vao_ = 0;
+    }
+  }
+
+  void OnDeleteTextures(GLsizei n, const GLuint *textures) {
+    for (GLsizei i = 0; i < n; i++) {
+      for (auto &unit : textures_) {
+        for (auto &bound : unit) {
+          if (bound == textures[i]) {
+            bound = 0;
+          }
+        }
+      }
+    }
+  }
+
+  void OnDeleteSampler(GLuint sampler) {
+    for (auto &bound : samplers_) {
+      if (bound == sampler) {
+        bound = 0;
+      }
+    }
+  }
+
+  void OnDeleteFramebuffer(GLuint fbo) {
+    if (drawFBO_ == fbo) {
+      drawFBO_ = 0;
+    }
+    if (readFBO_ == fbo) {
+      readFBO_ = 0;
+    }
+  }
+
+  /**
+   * @brief 保持している状態を全て不明にします。
+   * @note 次の呼び出しは必ずドライバーに渡されます。
+   */
+  void Invalidate() {
+    program_ = kUnknown;
+    vao_ = kUnknown;
+    activeUnit_ = kUnknown;
+    for (auto &unit : textures_) {
+      unit.fill(kUnknown);
+    }
+    samplers_.fill(kUnknown);
+    drawFBO_ = kUnknown;
+    readFBO_ = kUnknown;
+    isViewportValid_ = false;
+    capabilities_.clear();
+  }
+
+  //*--------------------------------------------------------------------------------
+  // Counters
+  //*--------------------------------------------------------------------------------
+
+  /**< @brief フレームの始めに呼び出し、カウンターを切り替えます。 */
+  void BeginFrame() {
+    lastFrame_ = frame_;
+    frame_ = Counters{};
+  }
+
+  /**< @brief 現在のフレームのカウンター */
+  const Counters &GetFrameCounters() const { return frame_; }
+  /**< @brief 直前のフレームのカウンター */
+  const Counters &GetLastFrameCounters() const { return lastFrame_; }
+
+private:
+  static constexpr inline GLuint kUnknown = 0xFFFFFFFF;
+  static constexpr inline std::size_t kTargetsNum = 6;
+
+  static int ToTargetIndex(GLenum target) {
+    switch (target) {
+    case GL_TEXTURE_2D:
+      return 0;
+    case GL_TEXTURE_2D_ARRAY:
+      return 1;
+    case GL_TEXTURE_CUBE_MAP:
+      return 2;
+    case GL_TEXTURE_3D:
+      return 3;
+    case GL_TEXTURE_2D_MULTISAMPLE:
+      return 4;
+    case GL_TEXTURE_1D:
+      return 5;
+    default:
+      return -1;
+    }
+  }
+
+  /**
+   * @brief 値が変化する場合だけ更新します。
+   * @return 呼び出しをドライバーに渡す必要があれば true
+   */
+  bool Filter(GLuint &cache, GLuint value) {
+    if (cache == value) {
+      Avoid();
+      return false;
+    }
+    cache = value;
+    Issue();
+    return true;
+  }
+
+  void SetCapability(GLenum cap, bool isEnabled) {
+    for (auto &[key, state] : capabilities_) {
+      if (key != cap) {
+        continue;
+      }
+      if (state == isEnabled) {
+        Avoid();
+        return;
+      }
+      state = isEnabled;
+      Issue();
+      isEnabled ? glEnable(cap) : glDisable(cap);
+      return;
+    }
+    capabilities_.emplace_back(cap, isEnabled);
+    Issue();
+    isEnabled ? glEnable(cap) : glDisable(cap);
+  }
+
+  void Issue() { frame_.issued++; }
+  void Avoid() { frame_.avoided++; }
+
+  GLuint program_;
+  GLuint vao_;
+  GLuint activeUnit_;
+  std::array<std::array<GLuint, kTargetsNum>, kMaxTextureUnits> textures_{};
+  std::array<GLuint, kMaxTextureUnits> samplers_{};
+  GLuint drawFBO_;
+  GLuint readFBO_;
+  std::array<GLint, 4> viewport_{};
+  bool isViewportValid_ = false;
+  std::vector<std::pair<GLenum, bool>> capabilities_{}; // 数が少ないので線形探索します。
+
+  Counters frame_{};
+  Counters lastFrame_{};
+};
+
+#endif
@@ -0,0 +1,286 @@
+/**
+ * @brief  Geometry arena
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Graphics/GeometryArena.h"
+
+#include <algorithm>
+#include <boost/assert.hpp>
+
+#include "Graphics/GLState.h"
+
+//*--------------------------------------------------------------------------------
+// Helper
+//*--------------------------------------------------------------------------------
+
+static GLsizeiptr AlignUp(GLsizeiptr offset, GLsizeiptr alignment) {
+  return (offset + alignment - 1) / alignment * alignment;
+}
+
+//*--------------------------------------------------------------------------------
+// Range list
+//*--------------------------------------------------------------------------------
+
+GeometryArena::RangeList::RangeList(GLsizeiptr capacity)
+    : capacity_(capacity) {
+  free_.emplace(0, capacity);
+}
+
+GLsizeiptr GeometryArena::RangeList::Allocate(GLsizeiptr size,
+                                              GLsizeiptr alignment) {
+  for (auto it = free_.begin(); it != free_.end(); ++it) {
+    const auto [offset, space] = *it;
+    const GLsizeiptr aligned = AlignUp(offset, alignment);
+    const GLsizeiptr end = offset + space;
+    if (aligned + size > end) {
+      continue;
+    }
+
+    // 揃えで空いた前と、残った後ろを空き領域に戻します。
+    free_.erase(it);
+    if (aligned > offset) {
+      free_.emplace(offset, aligned - offset);
+    }
+    if (aligned + size < end) {
+      free_.emplace(aligned + size, end - aligned - size);
+    }
+    used_ += size;
+    return aligned;
+  }
+  return -1;
+}
+
+void GeometryArena::RangeList::Free(GLsizeiptr offset, GLsizeiptr size) {
+  if (size <= 0) {
+    return;
+  }
+  used_ -= size;
+  auto it = free_.emplace(offset, size).first;
+
+  // 後ろと前の空き領域が接していれば結合します。
+  const auto next = std::next(it);
+  if (next != free_.end() && it->first + it->second == next->first) {
+    it->second += next->second;
+    free_.erase(next);
+  }
+  if (it != free_.begin()) {
+    const auto prev = std::prev(it);
+    if (prev->first + prev->second == it->first) {
+      prev->second += it->second;
+      free_.erase(it);
+    }
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// Special member functions
+//*--------------------------------------------------------------------------------
+
+GeometryArena::GeometryArena() {
+#if !defined(__APPLE__)
+  isImmutable_ = GLAD_GL_VERSION_4_4 != 0;
+#endif
+}
+
+GeometryArena::~GeometryArena() {
+  for (std::size_t i = 0; i < pages_.size(); i++) {
+    DestroyPage(i);
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// Functions
+//*--------------------------------------------------------------------------------
+
+GeometryArena::Allocation
+GeometryArena::Allocate(const Layout &layout, const void *vertices,
+                        GLsizeiptr vertexBytes, const void *indices,
+                        GLsizeiptr indexBytes) {
+  BOOST_ASSERT_MSG(layout.stride > 0 && layout.setup != nullptr,
+                   "Vertex layout is invalid.");
+  Allocation alloc{};
+  if (layout.stride <= 0 || layout.setup == nullptr) {
+    return alloc;
+  }
+
+  // 頂点は baseVertex で参照できるよう、ストライドの倍数の位置に置きます。
+  const GLsizeiptr stride = layout.stride;
+  GLsizeiptr vertexOffset = -1, indexOffset = -1;
+  std::size_t index = pages_.size();
+  for (std::size_t i = 0; i < pages_.size(); i++) {
+    Page *page = pages_[i].get();
+    if (page == nullptr) {
+      index = std::min(index, i);
+      continue;
+    }
+    vertexOffset = page->vertices.Allocate(vertexBytes, stride);
+    if (vertexOffset < 0) {
+      continue;
+    }
+    indexOffset = page->indices.Allocate(indexBytes, kIndexAlignment);
+    if (indexOffset < 0) {
+      page->vertices.Free(vertexOffset, vertexBytes);
+      vertexOffset = -1;
+      continue;
+    }
+    index = i;
+    break;
+  }
+
+  if (vertexOffset < 0) {
+    Page &page = CreatePage(index, AlignUp(vertexBytes, stride), indexBytes);
+    vertexOffset = page.vertices.Allocate(vertexBytes, stride);
+    indexOffset = page.indices.Allocate(indexBytes, kIndexAlignment);
+  }
+  BOOST_ASSERT_MSG(vertexOffset >= 0 && indexOffset >= 0,
+                   "Failed to allocate geometry.");
+
+  Page &page = *pages_[index];
+  page.allocations++;
+
+  // VAO のバインドに影響しないよう、コピー用のターゲットで転送します。
+  if (vertexBytes > 0) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, page.vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, vertexOffset, vertexBytes,
+                    vertices);
+  }
+  if (indexBytes > 0) {
+    glBindBuffer(GL_COPY_WRITE_BUFFER, page.indexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexBytes, indices);
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  alloc.page = index;
+  alloc.vao = FindVertexArray(page, layout);
+  alloc.vertexBuffer = page.vertexBuffer;
+  alloc.indexBuffer = page.indexBuffer;
+  alloc.baseVertex = static_cast<GLint>(vertexOffset / stride);
+  alloc.vertexOffset = vertexOffset;
+  alloc.vertexBytes = vertexBytes;
+  alloc.indexOffset = indexOffset;
+  alloc.indexBytes = indexBytes;
+  return alloc;
+}
+
+void GeometryArena::Free(const Allocation &alloc) {
+  if (!alloc.IsValid() || alloc.page >= pages_.size() ||
+      pages_[alloc.page] == nullptr) {
+    return;
+  }
+  Page &page = *pages_[alloc.page];
+  page.vertices.Free(alloc.vertexOffset, alloc.vertexBytes);
+  page.indices.Free(alloc.indexOffset, alloc.indexBytes);
+  if (--page.allocations == 0) {
+    DestroyPage(alloc.page);
+  }
+}
+
+GeometryArena::Stats GeometryArena::GetStats() const {
+  Stats stats{};
+  for (const auto &page : pages_) {
+    if (page == nullptr) {
+      continue;
+    }
+    stats.pages++;
+    stats.allocations += page->allocations;
+    stats.vertexCapacity += page->vertices.GetCapacity();
+    stats.vertexBytes += page->vertices.GetUsed();
+    stats.indexCapacity += page->indices.GetCapacity();
+    stats.indexBytes += page->indices.GetUsed();
+  }
+  return stats;
+}
+
+//*--------------------------------------------------------------------------------
+// Page
+//*--------------------------------------------------------------------------------
+
+GeometryArena::Page &GeometryArena::CreatePage(std::size_t index,
+                                               GLsizeiptr vertexBytes,
+                                               GLsizeiptr indexBytes) {
+  const GLsizeiptr vertexCapacity = std::max(vertexBytes, kVertexPageBytes);
+  const GLsizeiptr indexCapacity = std::max(indexBytes, kIndexPageBytes);
+  auto page = std::make_unique<Page>(vertexCapacity, indexCapacity);
+
+  const auto createBuffer = [this](GLsizeiptr size) {
+    GLuint buffer = 0;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+#if !defined(__APPLE__)
+    if (isImmutable_) {
+      // 大きさは変えられませんが、glBufferSubData で書き込めるようにします。
+      glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr,
+                      GL_DYNAMIC_STORAGE_BIT);
+      return buffer;
+    }
+#endif
+    glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+    return buffer;
+  };
+  page->vertexBuffer = createBuffer(vertexCapacity);
+  page->indexBuffer = createBuffer(indexCapacity);
+  if (drawIndexBuffer_ == 0) {
+    std::vector<GLuint> drawIndices(kMaxDrawIndices);
+    for (GLuint i = 0; i < kMaxDrawIndices; i++) {
+      drawIndices[i] = i;
+    }
+    drawIndexBuffer_ =
+        createBuffer(static_cast<GLsizeiptr>(sizeof(GLuint) * kMaxDrawIndices));
+    glBufferSubData(GL_COPY_WRITE_BUFFER, 0,
+                    static_cast<GLsizeiptr>(sizeof(GLuint) * kMaxDrawIndices),
+                    drawIndices.data());
+  }
+  glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+  if (index == pages_.size()) {
+    pages_.emplace_back();
+  }
+  pages_[index] = std::move(page);
+  return *pages_[index];
+}
+
+void GeometryArena::DestroyPage(std::size_t index) {
+  if (pages_[index] == nullptr) {
+    return;
+  }
+  Page &page = *pages_[index];
+  for (const auto &[key, vao] : page.vaos) {
+    GLState::DeleteVertexArrays(1, &vao);
+  }
+  const GLuint buffers[] = {page.vertexBuffer, page.indexBuffer};
+  glDeleteBuffers(2, buffers);
+  pages_[index].reset();
+
+  if (std::all_of(pages_.begin(), pages_.end(),
+                  [](const auto &p) { return p == nullptr; })) {
+    glDeleteBuffers(1, &drawIndexBuffer_);
+    drawIndexBuffer_ = 0;
+  }
+}
+
+GLuint GeometryArena::FindVertexArray(Page &page, const Layout &layout) {
+  for (const auto &[key, vao] : page.vaos) {
+    if (key == layout.key) {
+      return vao;
+    }
+  }
+
+  GLuint vao = 0;
+  glGenVertexArrays(1, &vao);
+  GLState::Get().BindVertexArray(vao);
+  glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, page.indexBuffer);
+  glBindBuffer(GL_ARRAY_BUFFER, page.vertexBuffer);
+  layout.setup(0);
+  glBindBuffer(GL_ARRAY_BUFFER, drawIndexBuffer_);
+  glVertexAttribIPointer(kDrawIndexLocation, 1, GL_UNSIGNED_INT, 0, nullptr);
+  glVertexAttribDivisor(kDrawIndexLocation, 1);
+  glEnableVertexAttribArray(kDrawIndexLocation);
+  GLState::Get().BindVertexArray(0);
+  glBindBuffer(GL_ARRAY_BUFFER, 0);
+  page.vaos.emplace_back(layout.key, vao);
+  return vao;
+}
@@ -0,0 +1,157 @@
+/**
+ * @brief  Geometry arena
+ * @note   全てのメッシュの頂点とインデックスを、少数の大きな不変バッファ (glBufferStorage) の
+ * ページから切り出して置きます。VAO はページと頂点レイアウトの組ごとに一つだけ作るので、
+ * 同じレイアウトのメッシュは VAO もバッファも切り替えずに baseVertex と firstIndex だけで描画できます。
+ * まとめて描画 (glMultiDrawElementsIndirect など) する場合の前提にもなります。
+ * 各 VAO の kDrawIndexLocation には 0, 1, 2, ... と並んだバッファを除数 1 で割り当てるので、
+ * シェーダーはこの属性から baseInstance + gl_InstanceID を受け取れます。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef GEOMETRY_ARENA_H
+#define GEOMETRY_ARENA_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "Utils/Singleton.h"
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief Geometry Arena Class
+ * @code
+ *   const auto alloc = GeometryArena::Get().Allocate(layout, vertices,
+ *                                                    vertexBytes, indices,
+ *                                                    indexBytes);
+ *   GLState::Get().BindVertexArray(alloc.vao);
+ *   glDrawElementsBaseVertex(GL_TRIANGLES, count, type,
+ *                            (void *)alloc.indexOffset, alloc.baseVertex);
+ *   GeometryArena::Get().Free(alloc);
+ * @endcode
+ * @note 空になったページはその場で破棄するので、メッシュは全てコンテキストが有効な間に破棄してください。
+ */
+class GeometryArena : public Singleton<GeometryArena> {
+public:
+  /**< @brief ページの大きさ (これより大きいメッシュには専用のページを作ります) */
+  static constexpr inline GLsizeiptr kVertexPageBytes = 16 << 20;
+  static constexpr inline GLsizeiptr kIndexPageBytes = 8 << 20;
+  /**< @brief インデックスの位置の揃え (16 ビットと 32 ビットのどちらも要素の単位で表せます) */
+  static constexpr inline GLsizeiptr kIndexAlignment = 4;
+  /**< @brief 描画ごとの番号 (baseInstance + gl_InstanceID) を渡す属性の location */
+  static constexpr inline GLuint kDrawIndexLocation = 15;
+  /**< @brief kDrawIndexLocation で表せる番号の数 */
+  static constexpr inline GLuint kMaxDrawIndices = 1 << 18;
+
+  /**
+   * @brief 頂点レイアウト
+   * @note key が同じであれば同じ VAO を共有します。setup はバインド中の VAO に、
+   * GL_ARRAY_BUFFER の先頭からの属性を設定します (VertexLayout::Setup など)。
+   */
+  struct Layout {
+    std::uint32_t key = 0;
+    GLsizei stride = 0;
+    void (*setup)(std::size_t baseOffset) = nullptr;
+  };
+
+  /**< @brief 切り出した範囲 */
+  struct Allocation {
+    std::size_t page = 0;
+    GLuint vao = 0; // ページとレイアウトで共有する VAO
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    GLint baseVertex = 0;        // glDrawElementsBaseVertex に渡す頂点の番号
+    GLsizeiptr vertexOffset = 0; // 頂点バッファ内のバイト位置 (baseVertex * stride)
+    GLsizeiptr vertexBytes = 0;
+    GLsizeiptr indexOffset = 0; // インデックスバッファ内のバイト位置
+    GLsizeiptr indexBytes = 0;
+
+    bool IsValid() const { return vao != 0; }
+  };
+
+  /**< @brief 使用量 */
+  struct Stats {
+    std::size_t pages = 0;
+    std::size_t allocations = 0;
+    GLsizeiptr vertexCapacity = 0;
+    GLsizeiptr vertexBytes = 0;
+    GLsizeiptr indexCapacity = 0;
+    GLsizeiptr indexBytes = 0;
+  };
+
+  GeometryArena();
+  ~GeometryArena();
+
+  /**
+   * @brief 頂点とインデックスの範囲を切り出して転送します。
+   * @note 空きのあるページが無ければ新しいページを作ります。
+   */
+  Allocation Allocate(const Layout &layout, const void *vertices,
+                      GLsizeiptr vertexBytes, const void *indices,
+                      GLsizeiptr indexBytes);
+
+  /**< @brief 範囲を返します。ページが空になれば破棄します。 */
+  void Free(const Allocation &alloc);
+
+  Stats GetStats() const;
+
+  /**< @brief glBufferStorage で不変のバッファを作れるか */
+  bool IsImmutable() const { return isImmutable_; }
+
+private:
+  /**
+   * @brief 空き領域の管理 (最初に収まる位置を使い、返された範囲は隣と結合します)
+   */
+  class RangeList {
+  public:
+    explicit RangeList(GLsizeiptr capacity);
+    /**< @brief alignment の倍数の位置に size バイトを確保します。失敗すると -1 を返します。 */
+    GLsizeiptr Allocate(GLsizeiptr size, GLsizeiptr alignment);
+    void Free(GLsizeiptr offset, GLsizeiptr size);
+    GLsizeiptr GetCapacity() const { return capacity_; }
+    GLsizeiptr GetUsed() const { return used_; }
+
+  private:
+    GLsizeiptr capacity_ = 0;
+    GLsizeiptr used_ = 0;
+    std::map<GLsizeiptr, GLsizeiptr> free_{}; // 位置と大きさ
+  };
+
+  struct Page {
+    Page(GLsizeiptr vertexCapacity, GLsizeiptr indexCapacity)
+        : vertices(vertexCapacity), indices(indexCapacity) {}
+
+    GLuint vertexBuffer = 0;
+    GLuint indexBuffer = 0;
+    RangeList vertices;
+    RangeList indices;
+    std::size_t allocations = 0;
+    std::vector<std::pair<std::uint32_t, GLuint>> vaos{}; // レイアウトの key と VAO
+  };
+
+  Page &CreatePage(std::size_t index, GLsizeiptr vertexBytes,
+                   GLsizeiptr indexBytes);
+  void DestroyPage(std::size_t index);
+  GLuint FindVertexArray(Page &page, const Layout &layout);
+
+  bool isImmutable_ = false;
+  GLuint drawIndexBuffer_ = 0; // 0, 1, 2, ... (ページがある間だけ持ちます)
+  std::vector<std::unique_ptr<Page>> pages_{}; // 破棄したページは nullptr にして番号を再利用します。
+};
+
+#endif
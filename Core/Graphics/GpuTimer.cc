@@ -0,0 +1,218 @@
+/**
+ * @brief  GPU Timer
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Graphics/GpuTimer.h"
+
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <cmath>
+#include <fstream>
+#include <imgui.h>
+#include <iostream>
+#include <numeric>
+
+//*--------------------------------------------------------------------------------
+// Special member functions
+//*--------------------------------------------------------------------------------
+
+GpuTimer::~GpuTimer() {
+  for (auto &frame : frames_) {
+    if (!frame.queries.empty()) {
+      glDeleteQueries(static_cast<GLsizei>(frame.queries.size()),
+                      frame.queries.data());
+    }
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// Measurement
+//*--------------------------------------------------------------------------------
+
+void GpuTimer::BeginFrame() {
+  // kLatency フレーム前に発行したクエリの結果を回収してから使い回します。
+  Frame &frame = frames_[frameIdx_ % kLatency];
+  Collect(frame);
+  frame.used = 0;
+  frame.issued = frameIdx_;
+}
+
+void GpuTimer::EndFrame() {
+  BOOST_ASSERT_MSG(!isActive_, "GpuTimer::End() is not called.");
+  frameIdx_++;
+}
+
+void GpuTimer::Begin(const std::string &name) {
+  BOOST_ASSERT_MSG(!isActive_, "GL_TIME_ELAPSED queries cannot be nested.");
+
+  Frame &frame = frames_[frameIdx_ % kLatency];
+  if (frame.used == frame.queries.size()) {
+    GLuint query = 0;
+    glGenQueries(1, &query);
+    frame.queries.emplace_back(query);
+    frame.passes.emplace_back(0);
+  }
+  frame.passes[frame.used] = FindOrAddPass(name);
+  glBeginQuery(GL_TIME_ELAPSED, frame.queries[frame.used]);
+  frame.used++;
+  isActive_ = true;
+}
+
+void GpuTimer::End() {
+  BOOST_ASSERT_MSG(isActive_, "GpuTimer::Begin() is not called.");
+  glEndQuery(GL_TIME_ELAPSED);
+  isActive_ = false;
+}
+
+//*--------------------------------------------------------------------------------
+// Result
+//*--------------------------------------------------------------------------------
+
+std::optional<GpuTimer::Stats>
+GpuTimer::GetStats(const std::string &name) const {
+  for (const auto &pass : passes_) {
+    if (pass.name == name && !pass.history.empty()) {
+      return ComputeStats(pass.history);
+    }
+  }
+  return std::nullopt;
+}
+
+std::vector<std::string> GpuTimer::GetPassNames() const {
+  std::vector<std::string> names;
+  names.reserve(passes_.size());
+  for (const auto &pass : passes_) {
+    names.emplace_back(pass.name);
+  }
+  return names;
+}
+
+void GpuTimer::ShowGUI(const char *title) {
+  ImGui::Begin(title);
+  if (ImGui::BeginTable("GpuTimerTable", 4,
+                        ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+    ImGui::TableSetupColumn("Pass");
+    ImGui::TableSetupColumn("min (ms)");
+    ImGui::TableSetupColumn("avg (ms)");
+    ImGui::TableSetupColumn("p99 (ms)");
+    ImGui::TableHeadersRow();
+
+    double total = 0.0;
+    for (const auto &pass : passes_) {
+      if (pass.history.empty()) {
+        continue;
+      }
+      const Stats stats = ComputeStats(pass.history);
+      total += stats.avg;
+
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::TextUnformatted(pass.name.c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", stats.min);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", stats.avg);
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", stats.p99);
+    }
+    ImGui::EndTable();
+    ImGui::Text("Total (avg): %.3f ms", total);
+  }
+
+  if (ImGui::Button("Dump CSV")) {
+    static constexpr const char *kCSVPath = "./GpuTimer.csv";
+    if (const auto msg = DumpCSV(kCSVPath)) {
+      std::cerr << msg.value() << std::endl;
+      dumpStatus_ = msg.value();
+    } else {
+      dumpStatus_ = std::string("Written to ") + kCSVPath;
+    }
+  }
+  if (!dumpStatus_.empty()) {
+    ImGui::SameLine();
+    ImGui::TextUnformatted(dumpStatus_.c_str());
+  }
+  ImGui::End();
+}
+
+std::optional<std::string>
+GpuTimer::DumpCSV(const std::string &filepath) const {
+  std::ofstream ofs(filepath, std::ios::out | std::ios::trunc);
+  if (!ofs) {
+    return std::string("Can't open file : ") + filepath;
+  }
+
+  ofs << "pass,samples,min_ms,avg_ms,p99_ms\n";
+  for (const auto &pass : passes_) {
+    const Stats stats = ComputeStats(pass.history);
+    ofs << pass.name << ',' << stats.samples << ',' << stats.min << ','
+        << stats.avg << ',' << stats.p99 << '\n';
+  }
+  return std::nullopt;
+}
+
+//*--------------------------------------------------------------------------------
+// Private functions
+//*--------------------------------------------------------------------------------
+
+std::size_t GpuTimer::FindOrAddPass(const std::string &name) {
+  // パスの数は高々数個なので線形探索で十分です。
+  for (std::size_t i = 0; i < passes_.size(); i++) {
+    if (passes_[i].name == name) {
+      return i;
+    }
+  }
+  passes_.emplace_back(Pass{name, {}});
+  return passes_.size() - 1;
+}
+
+void GpuTimer::Collect(Frame &frame) {
+  if (frame.issued < kWarmupFrames) {
+    return;
+  }
+  for (std::size_t i = 0; i < frame.used; i++) {
+    const GLuint query = frame.queries[i];
+
+    // 結果がまだ出ていなければ待たずに捨てます。
+    GLint available = GL_FALSE;
+    glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) {
+      dropped_++;
+      continue;
+    }
+
+    GLuint64 elapsed = 0;
+    glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+
+    auto &history = passes_[frame.passes[i]].history;
+    history.emplace_back(static_cast<double>(elapsed) * 1.0e-6);
+    if (history.size() > kHistorySize) {
+      history.pop_front();
+    }
+  }
+}
+
+GpuTimer::Stats GpuTimer::ComputeStats(const std::deque<double> &history) {
+  if (history.empty()) {
+    return Stats{};
+  }
+
+  std::vector<double> sorted(history.begin(), history.end());
+  std::sort(sorted.begin(), sorted.end());
+
+  const std::size_t n = sorted.size();
+  const auto p99 = static_cast<std::size_t>(
+      std::ceil(0.99 * static_cast<double>(n)));
+
+  Stats stats;
+  stats.min = sorted.front();
+  stats.avg = std::accumulate(sorted.begin(), sorted.end(), 0.0) /
+              static_cast<double>(n);
+  stats.p99 = sorted[std::max<std::size_t>(p99, 1) - 1];
+  stats.samples = n;
+  return stats;
+}
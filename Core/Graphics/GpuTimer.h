@@ -0,0 +1,142 @@
+/**
+ * @brief  GPU Timer
+ * @note   GL_TIME_ELAPSED クエリでパスごとの GPU 時間を計測します。
+ * 結果は kLatency フレーム後に読み出すため、パイプラインをストールさせません。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef GPU_TIMER_H
+#define GPU_TIMER_H
+
+// ********************************************************************************
+// Including file
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <array>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief GPU Timer Class
+ * @code
+ *   timer.BeginFrame();
+ *   {
+ *     const auto scope = timer.Measure("Pass1");
+ *     Pass1();
+ *   }
+ *   timer.EndFrame();
+ * @endcode
+ */
+class GpuTimer : private boost::noncopyable {
+public:
+  /**< @brief クエリを発行してから結果を読み出すまでのフレーム数 */
+  static constexpr inline std::size_t kLatency = 4;
+  /**< @brief 統計に使うサンプル数 */
+  static constexpr inline std::size_t kHistorySize = 240;
+  /**< @brief 統計から除外する最初のフレーム数 (シェーダーの遅延コンパイルなどを含むため) */
+  static constexpr inline std::size_t kWarmupFrames = 1;
+
+  /**< @brief パスごとの統計 (ミリ秒) */
+  struct Stats {
+    double min = 0.0;
+    double avg = 0.0;
+    double p99 = 0.0;
+    std::size_t samples = 0;
+  };
+
+  /**
+   * @brief 計測区間をスコープで管理します。
+   */
+  class Scope : private boost::noncopyable {
+  public:
+    Scope(GpuTimer &timer, const std::string &name) : timer_(timer) {
+      timer_.Begin(name);
+    }
+    ~Scope() { timer_.End(); }
+
+  private:
+    GpuTimer &timer_;
+  };
+
+  GpuTimer() = default;
+  ~GpuTimer();
+
+  //*--------------------------------------------------------------------------------
+  // Measurement
+  //*--------------------------------------------------------------------------------
+
+  void BeginFrame();
+  void EndFrame();
+
+  /**
+   * @note GL_TIME_ELAPSED クエリは入れ子にできないため、
+   * Begin/End の区間を重ねないでください。
+   */
+  void Begin(const std::string &name);
+  void End();
+
+  Scope Measure(const std::string &name) { return Scope(*this, name); }
+
+  //*--------------------------------------------------------------------------------
+  // Result
+  //*--------------------------------------------------------------------------------
+
+  std::optional<Stats> GetStats(const std::string &name) const;
+  std::vector<std::string> GetPassNames() const;
+  std::uint64_t GetDroppedSamples() const { return dropped_; }
+
+  void ShowGUI(const char *title = "GPU Timer");
+  std::optional<std::string> DumpCSV(const std::string &filepath) const;
+
+private:
+  //*--------------------------------------------------------------------------------
+  // Private structures
+  //*--------------------------------------------------------------------------------
+
+  struct Pass {
+    std::string name;
+    std::deque<double> history; // ミリ秒
+  };
+
+  struct Frame {
+    std::vector<GLuint> queries;
+    std::vector<std::size_t> passes;
+    std::size_t used = 0;
+    std::size_t issued = 0; // クエリを発行したフレーム番号
+  };
+
+  //*--------------------------------------------------------------------------------
+  // Private functions
+  //*--------------------------------------------------------------------------------
+
+  std::size_t FindOrAddPass(const std::string &name);
+  void Collect(Frame &frame);
+  static Stats ComputeStats(const std::deque<double> &history);
+
+  //*--------------------------------------------------------------------------------
+  // Member Variable(s)
+  //*--------------------------------------------------------------------------------
+
+  std::array<Frame, kLatency> frames_{};
+  std::size_t frameIdx_ = 0;
+  std::vector<Pass> passes_{};
+  bool isActive_ = false;
+  std::uint64_t dropped_ = 0;
+  std::string dumpStatus_{}; // 最後の Dump CSV の結果 (GUI に表示します)
+};
+
+#endif
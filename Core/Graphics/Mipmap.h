@@ -0,0 +1,308 @@
+/**
+ * @brief  Mipmap generator
+ * @note   8bit RGBA の画像から縮小レベルを CPU で作ります。
+ * sRGB の画像は一度線形に戻してから平均するため、縮小しても暗くなりません。
+ * 行ごとにスレッドへ分け、texel の平均は SIMD で計算します。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef MIPMAP_H
+#define MIPMAP_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <future>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define MIPMAP_USE_SSE
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define MIPMAP_USE_NEON
+#endif
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace Mipmap {
+
+static constexpr int kChannels = 4;
+
+/**< @brief 線形 → sRGB 変換表の大きさ (暗部でも 8bit の 1 段階より細かくなるようにします) */
+static constexpr std::size_t kEncodeTableSize = 1 << 14;
+
+/**< @brief これより texel 数が少なければスレッドを使いません。 */
+static constexpr std::size_t kParallelThreshold = 128 * 128;
+
+/**< @brief 線形空間の RGBA 画像 */
+struct Image {
+  int width = 0;
+  int height = 0;
+  std::vector<float> texels{};
+};
+
+/**
+ * @brief 最小の 1x1 までを含めたレベル数を返します。
+ */
+static inline int ComputeLevels(int width, int height) {
+  int levels = 1;
+  for (int size = std::max(width, height); size > 1; size >>= 1) {
+    levels++;
+  }
+  return levels;
+}
+
+//*--------------------------------------------------------------------------------
+// Color space
+//*--------------------------------------------------------------------------------
+
+static inline float SRGBToLinear(float c) {
+  return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+static inline float LinearToSRGB(float c) {
+  return c <= 0.0031308f ? c * 12.92f
+                         : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+struct Tables {
+  std::array<float, 256> decode{};
+  std::vector<unsigned char> encode{};
+};
+
+static inline const Tables &GetTables() {
+  static const Tables tables = [] {
+    Tables t{};
+    for (std::size_t i = 0; i < t.decode.size(); i++) {
+      t.decode[i] = SRGBToLinear(static_cast<float>(i) / 255.0f);
+    }
+    t.encode.resize(kEncodeTableSize);
+    for (std::size_t i = 0; i < kEncodeTableSize; i++) {
+      const float c = static_cast<float>(i) /
+                      static_cast<float>(kEncodeTableSize - 1);
+      t.encode[i] =
+          static_cast<unsigned char>(LinearToSRGB(c) * 255.0f + 0.5f);
+    }
+    return t;
+  }();
+  return tables;
+}
+
+//*--------------------------------------------------------------------------------
+// Parallel
+//*--------------------------------------------------------------------------------
+
+/**
+ * @brief 行を分割して func(begin, end) を並列に呼び出します。
+ * @param texelsPerRow 1 行の texel 数 (小さな画像はスレッドを使いません)
+ */
+template <typename Func>
+static inline void ParallelFor(int rows, int texelsPerRow, Func func) {
+  const auto total = static_cast<std::size_t>(rows) *
+                     static_cast<std::size_t>(texelsPerRow);
+  const int threads =
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  const int tasks = total < kParallelThreshold ? 1 : std::min(threads, rows);
+  if (tasks <= 1) {
+    func(0, rows);
+    return;
+  }
+
+  const int chunk = (rows + tasks - 1) / tasks;
+  std::vector<std::future<void>> futures;
+  for (int begin = chunk; begin < rows; begin += chunk) {
+    futures.emplace_back(std::async(std::launch::async, func, begin,
+                                    std::min(rows, begin + chunk)));
+  }
+  func(0, std::min(rows, chunk));
+  for (auto &future : futures) {
+    future.get();
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// Conversion
+//*--------------------------------------------------------------------------------
+
+/**
+ * @brief 8bit RGBA を線形空間の float に変換します。
+ * @param isSRGB RGB が sRGB で符号化されていれば true (アルファは常に線形です)
+ */
+static inline Image Decode(const unsigned char *rgba, int width, int height,
+                           bool isSRGB) {
+  const Tables &tables = GetTables();
+  Image image{width, height, {}};
+  image.texels.resize(static_cast<std::size_t>(width) *
+                      static_cast<std::size_t>(height) * kChannels);
+  ParallelFor(height, width, [&](int begin, int end) {
+    const std::size_t first =
+        static_cast<std::size_t>(begin) * static_cast<std::size_t>(width) *
+        kChannels;
+    const std::size_t last = static_cast<std::size_t>(end) *
+                             static_cast<std::size_t>(width) * kChannels;
+    for (std::size_t i = first; i < last; i++) {
+      const bool isAlpha = i % kChannels == kChannels - 1;
+      image.texels[i] = isSRGB && !isAlpha
+                            ? tables.decode[rgba[i]]
+                            : static_cast<float>(rgba[i]) / 255.0f;
+    }
+  });
+  return image;
+}
+
+/**
+ * @brief 線形空間の float を 8bit RGBA に戻します。
+ */
+static inline void Encode(const Image &image, bool isSRGB,
+                          std::vector<unsigned char> &out) {
+  const Tables &tables = GetTables();
+  out.resize(image.texels.size());
+  ParallelFor(image.height, image.width, [&](int begin, int end) {
+    const std::size_t first =
+        static_cast<std::size_t>(begin) *
+        static_cast<std::size_t>(image.width) * kChannels;
+    const std::size_t last = static_cast<std::size_t>(end) *
+                             static_cast<std::size_t>(image.width) *
+                             kChannels;
+    for (std::size_t i = first; i < last; i++) {
+      const float c = std::clamp(image.texels[i], 0.0f, 1.0f);
+      const bool isAlpha = i % kChannels == kChannels - 1;
+      out[i] = isSRGB && !isAlpha
+                   ? tables.encode[static_cast<std::size_t>(
+                         c * static_cast<float>(kEncodeTableSize - 1) + 0.5f)]
+                   : static_cast<unsigned char>(c * 255.0f + 0.5f);
+    }
+  });
+}
+
+//*--------------------------------------------------------------------------------
+// Downsample
+//*--------------------------------------------------------------------------------
+
+/**
+ * @brief 4 つの RGBA texel の平均を求めます。
+ */
+static inline void Average(const float *a, const float *b, const float *c,
+                           const float *d, float *out) {
+#if defined(MIPMAP_USE_SSE)
+  const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(a), _mm_loadu_ps(b)),
+                                _mm_add_ps(_mm_loadu_ps(c), _mm_loadu_ps(d)));
+  _mm_storeu_ps(out, _mm_mul_ps(sum, _mm_set1_ps(0.25f)));
+#elif defined(MIPMAP_USE_NEON)
+  const float32x4_t sum = vaddq_f32(vaddq_f32(vld1q_f32(a), vld1q_f32(b)),
+                                    vaddq_f32(vld1q_f32(c), vld1q_f32(d)));
+  vst1q_f32(out, vmulq_n_f32(sum, 0.25f));
+#else
+  for (int i = 0; i < kChannels; i++) {
+    out[i] = (a[i] + b[i] + c[i] + d[i]) * 0.25f;
+  }
+#endif
+}
+
+/**
+ * @brief 一つの軸で、出力の i 番目の texel が読む元の texel の数を求めます。
+ * @note 奇数の辺では最後の texel に残りの 1 列 (行) を畳み込み、3 つを読みます。
+ */
+static inline int CountTaps(int srcSize, int dstSize, int i) {
+  if (srcSize == 1) {
+    return 1;
+  }
+  return i == dstSize - 1 && srcSize % 2 == 1 ? 3 : 2;
+}
+
+/**
+ * @brief (x0, y0) から nx x ny 個の RGBA texel の平均を求めます。
+ */
+static inline void AverageBox(const Image &src, int x0, int y0, int nx, int ny,
+                              float *out) {
+  float sum[kChannels] = {};
+  for (int y = y0; y < y0 + ny; y++) {
+    const float *row = src.texels.data() +
+                       static_cast<std::size_t>(y) *
+                           static_cast<std::size_t>(src.width) * kChannels;
+    for (int x = x0; x < x0 + nx; x++) {
+      const float *texel = row + static_cast<std::size_t>(x) * kChannels;
+      for (int i = 0; i < kChannels; i++) {
+        sum[i] += texel[i];
+      }
+    }
+  }
+  const float weight = 1.0f / static_cast<float>(nx * ny);
+  for (int i = 0; i < kChannels; i++) {
+    out[i] = sum[i] * weight;
+  }
+}
+
+/**
+ * @brief 2x2 の box filter で半分の大きさにします。
+ * @note 奇数の辺は最後の texel を 3 texel 幅の box filter にして、端の列と行も必ず読みます。
+ * (5x5 を 2x2 にするとき x=4, y=4 を捨てて左上に寄らないようにします)
+ */
+static inline Image Downsample(const Image &src) {
+  Image dst{std::max(1, src.width / 2), std::max(1, src.height / 2), {}};
+  dst.texels.resize(static_cast<std::size_t>(dst.width) *
+                    static_cast<std::size_t>(dst.height) * kChannels);
+
+  ParallelFor(dst.height, dst.width, [&](int begin, int end) {
+    const auto stride = static_cast<std::size_t>(src.width) * kChannels;
+    for (int y = begin; y < end; y++) {
+      const int ny = CountTaps(src.height, dst.height, y);
+      const float *row0 =
+          src.texels.data() + static_cast<std::size_t>(y * 2) * stride;
+      const float *row1 = ny == 1 ? row0 : row0 + stride;
+      float *out = dst.texels.data() + static_cast<std::size_t>(y) *
+                                           static_cast<std::size_t>(dst.width) *
+                                           kChannels;
+      for (int x = 0; x < dst.width; x++) {
+        const int nx = CountTaps(src.width, dst.width, x);
+        float *texel = out + static_cast<std::size_t>(x) * kChannels;
+        if (nx == 2 && ny == 2) {
+          const std::size_t offset = static_cast<std::size_t>(x * 2) * kChannels;
+          Average(row0 + offset, row0 + offset + kChannels, row1 + offset,
+                  row1 + offset + kChannels, texel);
+        } else {
+          AverageBox(src, x * 2, y * 2, nx, ny, texel);
+        }
+      }
+    }
+  });
+  return dst;
+}
+
+/**
+ * @brief レベル 1 以降を順に作り、upload(level, width, height, rgba) に渡します。
+ * @note レベル 0 は元の画像をそのまま使ってください。
+ * 誤差が溜まらないよう、縮小は 8bit に戻す前の float で続けます。
+ */
+template <typename Upload>
+static inline void Generate(const unsigned char *rgba, int width, int height,
+                            bool isSRGB, Upload upload) {
+  const int levels = ComputeLevels(width, height);
+  if (levels <= 1) {
+    return;
+  }
+
+  Image image = Decode(rgba, width, height, isSRGB);
+  std::vector<unsigned char> pixels;
+  for (int level = 1; level < levels; level++) {
+    image = Downsample(image);
+    Encode(image, isSRGB, pixels);
+    upload(level, image.width, image.height, pixels.data());
+  }
+}
+
+} // namespace Mipmap
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @brief  Parallel shader compile
+ * @note   GL_KHR_parallel_shader_compile / GL_ARB_parallel_shader_compile が使えれば、
+ * コンパイルとリンクの完了を GL_COMPLETION_STATUS でブロックせずに問い合わせます。
+ * 読み込んだ glad には含まれていないため、定数と関数はこちらで定義します。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef PARALLEL_SHADER_COMPILE_H
+#define PARALLEL_SHADER_COMPILE_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include "Graphics/GLExtension.h"
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace ParallelShaderCompile {
+
+static constexpr GLenum kMaxShaderCompilerThreads = 0x91B0;
+static constexpr GLenum kCompletionStatus = 0x91B1;
+
+/**< @brief ドライバーに任せる場合のスレッド数 */
+static constexpr GLuint kThreadsAuto = 0xFFFFFFFF;
+
+using MaxShaderCompilerThreadsProc = void(APIENTRYP)(GLuint count);
+
+struct State {
+  bool isSupported = false;
+  MaxShaderCompilerThreadsProc maxShaderCompilerThreads = nullptr;
+};
+
+static inline State &GetState() {
+  static State state{};
+  return state;
+}
+
+/**
+ * @brief 拡張の有無を調べ、コンパイラスレッド数をドライバーに任せます。
+ * @param loader glad の読み込みに使った関数 (取得できなければ nullptr でも構いません)
+ */
+static inline void OnInit(GLADloadproc loader) {
+  State &state = GetState();
+  const char *name = nullptr;
+  if (GLExtension::Has("GL_KHR_parallel_shader_compile")) {
+    name = "glMaxShaderCompilerThreadsKHR";
+  } else if (GLExtension::Has("GL_ARB_parallel_shader_compile")) {
+    name = "glMaxShaderCompilerThreadsARB";
+  }
+  state.isSupported = name != nullptr;
+  if (!state.isSupported || loader == nullptr) {
+    return;
+  }
+
+  state.maxShaderCompilerThreads =
+      reinterpret_cast<MaxShaderCompilerThreadsProc>(loader(name));
+  if (state.maxShaderCompilerThreads != nullptr) {
+    state.maxShaderCompilerThreads(kThreadsAuto);
+  }
+}
+
+static inline bool IsSupported() { return GetState().isSupported; }
+
+/**
+ * @brief プログラムのリンクが終わっているか問い合わせます。
+ * @note 拡張が使えない場合は常に true を返すので、結果の取得時にブロックします。
+ */
+static inline bool IsProgramCompleted(GLuint program) {
+  if (!IsSupported()) {
+    return true;
+  }
+  GLint status = GL_FALSE;
+  glGetProgramiv(program, kCompletionStatus, &status);
+  return status == GL_TRUE;
+}
+
+} // namespace ParallelShaderCompile
+
+#endif
@@ -0,0 +1,203 @@
+/**
+ * @brief  Program binary cache
+ * @note   リンク済みプログラムを glGetProgramBinary でディスクに保存し、
+ * 次回起動時は glProgramBinary で復元してコンパイルとリンクを省略します。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef PROGRAM_BINARY_CACHE_H
+#define PROGRAM_BINARY_CACHE_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace ProgramBinaryCache {
+
+/**< @brief キャッシュの保存先を変更する環境変数 */
+static constexpr const char *kDirEnv = "REGL_SHADER_CACHE_DIR";
+/**< @brief 設定されていればキャッシュを使わない環境変数 */
+static constexpr const char *kDisableEnv = "REGL_NO_SHADER_CACHE";
+static constexpr const char *kDefaultDir = "./ShaderCache";
+
+static constexpr std::uint32_t kMagic = 0x42504c47; // "GLPB"
+static constexpr std::uint32_t kFileVersion = 1;
+
+static constexpr std::uint64_t kHashSeed = 0xcbf29ce484222325ull;
+static constexpr std::uint64_t kHashPrime = 0x100000001b3ull;
+
+/**< @brief キャッシュファイルの先頭に置くヘッダー */
+struct Header {
+  std::uint32_t magic = kMagic;
+  std::uint32_t version = kFileVersion;
+  std::uint64_t key = 0;
+  std::uint32_t format = 0;
+  std::uint32_t size = 0;
+};
+
+/**
+ * @brief FNV-1a で文字列をハッシュに混ぜます。
+ * @note 連結の区切りで衝突しないよう、長さも混ぜておきます。
+ */
+static inline std::uint64_t Hash(std::string_view data,
+                                 std::uint64_t hash = kHashSeed) {
+  const auto mix = [&hash](std::uint8_t byte) {
+    hash ^= byte;
+    hash *= kHashPrime;
+  };
+  std::uint64_t length = data.size();
+  for (int i = 0; i < 8; i++) {
+    mix(static_cast<std::uint8_t>(length >> (i * 8)));
+  }
+  for (const char c : data) {
+    mix(static_cast<std::uint8_t>(c));
+  }
+  return hash;
+}
+
+/**
+ * @brief ドライバーの情報をハッシュに混ぜます。
+ * @note ドライバーが更新されるとバイナリは使えなくなるため、キーに含めておきます。
+ */
+static inline std::uint64_t HashDriver(std::uint64_t hash) {
+  for (const GLenum name : {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+    const auto *str = reinterpret_cast<const char *>(glGetString(name));
+    hash = Hash(str != nullptr ? str : "", hash);
+  }
+  return hash;
+}
+
+/**
+ * @brief キャッシュが使えるか判定します。
+ * @note ドライバーがバイナリ形式を一つも公開していなければ使えません。
+ */
+static inline bool IsEnabled() {
+  if (std::getenv(kDisableEnv) != nullptr) {
+    return false;
+  }
+  GLint formats = 0;
+  glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  return formats > 0;
+}
+
+static inline std::filesystem::path GetPath(std::uint64_t key) {
+  const char *env = std::getenv(kDirEnv);
+  const std::filesystem::path dir(env != nullptr ? env : kDefaultDir);
+
+  static constexpr const char *kDigits = "0123456789abcdef";
+  std::string name(16, '0');
+  for (int i = 15; i >= 0; i--, key >>= 4) {
+    name[static_cast<std::size_t>(i)] = kDigits[key & 0xf];
+  }
+  return dir / (name + ".bin");
+}
+
+/**
+ * @brief キャッシュからプログラムを復元します。
+ * @return 復元してリンク済みになれば true
+ * @note ドライバーに拒否されたファイルは削除し、呼び出し側はソースからビルドし直します。
+ */
+static inline bool Load(GLuint program, std::uint64_t key) {
+  const std::filesystem::path path = GetPath(key);
+  std::ifstream ifs(path, std::ios::in | std::ios::binary);
+  if (!ifs) {
+    return false;
+  }
+
+  Header header{};
+  ifs.read(reinterpret_cast<char *>(&header), sizeof(header));
+  std::vector<char> binary{};
+  bool isValid = ifs && header.magic == kMagic &&
+                 header.version == kFileVersion && header.key == key;
+  if (isValid) {
+    binary.resize(header.size);
+    ifs.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+    isValid = static_cast<bool>(ifs);
+  }
+  ifs.close();
+
+  if (isValid) {
+    glProgramBinary(program, header.format, binary.data(),
+                    static_cast<GLsizei>(binary.size()));
+    GLint status = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &status);
+    isValid = status == GL_TRUE;
+  }
+  if (!isValid) {
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+  }
+  return isValid;
+}
+
+/**
+ * @brief リンク済みのプログラムをキャッシュに保存します。
+ * @note 複数のプロセスが同時に書き込んでも壊れないよう、一時ファイルに書いてから置き換えます。
+ */
+static inline std::optional<std::string> Store(GLuint program,
+                                               std::uint64_t key) {
+  GLint length = 0;
+  glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0) {
+    return std::string("Program binary is not available.");
+  }
+
+  Header header{};
+  header.key = key;
+  std::vector<char> binary(static_cast<std::size_t>(length));
+  GLsizei written = 0;
+  GLenum format = GL_NONE;
+  glGetProgramBinary(program, length, &written, &format, binary.data());
+  header.format = format;
+  header.size = static_cast<std::uint32_t>(written);
+
+  const std::filesystem::path path = GetPath(key);
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  if (ec) {
+    return std::string("Can't create directory : ") +
+           path.parent_path().string();
+  }
+
+  std::filesystem::path tmp = path;
+  tmp += ".tmp";
+  {
+    std::ofstream ofs(tmp, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!ofs) {
+      return std::string("Can't open file : ") + tmp.string();
+    }
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    ofs.write(binary.data(), written);
+    if (!ofs) {
+      return std::string("Can't write file : ") + tmp.string();
+    }
+  }
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+    return std::string("Can't rename file : ") + path.string();
+  }
+  return std::nullopt;
+}
+
+} // namespace ProgramBinaryCache
+
+#endif
@@ -0,0 +1,136 @@
+/**
+ * @brief  Shared sampler objects
+ * @note   フィルタリングの設定をテクスチャから切り離し、同じ設定のサンプラーを共有します。
+ * 異方性フィルタリングの強さは全てのサンプラーでまとめて変更できます。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "Graphics/GLExtension.h"
+#include "Graphics/GLState.h"
+#include "Utils/Singleton.h"
+
+// ********************************************************************************
+// Struct(s)
+// ********************************************************************************
+
+/**< @brief サンプラーの設定 */
+struct SamplerDesc {
+  GLenum minFilter = GL_LINEAR_MIPMAP_LINEAR;
+  GLenum magFilter = GL_LINEAR;
+  GLenum wrap = GL_REPEAT;
+  bool isAnisotropic = true; // SamplerCache の異方性の設定に従う
+
+  bool operator==(const SamplerDesc &rhs) const {
+    return minFilter == rhs.minFilter && magFilter == rhs.magFilter &&
+           wrap == rhs.wrap && isAnisotropic == rhs.isAnisotropic;
+  }
+};
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief Sampler Cache Class
+ * @code
+ *   GLState::Get().BindSampler(0, SamplerCache::Get().Find(SamplerDesc{}));
+ * @endcode
+ * @note サンプラーはコンテキストが有効な間に Destroy() で破棄してください。
+ */
+class SamplerCache : public Singleton<SamplerCache> {
+public:
+  static constexpr inline float kDefaultAnisotropy = 8.0f;
+
+  SamplerCache() {
+    isAnisotropySupported_ =
+        GLAD_GL_VERSION_4_6 != 0 ||
+        GLExtension::Has("GL_ARB_texture_filter_anisotropic") ||
+        GLExtension::Has("GL_EXT_texture_filter_anisotropic");
+    if (isAnisotropySupported_) {
+      glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &maxAnisotropy_);
+    }
+    anisotropy_ = std::min(kDefaultAnisotropy, maxAnisotropy_);
+  }
+
+  ~SamplerCache() {
+    for (const auto &[desc, sampler] : samplers_) {
+      GLState::DeleteSamplers(1, &sampler);
+    }
+  }
+
+  /**
+   * @brief 設定に一致するサンプラーを返します。無ければ作成します。
+   */
+  GLuint Find(const SamplerDesc &desc) {
+    for (const auto &[key, sampler] : samplers_) {
+      if (key == desc) {
+        return sampler;
+      }
+    }
+
+    GLuint sampler = 0;
+    glGenSamplers(1, &sampler);
+    glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER,
+                        static_cast<GLint>(desc.minFilter));
+    glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER,
+                        static_cast<GLint>(desc.magFilter));
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S,
+                        static_cast<GLint>(desc.wrap));
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T,
+                        static_cast<GLint>(desc.wrap));
+    glSamplerParameteri(sampler, GL_TEXTURE_WRAP_R,
+                        static_cast<GLint>(desc.wrap));
+    samplers_.emplace_back(desc, sampler);
+    ApplyAnisotropy(desc, sampler);
+    return sampler;
+  }
+
+  /**
+   * @brief 異方性フィルタリングの強さを変更します。
+   * @param level 1 で無効 (ハードウェアの上限に丸めます)
+   */
+  void SetAnisotropy(float level) {
+    const float clamped = std::clamp(level, 1.0f, maxAnisotropy_);
+    if (clamped == anisotropy_) {
+      return;
+    }
+    anisotropy_ = clamped;
+    for (const auto &[desc, sampler] : samplers_) {
+      ApplyAnisotropy(desc, sampler);
+    }
+  }
+
+  float GetAnisotropy() const { return anisotropy_; }
+  float GetMaxAnisotropy() const { return maxAnisotropy_; }
+  bool IsAnisotropySupported() const { return isAnisotropySupported_; }
+
+private:
+  void ApplyAnisotropy(const SamplerDesc &desc, GLuint sampler) const {
+    if (isAnisotropySupported_ && desc.isAnisotropic) {
+      glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, anisotropy_);
+    }
+  }
+
+  bool isAnisotropySupported_ = false;
+  float maxAnisotropy_ = 1.0f;
+  float anisotropy_ = 1.0f;
+  std::vector<std::pair<SamplerDesc, GLuint>> samplers_{}; // 数が少ないので線形探索します。
+};
+
+#endif
@@ -8,7 +8,11 @@
 //*--------------------------------------------------------------------------------
 
 #include "Graphics/Shader.h"
+#include "Graphics/GLState.h"
+#include "Graphics/ParallelShaderCompile.h"
+#include "Graphics/ProgramBinaryCache.h"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -28,20 +32,8 @@ ShaderProgram::~ShaderProgram() {
     return;
   }
 
-  // Query the number of attached shaders
-  GLint num = 0;
-  glGetProgramiv(handle_, GL_ATTACHED_SHADERS, &num);
-
-  // Get the shader names
-  GLuint *names = new GLuint[static_cast<std::size_t>(num)];
-  glGetAttachedShaders(handle_, num, nullptr, names);
-
-  // Delete
-  for (GLint i = 0; i < num; i++) {
-    glDeleteShader(names[i]);
-  }
-  delete[] names;
-  glDeleteProgram(handle_);
+  ReleaseShaders();
+  GLState::DeleteProgram(handle_);
 }
 
 //*--------------------------------------------------------------------------------
@@ -49,32 +41,11 @@ ShaderProgram::~ShaderProgram() {
 //*--------------------------------------------------------------------------------
 
 bool ShaderProgram::Compile(const std::string &filepath, ShaderType type) {
-
-  if (!IsFileExists(filepath)) {
-    log_ = std::string("File Not Found : ") + filepath;
-    return false;
-  }
-
-  if (handle_ <= 0) {
-
-    handle_ = glCreateProgram();
-    if (handle_ == 0) {
-      log_ = "Unable to create shader program.";
-      return false;
-    }
-  }
-
-  std::ifstream infile(filepath, std::ios::in);
-  if (!infile) {
-    log_ = std::string("Can't open file : ") + filepath;
+  std::string src;
+  if (!ReadSource(filepath, {}, src)) {
     return false;
   }
-
-  std::stringstream code;
-  code << infile.rdbuf();
-  infile.close();
-
-  return CompileShader(code.str(), type);
+  return CompileShader(src, type);
 }
 
 bool ShaderProgram::Link() {
@@ -87,34 +58,121 @@ bool ShaderProgram::Link() {
   }
 
   glLinkProgram(handle_);
+  return !FinishLink(std::nullopt).has_value();
+}
 
+std::optional<std::string>
+ShaderProgram::FinishLink(const std::optional<std::uint64_t> &cacheKey) {
   // Check for errors
+  // (並列コンパイルが有効な場合は、ここで初めてコンパイルとリンクの完了を待ちます。)
   int status = GL_FALSE;
   glGetProgramiv(handle_, GL_LINK_STATUS, &status);
   if (GL_FALSE == status) {
-    StoreLog(handle_);
+    if (!StoreCompileLog()) {
+      StoreLog(handle_);
+    }
+    ReleaseShaders();
+    return std::make_optional(log_);
+  }
+
+  // リンク済みのプログラムはシェーダーオブジェクトを参照しないので、ここで破棄します。
+  ReleaseShaders();
+  isLinked_ = true;
+  ReflectUniforms();
+  if (cacheKey.has_value()) {
+    if (const auto msg = ProgramBinaryCache::Store(handle_, cacheKey.value())) {
+      std::cerr << msg.value() << std::endl;
+    }
+  }
+  return std::nullopt;
+}
+
+bool ShaderProgram::StoreCompileLog() {
+  // リンクに失敗した原因がコンパイルエラーであれば、そちらのログを優先します。
+  for (const GLuint shader : shaders_) {
+    int res = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &res);
+    if (GL_FALSE == res) {
+      StoreLog(shader);
+      return true;
+    }
+  }
+  return false;
+}
+
+void ShaderProgram::ReleaseShaders() {
+  for (const GLuint shader : shaders_) {
+    glDetachShader(handle_, shader);
+    glDeleteShader(shader);
+  }
+  shaders_.clear();
+}
+
+bool ShaderProgram::IsLinkCompleted() const {
+  return isLinked_ || handle_ == 0 ||
+         ParallelShaderCompile::IsProgramCompleted(handle_);
+}
+
+bool ShaderProgram::CreateProgram() {
+  if (handle_ <= 0) {
+
+    handle_ = glCreateProgram();
+    if (handle_ == 0) {
+      log_ = "Unable to create shader program.";
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ShaderProgram::ReadSource(const std::string &filepath,
+                               const ShaderDefines &defines,
+                               std::string &src) {
+  if (!IsFileExists(filepath)) {
+    log_ = std::string("File Not Found : ") + filepath;
+    return false;
+  }
+
+  // #include の展開と定義の挿入を済ませたソースをドライバーに渡します。
+  if (auto msg = ShaderPreprocessor::Process(filepath, defines, src)) {
+    log_ = msg.value();
     return false;
-  } else {
-    isLinked_ = true;
-    return isLinked_;
   }
+  return true;
 }
 
-bool ShaderProgram::CompileShader(const std::string &src, ShaderType type) {
-  GLuint handle = CreateShader(type);
+GLuint ShaderProgram::SubmitShader(const std::string &src, ShaderType type) {
+  if (!CreateProgram()) {
+    return 0;
+  }
+  const GLuint handle = CreateShader(type);
+  if (handle == 0) {
+    log_ = "Unable to create shader.";
+    return 0;
+  }
 
   const char *code = src.c_str();
   glShaderSource(handle, 1, std::addressof(code), nullptr);
   glCompileShader(handle);
+  return handle;
+}
+
+bool ShaderProgram::CompileShader(const std::string &src, ShaderType type) {
+  const GLuint handle = SubmitShader(src, type);
+  if (handle == 0) {
+    return false;
+  }
 
   // Check for errors
   int res = GL_FALSE;
   glGetShaderiv(handle, GL_COMPILE_STATUS, &res);
   if (GL_FALSE == res) {
     StoreLog(handle);
+    glDeleteShader(handle);
     return false;
   } else {
     glAttachShader(handle_, handle);
+    shaders_.emplace_back(handle);
     return true;
   }
 }
@@ -144,7 +202,80 @@ GLuint ShaderProgram::CreateShader(ShaderType type) const {
 
 void ShaderProgram::Use() const {
   if (handle_ > 0 && isLinked_) {
-    glUseProgram(handle_);
+    GLState::Get().UseProgram(handle_);
+  }
+}
+
+//*--------------------------------------------------------------------------------
+// Reflection
+//*--------------------------------------------------------------------------------
+
+void ShaderProgram::ReflectUniforms() {
+  uniforms_.clear();
+
+  if (GLAD_GL_VERSION_4_3) {
+    GLint num = 0;
+    GLint maxLength = 0;
+    glGetProgramInterfaceiv(handle_, GL_UNIFORM, GL_ACTIVE_RESOURCES, &num);
+    glGetProgramInterfaceiv(handle_, GL_UNIFORM, GL_MAX_NAME_LENGTH,
+                            &maxLength);
+
+    std::string name(static_cast<std::size_t>(maxLength), '\0');
+    const GLenum props[] = {GL_LOCATION, GL_ARRAY_SIZE};
+    for (GLint i = 0; i < num; i++) {
+      GLint values[2] = {-1, 0};
+      glGetProgramResourceiv(handle_, GL_UNIFORM, static_cast<GLuint>(i), 2,
+                             props, 2, nullptr, values);
+      GLsizei length = 0;
+      glGetProgramResourceName(handle_, GL_UNIFORM, static_cast<GLuint>(i),
+                               maxLength, &length, name.data());
+      AddUniform(std::string(name.data(), static_cast<std::size_t>(length)),
+                 values[0], values[1]);
+    }
+  } else {
+    // GL 4.3 未満 (macOS) では古い API で列挙します。
+    GLint num = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(handle_, GL_ACTIVE_UNIFORMS, &num);
+    glGetProgramiv(handle_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string name(static_cast<std::size_t>(maxLength), '\0');
+    for (GLint i = 0; i < num; i++) {
+      GLsizei length = 0;
+      GLint size = 0;
+      GLenum type = GL_NONE;
+      glGetActiveUniform(handle_, static_cast<GLuint>(i), maxLength, &length,
+                         &size, &type, name.data());
+      const std::string uniform(name.data(), static_cast<std::size_t>(length));
+      AddUniform(uniform, glGetUniformLocation(handle_, uniform.c_str()), size);
+    }
+  }
+}
+
+void ShaderProgram::AddUniform(const std::string &name, GLint location,
+                               GLint size) {
+  // ユニフォームブロック内の変数はロケーションを持ちません。
+  if (location < 0) {
+    return;
+  }
+  const GLsizei count = std::max(size, 1);
+  uniforms_.emplace(name, UniformInfo{location, count});
+
+  // 配列は "Name[0]" で報告されるので、"Name" と各要素の名前でも引けるようにします。
+  static constexpr const char *kFirstElement = "[0]";
+  static constexpr std::size_t kSuffixLength = 3;
+  if (name.size() <= kSuffixLength ||
+      name.compare(name.size() - kSuffixLength, kSuffixLength,
+                   kFirstElement) != 0) {
+    return;
+  }
+  const std::string base = name.substr(0, name.size() - kSuffixLength);
+  uniforms_.emplace(base, UniformInfo{location, count});
+  for (GLint i = 1; i < size; i++) {
+    const std::string element = base + "[" + std::to_string(i) + "]";
+    uniforms_.emplace(element,
+                      UniformInfo{glGetUniformLocation(handle_, element.c_str()),
+                                  count - i});
   }
 }
 
@@ -156,14 +287,23 @@ void ShaderProgram::StoreLog(GLuint handle) {
   int length = 0;
   log_ = "";
 
-  glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &length);
+  const bool isShader = glIsShader(handle) == GL_TRUE;
+  if (isShader) {
+    glGetShaderiv(handle, GL_INFO_LOG_LENGTH, &length);
+  } else {
+    glGetProgramiv(handle, GL_INFO_LOG_LENGTH, &length);
+  }
   if (length <= 0) {
     return;
   }
 
   std::string log(length, ' ');
   int written = 0;
-  glGetProgramInfoLog(handle, length, &written, &log[0]);
+  if (isShader) {
+    glGetShaderInfoLog(handle, length, &written, &log[0]);
+  } else {
+    glGetProgramInfoLog(handle, length, &written, &log[0]);
+  }
   log_ = log;
 }
 
@@ -172,11 +312,94 @@ void ShaderProgram::StoreLog(GLuint handle) {
 //*--------------------------------------------------------------------------------
 
 std::optional<std::string> ShaderProgram::CompileAndLink(
-    const std::vector<std::pair<std::string, ShaderType>> &shaders) {
-  for (const auto &info : shaders) {
-    if (!Compile(info.first, info.second)) {
-      return std::make_optional(log_);
+    const std::vector<std::pair<std::string, ShaderType>> &shaders,
+    const ShaderDefines &defines) {
+  return CompileAndLinkAsync(shaders, defines).Get();
+}
+
+ShaderProgram::LinkFuture ShaderProgram::CompileAndLinkAsync(
+    const std::vector<std::pair<std::string, ShaderType>> &shaders,
+    const ShaderDefines &defines) {
+  std::vector<std::string> sources(shaders.size());
+  for (std::size_t i = 0; i < shaders.size(); i++) {
+    if (!ReadSource(shaders[i].first, defines, sources[i])) {
+      return LinkFuture(std::make_optional(log_));
+    }
+  }
+
+  // キーは展開後のソース (定義を含む) とステージの種類、ドライバーの情報から作ります。
+  std::optional<std::uint64_t> cacheKey = std::nullopt;
+  if (ProgramBinaryCache::IsEnabled()) {
+    std::uint64_t key = ProgramBinaryCache::kHashSeed;
+    for (std::size_t i = 0; i < shaders.size(); i++) {
+      key = ProgramBinaryCache::Hash(
+          std::to_string(static_cast<int>(shaders[i].second)), key);
+      key = ProgramBinaryCache::Hash(sources[i], key);
+    }
+    key = ProgramBinaryCache::HashDriver(key);
+    if (LoadBinary(key)) {
+      return LinkFuture(std::nullopt);
     }
+    cacheKey = key;
   }
-  return Link() ? std::nullopt : std::make_optional(log_);
+
+  // 各ステージのコンパイル結果は確認せずにリンクまで発行します。
+  for (std::size_t i = 0; i < shaders.size(); i++) {
+    const GLuint shader = SubmitShader(sources[i], shaders[i].second);
+    if (shader == 0) {
+      ReleaseShaders();
+      return LinkFuture(std::make_optional(log_));
+    }
+    glAttachShader(handle_, shader);
+    shaders_.emplace_back(shader);
+  }
+  if (cacheKey.has_value()) {
+    glProgramParameteri(handle_, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+  glLinkProgram(handle_);
+
+  return LinkFuture([this]() { return IsLinkCompleted(); },
+                    [this, cacheKey]() { return FinishLink(cacheKey); });
+}
+
+std::optional<std::string>
+ShaderProgram::WaitAll(std::vector<LinkFuture> &futures) {
+  std::optional<std::string> result = std::nullopt;
+  const auto finish = [&result](LinkFuture &future) {
+    auto msg = future.Get();
+    if (msg && !result) {
+      result = std::move(msg);
+    }
+  };
+
+  // 完了したものから確定させ、リフレクションやキャッシュへの保存を残りのリンクと重ねます。
+  std::vector<LinkFuture *> pending;
+  for (auto &future : futures) {
+    if (future.IsReady()) {
+      finish(future);
+    } else {
+      pending.emplace_back(&future);
+    }
+  }
+  // 失敗しても残りのプログラムの状態を確定させるため、全て待ちます。
+  for (LinkFuture *future : pending) {
+    finish(*future);
+  }
+  return result;
+}
+
+bool ShaderProgram::LoadBinary(std::uint64_t key) {
+  if (isLinked_ || !CreateProgram()) {
+    return false;
+  }
+  if (ProgramBinaryCache::Load(handle_, key)) {
+    isLinked_ = true;
+    ReflectUniforms();
+    return true;
+  }
+
+  // 拒否されたプログラムオブジェクトは使わず、ソースからのビルドは新しいオブジェクトで行います。
+  GLState::DeleteProgram(handle_);
+  handle_ = 0;
+  return false;
 }
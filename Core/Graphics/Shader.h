@@ -16,15 +16,22 @@
 
 #include "GLInclude.h"
 
+#include "Graphics/ShaderPreprocessor.h"
+
 #include <boost/assert.hpp>
+#include <algorithm>
 #include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
 #include <filesystem>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -44,11 +51,79 @@ enum class ShaderType {
   Compute,
 };
 
+/**
+ * @brief シェーダーに渡す定義 (#define) の組
+ */
+using ShaderDefines = ShaderPreprocessor::Defines;
+
+/**
+ * @brief 型付きのユニフォーム変数のハンドル
+ * @note リンク後に一度だけ解決しておけば、描画時に名前の検索は発生しません。
+ * 配列の場合は、その位置から書き込める要素の数も持ちます。
+ */
+template <typename T> class Uniform {
+public:
+  using ValueType = T;
+
+  Uniform() = default;
+  explicit Uniform(GLint location, GLsizei count = 1)
+      : location_(location), count_(count) {}
+
+  bool IsValid() const { return location_ >= 0; }
+  GLint GetLocation() const { return location_; }
+  GLsizei GetCount() const { return count_; }
+
+private:
+  GLint location_ = -1;
+  GLsizei count_ = 1;
+};
+
 /**
  * @brief GLSL Shader Program Class
  */
 class ShaderProgram : private boost::noncopyable {
 public:
+  /**
+   * @brief 発行済みのリンクの結果 (失敗した場合はログ) を受け取るハンドル
+   * @note IsReady でブロックせずに完了を問い合わせ、Get で結果を確定させます。
+   * どちらも GL コンテキストのあるスレッドで呼んでください。
+   */
+  class LinkFuture {
+  public:
+    using Result = std::optional<std::string>;
+
+    LinkFuture() = default;
+    /**< @brief 結果が既に決まっている場合 */
+    explicit LinkFuture(Result result)
+        : result_(std::move(result)), isDone_(true) {}
+    /**
+     * @param poll 完了していれば true を返す関数
+     * @param finish 完了を待って結果を返す関数 (一度だけ呼びます)
+     */
+    LinkFuture(std::function<bool()> poll, std::function<Result()> finish)
+        : poll_(std::move(poll)), finish_(std::move(finish)) {}
+
+    bool IsValid() const { return isDone_ || finish_ != nullptr; }
+    bool IsReady() const { return isDone_ || poll_ == nullptr || poll_(); }
+
+    /**< @brief 完了を待って結果を返します。 */
+    Result Get() {
+      if (!isDone_ && finish_ != nullptr) {
+        result_ = finish_();
+        isDone_ = true;
+        finish_ = nullptr;
+        poll_ = nullptr;
+      }
+      return result_;
+    }
+
+  private:
+    std::function<bool()> poll_ = nullptr;
+    std::function<Result()> finish_ = nullptr;
+    Result result_ = std::nullopt;
+    bool isDone_ = false;
+  };
+
   ShaderProgram() = default;
   ~ShaderProgram();
 
@@ -69,8 +144,29 @@ public:
   // Utility
   //*--------------------------------------------------------------------------------
 
-  std::optional<std::string> CompileAndLink(
-      const std::vector<std::pair<std::string, ShaderType>> &shaders);
+  /**
+   * @brief 全ステージをコンパイルしてリンクします。
+   * @param defines 各ステージの #version の直後に挿入する定義
+   * @note ドライバーが対応していれば、リンク結果をディスクにキャッシュして次回から再利用します。
+   */
+  std::optional<std::string>
+  CompileAndLink(const std::vector<std::pair<std::string, ShaderType>> &shaders,
+                 const ShaderDefines &defines = {});
+
+  /**
+   * @brief 全ステージのコンパイルとリンクをその場で発行し、結果を LinkFuture で返します。
+   * @note 状態の問い合わせは Get まで行わないため、その間にドライバーが別スレッドで
+   * コンパイルを進めます。完了したかは IsReady (IsLinkCompleted) で問い合わせられます。
+   */
+  LinkFuture CompileAndLinkAsync(
+      const std::vector<std::pair<std::string, ShaderType>> &shaders,
+      const ShaderDefines &defines = {});
+
+  /**
+   * @brief 複数のプログラムのリンクを待ち、最初のエラーを返します。
+   * @note 完了したものから順に結果を確定させます。
+   */
+  static std::optional<std::string> WaitAll(std::vector<LinkFuture> &futures);
 
   //*--------------------------------------------------------------------------------
   // Bind Location
@@ -84,6 +180,39 @@ public:
     glBindFragDataLocation(handle_, location, name);
   }
 
+  /**
+   * @note GLSL 4.10 では layout(binding) が使えないため、リンク後にこちらで割り当てます。
+   * @return プログラムがブロックを使っていなければ false
+   */
+  bool BindUniformBlock(const char *name, GLuint binding) const {
+    const GLuint index = glGetUniformBlockIndex(handle_, name);
+    if (index == GL_INVALID_INDEX) {
+      return false;
+    }
+    glUniformBlockBinding(handle_, index, binding);
+    return true;
+  }
+
+  /**
+   * @note シェーダーストレージブロック (GL 4.3 以降) を結合ポイントに割り当てます。
+   * @return プログラムがブロックを使っていなければ false
+   */
+  bool BindStorageBlock(const char *name, GLuint binding) const {
+#if !defined(__APPLE__)
+    const GLuint index =
+        glGetProgramResourceIndex(handle_, GL_SHADER_STORAGE_BLOCK, name);
+    if (index == GL_INVALID_INDEX) {
+      return false;
+    }
+    glShaderStorageBlockBinding(handle_, index, binding);
+    return true;
+#else
+    static_cast<void>(name);
+    static_cast<void>(binding);
+    return false;
+#endif
+  }
+
   //*--------------------------------------------------------------------------------
   // Accessor
   //*--------------------------------------------------------------------------------
@@ -92,10 +221,19 @@ public:
   GLuint GetHandle() const { return handle_; }
   bool IsLinked() const { return isLinked_; }
 
+  /**
+   * @brief ブロックせずにリンクが終わっているか問い合わせます。
+   * @note 並列コンパイルの拡張が無い環境では常に true になります。
+   */
+  bool IsLinkCompleted() const;
+
   //*--------------------------------------------------------------------------------
   // Setting Uniform Variable(s)
   //*--------------------------------------------------------------------------------
 
+  void SetUniform(const char *name, const glm::vec2 &v) const {
+    SetUniform(name, glUniform2f, v.x, v.y);
+  }
   void SetUniform(const char *name, float x, float y, float z) const {
     SetUniform(name, glUniform3f, x, y, z);
   }
@@ -123,6 +261,47 @@ public:
     SetUniform(name, static_cast<int>(b));
   }
 
+  //*--------------------------------------------------------------------------------
+  // Typed Uniform Handle(s)
+  //*--------------------------------------------------------------------------------
+
+  template <typename T> Uniform<T> GetUniform(const char *name) const {
+    const auto it = uniforms_.find(name);
+    return it != uniforms_.end()
+               ? Uniform<T>(it->second.location, it->second.count)
+               : Uniform<T>();
+  }
+
+  template <typename T>
+  void SetUniform(const Uniform<T> &uniform,
+                  const typename Uniform<T>::ValueType &value) const {
+    if (uniform.IsValid()) {
+      Upload(uniform.GetLocation(), value);
+    }
+#if !defined(NDEBUG)
+    else {
+      BOOST_ASSERT_MSG(false, "Uniform handle is invalid.");
+    }
+#endif
+  }
+
+  /**
+   * @brief 配列のユニフォーム変数に values の先頭 count 個を書き込みます。
+   * @note リフレクションで得た要素の数を超える分は書き込みません。
+   */
+  template <typename T>
+  void SetUniform(const Uniform<T> &uniform,
+                  const typename Uniform<T>::ValueType *values,
+                  std::size_t count) const {
+    BOOST_ASSERT_MSG(uniform.IsValid(), "Uniform handle is invalid.");
+    BOOST_ASSERT_MSG(count <= static_cast<std::size_t>(uniform.GetCount()),
+                     "Too many elements for the uniform array.");
+    if (uniform.IsValid()) {
+      Upload(uniform.GetLocation(), values,
+             std::min(static_cast<GLsizei>(count), uniform.GetCount()));
+    }
+  }
+
 private:
   //*--------------------------------------------------------------------------------
   // Private functions
@@ -134,7 +313,7 @@ private:
     if (location >= 0) {
       f(location, std::forward<Args>(args)...);
     }
-#if (!NDEBUG)
+#if !defined(NDEBUG)
     else {
       BOOST_ASSERT_MSG(false, "Failed to get uniform location.");
     }
@@ -142,7 +321,48 @@ private:
   }
 
   int GetUniformLocation(const char *name) const {
-    return glGetUniformLocation(handle_, name);
+    // リンク時に列挙したテーブルから引くので、ドライバへの問い合わせは発生しません。
+    const auto it = uniforms_.find(name);
+    return it != uniforms_.end() ? it->second.location : -1;
+  }
+
+  static void Upload(GLint location, float f) { glUniform1f(location, f); }
+  static void Upload(GLint location, int i) { glUniform1i(location, i); }
+  static void Upload(GLint location, bool b) {
+    glUniform1i(location, static_cast<int>(b));
+  }
+  static void Upload(GLint location, const glm::vec2 &v) {
+    glUniform2f(location, v.x, v.y);
+  }
+  static void Upload(GLint location, const glm::vec3 &v) {
+    glUniform3f(location, v.x, v.y, v.z);
+  }
+  static void Upload(GLint location, const glm::vec4 &v) {
+    glUniform4f(location, v.x, v.y, v.z, v.w);
+  }
+  static void Upload(GLint location, const glm::mat3 &m) {
+    glUniformMatrix3fv(location, 1, GL_FALSE, std::addressof(m[0][0]));
+  }
+  static void Upload(GLint location, const glm::mat4 &m) {
+    glUniformMatrix4fv(location, 1, GL_FALSE, std::addressof(m[0][0]));
+  }
+  static void Upload(GLint location, const float *v, GLsizei n) {
+    glUniform1fv(location, n, v);
+  }
+  static void Upload(GLint location, const int *v, GLsizei n) {
+    glUniform1iv(location, n, v);
+  }
+  static void Upload(GLint location, const glm::vec2 *v, GLsizei n) {
+    glUniform2fv(location, n, std::addressof(v[0][0]));
+  }
+  static void Upload(GLint location, const glm::vec3 *v, GLsizei n) {
+    glUniform3fv(location, n, std::addressof(v[0][0]));
+  }
+  static void Upload(GLint location, const glm::vec4 *v, GLsizei n) {
+    glUniform4fv(location, n, std::addressof(v[0][0]));
+  }
+  static void Upload(GLint location, const glm::mat4 *m, GLsizei n) {
+    glUniformMatrix4fv(location, n, GL_FALSE, std::addressof(m[0][0][0]));
   }
 
   bool IsFileExists(const std::string &filepath) const {
@@ -151,9 +371,20 @@ private:
     return !ec && result;
   }
 
+  bool CreateProgram();
+  bool ReadSource(const std::string &filepath, const ShaderDefines &defines,
+                  std::string &src);
+  GLuint SubmitShader(const std::string &src, ShaderType type);
   bool CompileShader(const std::string &src, ShaderType type);
+  std::optional<std::string>
+  FinishLink(const std::optional<std::uint64_t> &cacheKey);
+  bool StoreCompileLog();
+  void ReleaseShaders();
+  bool LoadBinary(std::uint64_t key);
   GLuint CreateShader(ShaderType type) const;
   void StoreLog(GLuint handle);
+  void ReflectUniforms();
+  void AddUniform(const std::string &name, GLint location, GLint size);
 
   //*--------------------------------------------------------------------------------
   // Member Variable(s)
@@ -162,6 +393,12 @@ private:
   GLuint handle_ = 0;
   bool isLinked_ = false;
   std::string log_;
+  std::vector<GLuint> shaders_{}; // リンクが終わるまで保持するシェーダーオブジェクト
+  struct UniformInfo {
+    GLint location = -1;
+    GLsizei count = 1; // その位置から書き込める配列の要素の数
+  };
+  std::unordered_map<std::string, UniformInfo> uniforms_{};
 };
 
 #endif
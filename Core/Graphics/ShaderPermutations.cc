@@ -0,0 +1,62 @@
+/**
+ * @brief  Shader permutations
+ */
+
+//*--------------------------------------------------------------------------------
+// Including files
+//*--------------------------------------------------------------------------------
+
+#include "Graphics/ShaderPermutations.h"
+
+//*--------------------------------------------------------------------------------
+// Compile & Link
+//*--------------------------------------------------------------------------------
+
+std::optional<std::string>
+ShaderPermutations::Prepare(const ShaderDefines &defines) {
+  return PrepareAsync(defines).Get();
+}
+
+ShaderProgram::LinkFuture
+ShaderPermutations::PrepareAsync(const ShaderDefines &defines) {
+  const std::string key = ShaderPreprocessor::ToKey(defines);
+  if (programs_.count(key) != 0) {
+    return ShaderProgram::LinkFuture(std::nullopt);
+  }
+  if (const auto it = failures_.find(key); it != failures_.end()) {
+    return ShaderProgram::LinkFuture(std::make_optional(it->second));
+  }
+
+  auto &prog = programs_[key];
+  prog = std::make_unique<ShaderProgram>();
+  ShaderProgram *const target = prog.get();
+  auto link = prog->CompileAndLinkAsync(stages_, defines);
+
+  // 失敗したプログラムは結果を受け取った時点で取り除き、ログを覚えておきます。
+  return ShaderProgram::LinkFuture(
+      [target]() { return target->IsLinkCompleted(); },
+      [this, key, link]() mutable {
+        auto msg = link.Get();
+        if (msg) {
+          programs_.erase(key);
+          failures_.emplace(key, msg.value());
+        }
+        return msg;
+      });
+}
+
+//*--------------------------------------------------------------------------------
+// Accessor
+//*--------------------------------------------------------------------------------
+
+ShaderProgram *ShaderPermutations::Find(const ShaderDefines &defines) const {
+  const auto it = programs_.find(ShaderPreprocessor::ToKey(defines));
+  if (it == programs_.end() || !it->second->IsLinked()) {
+    return nullptr;
+  }
+  return it->second.get();
+}
+
+bool ShaderPermutations::IsFailed(const ShaderDefines &defines) const {
+  return failures_.count(ShaderPreprocessor::ToKey(defines)) != 0;
+}
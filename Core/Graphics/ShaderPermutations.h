@@ -0,0 +1,89 @@
+/**
+ * @brief  Shader permutations
+ * @note   同じソースを定義の組み合わせごとに特殊化してコンパイルし、保持します。
+ * 定数をコンパイル時に決めることでループの展開などが効き、
+ * 品質の段階ごとにシェーダーファイルを複製する必要もなくなります。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef SHADER_PERMUTATIONS_H
+#define SHADER_PERMUTATIONS_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Graphics/Shader.h"
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief Shader Permutation Cache Class
+ * @code
+ *   permutations.SetStages({{"SSAO.vs.glsl", ShaderType::Vertex},
+ *                           {"SSAO.fs.glsl", ShaderType::Fragment}});
+ *   ShaderProgram *prog = permutations.Find({{"KERNEL_SIZE", "32"}});
+ * @endcode
+ * @note ディスク上のプログラムバイナリキャッシュのキーも展開後のソースから作るため、
+ * パーミュテーションごとに別々にキャッシュされます。
+ */
+class ShaderPermutations : private boost::noncopyable {
+public:
+  using Stages = std::vector<std::pair<std::string, ShaderType>>;
+
+  ShaderPermutations() = default;
+  explicit ShaderPermutations(Stages stages) : stages_(std::move(stages)) {}
+
+  /**< @brief ソースを変更します。(コンパイル済みのプログラムと失敗の記録は破棄します。) */
+  void SetStages(Stages stages) {
+    stages_ = std::move(stages);
+    programs_.clear();
+    failures_.clear();
+  }
+
+  /**
+   * @brief 定義の組み合わせに対応するプログラムを用意します。
+   * @note 既にあればコンパイルしません。失敗したものはプログラムを保持せずにログを覚えておき、
+   * 以降は作り直さずに同じログを返します。
+   */
+  std::optional<std::string> Prepare(const ShaderDefines &defines);
+
+  /**
+   * @brief Prepare の非同期版です。結果は ShaderProgram::CompileAndLinkAsync と同じく LinkFuture で返します。
+   */
+  ShaderProgram::LinkFuture PrepareAsync(const ShaderDefines &defines);
+
+  /**
+   * @brief リンク済みのプログラムを探します。
+   * @return 用意されていなければ nullptr
+   */
+  ShaderProgram *Find(const ShaderDefines &defines) const;
+
+  /**< @brief 定義の組み合わせのコンパイルかリンクに失敗したことがあるか */
+  bool IsFailed(const ShaderDefines &defines) const;
+
+  std::size_t GetSize() const { return programs_.size(); }
+
+private:
+  Stages stages_{};
+  std::unordered_map<std::string, std::unique_ptr<ShaderProgram>> programs_{};
+  std::unordered_map<std::string, std::string> failures_{}; // キーとログ
+};
+
+#endif
@@ -0,0 +1,194 @@
+/**
+ * @brief  GLSL preprocessor
+ * @note   ドライバーに渡す前に #include を展開し、#version の直後に #define を差し込みます。
+ * GLSL には #include が無いため、ここで一つのソースにまとめます。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef SHADER_PREPROCESSOR_H
+#define SHADER_PREPROCESSOR_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace ShaderPreprocessor {
+
+/**< @brief 名前と値の組 (値が空であれば名前だけを定義します) */
+using Defines = std::vector<std::pair<std::string, std::string>>;
+
+/**< @brief 展開中のファイル */
+struct Context {
+  std::vector<std::filesystem::path> included{}; // 展開済み (インデックスが #line の番号)
+  std::vector<std::filesystem::path> stack{};    // 展開中 (循環の検出用)
+  std::string extensions{}; // 読み込んだファイルにあった #extension の行
+};
+
+/**
+ * @brief 定義を名前順に並べ、同じ組み合わせが同じ文字列になるようにします。
+ * @note パーミュテーションのキーに使います。
+ */
+static inline std::string ToKey(Defines defines) {
+  std::sort(defines.begin(), defines.end());
+  std::string key;
+  for (const auto &[name, value] : defines) {
+    key += name + "=" + value + ";";
+  }
+  return key;
+}
+
+static inline std::string ToDirectives(const Defines &defines) {
+  std::string directives;
+  for (const auto &[name, value] : defines) {
+    directives += "#define " + name;
+    if (!value.empty()) {
+      directives += " " + value;
+    }
+    directives += "\n";
+  }
+  return directives;
+}
+
+/**
+ * @brief #include "path" の行であればパスを取り出します。
+ */
+static inline std::optional<std::string> ParseInclude(const std::string &line) {
+  static constexpr const char *kDirective = "#include";
+  const auto begin = line.find_first_not_of(" \t");
+  if (begin == std::string::npos || line.compare(begin, 8, kDirective) != 0) {
+    return std::nullopt;
+  }
+  const auto open = line.find('"', begin + 8);
+  const auto close = open == std::string::npos ? open : line.find('"', open + 1);
+  if (close == std::string::npos) {
+    return std::nullopt;
+  }
+  return line.substr(open + 1, close - open - 1);
+}
+
+/**
+ * @brief #extension の行であれば true を返します。
+ */
+static inline bool IsExtension(const std::string &line) {
+  static constexpr const char *kDirective = "#extension";
+  const auto begin = line.find_first_not_of(" \t");
+  return begin != std::string::npos && line.compare(begin, 10, kDirective) == 0;
+}
+
+/**
+ * @brief ファイルを読み込み、#include を再帰的に展開します。
+ * @note 同じファイルは一度しか展開しません。(#pragma once 相当)
+ * 展開したファイルの行番号がずれないよう、前後に #line を挿入します。
+ */
+static inline std::optional<std::string>
+Expand(const std::filesystem::path &filepath, Context &ctx, std::string &out) {
+  std::ifstream infile(filepath, std::ios::in);
+  if (!infile) {
+    return std::string("Can't open file : ") + filepath.string();
+  }
+  ctx.stack.emplace_back(filepath);
+  ctx.included.emplace_back(filepath);
+  const std::size_t index = ctx.included.size() - 1;
+
+  std::string line;
+  int lineNo = 0;
+  while (std::getline(infile, line)) {
+    lineNo++;
+    // #extension は宣言より前に置く必要があるため、#version の直後に移します。
+    // (行番号がずれないよう、元の位置には空行を残します)
+    if (ctx.stack.size() > 1 && IsExtension(line)) {
+      ctx.extensions += line + "\n";
+      out += "\n";
+      continue;
+    }
+    const auto include = ParseInclude(line);
+    if (!include) {
+      out += line + "\n";
+      continue;
+    }
+
+    const std::filesystem::path path =
+        (filepath.parent_path() / include.value()).lexically_normal();
+    if (std::find(ctx.stack.begin(), ctx.stack.end(), path) !=
+        ctx.stack.end()) {
+      return std::string("Recursive #include : ") + path.string();
+    }
+    if (std::find(ctx.included.begin(), ctx.included.end(), path) !=
+        ctx.included.end()) {
+      out += "\n";
+      continue;
+    }
+
+    out += "#line 1 " + std::to_string(ctx.included.size()) + "\n";
+    if (auto msg = Expand(path, ctx, out)) {
+      return std::string(msg.value()) + "\n  included from " +
+             filepath.string() + ":" + std::to_string(lineNo);
+    }
+    out += "#line " + std::to_string(lineNo + 1) + " " +
+           std::to_string(index) + "\n";
+  }
+  ctx.stack.pop_back();
+  return std::nullopt;
+}
+
+/**
+ * @brief ファイルを読み込み、#include の展開と #define の挿入を行います。
+ * @param out 展開したソース
+ * @return 失敗した場合はエラーメッセージ
+ */
+static inline std::optional<std::string> Process(const std::string &filepath,
+                                                 const Defines &defines,
+                                                 std::string &out) {
+  Context ctx{};
+  std::string src;
+  if (auto msg = Expand(std::filesystem::path(filepath).lexically_normal(), ctx,
+                        src)) {
+    return msg;
+  }
+  if (defines.empty() && ctx.extensions.empty()) {
+    out = std::move(src);
+    return std::nullopt;
+  }
+
+  // #version より前には何も置けないため、その直後に拡張と定義を挿入します。
+  std::istringstream iss(src);
+  std::string line;
+  std::string head;
+  int lineNo = 0;
+  bool hasVersion = false;
+  while (std::getline(iss, line)) {
+    lineNo++;
+    head += line + "\n";
+    if (line.find("#version") != std::string::npos) {
+      hasVersion = true;
+      break;
+    }
+  }
+  if (!hasVersion) {
+    head.clear();
+    lineNo = 0;
+  }
+  out = head + ctx.extensions + ToDirectives(defines) + "#line " + std::to_string(lineNo + 1) +
+        " 0\n" + src.substr(head.size());
+  return std::nullopt;
+}
+
+} // namespace ShaderPreprocessor
+
+#endif
@@ -4,9 +4,15 @@
 
 #include "Graphics/Texture.h"
 
+#include <algorithm>
 #include <boost/assert.hpp>
 #include <iostream>
 
+#include "Graphics/GLExtension.h"
+#include "Graphics/GLState.h"
+#include "Graphics/Mipmap.h"
+#include "Image/TextureContainer.h"
+
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
@@ -21,10 +27,83 @@ namespace Pixels {
   static void Free(unsigned char *data) { stbi_image_free(data); }
 }
 
+namespace Compressed {
+  // S3TC は拡張のため glad には定義がありません。
+  static constexpr GLenum kRGB_S3TC_DXT1 = 0x83F0;
+  static constexpr GLenum kRGBA_S3TC_DXT5 = 0x83F3;
+
+  /**
+   * @brief GL の内部形式を返します。使えなければ 0 を返します。
+   * @note 非圧縮の読み込みと同じく、sRGB の画像も GL_RGBA8 相当の線形の形式で扱います。
+   */
+  static GLenum ToInternalFormat(BlockFormat format) {
+    switch (format) {
+    case BlockFormat::BC1:
+    case BlockFormat::BC3:
+      if (!GLExtension::Has("GL_EXT_texture_compression_s3tc")) {
+        return 0;
+      }
+      return format == BlockFormat::BC1 ? kRGB_S3TC_DXT1 : kRGBA_S3TC_DXT5;
+    case BlockFormat::BC5:
+      return GL_COMPRESSED_RG_RGTC2;
+    case BlockFormat::BC7:
+      if (GLAD_GL_VERSION_4_2 == 0 &&
+          !GLExtension::Has("GL_ARB_texture_compression_bptc")) {
+        return 0;
+      }
+      return GL_COMPRESSED_RGBA_BPTC_UNORM;
+    }
+    return 0;
+  }
+
+  static GLuint Load(const std::string &path) {
+    CompressedTexture texture{};
+    if (const auto msg = TextureContainer::Read(path, texture)) {
+      std::cerr << msg.value() << std::endl;
+      BOOST_ASSERT_MSG(false, "Failed to load texture.");
+      return 0;
+    }
+    const GLenum internalFormat = ToInternalFormat(texture.format);
+    if (internalFormat == 0) {
+      std::cerr << BlockCompression::ToString(texture.format)
+                << " is not supported : " << path << std::endl;
+      BOOST_ASSERT_MSG(false, "Failed to load texture.");
+      return 0;
+    }
+    GLuint tex = 0;
+
+    glGenTextures(1, &tex);
+    GLState::Get().BindTexture(GL_TEXTURE_2D, tex);
+
+    const auto levels = static_cast<GLsizei>(texture.levels.size());
+    glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, texture.width,
+                   texture.height);
+    for (GLsizei level = 0; level < levels; level++) {
+      const auto &data = texture.levels[static_cast<std::size_t>(level)];
+      glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0,
+                                std::max(1, texture.width >> level),
+                                std::max(1, texture.height >> level),
+                                internalFormat,
+                                static_cast<GLsizei>(data.size()), data.data());
+    }
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+
+    GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+    return tex;
+  }
+}
+
 namespace Texture {
-  GLuint Load(const std::string &path) {
+  GLuint Load(const std::string &path, const LoadOptions &options) {
+    if (TextureContainer::IsSupportedPath(path)) {
+      return Compressed::Load(path);
+    }
+
     int w, h;
-    unsigned char *data = Pixels::Load(path, w, h);
+    unsigned char *data = Pixels::Load(path, w, h, options.flip);
     if (data == nullptr) {
       std::cerr << "Failed to load " << path << std::endl;
       BOOST_ASSERT_MSG(false, "Failed to load texture.");
@@ -33,16 +112,26 @@ namespace Texture {
     GLuint tex = 0;
 
     glGenTextures(1, &tex);
-    glBindTexture(GL_TEXTURE_2D, tex);
+    GLState::Get().BindTexture(GL_TEXTURE_2D, tex);
 
-    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, w, h);
+    const int levels = options.useMipmaps ? Mipmap::ComputeLevels(w, h) : 1;
+    glTexStorage2D(GL_TEXTURE_2D, levels, GL_RGBA8, w, h);
     glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, w, h, GL_RGBA, GL_UNSIGNED_BYTE,
                     data);
+    if (options.useMipmaps) {
+      // glGenerateMipmap は RGBA8 を符号化されたまま平均するため、CPU で作ります。
+      Mipmap::Generate(data, w, h, options.isSRGB,
+                       [](int level, int lw, int lh, const unsigned char *px) {
+                         glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, lw, lh,
+                                         GL_RGBA, GL_UNSIGNED_BYTE, px);
+                       });
+    }
 
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER,
+                    options.useMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
     
-    glBindTexture(GL_TEXTURE_2D, 0);
+    GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
     Pixels::Free(data);
     
     return tex;
@@ -9,7 +9,20 @@
 #include <string>
 
 namespace Texture {
-  GLuint Load(const std::string &path);
+  /**< @brief 読み込みの設定 */
+  struct LoadOptions {
+    bool isSRGB = true;      // 色のテクスチャ (縮小を線形空間で行います)
+    bool useMipmaps = true;  // 1x1 までの全レベルを作ります
+    bool flip = true;        // 上下を反転して読み込みます
+  };
+
+  /**
+   * @brief 画像を読み込み、縮小レベルまで埋めたテクスチャを作ります。
+   * @note .ktx2 / .dds はブロック圧縮済みのレベルをそのまま転送します。(options は使いません)
+   * フィルタリングは SamplerCache のサンプラーで指定してください。
+   * (サンプラーを使わない場合のために、テクスチャ側にも trilinear を設定します。)
+   */
+  GLuint Load(const std::string &path, const LoadOptions &options = {});
 // GLuint LoadCubeMap(const std::string &name);
 }
 
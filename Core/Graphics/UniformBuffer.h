@@ -0,0 +1,269 @@
+/**
+ * @brief  Uniform Buffer Object
+ * @note   C++ 側の構造体が std140 レイアウトと一致するかをコンパイル時に検証します。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef UNIFORM_BUFFER_H
+#define UNIFORM_BUFFER_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <array>
+#include <boost/assert.hpp>
+#include <boost/noncopyable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+#include <vector>
+
+// ********************************************************************************
+// std140
+// ********************************************************************************
+
+namespace Std140 {
+
+/**
+ * @brief std140 でのアラインメントとサイズ
+ * @note 特殊化されていない型 (glm::mat3 や bool など) はコンパイルエラーになります。
+ */
+template <typename T> struct Traits;
+
+template <std::size_t Align, std::size_t Size> struct TraitsBase {
+  static constexpr std::size_t kAlignment = Align;
+  static constexpr std::size_t kSize = Size;
+};
+
+template <> struct Traits<float> : TraitsBase<4, 4> {};
+template <> struct Traits<std::int32_t> : TraitsBase<4, 4> {};
+template <> struct Traits<std::uint32_t> : TraitsBase<4, 4> {};
+template <> struct Traits<glm::vec2> : TraitsBase<8, 8> {};
+template <> struct Traits<glm::vec3> : TraitsBase<16, 12> {};
+template <> struct Traits<glm::vec4> : TraitsBase<16, 16> {};
+template <> struct Traits<glm::ivec4> : TraitsBase<16, 16> {};
+template <> struct Traits<glm::mat4> : TraitsBase<16, 64> {};
+
+/**< @brief 配列の要素は vec4 単位に切り上げられるため、16 バイトの型だけ許可します。 */
+template <typename T, std::size_t N> struct Traits<T[N]> {
+  static_assert(Traits<T>::kSize % 16 == 0,
+                "std140 array elements must be 16-byte multiples.");
+  static constexpr std::size_t kAlignment = 16;
+  static constexpr std::size_t kSize = Traits<T>::kSize * N;
+};
+
+struct Member {
+  std::size_t offset;
+  std::size_t alignment;
+  std::size_t size;
+};
+
+static constexpr std::size_t RoundUp(std::size_t value, std::size_t align) {
+  return (value + align - 1) / align * align;
+}
+
+/**
+ * @brief メンバを宣言順に並べて、std140 の規則で配置した場合と一致するか判定します。
+ */
+static constexpr bool Verify(std::size_t blockSize,
+                             std::initializer_list<Member> members) {
+  std::size_t expected = 0;
+  for (const Member &m : members) {
+    expected = RoundUp(expected, m.alignment);
+    if (m.offset != expected) {
+      return false;
+    }
+    expected += m.size;
+  }
+  return RoundUp(expected, 16) == blockSize;
+}
+
+} // namespace Std140
+
+#define STD140_MEMBER(Type, Name)                                              \
+  Std140::Member {                                                             \
+    offsetof(Type, Name), Std140::Traits<decltype(Type::Name)>::kAlignment,    \
+        Std140::Traits<decltype(Type::Name)>::kSize                            \
+  }
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**
+ * @brief 一つの構造体を丸ごと保持するユニフォームブロック
+ * @note フレームごとのデータなど、一度書き込んで全プログラムから参照するものに使います。
+ */
+template <typename T> class UniformBlock : private boost::noncopyable {
+  static_assert(std::is_standard_layout_v<T> &&
+                    std::is_trivially_copyable_v<T>,
+                "Uniform block must be a standard-layout POD.");
+  static_assert(sizeof(T) % 16 == 0,
+                "std140 block size must be a multiple of 16 bytes.");
+
+public:
+  UniformBlock() = default;
+  ~UniformBlock() {
+    if (buffer_ != 0) {
+      glDeleteBuffers(1, &buffer_);
+    }
+  }
+
+  void OnInit(GLuint binding) {
+    binding_ = binding;
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(T), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, binding_, buffer_);
+  }
+
+  void Update(const T &data) const {
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(T), &data);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  /**< @brief 他のブロックと結合ポイントを共有する場合に付け直します。 */
+  void Bind() const { glBindBufferBase(GL_UNIFORM_BUFFER, binding_, buffer_); }
+
+  GLuint GetBinding() const { return binding_; }
+  GLuint GetHandle() const { return buffer_; }
+
+private:
+  GLuint buffer_ = 0;
+  GLuint binding_ = 0;
+};
+
+/**
+ * @brief オブジェクトごとのデータを切り出して渡すリングバッファ
+ * @note 1フレーム分の領域を kFrames 個持ち、各領域を使い終えたところでフェンスを置きます。
+ * 領域に書き込む前にそのフェンスを待つので、GPU が読んでいる可能性のある領域には書き込みません。
+ * Push したデータは Flush で同期なしのマップからまとめて転送し、glBindBufferRange で結合ポイントに割り当てます。
+ */
+template <typename T> class UniformRing : private boost::noncopyable {
+  static_assert(std::is_standard_layout_v<T> &&
+                    std::is_trivially_copyable_v<T>,
+                "Uniform block must be a standard-layout POD.");
+  static_assert(sizeof(T) % 16 == 0,
+                "std140 block size must be a multiple of 16 bytes.");
+
+public:
+  static constexpr inline std::size_t kFrames = 3;
+
+  UniformRing() = default;
+  ~UniformRing() {
+    for (GLsync &fence : fences_) {
+      if (fence != nullptr) {
+        glDeleteSync(fence);
+      }
+    }
+    if (buffer_ != 0) {
+      glDeleteBuffers(1, &buffer_);
+    }
+  }
+
+  /**
+   * @param binding 結合ポイント
+   * @param capacity 1フレームで書き込めるデータの数
+   */
+  void OnInit(GLuint binding, std::size_t capacity) {
+    binding_ = binding;
+    capacity_ = capacity;
+
+    // オフセットは GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT の倍数でなければなりません。
+    GLint align = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &align);
+    stride_ = Std140::RoundUp(sizeof(T), static_cast<std::size_t>(align));
+    staging_.resize(stride_ * capacity_);
+
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    glBufferData(GL_UNIFORM_BUFFER,
+                 static_cast<GLsizeiptr>(stride_ * capacity_ * kFrames),
+                 nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  /**
+   * @brief 前のフレームの領域にフェンスを置き、次の領域を GPU が読み終えるまで待ちます。
+   */
+  void BeginFrame() {
+    if (isStarted_) {
+      fences_[frame_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    isStarted_ = true;
+    frame_ = (frame_ + 1) % kFrames;
+    count_ = 0;
+
+    if (GLsync &fence = fences_[frame_]; fence != nullptr) {
+      while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT,
+                              kWaitTimeout) == GL_TIMEOUT_EXPIRED) {
+      }
+      glDeleteSync(fence);
+      fence = nullptr;
+    }
+  }
+
+  /**
+   * @brief データを書き込み、そのオフセットを返します。
+   * @note 転送は Flush で行うので、Bind する前に Flush を呼んでください。
+   */
+  GLintptr Push(const T &data) {
+    BOOST_ASSERT_MSG(count_ < capacity_, "UniformRing overflow.");
+    const std::size_t index = count_ < capacity_ ? count_++ : capacity_ - 1;
+    std::memcpy(staging_.data() + stride_ * index, &data, sizeof(T));
+    return static_cast<GLintptr>(stride_ * (frame_ * capacity_ + index));
+  }
+
+  /**
+   * @brief このフレームで Push したデータを転送します。
+   * @note BeginFrame でフェンスを待っているので、同期なしでマップします。
+   */
+  void Flush() const {
+    if (count_ == 0) {
+      return;
+    }
+    const auto size = static_cast<GLsizeiptr>(stride_ * count_);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer_);
+    if (void *dst = glMapBufferRange(
+            GL_UNIFORM_BUFFER,
+            static_cast<GLintptr>(stride_ * capacity_ * frame_), size,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT |
+                GL_MAP_UNSYNCHRONIZED_BIT)) {
+      std::memcpy(dst, staging_.data(), static_cast<std::size_t>(size));
+      glUnmapBuffer(GL_UNIFORM_BUFFER);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+  }
+
+  void Bind(GLintptr offset) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding_, buffer_, offset,
+                      sizeof(T));
+  }
+
+  GLuint GetBinding() const { return binding_; }
+
+private:
+  static constexpr inline GLuint64 kWaitTimeout = 1000000; // 1ms
+
+  GLuint buffer_ = 0;
+  GLuint binding_ = 0;
+  std::size_t capacity_ = 0;
+  std::size_t stride_ = 0;
+  std::size_t frame_ = 0;
+  std::size_t count_ = 0;
+  bool isStarted_ = false;
+  std::array<GLsync, kFrames> fences_{};
+  std::vector<std::uint8_t> staging_{}; // 1フレーム分 (stride_ ごと)
+};
+
+#endif
@@ -0,0 +1,224 @@
+/**
+ * @brief  Vertex layout
+ * @note   インターリーブした頂点属性の並びをコンパイル時に決め、
+ * float の入力を詰め込んだ形式に変換して VAO を設定します。
+ * VertexLayout<Attribute<0, VertexFormat::Half4>,
+ *              Attribute<1, VertexFormat::Snorm10x3>> のように使います。
+ */
+
+// ********************************************************************************
+// Include guard
+// ********************************************************************************
+
+#ifndef VERTEX_LAYOUT_H
+#define VERTEX_LAYOUT_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#include <glm/gtc/packing.hpp>
+
+// ********************************************************************************
+// Vertex formats
+// ********************************************************************************
+
+/**
+ * @brief 頂点属性の形式
+ * @note kInputs: 入力の float の数、kComponents / kType / kNormalized:
+ * glVertexAttribPointer の引数、kBytes: 1 頂点あたりのバイト数
+ */
+namespace VertexFormat {
+
+/**
+ * @brief 符号付き 10 ビットの正規化整数
+ * @note GL 4.2 未満 (macOS の 4.1) は (2c + 1) / (2^b - 1) で変換するため、
+ * 2 ビットの w は -2 と 1 を使い、どちらの規則でも -1 と 1 になるようにします。
+ */
+static inline std::uint32_t PackSnorm10(float v) {
+  const float c = std::round(std::clamp(v, -1.0f, 1.0f) * 511.0f);
+  return static_cast<std::uint32_t>(static_cast<std::int32_t>(c)) & 0x3FFu;
+}
+
+static inline std::uint32_t PackSnorm2101010(float x, float y, float z,
+                                             float w) {
+  const std::uint32_t sign = w < 0.0f ? 0x2u : 0x1u;
+  return PackSnorm10(x) | (PackSnorm10(y) << 10) | (PackSnorm10(z) << 20) |
+         (sign << 30);
+}
+
+template <typename T> static inline void Store(std::uint8_t *dst, const T &v) {
+  std::memcpy(dst, &v, sizeof(T));
+}
+
+/**< @brief 32 ビット浮動小数点数 3 つ */
+struct Float3 {
+  static constexpr int kInputs = 3;
+  static constexpr GLint kComponents = 3;
+  static constexpr GLenum kType = GL_FLOAT;
+  static constexpr GLboolean kNormalized = GL_FALSE;
+  static constexpr std::size_t kBytes = 12;
+  static void Encode(const float *src, std::uint8_t *dst) {
+    std::memcpy(dst, src, kBytes);
+  }
+};
+
+/**< @brief 16 ビット浮動小数点数 4 つ (w は 1) */
+struct Half4 {
+  static constexpr int kInputs = 3;
+  static constexpr GLint kComponents = 4;
+  static constexpr GLenum kType = GL_HALF_FLOAT;
+  static constexpr GLboolean kNormalized = GL_FALSE;
+  static constexpr std::size_t kBytes = 8;
+  static void Encode(const float *src, std::uint8_t *dst) {
+    Store(dst, glm::packHalf4x16(glm::vec4(src[0], src[1], src[2], 1.0f)));
+  }
+};
+
+/**< @brief 32 ビット浮動小数点数 2 つ */
+struct Float2 {
+  static constexpr int kInputs = 2;
+  static constexpr GLint kComponents = 2;
+  static constexpr GLenum kType = GL_FLOAT;
+  static constexpr GLboolean kNormalized = GL_FALSE;
+  static constexpr std::size_t kBytes = 8;
+  static void Encode(const float *src, std::uint8_t *dst) {
+    std::memcpy(dst, src, kBytes);
+  }
+};
+
+/**< @brief [0, 1] の 16 ビット正規化整数 2 つ */
+struct Unorm16x2 {
+  static constexpr int kInputs = 2;
+  static constexpr GLint kComponents = 2;
+  static constexpr GLenum kType = GL_UNSIGNED_SHORT;
+  static constexpr GLboolean kNormalized = GL_TRUE;
+  static constexpr std::size_t kBytes = 4;
+  static void Encode(const float *src, std::uint8_t *dst) {
+    Store(dst, glm::packUnorm2x16(glm::vec2(src[0], src[1])));
+  }
+};
+
+/**< @brief 単位ベクトル (法線)。w は 1 */
+struct Snorm10x3 {
+  static constexpr int kInputs = 3;
+  static constexpr GLint kComponents = 4;
+  static constexpr GLenum kType = GL_INT_2_10_10_10_REV;
+  static constexpr GLboolean kNormalized = GL_TRUE;
+  static constexpr std::size_t kBytes = 4;
+  static void Encode(const float *src, std::uint8_t *dst) {
+    Store(dst, PackSnorm2101010(src[0], src[1], src[2], 1.0f));
+  }
+};
+
+/**< @brief 単位ベクトルと向きの符号 (接線)。w は -1 か 1 */
+struct Snorm10x3Sign {
+  static constexpr int kInputs = 4;
+  static constexpr GLint kComponents = 4;
+  static constexpr GLenum kType = GL_INT_2_10_10_10_REV;
+  static constexpr GLboolean kNormalized = GL_TRUE;
+  static constexpr std::size_t kBytes = 4;
+  static void Encode(const float *src, std::uint8_t *dst) {
+    Store(dst, PackSnorm2101010(src[0], src[1], src[2], src[3]));
+  }
+};
+
+} // namespace VertexFormat
+
+// ********************************************************************************
+// Class(es)
+// ********************************************************************************
+
+/**< @brief シェーダーの location と形式の組 */
+template <GLuint Location, typename Format> struct Attribute {
+  static constexpr GLuint kLocation = Location;
+  using FormatType = Format;
+};
+
+template <typename... Attribs> class VertexLayout {
+public:
+  static constexpr std::size_t kCount = sizeof...(Attribs);
+
+  /**< @brief 属性ごとのシェーダーの location */
+  static constexpr std::array<GLuint, kCount> kLocations{Attribs::kLocation...};
+
+  /**< @brief 1 頂点あたりのバイト数 */
+  static constexpr std::size_t kStride =
+      (std::size_t{0} + ... + Attribs::FormatType::kBytes);
+
+  /**< @brief 属性ごとの頂点の先頭からのバイト数 */
+  static constexpr std::array<std::size_t, kCount> kOffsets = [] {
+    std::array<std::size_t, kCount> offsets{};
+    const std::array<std::size_t, kCount> bytes{Attribs::FormatType::kBytes...};
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < kCount; i++) {
+      offsets[i] = offset;
+      offset += bytes[i];
+    }
+    return offsets;
+  }();
+
+  static_assert(kCount > 0, "VertexLayout needs at least one attribute.");
+  static_assert(kStride % 4 == 0, "Vertex stride must be 4-byte aligned.");
+
+  /**
+   * @brief 属性ごとの float の配列をインターリーブした頂点データに変換します。
+   * @param sources Attribs の順に、各頂点 kInputs 個の float が並んだ配列
+   */
+  static std::vector<std::uint8_t>
+  Pack(std::size_t vertexCount,
+       const std::array<const float *, kCount> &sources) {
+    std::vector<std::uint8_t> out(vertexCount * kStride);
+    PackImpl(vertexCount, sources, out.data(),
+             std::make_index_sequence<kCount>{});
+    return out;
+  }
+
+  /**
+   * @brief バインド中の VAO に、GL_ARRAY_BUFFER にバインド中のバッファの属性を設定します。
+   * @param baseOffset バッファ内での頂点データの開始位置
+   */
+  static void Setup(std::size_t baseOffset = 0) {
+    SetupImpl(baseOffset, std::make_index_sequence<kCount>{});
+  }
+
+private:
+  template <std::size_t... I>
+  static void PackImpl(std::size_t vertexCount,
+                       const std::array<const float *, kCount> &sources,
+                       std::uint8_t *dst, std::index_sequence<I...>) {
+    for (std::size_t v = 0; v < vertexCount; v++) {
+      std::uint8_t *vertex = dst + v * kStride;
+      (Attribs::FormatType::Encode(
+           sources[I] + v * Attribs::FormatType::kInputs,
+           vertex + kOffsets[I]),
+       ...);
+    }
+  }
+
+  template <std::size_t... I>
+  static void SetupImpl(std::size_t baseOffset, std::index_sequence<I...>) {
+    (SetupAttribute<Attribs>(baseOffset + kOffsets[I]), ...);
+  }
+
+  template <typename Attrib> static void SetupAttribute(std::size_t offset) {
+    using Format = typename Attrib::FormatType;
+    glVertexAttribPointer(Attrib::kLocation, Format::kComponents, Format::kType,
+                          Format::kNormalized, static_cast<GLsizei>(kStride),
+                          reinterpret_cast<const void *>(offset));
+    glEnableVertexAttribArray(Attrib::kLocation);
+  }
+};
+
+#endif
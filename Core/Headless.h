@@ -0,0 +1,197 @@
+/**
+ * @brief  Headless (offscreen) context
+ * @note   EGL の pbuffer サーフェスにレンダリングするため、ディスプレイが無くても動作します。
+ */
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <string>
+
+#if defined(ENABLE_HEADLESS)
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+// ********************************************************************************
+// Namespace
+// ********************************************************************************
+
+namespace Headless {
+
+/**< @brief ヘッドレスモードで実行するフレーム数を指定する環境変数 */
+static constexpr const char *kFramesEnv = "REGL_HEADLESS_FRAMES";
+
+/**< @brief ヘッドレスモードで1フレームあたりに進める時間 (秒) */
+static constexpr double kTimeStep = 1.0 / 60.0;
+
+/**
+ * @brief 環境変数からヘッドレスモードで実行するフレーム数を取得します。
+ * @return 指定されていなければ std::nullopt
+ */
+static inline std::optional<int> GetFramesFromEnv() {
+  const char *env = std::getenv(kFramesEnv);
+  if (env == nullptr) {
+    return std::nullopt;
+  }
+  const int frames = std::atoi(env);
+  return frames > 0 ? std::make_optional(frames) : std::nullopt;
+}
+
+#if defined(ENABLE_HEADLESS)
+
+struct Context {
+  EGLDisplay display = EGL_NO_DISPLAY;
+  EGLContext context = EGL_NO_CONTEXT;
+  EGLSurface surface = EGL_NO_SURFACE;
+};
+
+static inline EGLDisplay GetDisplay() {
+  // Mesa の surfaceless プラットフォームを優先し、無ければデフォルトのディスプレイを使います。
+  const auto getPlatformDisplay =
+      reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+          eglGetProcAddress("eglGetPlatformDisplayEXT"));
+  if (getPlatformDisplay != nullptr) {
+    EGLDisplay display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA,
+                                            EGL_DEFAULT_DISPLAY, nullptr);
+    if (display != EGL_NO_DISPLAY) {
+      return display;
+    }
+  }
+  return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+static inline void Destroy(Context &ctx) {
+  if (ctx.display == EGL_NO_DISPLAY) {
+    return;
+  }
+  eglMakeCurrent(ctx.display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+  if (ctx.context != EGL_NO_CONTEXT) {
+    eglDestroyContext(ctx.display, ctx.context);
+  }
+  if (ctx.surface != EGL_NO_SURFACE) {
+    eglDestroySurface(ctx.display, ctx.surface);
+  }
+  eglTerminate(ctx.display);
+  ctx = Context{};
+}
+
+/**
+ * @brief オフスクリーンのコンテキストを生成し、カレントにします。
+ * @note デフォルトフレームバッファは w x h の pbuffer になるため、
+ * シーン側で glBindFramebuffer(GL_FRAMEBUFFER, 0) してもそのまま動作します。
+ */
+static inline bool Create(Context &ctx, int w, int h, int samples) {
+  ctx.display = GetDisplay();
+  if (ctx.display == EGL_NO_DISPLAY ||
+      eglInitialize(ctx.display, nullptr, nullptr) == EGL_FALSE) {
+    std::cerr << "Failed to initialize EGL display." << std::endl;
+    ctx.display = EGL_NO_DISPLAY;
+    return false;
+  }
+  if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+    std::cerr << "EGL does not support desktop OpenGL." << std::endl;
+    Destroy(ctx);
+    return false;
+  }
+
+  // Select framebuffer config
+  const EGLint configAttribs[] = {
+      EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+      EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+      EGL_RED_SIZE,        8,
+      EGL_GREEN_SIZE,      8,
+      EGL_BLUE_SIZE,       8,
+      EGL_ALPHA_SIZE,      8,
+      EGL_DEPTH_SIZE,      24,
+      EGL_SAMPLE_BUFFERS,  samples > 0 ? 1 : 0,
+      EGL_SAMPLES,         samples,
+      EGL_NONE,
+  };
+  EGLConfig config = nullptr;
+  EGLint numConfigs = 0;
+  if (eglChooseConfig(ctx.display, configAttribs, &config, 1, &numConfigs) ==
+          EGL_FALSE ||
+      numConfigs == 0) {
+    std::cerr << "No suitable EGL config found." << std::endl;
+    Destroy(ctx);
+    return false;
+  }
+
+  // Create offscreen surface
+  const EGLint surfaceAttribs[] = {EGL_WIDTH, w, EGL_HEIGHT, h, EGL_NONE};
+  ctx.surface = eglCreatePbufferSurface(ctx.display, config, surfaceAttribs);
+  if (ctx.surface == EGL_NO_SURFACE) {
+    std::cerr << "Failed to create EGL pbuffer surface." << std::endl;
+    Destroy(ctx);
+    return false;
+  }
+
+  // Select OpenGL version
+  const EGLint contextAttribs[] = {
+      EGL_CONTEXT_MAJOR_VERSION,
+      4,
+      EGL_CONTEXT_MINOR_VERSION,
+      4,
+      EGL_CONTEXT_OPENGL_PROFILE_MASK,
+      EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#if !defined(NDEBUG)
+      EGL_CONTEXT_OPENGL_DEBUG,
+      EGL_TRUE,
+#endif
+      EGL_NONE,
+  };
+  ctx.context =
+      eglCreateContext(ctx.display, config, EGL_NO_CONTEXT, contextAttribs);
+  if (ctx.context == EGL_NO_CONTEXT) {
+    std::cerr << "Failed to create EGL context." << std::endl;
+    Destroy(ctx);
+    return false;
+  }
+
+  if (eglMakeCurrent(ctx.display, ctx.surface, ctx.surface, ctx.context) ==
+      EGL_FALSE) {
+    std::cerr << "Failed to make EGL context current." << std::endl;
+    Destroy(ctx);
+    return false;
+  }
+  return true;
+}
+
+static inline void SwapBuffers(const Context &ctx) {
+  // pbuffer ではスワップは何もしないので、明示的にコマンドを発行します。
+  glFlush();
+  eglSwapBuffers(ctx.display, ctx.surface);
+}
+
+static inline GLADloadproc GetLoader() {
+  return reinterpret_cast<GLADloadproc>(eglGetProcAddress);
+}
+
+#else
+
+// EGL が使えない環境ではヘッドレスモードは利用できません。
+struct Context {};
+
+static inline bool Create(Context &, int, int, int) {
+  std::cerr << "Headless mode is not supported on this platform." << std::endl;
+  return false;
+}
+static inline void Destroy(Context &) {}
+static inline void SwapBuffers(const Context &) {}
+static inline GLADloadproc GetLoader() { return nullptr; }
+
+#endif
+
+} // namespace Headless
+
+#endif // HEADLESS_H
@@ -0,0 +1,268 @@
+/**
+ * @brief 全シーンのベンチマーク
+ */
+
+#include "BenchRunner.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+
+#define FMT_HEADER_ONLY
+#include <fmt/format.h>
+
+#include "Graphics/GLState.h"
+
+// ********************************************************************************
+// Functions
+// ********************************************************************************
+
+static std::string EscapeJSON(const std::string &str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+static std::string GetString(GLenum name) {
+  const auto *str = reinterpret_cast<const char *>(glGetString(name));
+  return str != nullptr ? std::string(str) : std::string();
+}
+
+// ********************************************************************************
+// Special member functions
+// ********************************************************************************
+
+BenchRunner::~BenchRunner() {
+  if (!queries_.empty()) {
+    glDeleteQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+  }
+}
+
+// ********************************************************************************
+// Setup
+// ********************************************************************************
+
+void BenchRunner::AddScene(const std::string &name, SceneFactory factory) {
+  entries_.emplace_back(Entry{name, std::move(factory)});
+}
+
+void BenchRunner::OnInit(int w, int h) {
+  width_ = w;
+  height_ = h;
+  renderer_ = GetString(GL_RENDERER);
+  version_ = GetString(GL_VERSION);
+
+  queries_.resize(static_cast<std::size_t>(config_.measuredFrames) * 2);
+  glGenQueries(static_cast<GLsizei>(queries_.size()), queries_.data());
+}
+
+// ********************************************************************************
+// Loop
+// ********************************************************************************
+
+void BenchRunner::OnUpdate() {
+  if (IsFinished()) {
+    return;
+  }
+  if (scene_ == nullptr) {
+    BeginScene();
+  }
+
+  if (IsMeasuring()) {
+    const auto i = static_cast<std::size_t>(frame_ - config_.warmupFrames);
+    cpuBegin_ = std::chrono::steady_clock::now();
+    glQueryCounter(queries_[i * 2], GL_TIMESTAMP);
+  }
+
+  // シーンにはアプリの時間ではなく、シーン開始からの固定ステップの時間を渡します。
+  scene_->OnUpdate(static_cast<float>(frame_ * config_.timeStep));
+}
+
+void BenchRunner::OnRender() {
+  if (scene_ == nullptr) {
+    return;
+  }
+  scene_->OnRender();
+
+  if (IsMeasuring()) {
+    const auto i = static_cast<std::size_t>(frame_ - config_.warmupFrames);
+    glQueryCounter(queries_[i * 2 + 1], GL_TIMESTAMP);
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - cpuBegin_;
+    entries_[current_].cpu.emplace_back(elapsed.count());
+
+    const auto &counters = GLState::Get().GetFrameCounters();
+    entries_[current_].glIssued += counters.issued;
+    entries_[current_].glAvoided += counters.avoided;
+  }
+
+  frame_++;
+  if (frame_ >= config_.warmupFrames + config_.measuredFrames) {
+    EndScene();
+  }
+}
+
+void BenchRunner::OnDestroy() {
+  if (scene_ != nullptr) {
+    std::cerr << "Benchmark was interrupted in " << entries_[current_].name
+              << "." << std::endl;
+    EndScene();
+  }
+
+  std::cout << ToJSON() << std::endl;
+  if (const auto msg = WriteJSON()) {
+    std::cerr << msg.value() << std::endl;
+  }
+}
+
+// ********************************************************************************
+// Scene management
+// ********************************************************************************
+
+void BenchRunner::BeginScene() {
+  ResetState();
+
+  scene_ = entries_[current_].factory();
+  scene_->SetDimensions(width_, height_);
+  scene_->OnInit();
+  scene_->OnResize(width_, height_);
+  frame_ = 0;
+}
+
+void BenchRunner::EndScene() {
+  Entry &entry = entries_[current_];
+
+  // シーンの終わりでだけ GPU の完了を待ち、タイムスタンプをまとめて回収します。
+  glFinish();
+  const std::size_t measured = entry.cpu.size();
+  for (std::size_t i = 0; i < measured; i++) {
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(queries_[i * 2], GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(queries_[i * 2 + 1], GL_QUERY_RESULT, &end);
+    entry.gpu.emplace_back(static_cast<double>(end - begin) * 1.0e-6);
+  }
+  entry.isCompleted =
+      measured == static_cast<std::size_t>(config_.measuredFrames);
+
+  scene_->OnDestroy();
+  scene_.reset();
+  current_++;
+}
+
+void BenchRunner::ResetState() const {
+  // 前のシーンが削除したオブジェクトの名前が再利用されるため、キャッシュを捨ててから既定値に戻します。
+  GLState &state = GLState::Get();
+  state.Invalidate();
+  state.BindFramebuffer(GL_FRAMEBUFFER, 0);
+  state.BindVertexArray(0);
+  state.UseProgram(0);
+  for (GLenum unit = GL_TEXTURE0; unit <= GL_TEXTURE7; unit++) {
+    state.ActiveTexture(unit);
+    state.BindTexture(GL_TEXTURE_2D, 0);
+    state.BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    state.BindSampler(unit - GL_TEXTURE0, 0);
+  }
+  state.ActiveTexture(GL_TEXTURE0);
+
+  state.Disable(GL_DEPTH_TEST);
+  glDepthFunc(GL_LESS);
+  state.Disable(GL_CULL_FACE);
+  glCullFace(GL_BACK);
+  state.Disable(GL_BLEND);
+  glBlendFunc(GL_ONE, GL_ZERO);
+  state.Disable(GL_POLYGON_OFFSET_FILL);
+  state.Enable(GL_MULTISAMPLE);
+  glPointSize(1.0f);
+
+  state.Viewport(0, 0, width_, height_);
+  glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+}
+
+// ********************************************************************************
+// Result
+// ********************************************************************************
+
+std::string BenchRunner::ToJSON() const {
+  std::string scenes;
+  for (const auto &entry : entries_) {
+    if (entry.cpu.empty()) {
+      continue;
+    }
+    if (!scenes.empty()) {
+      scenes += ",\n";
+    }
+    const auto frames = static_cast<double>(entry.cpu.size());
+    scenes += fmt::format(
+        "    {{\"name\": \"{}\", \"completed\": {}, \"frames\": {}, "
+        "\"cpu_ms\": {}, \"gpu_ms\": {}, "
+        "\"gl_state_per_frame\": {{\"issued\": {:.1f}, \"avoided\": {:.1f}}}}}",
+        EscapeJSON(entry.name), entry.isCompleted, entry.cpu.size(),
+        ToJSON(ComputeStats(entry.cpu)), ToJSON(ComputeStats(entry.gpu)),
+        static_cast<double>(entry.glIssued) / frames,
+        static_cast<double>(entry.glAvoided) / frames);
+  }
+
+  return fmt::format(
+      "{{\n"
+      "  \"renderer\": \"{}\",\n"
+      "  \"version\": \"{}\",\n"
+      "  \"width\": {},\n"
+      "  \"height\": {},\n"
+      "  \"warmup_frames\": {},\n"
+      "  \"measured_frames\": {},\n"
+      "  \"time_step\": {},\n"
+      "  \"scenes\": [\n{}\n  ]\n"
+      "}}",
+      EscapeJSON(renderer_), EscapeJSON(version_), width_, height_,
+      config_.warmupFrames, config_.measuredFrames, config_.timeStep, scenes);
+}
+
+std::optional<std::string> BenchRunner::WriteJSON() const {
+  std::ofstream ofs(config_.outputPath, std::ios::out | std::ios::trunc);
+  if (!ofs) {
+    return std::string("Can't open file : ") + config_.outputPath;
+  }
+  ofs << ToJSON() << std::endl;
+  return std::nullopt;
+}
+
+BenchRunner::Stats BenchRunner::ComputeStats(std::vector<double> samples) {
+  if (samples.empty()) {
+    return Stats{};
+  }
+  std::sort(samples.begin(), samples.end());
+
+  // Nearest-rank 法でパーセンタイルを求めます。
+  const auto percentile = [&samples](double p) {
+    const auto rank = static_cast<std::size_t>(
+        std::ceil(p * static_cast<double>(samples.size())));
+    return samples[std::max<std::size_t>(rank, 1) - 1];
+  };
+
+  Stats stats;
+  stats.min = samples.front();
+  stats.avg = std::accumulate(samples.begin(), samples.end(), 0.0) /
+              static_cast<double>(samples.size());
+  stats.p50 = percentile(0.50);
+  stats.p90 = percentile(0.90);
+  stats.p99 = percentile(0.99);
+  stats.max = samples.back();
+  return stats;
+}
+
+std::string BenchRunner::ToJSON(const Stats &stats) {
+  return fmt::format("{{\"min\": {:.4f}, \"avg\": {:.4f}, \"p50\": {:.4f}, "
+                     "\"p90\": {:.4f}, \"p99\": {:.4f}, \"max\": {:.4f}}}",
+                     stats.min, stats.avg, stats.p50, stats.p90, stats.p99,
+                     stats.max);
+}
@@ -0,0 +1,103 @@
+/**
+ * @brief 全シーンのベンチマーク
+ * @note 各シーンに固定のタイムステップで時間を与え、
+ * ウォームアップの後に計測したフレームの CPU/GPU 時間を JSON で出力します。
+ */
+
+#ifndef BENCH_RUNNER_H
+#define BENCH_RUNNER_H
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include "GLInclude.h"
+
+#include <boost/noncopyable.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Scene/Scene.h"
+
+// ********************************************************************************
+// Class
+// ********************************************************************************
+
+class BenchRunner : private boost::noncopyable {
+public:
+  using SceneFactory = std::function<std::unique_ptr<Scene>()>;
+
+  struct Config {
+    int warmupFrames = 60;
+    int measuredFrames = 300;
+    double timeStep = 1.0 / 60.0;
+    std::string outputPath = "./Bench.json";
+  };
+
+  explicit BenchRunner(const Config &config) : config_(config) {}
+  ~BenchRunner();
+
+  void AddScene(const std::string &name, SceneFactory factory);
+
+  void OnInit(int w, int h);
+  void OnUpdate();
+  void OnRender();
+  void OnDestroy();
+
+  bool IsFinished() const { return current_ >= entries_.size(); }
+
+  std::string ToJSON() const;
+  std::optional<std::string> WriteJSON() const;
+
+private:
+  /**< @brief フレーム時間の統計 (ミリ秒) */
+  struct Stats {
+    double min = 0.0;
+    double avg = 0.0;
+    double p50 = 0.0;
+    double p90 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+  };
+
+  struct Entry {
+    std::string name;
+    SceneFactory factory;
+    std::vector<double> cpu{}; // ミリ秒
+    std::vector<double> gpu{}; // ミリ秒
+    std::uint64_t glIssued = 0;  // 計測フレームでドライバーに渡した状態変更の数
+    std::uint64_t glAvoided = 0; // 計測フレームで GLState が捨てた状態変更の数
+    bool isCompleted = false;
+  };
+
+  void BeginScene();
+  void EndScene();
+  void ResetState() const;
+  bool IsMeasuring() const { return frame_ >= config_.warmupFrames; }
+
+  static Stats ComputeStats(std::vector<double> samples);
+  static std::string ToJSON(const Stats &stats);
+
+  Config config_;
+  int width_ = 0;
+  int height_ = 0;
+  std::string renderer_{};
+  std::string version_{};
+
+  std::vector<Entry> entries_{};
+  std::size_t current_ = 0;
+  std::unique_ptr<Scene> scene_ = nullptr;
+  int frame_ = 0;
+
+  // 計測フレームごとに開始と終了のタイムスタンプを記録し、シーンの最後にまとめて読み出します。
+  std::vector<GLuint> queries_{};
+  std::chrono::steady_clock::time_point cpuBegin_{};
+};
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * @brief  全シーンのベンチマーク
+ * @note   Bench [--headless] [--warmup N] [--frames M] [--output path]
+ */
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "App.h"
+
+#include "BenchRunner.h"
+#include "Bezier/SceneBezier.h"
+#include "CSM/SceneCSM.h"
+#include "Deferred/SceneDeferred.h"
+#include "Diffuse/SceneDiffuse.h"
+#include "GUI/SceneGUI.h"
+#include "HelloTriangle/SceneHelloTriangle.h"
+#include "Instancing/SceneInstancing.h"
+#include "MSAA/SceneMSAA.h"
+#include "PBR/ScenePBR.h"
+#include "PCF/ScenePCF.h"
+#include "Particles/SceneParticles.h"
+#include "Phong/ScenePhong.h"
+#include "SSAO/SceneSSAO.h"
+#include "ShadowMap/SceneShadowMap.h"
+#include "Texture/SceneTexture.h"
+
+// ********************************************************************************
+// Functions
+// ********************************************************************************
+
+template <typename T> static BenchRunner::SceneFactory MakeFactory() {
+  return []() { return std::make_unique<T>(); };
+}
+
+// ********************************************************************************
+// Entry point
+// ********************************************************************************
+
+int main(int argc, char **argv) {
+  BenchRunner::Config config{};
+  bool isHeadless = false;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg(argv[i]);
+    if (arg == "--headless") {
+      isHeadless = true;
+    } else if (arg == "--warmup" && i + 1 < argc) {
+      config.warmupFrames = std::stoi(argv[++i]);
+    } else if (arg == "--frames" && i + 1 < argc) {
+      config.measuredFrames = std::stoi(argv[++i]);
+    } else if (arg == "--output" && i + 1 < argc) {
+      config.outputPath = argv[++i];
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--headless] [--warmup N] [--frames M] [--output path]"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // ヘッドレスの場合は全シーンを回し終えた時点で Quit するので、フレーム数は上限を指定しておきます。
+  App app("Benchmark", Default::Window::Width, Default::Window::Height,
+          Default::Sampling::Num,
+          isHeadless ? std::make_optional(std::numeric_limits<int>::max())
+                     : Headless::GetFramesFromEnv());
+
+  BenchRunner runner(config);
+  runner.AddScene("HelloTriangle", MakeFactory<SceneHelloTriangle>());
+  runner.AddScene("GUI", MakeFactory<SceneGUI>());
+  runner.AddScene("Diffuse", MakeFactory<SceneDiffuse>());
+  runner.AddScene("Phong", MakeFactory<ScenePhong>());
+  runner.AddScene("PBR", MakeFactory<ScenePBR>());
+  runner.AddScene("Texture", MakeFactory<SceneTexture>());
+  runner.AddScene("Deferred", MakeFactory<SceneDeferred>());
+  runner.AddScene("MSAA", MakeFactory<SceneMSAA>());
+  runner.AddScene("SSAO", MakeFactory<SceneSSAO>());
+  runner.AddScene("ShadowMap", MakeFactory<SceneShadowMap>());
+  runner.AddScene("PCF", MakeFactory<ScenePCF>());
+  runner.AddScene("CSM", MakeFactory<SceneCSM>());
+  runner.AddScene("Bezier", MakeFactory<SceneBezier>());
+  runner.AddScene("TeapotMesh", [] {
+    return std::make_unique<SceneBezier>(SceneBezier::Mode::TeapotMesh);
+  });
+  runner.AddScene("TeapotPatches", [] {
+    return std::make_unique<SceneBezier>(SceneBezier::Mode::TeapotPatches);
+  });
+#if !defined(__APPLE__)
+  runner.AddScene("Particles", MakeFactory<SceneParticles>());
+#endif
+  runner.AddScene("Instanced", [] {
+    return std::make_unique<SceneInstancing>(SceneInstancing::Mode::Instanced);
+  });
+  runner.AddScene("InstancedLoop", [] {
+    return std::make_unique<SceneInstancing>(SceneInstancing::Mode::Loop);
+  });
+
+  return app.Run([&runner](int w, int h) { runner.OnInit(w, h); },
+                 [&runner](float) { runner.OnUpdate(); },
+                 [&runner, &app]() {
+                   runner.OnRender();
+                   if (runner.IsFinished()) {
+                     app.Quit();
+                   }
+                 },
+                 [&runner]() { runner.OnDestroy(); });
+}
@@ -6,12 +6,32 @@
 // Including files
 // ********************************************************************************
 
+#include <algorithm>
 #include <boost/assert.hpp>
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 
 #include "SceneBezier.h"
 
+#include "Graphics/GLState.h"
+#include "HID/KeyInput.h"
+
+// ********************************************************************************
+// constexpr variables
+// ********************************************************************************
+
+/**< @brief CPU で分割する場合のパッチあたりの分割数 */
+static constexpr int kTeapotGrid = 32;
+/**< @brief GPU で分割する場合の、画面上の辺の長さの目標 [px] */
+static constexpr float kPixelsPerEdge = 8.0f;
+static constexpr float kMaxTessLevel = 64.0f;
+
+static constexpr float kCameraFOVY = 50.0f;
+static constexpr float kCameraRadius = 7.0f;
+static constexpr float kCameraHeight = 3.0f;
+static constexpr float kRotSpeed = 0.5f;
+
 // ********************************************************************************
 // Override functions
 // ********************************************************************************
@@ -25,46 +45,50 @@ void SceneBezier::OnInit() {
     BOOST_ASSERT_MSG(false, "failed to compile or link!");
   }
 
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
   glPointSize(10.0f);
 
   CreateVAO();
-  // パッチごとの頂点数(制御点)を設定します。  IMPORTANT!!
-  glPatchParameteri(GL_PATCH_VERTICES, 4);
   SetUniforms();
+  SetupTeapot();
 }
 
 void SceneBezier::OnDestroy() {
-  glDeleteVertexArrays(1, &vao_);
+  GLState::DeleteVertexArrays(1, &vao_);
   glDeleteBuffers(1, &vbo_);
 }
 
-void SceneBezier::OnUpdate(float d) { static_cast<void>(d); }
+void SceneBezier::OnUpdate(float t) {
+  angle_ = t * kRotSpeed;
+
+  const int num = static_cast<int>(Mode::Num);
+  int mode = static_cast<int>(mode_);
+  if (KeyInput::Get().IsTrg(Key::Right)) {
+    mode = (mode + 1) % num;
+  } else if (KeyInput::Get().IsTrg(Key::Left)) {
+    mode = (mode + num - 1) % num;
+  }
+  if (mode != static_cast<int>(mode_)) {
+    mode_ = static_cast<Mode>(mode);
+    SetupTeapot();
+  }
+}
 
 void SceneBezier::OnRender() {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  view_ = glm::lookAt(glm::vec3(0.0f, 0.0f, 1.5f), glm::vec3(0.0f, 0.0f, 0.0f),
-                      glm::vec3(0.0f, 1.0f, 0.0f));
-  model_ = glm::mat4(1.0f);
-
-  glBindVertexArray(vao_);
-  SetMatrices();
-
-  // ベジェ曲線の描画
-  bezier_.Use();
-  glDrawArrays(GL_PATCHES, 0, 4);
-
-  // 制御点の描画
-  solid_.Use();
-  glDrawArrays(GL_POINTS, 0, 4);
+  if (mode_ == Mode::Curve) {
+    RenderCurve();
+  } else {
+    RenderTeapot();
+  }
 
   glFinish();
 }
 
 void SceneBezier::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -86,6 +110,26 @@ std::optional<std::string> SceneBezier::CompileAndLinkShader() {
   }
   bezier_.Use();
 
+  if (!(teapotMesh_.Compile("./Assets/Shaders/Bezier/TeapotMesh.vs.glsl",
+                            ShaderType::Vertex) &&
+        teapotMesh_.Compile("./Assets/Shaders/Bezier/Teapot.fs.glsl",
+                            ShaderType::Fragment) &&
+        teapotMesh_.Link())) {
+    return teapotMesh_.GetLog();
+  }
+
+  if (!(teapotPatches_.Compile("./Assets/Shaders/Bezier/Teapot.vs.glsl",
+                               ShaderType::Vertex) &&
+        teapotPatches_.Compile("./Assets/Shaders/Bezier/Teapot.tcs.glsl",
+                               ShaderType::TessControl) &&
+        teapotPatches_.Compile("./Assets/Shaders/Bezier/Teapot.tes.glsl",
+                               ShaderType::TessEvaluation) &&
+        teapotPatches_.Compile("./Assets/Shaders/Bezier/Teapot.fs.glsl",
+                               ShaderType::Fragment) &&
+        teapotPatches_.Link())) {
+    return teapotPatches_.GetLog();
+  }
+
   if (!(solid_.Compile("./Assets/Shaders/Bezier/Solid.vs.glsl",
                        ShaderType::Vertex) &&
         solid_.Compile("./Assets/Shaders/Bezier/Solid.fs.glsl",
@@ -107,13 +151,13 @@ void SceneBezier::CreateVAO() {
 
   // パッチのVAOを生成します。
   glGenVertexArrays(1, &vao_);
-  glBindVertexArray(vao_);
+  GLState::Get().BindVertexArray(vao_);
 
   glBindBuffer(GL_ARRAY_BUFFER, vbo_);
   glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, 0);
   glEnableVertexAttribArray(0);
 
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
 
 void SceneBezier::SetUniforms() {
@@ -125,6 +169,86 @@ void SceneBezier::SetUniforms() {
 
   solid_.Use();
   solid_.SetUniform("Color", glm::vec4(0.5f, 1.0f, 1.0f, 1.0f));
+
+  for (ShaderProgram *prog : {&teapotMesh_, &teapotPatches_}) {
+    prog->Use();
+    prog->SetUniform("LightPosition", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    prog->SetUniform("Kd", glm::vec3(0.9f, 0.5f, 0.3f));
+  }
+  teapotPatches_.SetUniform("PixelsPerEdge", kPixelsPerEdge);
+  teapotPatches_.SetUniform("MaxTessLevel", kMaxTessLevel);
+}
+
+/**
+ * @brief 選んだ方のティーポットだけを作り、バッファの大きさを表示します。
+ */
+void SceneBezier::SetupTeapot() {
+  if (mode_ == Mode::TeapotMesh && !teapot_) {
+    teapot_ = std::make_unique<Teapot>(kTeapotGrid, glm::mat4(1.0f));
+    std::cout << "Teapot (grid " << kTeapotGrid
+              << "): " << teapot_->GetNumUniqueVerts() << " vertices, "
+              << teapot_->GetAllocation().vertexBytes +
+                     teapot_->GetAllocation().indexBytes
+              << " bytes" << std::endl;
+  }
+  if (mode_ == Mode::TeapotPatches && !patches_) {
+    patches_ = std::make_unique<TeapotPatches>(glm::mat4(1.0f));
+    std::cout << "TeapotPatches: "
+              << TeapotPatches::kPatchNum * TeapotPatches::kPatchVertices
+              << " control points, " << patches_->GetBufferSize() << " bytes"
+              << std::endl;
+  }
+}
+
+void SceneBezier::RenderCurve() {
+  view_ = glm::lookAt(glm::vec3(0.0f, 0.0f, 1.5f), glm::vec3(0.0f, 0.0f, 0.0f),
+                      glm::vec3(0.0f, 1.0f, 0.0f));
+  model_ = glm::mat4(1.0f);
+
+  GLState::Get().BindVertexArray(vao_);
+  SetMatrices();
+
+  // ベジェ曲線の描画
+  // パッチごとの頂点数(制御点)を設定します。  IMPORTANT!!
+  glPatchParameteri(GL_PATCH_VERTICES, 4);
+  bezier_.Use();
+  glDrawArrays(GL_PATCHES, 0, 4);
+
+  // 制御点の描画
+  solid_.Use();
+  glDrawArrays(GL_POINTS, 0, 4);
+}
+
+void SceneBezier::RenderTeapot() {
+  const float aspect =
+      static_cast<float>(width_) / static_cast<float>(std::max(height_, 1));
+  const glm::mat4 proj =
+      glm::perspective(glm::radians(kCameraFOVY), aspect, 0.3f, 100.0f);
+  const glm::vec3 eye(kCameraRadius * std::cos(angle_), kCameraHeight,
+                      kCameraRadius * std::sin(angle_));
+  view_ = glm::lookAt(eye, glm::vec3(0.0f, 1.5f, 0.0f),
+                      glm::vec3(0.0f, 1.0f, 0.0f));
+  // ティーポットは z 軸が上向きなので、y 軸が上向きになるよう回転します。
+  model_ = glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f),
+                       glm::vec3(1.0f, 0.0f, 0.0f));
+  const glm::mat4 mv = view_ * model_;
+
+  GLState::Get().Enable(GL_CULL_FACE);
+  if (mode_ == Mode::TeapotMesh) {
+    teapotMesh_.Use();
+    teapotMesh_.SetUniform("ModelViewMatrix", mv);
+    teapotMesh_.SetUniform("ProjectionMatrix", proj);
+    teapot_->Render();
+  } else {
+    teapotPatches_.Use();
+    teapotPatches_.SetUniform("ModelViewMatrix", mv);
+    teapotPatches_.SetUniform("ProjectionMatrix", proj);
+    teapotPatches_.SetUniform(
+        "ViewportSize",
+        glm::vec2(static_cast<float>(width_), static_cast<float>(height_)));
+    patches_->Render();
+  }
+  GLState::Get().Disable(GL_CULL_FACE);
 }
 
 void SceneBezier::SetMatrices() {
@@ -9,12 +9,16 @@
 // Including files
 // ********************************************************************************
 
+#include <cstdint>
+#include <memory>
 #include <optional>
 #include <string>
 
 #include <glm/glm.hpp>
 
 #include "Graphics/Shader.h"
+#include "Primitive/Teapot.h"
+#include "Primitive/TeapotPatches.h"
 #include "Scene/Scene.h"
 
 // ********************************************************************************
@@ -26,6 +30,16 @@
  */
 class SceneBezier : public Scene {
 public:
+  /**< @brief 描画する内容 (左右キーで切り替えます) */
+  enum struct Mode : std::int32_t {
+    Curve,         // ベジェ曲線
+    TeapotMesh,    // CPU で分割したティーポット (Teapot)
+    TeapotPatches, // GPU で分割したティーポット (TeapotPatches)
+    Num,
+  };
+
+  explicit SceneBezier(Mode mode = Mode::Curve) : mode_(mode) {}
+
   void OnInit() override;
   void OnDestroy() override;
   void OnUpdate(float) override;
@@ -37,12 +51,22 @@ private:
   void CreateVAO();
   void SetUniforms();
   void SetMatrices();
+  void SetupTeapot();
+  void RenderCurve();
+  void RenderTeapot();
 
   ShaderProgram bezier_;
   ShaderProgram solid_;
+  ShaderProgram teapotMesh_;
+  ShaderProgram teapotPatches_;
 
   GLuint vbo_ = 0;
   GLuint vao_ = 0;
+
+  Mode mode_ = Mode::Curve;
+  float angle_ = 0.0f;
+  std::unique_ptr<Teapot> teapot_{};
+  std::unique_ptr<TeapotPatches> patches_{};
 };
 
 #endif // SCENE_BEZIER_H
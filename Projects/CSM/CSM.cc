@@ -33,7 +33,7 @@ std::vector<float> CSM::ComputeSplitPlanes(int cascades, float near, float far,
   splits[cascades] = far;
   for (int i = 1; i < cascades; i++) {
     const float i_m = static_cast<float>(i) / static_cast<float>(cascades);
-    const float cilog = near * std::powf(far / near, i_m);
+    const float cilog = near * std::pow(far / near, i_m);
     const float ciuni = near + (far - near) * i_m;
     splits[i] = lambda * cilog + ciuni * (1.0f - lambda);
   }
@@ -1,24 +1,26 @@
 #include "CascadedShadowMapsFBO.h"
 
+#include "Graphics/GLState.h"
+
 CascadedShadowMapsFBO::~CascadedShadowMapsFBO() { OnDestroy(); }
 
 bool CascadedShadowMapsFBO::OnInit(int cascades, int w, int h) {
   // シャドウマップ用のFBOを生成します。
   if (shadowFBO_ != 0) {
-    glDeleteFramebuffers(1, &shadowFBO_);
+    GLState::DeleteFramebuffers(1, &shadowFBO_);
   }
   glGenFramebuffers(1, &shadowFBO_);
-  glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
   glDrawBuffer(GL_NONE);
   glReadBuffer(GL_NONE);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 
   // シャドウマップに使用する深度テクスチャ配列を生成します。
   if (depthTexAry_ != 0) {
-    glDeleteTextures(1, &depthTexAry_);
+    GLState::DeleteTextures(1, &depthTexAry_);
   }
   glGenTextures(1, &depthTexAry_);
-  glBindTexture(GL_TEXTURE_2D_ARRAY, depthTexAry_);
+  GLState::Get().BindTexture(GL_TEXTURE_2D_ARRAY, depthTexAry_);
   glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_DEPTH_COMPONENT32F, w, h, cascades);
   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
@@ -28,7 +30,7 @@ bool CascadedShadowMapsFBO::OnInit(int cascades, int w, int h) {
   glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_COMPARE_MODE,
                   GL_COMPARE_REF_TO_TEXTURE);
 
-  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D_ARRAY, 0);
 
   const GLenum result = glCheckFramebufferStatus(GL_FRAMEBUFFER);
   return result == GL_FRAMEBUFFER_COMPLETE;
@@ -36,9 +38,11 @@ bool CascadedShadowMapsFBO::OnInit(int cascades, int w, int h) {
 
 void CascadedShadowMapsFBO::OnDestroy() {
   if (depthTexAry_ != 0) {
-    glDeleteTextures(1, &depthTexAry_);
+    GLState::DeleteTextures(1, &depthTexAry_);
+    depthTexAry_ = 0;
   }
   if (shadowFBO_ != 0) {
-    glDeleteFramebuffers(1, &shadowFBO_);
+    GLState::DeleteFramebuffers(1, &shadowFBO_);
+    shadowFBO_ = 0;
   }
 }
@@ -12,6 +12,7 @@
 
 #include "CSM.h"
 #include "GUI/GUI.h"
+#include "Graphics/GLState.h"
 #include "HID/KeyInput.h"
 
 #ifdef WIN32
@@ -27,8 +28,6 @@
 // constexpr variables
 // ********************************************************************************
 
-static constexpr int kCascadesMax = 8;
-
 static constexpr float kCameraFOVY = 50.0f;
 static constexpr float kCameraNear = 0.1f;
 static constexpr float kCameraFar = 10.0f;
@@ -63,11 +62,12 @@ void SceneCSM::OnInit() {
     BOOST_ASSERT_MSG(false, "failed to compile or link!");
   } else {
     progs_[kShadeWithShadow].Use();
-    progs_[kShadeWithShadow].SetUniform("Light.La", kLightColor);
-    progs_[kShadeWithShadow].SetUniform("Light.Ld", kLightColor);
-    progs_[kShadeWithShadow].SetUniform("Light.Ls", kLightColor);
     progs_[kShadeWithShadow].SetUniform("ShadowMaps", 0);
+    SetupUniforms();
   }
+  frameBlock_.OnInit(UniformBinding::kFrame);
+  shadowList_.OnInit(kObjectsMax);
+  mainList_.OnInit(kObjectsMax);
 
   // CSM用のFBOの初期化を行います。
   if (!csmFBO_.OnInit(kCascadesMax, kShadowMapWidth, kShadowMapHeight)) {
@@ -98,19 +98,26 @@ void SceneCSM::OnUpdate(float t) {
 void SceneCSM::OnRender() {
   PrepareRender();
 
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
+  gpuTimer_.BeginFrame();
   {
+    gpuTimer_.Begin("Pass1 (Shadow Maps)");
     Pass1();
+    gpuTimer_.End();
+
+    gpuTimer_.Begin("Pass2 (Shading)");
     Pass2();
+    gpuTimer_.End();
   }
-  glDisable(GL_DEPTH_TEST);
+  gpuTimer_.EndFrame();
+  GLState::Get().Disable(GL_DEPTH_TEST);
 
   GUI::Render();
 }
 
 void SceneCSM::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 void SceneCSM::PrepareRender() {
@@ -123,14 +130,24 @@ void SceneCSM::PrepareRender() {
   progs_[kShadeWithShadow].SetUniform("CascadesNum", param_.cascades);
   csm.UpdateSplitPlanesUniform(
       param_.cascades, splits, camera_, [&](int i, float clip) {
-        const std::string plane =
-            fmt::format("CameraHomogeneousSplitPlanes[{}]", i);
-        progs_[kShadeWithShadow].SetUniform(plane.c_str(), clip);
+        progs_[kShadeWithShadow].SetUniform(uniforms_.splitPlanes[i], clip);
       });
 
   csm.UpdateFrustums(param_.cascades, splits, camera_);
   vpCrops_ = csm.ComputeCropMatrices(param_.cascades, kLightDefaultDir,
                                      static_cast<float>(kShadowMapSize));
+
+  // カスケードごとのシャドウ行列はオブジェクトに依らないので、フレームごとに一度だけ設定します。
+  const glm::mat4 kInvView = camera_.GetInverseViewMatrix();
+  for (int i = 0; i < param_.cascades; i++) {
+    const glm::mat4 kLightMVP = kShadowBias * vpCrops_[i] * kInvView;
+    progs_[kShadeWithShadow].SetUniform(uniforms_.shadowMatrices[i],
+                                        kLightMVP);
+  }
+
+  UpdateFrameBlock();
+  BuildDrawList(shadowList_, param_.shadowLodBias);
+  BuildDrawList(mainList_, 0);
 }
 
 // ********************************************************************************
@@ -143,49 +160,64 @@ std::optional<std::string> SceneCSM::CompileAndLinkShader() {
           {{"./Assets/Shaders/ShadowMap/RecordDepth.vs.glsl",
             ShaderType::Vertex},
            {"./Assets/Shaders/ShadowMap/RecordDepth.fs.glsl",
-            ShaderType::Fragment}})) {
+            ShaderType::Fragment}},
+          DrawList::GetDefines())) {
     return msg;
   }
   if (auto msg = progs_[kShadeWithShadow].CompileAndLink(
           {{"./Assets/Shaders/ShadowMap/CSM/CSM.vs.glsl", ShaderType::Vertex},
            {"./Assets/Shaders/ShadowMap/CSM/CSM.fs.glsl",
-            ShaderType::Fragment}})) {
+            ShaderType::Fragment}},
+          DrawList::GetDefines())) {
     return msg;
   }
   return std::nullopt;
 }
 
-void SceneCSM::SetMatrices() {
-  if (pass_ == kRecordDepth) {
-    const glm::mat4 mvp = vpCrops_[cascadeIdx_] * model_;
-    progs_[kRecordDepth].SetUniform("MVP", mvp);
-  } else if (pass_ == kShadeWithShadow) {
-    const glm::mat4 mv = view_ * model_;
-    progs_[kShadeWithShadow].SetUniform("ModelViewMatrix", mv);
-    progs_[kShadeWithShadow].SetUniform("NormalMatrix", glm::mat3(mv));
-
-    const glm::mat4 mvp = proj_ * mv;
-    progs_[kShadeWithShadow].SetUniform("MVP", mvp);
-
-    const glm::mat4 kInvView = camera_.GetInverseViewMatrix();
-    for (int i = 0; i < param_.cascades; i++) {
-      const glm::mat4 kLightMVP = kShadowBias * vpCrops_[i] * kInvView;
-      const std::string kUniLiMVP = fmt::format("ShadowMatrices[{}]", i);
-      progs_[kShadeWithShadow].SetUniform(kUniLiMVP.c_str(), kLightMVP);
-    }
+void SceneCSM::SetupUniforms() {
+  for (const auto &prog : progs_) {
+    prog.BindUniformBlock("FrameBlock", UniformBinding::kFrame);
+    DrawList::BindProgram(prog);
+  }
+
+  // 描画中に名前で引かないよう、ハンドルをリンク後に解決しておきます。
+  uniforms_.depthVP =
+      progs_[kRecordDepth].GetUniform<glm::mat4>("ViewProjection");
+
+  const ShaderProgram &prog = progs_[kShadeWithShadow];
+  for (int i = 0; i < kCascadesMax; i++) {
+    const std::string plane =
+        fmt::format("CameraHomogeneousSplitPlanes[{}]", i);
+    uniforms_.splitPlanes[i] = prog.GetUniform<float>(plane.c_str());
+
+    const std::string shadow = fmt::format("ShadowMatrices[{}]", i);
+    uniforms_.shadowMatrices[i] = prog.GetUniform<glm::mat4>(shadow.c_str());
   }
 }
 
+void SceneCSM::UpdateFrameBlock() {
+  FrameBlock frame{};
+  frame.view = camera_.GetViewMatrix();
+  frame.proj = camera_.GetProjectionMatrix();
+  frame.lightPosition = frame.view * glm::vec4(kLightDefaultPosition, 1.0f);
+  frame.lightLa = kLightColor;
+  frame.lightLd = kLightColor;
+  frame.lightLs = kLightColor;
+  frameBlock_.Update(frame);
+}
+
+void SceneCSM::Submit(DrawList &list, const TriangleMesh &mesh,
+                      std::size_t lod) {
+  object_.model = model_;
+  list.Add(mesh, object_, lod);
+}
+
 void SceneCSM::SetMaterialUniforms(const glm::vec3 &diff, const glm::vec3 &amb,
                                    const glm::vec3 &spec, float shininess) {
-
-  if (pass_ != kShadeWithShadow) {
-    return;
-  }
-  progs_[kShadeWithShadow].SetUniform("Material.Ka", amb);
-  progs_[kShadeWithShadow].SetUniform("Material.Kd", diff);
-  progs_[kShadeWithShadow].SetUniform("Material.Ks", spec);
-  progs_[kShadeWithShadow].SetUniform("Material.Shininess", shininess);
+  object_.ka = amb;
+  object_.kd = diff;
+  object_.ks = spec;
+  object_.shininess = shininess;
 }
 
 void SceneCSM::UpdateGUI() {
@@ -195,6 +227,7 @@ void SceneCSM::UpdateGUI() {
   ImGui::Checkbox("PCF ON", &param_.isPCF);
   ImGui::Checkbox("Visible Indicator", &param_.isVisibleIndicator);
   ImGui::Checkbox("Shadow Only", &param_.isShadowOnly);
+  ImGui::Checkbox("Frustum Culling", &param_.isFrustumCulling);
   ImGui::SliderFloat("Split Scheme Lambda", &param_.schemeLambda, 0.01f, 0.99f);
   ImGui::Text("Cascades");
   ImGui::SameLine();
@@ -205,7 +238,11 @@ void SceneCSM::UpdateGUI() {
     }
   }
   ImGui::SliderFloat("Camera Rotate Speed", &param_.rotSpeed, 0.0f, 1.0f);
+  ImGui::SliderFloat("LOD Threshold (px)", &param_.lodThreshold, 0.25f, 16.0f);
+  ImGui::SliderInt("Shadow LOD Bias", &param_.shadowLodBias, 0, 3);
   ImGui::End();
+
+  gpuTimer_.ShowGUI();
 }
 
 // ********************************************************************************
@@ -216,72 +253,88 @@ void SceneCSM::UpdateGUI() {
 void SceneCSM::Pass1() {
   pass_ = RenderPass::kRecordDepth;
 
-  glBindFramebuffer(GL_FRAMEBUFFER, csmFBO_.GetShadowFBO());
-  glViewport(0, 0, kShadowMapWidth, kShadowMapHeight);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, csmFBO_.GetShadowFBO());
+  GLState::Get().Viewport(0, 0, kShadowMapWidth, kShadowMapHeight);
 
-  glEnable(GL_POLYGON_OFFSET_FILL);
+  GLState::Get().Enable(GL_POLYGON_OFFSET_FILL);
   glPolygonOffset(2.5f, 10.0f);
-  glDisable(GL_CULL_FACE);
+  GLState::Get().Disable(GL_CULL_FACE);
 
-  progs_[kRecordDepth].Use();
   for (int i = 0; i < param_.cascades; i++) {
     cascadeIdx_ = i;
     glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
                               csmFBO_.GetDepthTextureArray(), 0, i);
     glClear(GL_DEPTH_BUFFER_BIT);
 
+    // カスケードのライトの視錐台から外れるものは描画しません。
+    if (param_.isFrustumCulling) {
+      shadowList_.Cull(vpCrops_[i]);
+    }
+
     // ライトから見たシーンの描画
-    DrawScene();
+    progs_[kRecordDepth].Use();
+    progs_[kRecordDepth].SetUniform(uniforms_.depthVP, vpCrops_[i]);
+    shadowList_.Draw();
   }
 
-  glEnable(GL_CULL_FACE);
-  glDisable(GL_POLYGON_OFFSET_FILL);
+  GLState::Get().Enable(GL_CULL_FACE);
+  GLState::Get().Disable(GL_POLYGON_OFFSET_FILL);
 }
 
 // render
 void SceneCSM::Pass2() {
   pass_ = RenderPass::kShadeWithShadow;
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
-  glViewport(0, 0, width_, height_);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().Viewport(0, 0, width_, height_);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D_ARRAY, csmFBO_.GetDepthTextureArray());
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D_ARRAY,
+                             csmFBO_.GetDepthTextureArray());
 
   proj_ = camera_.GetProjectionMatrix();
   view_ = camera_.GetViewMatrix();
+  if (param_.isFrustumCulling) {
+    mainList_.Cull(proj_ * view_);
+  }
   progs_[kShadeWithShadow].Use();
-  progs_[kShadeWithShadow].SetUniform(
-      "Light.Position", view_ * glm::vec4(kLightDefaultPosition, 1.0f));
   progs_[kShadeWithShadow].SetUniform("IsPCF", param_.isPCF);
   progs_[kShadeWithShadow].SetUniform("IsShadowOnly", param_.isShadowOnly);
   progs_[kShadeWithShadow].SetUniform("IsVisibleIndicator",
                                       param_.isVisibleIndicator);
 
-  DrawScene();
+  mainList_.Draw();
 
-  glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
 
-void SceneCSM::DrawScene() {
+/**
+ * @brief パスで描画するオブジェクトを集めて転送します。
+ * @param lodBias 建物の詳細度をいくつ粗くするか
+ */
+void SceneCSM::BuildDrawList(DrawList &list, int lodBias) {
+  list.Clear();
+
   const glm::vec3 diff = glm::vec3(1.0f, 0.85f, 0.55f);
   const glm::vec3 amb = diff * 0.1f;
   const glm::vec3 spec = glm::vec3(0.0f);
 
   // 建物の描画
+  // シャドウマップでもカメラからの距離で詳細度を選び、さらに粗くします。
+  const LodView lodView =
+      LodView::FromCamera(camera_, height_, param_.lodThreshold, lodBias);
   SetMaterialUniforms(diff, amb, spec, 1.0f);
   model_ = glm::mat4(1.0f);
-  SetMatrices();
-  building_->Render();
+  Submit(list, *building_, building_->SelectLod(lodView, model_));
 
   // 平面の描画
   SetMaterialUniforms(glm::vec3(0.25f, 0.25f, 0.25f),
                       glm::vec3(0.0f, 0.0f, 0.0f),
                       glm::vec3(0.05f, 0.05f, 0.05f), 1.0f);
   model_ = glm::mat4(1.0f);
-  SetMatrices();
-  plane_.Render();
+  Submit(list, plane_);
+  list.Upload();
 }
 
 // ********************************************************************************
@@ -15,13 +15,18 @@
 
 #include "Geometry/AABB.h"
 #include "Geometry/BSphere.h"
+#include "Graphics/GpuTimer.h"
 #include "Graphics/Shader.h"
+#include "Graphics/UniformBuffer.h"
 #include "Mesh/ObjMesh.h"
 #include "Primitive/Plane.h"
 #include "Primitive/Teapot.h"
 #include "Primitive/Torus.h"
+#include "Scene/DrawList.h"
+#include "Scene/UniformBlocks.h"
 #include "View/Camera.h"
 #include "View/Frustum.h"
+#include "View/LodView.h"
 
 #include "CascadedShadowMapsFBO.h"
 
@@ -37,7 +42,9 @@ private:
   void PrepareRender();
 
   std::optional<std::string> CompileAndLinkShader();
-  void SetMatrices();
+  void SetupUniforms();
+  void UpdateFrameBlock();
+  void Submit(DrawList &list, const TriangleMesh &mesh, std::size_t lod = 0);
   void SetMaterialUniforms(const glm::vec3 &diff, const glm::vec3 &amb,
                            const glm::vec3 &spec, float shininess);
   void SetupCamera();
@@ -46,13 +53,18 @@ private:
   void Pass2();
 
   void UpdateGUI();
-  void DrawScene();
+  void BuildDrawList(DrawList &list, int lodBias);
+
+  static constexpr inline int kCascadesMax = 8;
+  static constexpr inline std::size_t kObjectsMax = 32;
 
   Camera camera_;
 
   Plane plane_{20.0f, 20.0f, 1, 1};
   std::unique_ptr<ObjMesh> building_ =
-      std::make_unique<ObjMesh>("./Assets/Models/SDCC/building.obj");
+      std::make_unique<ObjMesh>("./Assets/Models/SDCC/building.obj",
+                                TriangleMesh::kCookOptimize |
+                                    TriangleMesh::kCookLods);
 
   float tPrev_ = 0.0f;
   float angle_ = glm::two_pi<float>() * 0.85f;
@@ -66,8 +78,20 @@ private:
   RenderPass pass_ = kRecordDepth;
   int cascadeIdx_ = 0;
 
+  UniformBlock<FrameBlock> frameBlock_{};
+  DrawList shadowList_{}; // 全カスケードで共有します。
+  DrawList mainList_{};
+  ObjectBlock object_{};
+
+  struct Uniforms {
+    Uniform<glm::mat4> depthVP;
+    std::array<Uniform<float>, kCascadesMax> splitPlanes;
+    std::array<Uniform<glm::mat4>, kCascadesMax> shadowMatrices;
+  } uniforms_{};
+
   CascadedShadowMapsFBO csmFBO_{};
   std::vector<glm::mat4> vpCrops_{};
+  GpuTimer gpuTimer_{};
 
   struct Param {
     int cascades = 3;
@@ -75,7 +99,10 @@ private:
     bool isPCF = true;
     bool isShadowOnly = false;
     bool isVisibleIndicator = false;
+    bool isFrustumCulling = true; // DrawList::Cull (GL 4.3 以上では計算シェーダー)
     float rotSpeed = 0.0f;
+    float lodThreshold = 1.0f; // 建物の詳細度を選ぶ画面上の誤差 [px]
+    int shadowLodBias = 1;     // シャドウマップの描画で詳細度をいくつ粗くするか
   } param_{};
 };
 
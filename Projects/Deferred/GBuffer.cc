@@ -1,5 +1,9 @@
 #include "GBuffer.h"
 
+#include "Graphics/GLState.h"
+
+namespace Deferred {
+
 GBuffer::~GBuffer() { Destroy(); }
 
 void GBuffer::Init(int w, int h) {
@@ -8,7 +12,7 @@ void GBuffer::Init(int w, int h) {
 
   // FBOの生成とバインド
   glGenFramebuffers(1, &buffers_[DeferredFBO]);
-  glBindFramebuffer(GL_FRAMEBUFFER, buffers_[DeferredFBO]);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, buffers_[DeferredFBO]);
 
   // 深度バッファの生成とバインド
   glGenRenderbuffers(1, &buffers_[DepthBuf]);
@@ -33,32 +37,33 @@ void GBuffer::Init(int w, int h) {
   const GLenum drawBuffers[] = {GL_NONE, GL_COLOR_ATTACHMENT0,
                                 GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2};
   glDrawBuffers(4, drawBuffers);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void GBuffer::PrepareRender() const {
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, textures_[PosTex]);
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[PosTex]);
 
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, textures_[NormTex]);
+  GLState::Get().ActiveTexture(GL_TEXTURE1);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[NormTex]);
 
-  glActiveTexture(GL_TEXTURE2);
-  glBindTexture(GL_TEXTURE_2D, textures_[ColorTex]);
+  GLState::Get().ActiveTexture(GL_TEXTURE2);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[ColorTex]);
 }
 
 void GBuffer::Destroy() {
-  glDeleteTextures(textures_.size(), textures_.data());
+  GLState::DeleteTextures(static_cast<GLsizei>(textures_.size()),
+                          textures_.data());
   glDeleteRenderbuffers(1, &buffers_[DepthBuf]);
-  glDeleteFramebuffers(1, &buffers_[DeferredFBO]);
+  GLState::DeleteFramebuffers(1, &buffers_[DeferredFBO]);
 }
 
 GLuint GBuffer::CreateGBufferTexture(GLenum texUnit, GLenum format) const {
   GLuint texId;
 
-  glActiveTexture(texUnit);
+  GLState::Get().ActiveTexture(texUnit);
   glGenTextures(1, &texId);
-  glBindTexture(GL_TEXTURE_2D, texId);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, texId);
 
   glTexStorage2D(GL_TEXTURE_2D, 1, format, width_, height_);
 
@@ -66,7 +71,9 @@ GLuint GBuffer::CreateGBufferTexture(GLenum texUnit, GLenum format) const {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
 
   return texId;
 }
+
+} // namespace Deferred
@@ -1,11 +1,14 @@
-#ifndef G_BUFFER_H
-#define G_BUFFER_H
+#ifndef DEFERRED_G_BUFFER_H
+#define DEFERRED_G_BUFFER_H
 
 #include "GLInclude.h"
 
 #include <array>
 #include <vector>
 
+// NOTE: SSAO にも GBuffer があるため、同じバイナリにリンクできるよう名前空間に入れています。
+namespace Deferred {
+
 class GBuffer {
 public:
   ~GBuffer();
@@ -36,4 +39,6 @@ private:
   std::array<GLuint, TextureNum> textures_; // GBuffer textures
 };
 
+} // namespace Deferred
+
 #endif
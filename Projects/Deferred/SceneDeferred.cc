@@ -10,6 +10,15 @@
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "GUI/GUI.h"
+#include "Graphics/GLState.h"
+
+// ********************************************************************************
+// constexpr variables
+// ********************************************************************************
+
+static constexpr std::size_t kObjectsMax = 16;
+
 // ********************************************************************************
 // Override functions
 // ********************************************************************************
@@ -24,7 +33,12 @@ void SceneDeferred::OnInit() {
     prog_.SetUniform("PositionTex", 0);
     prog_.SetUniform("NormalTex", 1);
     prog_.SetUniform("ColorTex", 2);
+
+    gbufferProg_.BindUniformBlock("FrameBlock", UniformBinding::kFrame);
+    DrawList::BindProgram(gbufferProg_);
   }
+  frameBlock_.OnInit(UniformBinding::kFrame);
+  drawList_.OnInit(kObjectsMax);
 
   // 四角形ポリゴン用配列
   GLfloat verts[] = {-1.0f, -1.0f, 0.0f, 1.0f, -1.0f, 0.0f, 1.0f,  1.0f, 0.0f,
@@ -42,7 +56,7 @@ void SceneDeferred::OnInit() {
 
   // 頂点配列オブジェクトの設定
   glGenVertexArrays(1, &quad_);
-  glBindVertexArray(quad_);
+  GLState::Get().BindVertexArray(quad_);
 
   glBindBuffer(GL_ARRAY_BUFFER, vbo_[0]);
   glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
@@ -52,7 +66,7 @@ void SceneDeferred::OnInit() {
   glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
   glEnableVertexAttribArray(2); // TexCoord
 
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 
   gbuffer_.Init(width_, height_);
 
@@ -60,11 +74,14 @@ void SceneDeferred::OnInit() {
 }
 
 void SceneDeferred::OnDestroy() {
-  glDeleteVertexArrays(1, &quad_);
+  GLState::DeleteVertexArrays(1, &quad_);
   glDeleteBuffers(vbo_.size(), vbo_.data());
 }
 
 void SceneDeferred::OnUpdate(float t) {
+  GUI::NewFrame();
+  gpuTimer_.ShowGUI();
+
   const float deltaT = tPrev_ == 0.0f ? 0.0f : t - tPrev_;
   tPrev_ = t;
 
@@ -75,13 +92,24 @@ void SceneDeferred::OnUpdate(float t) {
 }
 
 void SceneDeferred::OnRender() {
-  Pass1();
-  Pass2();
+  gpuTimer_.BeginFrame();
+  {
+    gpuTimer_.Begin("Pass1 (GBuffer)");
+    Pass1();
+    gpuTimer_.End();
+
+    gpuTimer_.Begin("Pass2 (Lighting)");
+    Pass2();
+    gpuTimer_.End();
+  }
+  gpuTimer_.EndFrame();
+
+  GUI::Render();
 }
 
 void SceneDeferred::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -98,17 +126,54 @@ void SceneDeferred::SetMatrices() {
 
 std::optional<std::string> SceneDeferred::CompileAndLinkShader() {
   // Compile and links
+  if (auto msg = gbufferProg_.CompileAndLink(
+          {{"./Assets/Shaders/Deferred/GBuffer.vs.glsl", ShaderType::Vertex},
+           {"./Assets/Shaders/Deferred/GBuffer.fs.glsl",
+            ShaderType::Fragment}},
+          DrawList::GetDefines())) {
+    return msg;
+  }
   return prog_.CompileAndLink(
       {{"./Assets/Shaders/Deferred/Deferred.vs.glsl", ShaderType::Vertex},
        {"./Assets/Shaders/Deferred/Deferred.fs.glsl", ShaderType::Fragment}});
 }
 
-void SceneDeferred::Pass1() {
-  prog_.SetUniform("Pass", 1);
+/**
+ * @brief GBuffer に書き込むオブジェクトを集めて転送します。
+ */
+void SceneDeferred::BuildDrawList() {
+  drawList_.Clear();
+  ObjectBlock object{};
+
+  // ティーポットの描画
+  object.kd = glm::vec3(0.9f, 0.9f, 0.9f);
+  object.model = glm::mat4(1.0f);
+  object.model = glm::translate(object.model, glm::vec3(0.0f, 0.0f, 0.0f));
+  object.model = glm::rotate(object.model, glm::radians(-90.0f),
+                             glm::vec3(1.0f, 0.0f, 0.0f));
+  drawList_.Add(teapot_, object);
+
+  // 平面の描画
+  object.kd = glm::vec3(0.4f, 0.4f, 0.4f);
+  object.model = glm::mat4(1.0f);
+  object.model = glm::translate(object.model, glm::vec3(0.0f, -0.75f, 0.0f));
+  drawList_.Add(plane_, object);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetDeferredFBO());
+  // トーラスの描画
+  object.kd = glm::vec3(0.9f, 0.5f, 0.2f);
+  object.model = glm::mat4(1.0f);
+  object.model = glm::translate(object.model, glm::vec3(3.0f, 1.0f, 3.0f));
+  object.model = glm::rotate(object.model, glm::radians(90.0f),
+                             glm::vec3(1.0f, 0.0f, 0.0f));
+  drawList_.Add(torus_, object);
+
+  drawList_.Upload();
+}
+
+void SceneDeferred::Pass1() {
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetDeferredFBO());
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
 
   view_ = glm::lookAt(glm::vec3(7.0f * cos(angle_), 4.0f, 7.0f * sin(angle_)),
                       glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
@@ -116,43 +181,29 @@ void SceneDeferred::Pass1() {
       glm::radians(60.0f),
       static_cast<float>(width_) / static_cast<float>(height_), 0.3f, 100.0f);
 
-  // ティーポットの描画
-  prog_.SetUniform("Light.Position", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
-  prog_.SetUniform("Material.Kd", 0.9f, 0.9f, 0.9f);
-  model_ = glm::mat4(1.0f);
-  model_ = glm::translate(model_, glm::vec3(0.0f, 0.0f, 0.0f));
-  model_ =
-      glm::rotate(model_, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-  SetMatrices();
-  teapot_.Render();
+  FrameBlock frame{};
+  frame.view = view_;
+  frame.proj = proj_;
+  frameBlock_.Update(frame);
 
-  // 平面の描画
-  prog_.SetUniform("Material.Kd", 0.4f, 0.4f, 0.4f);
-  model_ = glm::mat4(1.0f);
-  model_ = glm::translate(model_, glm::vec3(0.0f, -0.75f, 0.0f));
-  SetMatrices();
-  plane_.Render();
-
-  // トーラスの描画
-  prog_.SetUniform("Light.Position", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
-  prog_.SetUniform("Material.Kd", 0.9f, 0.5f, 0.2f);
-  model_ = glm::mat4(1.0f);
-  model_ = glm::translate(model_, glm::vec3(3.0f, 1.0f, 3.0f));
-  model_ =
-      glm::rotate(model_, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-  SetMatrices();
-  torus_.Render();
+  BuildDrawList();
+  // 視錐台から外れるものは描画しません。(Cull は使用中のプログラムを変えます)
+  drawList_.Cull(proj_ * view_);
+  gbufferProg_.Use();
+  drawList_.Draw();
 
   glFlush();
 }
 
 void SceneDeferred::Pass2() {
+  prog_.Use();
   prog_.SetUniform("Pass", 2);
+  prog_.SetUniform("Light.Position", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
 
   // デフォルトのフレームバッファに戻します
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glDisable(GL_DEPTH_TEST);
+  GLState::Get().Disable(GL_DEPTH_TEST);
 
   view_ = glm::mat4(1.0f);
   proj_ = glm::mat4(1.0f);
@@ -161,7 +212,7 @@ void SceneDeferred::Pass2() {
   gbuffer_.PrepareRender();
 
   // 四角形ポリゴンとして描画していく
-  glBindVertexArray(quad_);
+  GLState::Get().BindVertexArray(quad_);
   glDrawArrays(GL_TRIANGLES, 0, 6);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
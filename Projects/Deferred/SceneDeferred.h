@@ -12,10 +12,14 @@
 #include <string>
 
 #include "GBuffer.h"
+#include "Graphics/GpuTimer.h"
 #include "Graphics/Shader.h"
+#include "Graphics/UniformBuffer.h"
 #include "Primitive/Plane.h"
 #include "Primitive/Teapot.h"
 #include "Primitive/Torus.h"
+#include "Scene/DrawList.h"
+#include "Scene/UniformBlocks.h"
 
 class SceneDeferred : public Scene {
 public:
@@ -29,6 +33,7 @@ private:
   void Pass1();
   void Pass2();
   void SetMatrices();
+  void BuildDrawList();
   std::optional<std::string> CompileAndLinkShader();
 
   static inline constexpr float rotSpeed_ = glm::pi<float>() / 8.0f;
@@ -40,8 +45,12 @@ private:
   float angle_ = glm::pi<float>() / 2.0f;
   float tPrev_ = 0.0f;
 
-  ShaderProgram prog_;
-  GBuffer gbuffer_;
+  ShaderProgram gbufferProg_; // Pass1 (GBuffer への書き込み)
+  ShaderProgram prog_;        // Pass2 (ライティング)
+  UniformBlock<FrameBlock> frameBlock_{};
+  DrawList drawList_{};
+  Deferred::GBuffer gbuffer_;
+  GpuTimer gpuTimer_;
 
   GLuint quad_ = 0;
   std::array<GLuint, 2> vbo_;
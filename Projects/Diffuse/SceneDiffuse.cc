@@ -13,6 +13,8 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Graphics/GLState.h"
+
 // ********************************************************************************
 // Override functions
 // ********************************************************************************
@@ -23,7 +25,7 @@ void SceneDiffuse::OnInit() {
     BOOST_ASSERT_MSG(false, "failed to compile or link!");
   }
 
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
 
   model_ = glm::mat4(1.0f);
   model_ =
@@ -54,7 +56,7 @@ void SceneDiffuse::OnRender() {
 
 void SceneDiffuse::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
   proj_ = glm::perspective(glm::radians(70.0f),
                            static_cast<float>(w) / static_cast<float>(h), 0.3f,
                            100.0f);
@@ -10,11 +10,11 @@
 
 #include <boost/assert.hpp>
 #include <glm/gtc/matrix_transform.hpp>
-#include <imgui.h>
-#include <imgui_impl_glfw.h>
-#include <imgui_impl_opengl3.h>
 #include <iostream>
 
+#include "GUI/GUI.h"
+#include "Graphics/GLState.h"
+
 // ********************************************************************************
 // Override functions
 // ********************************************************************************
@@ -26,9 +26,7 @@ void SceneGUI::OnDestroy() {}
 void SceneGUI::OnUpdate(float) {}
 
 void SceneGUI::OnRender() {
-  ImGui_ImplOpenGL3_NewFrame();
-  ImGui_ImplGlfw_NewFrame();
-  ImGui::NewFrame();
+  GUI::NewFrame();
 
   if (param_.showDemoWindow) {
     ImGui::ShowDemoWindow(&param_.showDemoWindow);
@@ -64,14 +62,13 @@ void SceneGUI::OnRender() {
     ImGui::End();
   }
 
-  ImGui::Render();
   glClearColor(param_.clearColor.x, param_.clearColor.y, param_.clearColor.z,
                param_.clearColor.w);
   glClear(GL_COLOR_BUFFER_BIT);
-  ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+  GUI::Render();
 }
 
 void SceneGUI::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
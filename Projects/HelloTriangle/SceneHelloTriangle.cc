@@ -11,6 +11,8 @@
 
 #include "SceneHelloTriangle.h"
 
+#include "Graphics/GLState.h"
+
 // ********************************************************************************
 // Override functions
 // ********************************************************************************
@@ -25,7 +27,7 @@ void SceneHelloTriangle::OnInit() {
 }
 
 void SceneHelloTriangle::OnDestroy() {
-  glDeleteVertexArrays(1, &vao_);
+  GLState::DeleteVertexArrays(1, &vao_);
   glDeleteBuffers(static_cast<GLsizei>(vbo_.size()), vbo_.data());
 }
 
@@ -37,14 +39,14 @@ void SceneHelloTriangle::OnRender() {
   glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
   glClear(GL_COLOR_BUFFER_BIT);
 
-  glBindVertexArray(vao_);
+  GLState::Get().BindVertexArray(vao_);
   glDrawArrays(GL_TRIANGLES, 0, 3);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
 
 void SceneHelloTriangle::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -76,7 +78,7 @@ void SceneHelloTriangle::CreateVAO() {
   glBufferData(GL_ARRAY_BUFFER, sizeof(color), color, GL_STATIC_DRAW);
 
   glGenVertexArrays(1, &vao_);
-  glBindVertexArray(vao_);
+  GLState::Get().BindVertexArray(vao_);
 
   glEnableVertexAttribArray(0); // Vertex position
   glEnableVertexAttribArray(1); // Vertex color
@@ -88,5 +90,5 @@ void SceneHelloTriangle::CreateVAO() {
   glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
 
   glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
@@ -0,0 +1,33 @@
+/**
+ * @brief  Instancing Scene
+ */
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <memory>
+
+#include "App.h"
+#include "Scene/SceneLoop.h"
+#include "SceneInstancing.h"
+
+// ********************************************************************************
+// Entry point
+// ********************************************************************************
+
+int main(
+#if true
+    void
+#else
+    int argc, char **argv
+#endif
+) {
+  App app("Instancing");
+
+  // Create scene
+  std::unique_ptr<Scene> scene = std::make_unique<SceneInstancing>();
+
+  // Enter the main loop
+  return SceneLoop::Run(app, std::move(scene));
+}
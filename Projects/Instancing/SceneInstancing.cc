@@ -0,0 +1,284 @@
+/**
+ * @brief インスタンス描画のテストシーン
+ */
+
+#include "SceneInstancing.h"
+
+#include <algorithm>
+#include <boost/assert.hpp>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "GUI/GUI.h"
+#include "Graphics/GLState.h"
+#include "HID/KeyInput.h"
+
+// ********************************************************************************
+// constexpr variables
+// ********************************************************************************
+
+static constexpr float kSpacing = 1.0f; // 隣り合うインスタンスの間隔
+static constexpr float kRotSpeed = glm::pi<float>() / 16.0f;
+static constexpr float kCameraFOVY = 50.0f;
+
+static constexpr std::array<glm::vec3, 8> kMaterialColors{
+    glm::vec3(0.9f, 0.3f, 0.2f), glm::vec3(0.2f, 0.7f, 0.3f),
+    glm::vec3(0.2f, 0.4f, 0.9f), glm::vec3(0.9f, 0.8f, 0.2f),
+    glm::vec3(0.8f, 0.3f, 0.8f), glm::vec3(0.2f, 0.8f, 0.8f),
+    glm::vec3(0.9f, 0.6f, 0.3f), glm::vec3(0.7f, 0.7f, 0.7f),
+};
+
+static constexpr glm::vec3 kLightDirection{0.408248f, 0.816497f, 0.408248f};
+
+// ********************************************************************************
+// Override functions
+// ********************************************************************************
+
+void SceneInstancing::OnInit() {
+  if (const auto msg = CompileAndLinkShader()) {
+    std::cerr << msg.value() << std::endl;
+    BOOST_ASSERT_MSG(false, "failed to compile or link!");
+  } else {
+    SetupUniforms();
+  }
+
+  instanceBuffer_.OnInit(kInstancesMax);
+  count_ = std::clamp(count_, 1, kInstancesMax);
+  BuildInstances();
+
+  glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+}
+
+void SceneInstancing::OnUpdate(float t) {
+  UpdateGUI();
+
+  const float deltaT = tPrev_ == 0.0f ? 0.0f : t - tPrev_;
+  tPrev_ = t;
+
+  angle_ += kRotSpeed * deltaT;
+  if (angle_ > glm::two_pi<float>()) {
+    angle_ -= glm::two_pi<float>();
+  }
+
+  const int num = static_cast<int>(Mode::Num);
+  int mode = static_cast<int>(mode_);
+  if (KeyInput::Get().IsTrg(Key::Right)) {
+    mode = (mode + 1) % num;
+  } else if (KeyInput::Get().IsTrg(Key::Left)) {
+    mode = (mode + num - 1) % num;
+  }
+  mode_ = static_cast<Mode>(mode);
+
+  if (count_ != builtCount_) {
+    BuildInstances();
+  }
+}
+
+void SceneInstancing::OnRender() {
+  glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  GLState::Get().Enable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_CULL_FACE);
+
+  // 格子のすぐ外側から中心を見て、手前の角などが視錐台から外れるようにします。
+  const float distance = extent_ + 2.0f;
+  view_ = glm::lookAt(glm::vec3(distance * std::cos(angle_), extent_ * 0.5f,
+                                distance * std::sin(angle_)),
+                      glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+  proj_ = glm::perspective(
+      glm::radians(kCameraFOVY),
+      static_cast<float>(width_) / static_cast<float>(height_), 0.1f,
+      distance * 4.0f);
+
+  gpuTimer_.BeginFrame();
+  {
+    const auto begin = std::chrono::steady_clock::now();
+    gpuTimer_.Begin(mode_ == Mode::Instanced ? "Instanced" : "Loop");
+    CullInstances();
+    if (mode_ == Mode::Instanced) {
+      RenderInstanced();
+    } else {
+      RenderLoop();
+    }
+    gpuTimer_.End();
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - begin;
+    submitMs_ = elapsed.count();
+  }
+  gpuTimer_.EndFrame();
+
+  GLState::Get().Disable(GL_CULL_FACE);
+  GLState::Get().Disable(GL_DEPTH_TEST);
+
+  GUI::Render();
+}
+
+void SceneInstancing::OnResize(int w, int h) {
+  SetDimensions(w, h);
+  GLState::Get().Viewport(0, 0, w, h);
+}
+
+// ********************************************************************************
+// Shader settings
+// ********************************************************************************
+
+std::optional<std::string> SceneInstancing::CompileAndLinkShader() {
+  // compile and links
+  const std::vector<std::pair<std::string, ShaderType>> stages = {
+      {"./Assets/Shaders/Instancing/Instancing.vs.glsl", ShaderType::Vertex},
+      {"./Assets/Shaders/Instancing/Instancing.fs.glsl", ShaderType::Fragment},
+  };
+  if (auto msg = progs_[static_cast<std::size_t>(Mode::Instanced)]
+                     .CompileAndLink(stages, {{"INSTANCED", ""}})) {
+    return msg;
+  }
+  return progs_[static_cast<std::size_t>(Mode::Loop)].CompileAndLink(stages);
+}
+
+void SceneInstancing::SetupUniforms() {
+  for (std::size_t i = 0; i < progs_.size(); i++) {
+    const ShaderProgram &prog = progs_[i];
+    prog.Use();
+    for (std::size_t m = 0; m < kMaterialColors.size(); m++) {
+      prog.SetUniform(("MaterialColors[" + std::to_string(m) + "]").c_str(),
+                      kMaterialColors[m]);
+    }
+    prog.SetUniform("LightDirection", kLightDirection);
+    viewProj_[i] = prog.GetUniform<glm::mat4>("ViewProjection");
+  }
+  const ShaderProgram &loop = progs_[static_cast<std::size_t>(Mode::Loop)];
+  loopModel_ = loop.GetUniform<glm::mat4>("InstanceModel");
+  loopMaterial_ = loop.GetUniform<int>("InstanceMaterial");
+}
+
+// ********************************************************************************
+// Drawing
+// ********************************************************************************
+
+/**
+ * @brief count_ 個のインスタンスを立方体の格子に並べ、インスタンスのバッファに転送します。
+ * @note 描画の方法による違いだけを比べられるよう、データは個数が変わったときにだけ作り直します。
+ */
+void SceneInstancing::BuildInstances() {
+  const int side = static_cast<int>(
+      std::ceil(std::cbrt(static_cast<float>(count_)) - 1e-3f));
+  extent_ = 0.5f * kSpacing * static_cast<float>(side - 1);
+
+  instances_.resize(static_cast<std::size_t>(count_));
+  const AABB bbox = torus_.GetAABB();
+  const glm::vec3 center = (bbox.mini + bbox.maxi) * 0.5f;
+  const float radius = glm::length(bbox.maxi - bbox.mini) * 0.5f;
+  spheres_ = Spheres{};
+  for (int i = 0; i < count_; i++) {
+    const int x = i % side;
+    const int y = (i / side) % side;
+    const int z = i / (side * side);
+    const glm::vec3 position =
+        glm::vec3(static_cast<float>(x), static_cast<float>(y),
+                  static_cast<float>(z)) *
+            kSpacing -
+        glm::vec3(extent_);
+    // 向きは番号から決め、同じ格子であれば毎回同じ並びになるようにします。
+    const float angle = static_cast<float>(i) * 0.618034f * glm::two_pi<float>();
+    InstanceBuffer::Instance &instance = instances_[static_cast<std::size_t>(i)];
+    instance.model = glm::translate(glm::mat4(1.0f), position);
+    instance.model = glm::rotate(instance.model, angle,
+                                 glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f)));
+    instance.material = static_cast<GLuint>(i) %
+                        static_cast<GLuint>(kMaterialColors.size());
+
+    const glm::vec3 c = glm::vec3(instance.model * glm::vec4(center, 1.0f));
+    spheres_.x.emplace_back(c.x);
+    spheres_.y.emplace_back(c.y);
+    spheres_.z.emplace_back(c.z);
+    spheres_.radius.emplace_back(radius);
+  }
+  visible_.assign(instances_.size(), 1);
+  visibleCount_ = count_;
+  instanceBuffer_.Update(instances_.data(), instances_.size());
+  isBufferCulled_ = false;
+  builtCount_ = count_;
+}
+
+/**
+ * @brief 描画の呼び出しの前に、全インスタンスの境界球をまとめて視錐台と比べます。
+ */
+void SceneInstancing::CullInstances() {
+  if (isCulling_) {
+    frustum_.SetupPlanes(proj_ * view_);
+    visibleCount_ = static_cast<int>(frustum_.CullSpheres(
+        {spheres_.x.data(), spheres_.y.data(), spheres_.z.data(),
+         spheres_.radius.data(), spheres_.x.size()},
+        visible_.data()));
+  } else {
+    std::fill(visible_.begin(), visible_.end(), std::uint8_t{1});
+    visibleCount_ = count_;
+  }
+}
+
+void SceneInstancing::RenderInstanced() {
+  // 残ったものだけを詰め直して転送します。カリングしない場合は全てを一度だけ転送します。
+  if (isCulling_) {
+    visibleInstances_.clear();
+    for (std::size_t i = 0; i < instances_.size(); i++) {
+      if (visible_[i] != 0) {
+        visibleInstances_.emplace_back(instances_[i]);
+      }
+    }
+    instanceBuffer_.Update(visibleInstances_.data(), visibleInstances_.size());
+    isBufferCulled_ = true;
+  } else if (isBufferCulled_) {
+    instanceBuffer_.Update(instances_.data(), instances_.size());
+    isBufferCulled_ = false;
+  }
+
+  const std::size_t mode = static_cast<std::size_t>(Mode::Instanced);
+  progs_[mode].Use();
+  progs_[mode].SetUniform(viewProj_[mode], proj_ * view_);
+  torus_.RenderInstanced(instanceBuffer_, visibleCount_);
+}
+
+void SceneInstancing::RenderLoop() {
+  const std::size_t mode = static_cast<std::size_t>(Mode::Loop);
+  progs_[mode].Use();
+  progs_[mode].SetUniform(viewProj_[mode], proj_ * view_);
+
+  for (std::size_t i = 0; i < instances_.size(); i++) {
+    if (visible_[i] == 0) {
+      continue;
+    }
+    const InstanceBuffer::Instance &instance = instances_[i];
+    progs_[mode].SetUniform(loopModel_, instance.model);
+    progs_[mode].SetUniform(loopMaterial_, static_cast<int>(instance.material));
+    torus_.Render();
+  }
+}
+
+// ********************************************************************************
+// GUI
+// ********************************************************************************
+
+void SceneInstancing::UpdateGUI() {
+  GUI::NewFrame();
+
+  ImGui::Begin("Instancing Config");
+  int mode = static_cast<int>(mode_);
+  ImGui::RadioButton("Instanced", &mode, static_cast<int>(Mode::Instanced));
+  ImGui::SameLine();
+  ImGui::RadioButton("Per-object Loop", &mode, static_cast<int>(Mode::Loop));
+  mode_ = static_cast<Mode>(mode);
+  ImGui::SliderInt("Instances", &count_, 1, kInstancesMax, "%d",
+                   ImGuiSliderFlags_Logarithmic);
+  ImGui::Checkbox("Frustum Culling", &isCulling_);
+  ImGui::Text("Draw calls: %d", mode_ == Mode::Instanced ? 1 : visibleCount_);
+  ImGui::Text("Visible: %d / %d", visibleCount_, count_);
+  ImGui::Text("Triangles: %d",
+              visibleCount_ * static_cast<int>(torus_.GetNumVers() / 3));
+  ImGui::Text("Submit (CPU): %.3f ms", submitMs_);
+  ImGui::End();
+
+  gpuTimer_.ShowGUI();
+}
@@ -0,0 +1,88 @@
+/**
+ * @brief インスタンス描画のテストシーン
+ */
+
+#ifndef SCENE_INSTANCING_H
+#define SCENE_INSTANCING_H
+
+#include "Scene/Scene.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Graphics/GpuTimer.h"
+#include "Graphics/Shader.h"
+#include "Primitive/InstanceBuffer.h"
+#include "Primitive/Torus.h"
+#include "View/Frustum.h"
+
+/**
+ * @brief 同じトーラスを格子状に最大 10 万個並べ、RenderInstanced 一回で描画する場合と、
+ * オブジェクトごとにユニフォームを設定して Render する場合の処理時間を比べます。
+ * どちらの場合も、視錐台から外れるものを境界球で一括して判定して飛ばします。
+ * (インスタンス描画では残ったものだけをインスタンスのバッファに詰め直します)
+ */
+class SceneInstancing : public Scene {
+public:
+  /**< @brief 描画の方法 (左右キーで切り替えます) */
+  enum struct Mode : std::int32_t {
+    Instanced, // TriangleMesh::RenderInstanced
+    Loop,      // オブジェクトごとに SetUniform と Render
+    Num,
+  };
+
+  static constexpr int kInstancesMax = 100000;
+  static constexpr int kInstancesDefault = 10000;
+
+  explicit SceneInstancing(Mode mode = Mode::Instanced,
+                           int count = kInstancesDefault)
+      : mode_(mode), count_(count) {}
+
+  void OnInit() override;
+  void OnUpdate(float) override;
+  void OnRender() override;
+  void OnResize(int, int) override;
+
+private:
+  std::optional<std::string> CompileAndLinkShader();
+  void SetupUniforms();
+  void BuildInstances();
+  void UpdateGUI();
+  void CullInstances();
+  void RenderInstanced();
+  void RenderLoop();
+
+  Torus torus_{0.3f, 0.12f, 12, 8};
+
+  std::array<ShaderProgram, static_cast<std::size_t>(Mode::Num)> progs_{};
+  std::array<Uniform<glm::mat4>, static_cast<std::size_t>(Mode::Num)>
+      viewProj_{};
+  Uniform<glm::mat4> loopModel_{};
+  Uniform<int> loopMaterial_{};
+
+  std::vector<InstanceBuffer::Instance> instances_{};
+  std::vector<InstanceBuffer::Instance> visibleInstances_{}; // 詰め直したもの
+  struct Spheres {
+    std::vector<float> x, y, z, radius;
+  } spheres_{}; // インスタンスのワールド座標系での境界球 (SoA)
+  std::vector<std::uint8_t> visible_{};
+  Frustum frustum_{};
+  InstanceBuffer instanceBuffer_{};
+  GpuTimer gpuTimer_;
+
+  Mode mode_ = Mode::Instanced;
+  int count_ = kInstancesDefault;
+  int builtCount_ = 0;   // instances_ を作ったときの count_
+  float extent_ = 1.0f;  // 格子の一辺の長さの半分
+  float angle_ = 0.0f;
+  float tPrev_ = 0.0f;
+  double submitMs_ = 0.0; // 描画の呼び出しにかかった CPU 時間
+  bool isCulling_ = true;
+  bool isBufferCulled_ = false; // instanceBuffer_ が詰め直したものを持っているか
+  int visibleCount_ = 0;
+};
+
+#endif
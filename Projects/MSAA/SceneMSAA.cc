@@ -13,6 +13,7 @@
 #include "SceneMSAA.h"
 
 #include "GUI/GUI.h"
+#include "Graphics/GLState.h"
 
 // ********************************************************************************
 // Override functions
@@ -36,7 +37,7 @@ void SceneMSAA::OnInit() {
 }
 
 void SceneMSAA::OnDestroy() {
-  glDeleteVertexArrays(1, &quad_);
+  GLState::DeleteVertexArrays(1, &quad_);
   glDeleteBuffers(static_cast<GLsizei>(vbo_.size()), vbo_.data());
 }
 
@@ -59,7 +60,7 @@ void SceneMSAA::OnRender() {
 
 void SceneMSAA::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -98,7 +99,7 @@ void SceneMSAA::CreateVAO() {
   glBufferData(GL_ARRAY_BUFFER, sizeof(tc), tc, GL_STATIC_DRAW);
 
   glGenVertexArrays(1, &quad_);
-  glBindVertexArray(quad_);
+  GLState::Get().BindVertexArray(quad_);
 
   glBindBuffer(GL_ARRAY_BUFFER, vbo_[Position]);
   glVertexAttribPointer(Position, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
@@ -109,7 +110,7 @@ void SceneMSAA::CreateVAO() {
   glEnableVertexAttribArray(TexCoord);
 
   glBindBuffer(GL_ARRAY_BUFFER, 0);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
 
 void SceneMSAA::UpdateGUI() {
@@ -127,9 +128,9 @@ void SceneMSAA::UpdateGUI() {
 // ********************************************************************************
 
 void SceneMSAA::DrawQuad() {
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
   if (param_.isEnabledMSAA) {
-    glEnable(GL_MULTISAMPLE);
+    GLState::Get().Enable(GL_MULTISAMPLE);
   }
 
   glClearColor(0.5f, 0.5f, 0.5f, 1.0f);
@@ -151,10 +152,10 @@ void SceneMSAA::DrawQuad() {
     noCentroid_.SetUniform("MVP", proj_ * view_ * model_);
   }
 
-  glBindVertexArray(quad_);
+  GLState::Get().BindVertexArray(quad_);
   glDrawArrays(GL_TRIANGLES, 0, 6);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 
-  glDisable(GL_MULTISAMPLE);
-  glDisable(GL_DEPTH_TEST);
+  GLState::Get().Disable(GL_MULTISAMPLE);
+  GLState::Get().Disable(GL_DEPTH_TEST);
 }
@@ -11,12 +11,15 @@
 #include <map>
 
 #include "GUI/GUI.h"
+#include "Graphics/GLState.h"
 
 // ********************************************************************************
 // Constant expressions
 // ********************************************************************************
 
 static constexpr float kFOVY = 60.0f;
+static constexpr float kNear = 0.3f;
+static constexpr float kFar = 100.0f;
 static const std::map<MetalColor, glm::vec3> kMetalLinearRGB{
     {MetalColor::Nil, glm::vec3(0.0f, 0.0f, 0.0f)},
     {MetalColor::Iron, glm::vec3(0.560f, 0.570f, 0.580f)},
@@ -49,7 +52,7 @@ void ScenePBR::OnInit() {
                       glm::vec3(0.0f, 1.0f, 0.0f));
   proj_ = glm::perspective(
       glm::radians(kFOVY),
-      static_cast<float>(width_) / static_cast<float>(height_), 0.3f, 100.0f);
+      static_cast<float>(width_) / static_cast<float>(height_), kNear, kFar);
 
   if (const auto msg = CompileAndLinkShader()) {
     std::cerr << msg.value() << std::endl;
@@ -64,7 +67,7 @@ void ScenePBR::OnInit() {
     prog_.SetUniform("Light[2].Position", view_ * lightPositions_[2]);
   }
 
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
 }
 
 void ScenePBR::OnUpdate(float t) {
@@ -87,13 +90,14 @@ void ScenePBR::OnUpdate(float t) {
 void ScenePBR::OnRender() {
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
   prog_.SetUniform("Light[0].Position", view_ * lightPositions_[0]);
+  SubmitScene();
   DrawScene();
 
   GUI::Render();
 }
 
 void ScenePBR::OnResize(int w, int h) {
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
   SetDimensions(w, h);
 }
 
@@ -149,39 +153,65 @@ void ScenePBR::UpdateGUI() {
   ImGui::End();
 }
 
-void ScenePBR::DrawScene() {
-  DrawFloor();
-
-  DrawMesh(glm::vec3(3.0f, 0.0f, 0.0f), param_.dielectricRough, 0,
-           param_.dielectricBaseColor);
-  DrawMesh(glm::vec3(-3.0, 0.0f, 0.0f), param_.metalRough, 1,
-           param_.metalSpecular);
-}
+/**
+ * @brief 描画するものを RenderQueue に積みます。
+ * @note 積む順に依らず、並べ替えた後はマテリアルごとに手前から描画されます。
+ */
+void ScenePBR::SubmitScene() {
+  queue_.Clear();
+  objects_.clear();
 
-void ScenePBR::DrawFloor() {
+  material_ = Material{1.0f, 0.0f, 1.0f, glm::vec3(0.0f)};
   model_ = glm::mat4(1.0f);
-  prog_.SetUniform("Material.Roughness", 1.0f);
-  prog_.SetUniform("Material.Metallic", 0.0f);
-  prog_.SetUniform("Material.Reflectance", 1.0f);
-  prog_.SetUniform("Material.BaseColor", glm::vec3(0.0f));
   model_ = glm::translate(model_, glm::vec3(0.0f, -3.0f, 0.0f));
-  SetMatrices();
+  Submit(kPlane, kFloor);
+
+  SubmitMesh(glm::vec3(3.0f, 0.0f, 0.0f), kDielectric, param_.dielectricRough,
+             0, param_.dielectricBaseColor);
+  SubmitMesh(glm::vec3(-3.0, 0.0f, 0.0f), kMetal, param_.metalRough, 1,
+             param_.metalSpecular);
 
-  plane_.Render();
+  queue_.Sort();
 }
 
-void ScenePBR::DrawMesh(const glm::vec3 &pos, float rough, int metal,
-                        const glm::vec3 &color) {
-  prog_.SetUniform("Material.Roughness", rough);
-  prog_.SetUniform("Material.Metallic", static_cast<float>(metal));
-  prog_.SetUniform("Material.Reflectance", param_.dielectricReflectance);
-  prog_.SetUniform("Material.BaseColor", color);
+void ScenePBR::SubmitMesh(const glm::vec3 &pos, std::uint32_t materialId,
+                          float rough, int metal, const glm::vec3 &color) {
+  material_ = Material{rough, static_cast<float>(metal),
+                       param_.dielectricReflectance, color};
   model_ = glm::translate(glm::mat4(1.0f), pos);
   model_ =
       glm::rotate(model_, glm::radians(180.0f), glm::vec3(0.0f, 1.0f, 0.0f));
   model_ = glm::scale(model_, glm::vec3(3.0f));
+  Submit(kSpot, materialId);
+}
 
-  SetMatrices();
+void ScenePBR::Submit(std::uint32_t mesh, std::uint32_t materialId) {
+  // 深度はモデルの原点のカメラからの距離を [near, far] で正規化したものです。
+  const float z = -(view_ * model_[3]).z;
+  RenderQueue::Item item{};
+  item.mesh = mesh;
+  item.material = materialId;
+  item.depth = (z - kNear) / (kFar - kNear);
+  item.payload = static_cast<std::uint32_t>(objects_.size());
+  objects_.push_back({model_, material_});
+  queue_.Submit(item);
+}
 
-  mesh_->Render();
+void ScenePBR::DrawScene() {
+  queue_.Execute([this](const RenderQueue::Item &item, std::uint32_t changes) {
+    const Object &object = objects_[item.payload];
+    if (changes & RenderQueue::kMaterialChanged) {
+      prog_.SetUniform("Material.Roughness", object.material.roughness);
+      prog_.SetUniform("Material.Metallic", object.material.metallic);
+      prog_.SetUniform("Material.Reflectance", object.material.reflectance);
+      prog_.SetUniform("Material.BaseColor", object.material.baseColor);
+    }
+    model_ = object.model;
+    SetMatrices();
+    if (item.mesh == kPlane) {
+      plane_.Render();
+    } else {
+      mesh_->Render();
+    }
+  });
 }
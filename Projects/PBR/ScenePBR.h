@@ -7,14 +7,17 @@
 
 #include "Scene/Scene.h"
 
+#include <cstdint>
 #include <glm/gtc/constants.hpp>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "Graphics/Shader.h"
 #include "Mesh/ObjMesh.h"
 #include "Primitive/Plane.h"
 #include "Primitive/Teapot.h"
+#include "Scene/RenderQueue.h"
 
 enum struct MetalColor : std::uint32_t {
   Nil,
@@ -42,12 +45,33 @@ private:
   std::optional<std::string> CompileAndLinkShader();
   void SetMatrices();
   void UpdateGUI();
+  void SubmitScene();
+  void SubmitMesh(const glm::vec3 &pos, std::uint32_t materialId, float rough,
+                  int metal, const glm::vec3 &color);
+  void Submit(std::uint32_t mesh, std::uint32_t materialId);
   void DrawScene();
-  void DrawFloor();
-  void DrawMesh(const glm::vec3 &pos, float rough, int metal,
-                const glm::vec3 &color);
+
+  /**< @brief RenderQueue のキーに詰める番号 */
+  enum MeshId : std::uint32_t { kPlane, kSpot };
+  enum MaterialId : std::uint32_t { kFloor, kDielectric, kMetal };
+
+  struct Material {
+    float roughness = 1.0f;
+    float metallic = 0.0f;
+    float reflectance = 1.0f;
+    glm::vec3 baseColor{0.0f};
+  };
+
+  /**< @brief RenderQueue::Item::payload で参照する描画ごとのデータ */
+  struct Object {
+    glm::mat4 model{1.0f};
+    Material material{};
+  };
 
   ShaderProgram prog_;
+  RenderQueue queue_{};
+  std::vector<Object> objects_{};
+  Material material_{};
 
   std::unique_ptr<ObjMesh> mesh_ =
       std::make_unique<ObjMesh>("./Assets/Models/Spot/spot_triangulated.obj");
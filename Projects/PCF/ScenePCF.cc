@@ -9,6 +9,7 @@
 #include <iostream>
 #include <spdlog/spdlog.h>
 
+#include "Graphics/GLState.h"
 #include "HID/KeyInput.h"
 
 // ********************************************************************************
@@ -26,6 +27,10 @@ static constexpr float kLightFar = 10.0f;
 static constexpr float kRotSpeed = 0.0f;
 static constexpr int kShadowMapWidth = 1024;
 static constexpr int kShadowMapHeight = 1024;
+static constexpr std::size_t kObjectsMax = 16;
+
+static constexpr float kLodThreshold = 1.0f; // 建物の詳細度を選ぶ画面上の誤差 [px]
+static constexpr int kShadowLodBias = 1; // シャドウマップの描画で詳細度をいくつ粗くするか
 
 static constexpr glm::mat4 kShadowBias{0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.5f,
                                        0.0f, 0.0f, 0.0f, 0.0f, 0.5f, 0.0f,
@@ -51,11 +56,12 @@ void ScenePCF::OnInit() {
     BOOST_ASSERT_MSG(false, "failed to compile or link!");
   } else {
     progs_[kShadeWithShadow].Use();
-    progs_[kShadeWithShadow].SetUniform("Light.La", kLightColor);
-    progs_[kShadeWithShadow].SetUniform("Light.Ld", kLightColor);
-    progs_[kShadeWithShadow].SetUniform("Light.Ls", kLightColor);
     progs_[kShadeWithShadow].SetUniform("ShadowMap", 0);
+    SetupUniforms();
   }
+  frameBlock_.OnInit(UniformBinding::kFrame);
+  shadowList_.OnInit(kObjectsMax);
+  mainList_.OnInit(kObjectsMax);
 
   // フレームバッファオブジェクトの生成
   SetupFBO();
@@ -63,7 +69,7 @@ void ScenePCF::OnInit() {
 
 void ScenePCF::OnDestroy() {
   glDeleteBuffers(1, &shadowFBO_);
-  glDeleteTextures(1, &depthTex_);
+  GLState::DeleteTextures(1, &depthTex_);
 }
 
 void ScenePCF::OnUpdate(float t) {
@@ -89,24 +95,28 @@ void ScenePCF::OnUpdate(float t) {
 
 void ScenePCF::OnRender() {
   glClearColor(0.9f, 0.9f, 0.9f, 1.0f);
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_CULL_FACE);
+  GLState::Get().Enable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_CULL_FACE);
 
   // シャドウマップをチャンネル0に登録します。
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, depthTex_);
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, depthTex_);
+
+  UpdateFrameBlock();
+  BuildDrawList(shadowList_, kShadowLodBias);
+  BuildDrawList(mainList_, 0);
   {
     Pass1();
     Pass2();
   }
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_CULL_FACE);
-  glDisable(GL_DEPTH_TEST);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+  GLState::Get().Disable(GL_CULL_FACE);
+  GLState::Get().Disable(GL_DEPTH_TEST);
 }
 
 void ScenePCF::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -119,42 +129,53 @@ std::optional<std::string> ScenePCF::CompileAndLinkShader() {
           {{"./Assets/Shaders/ShadowMap/RecordDepth.vs.glsl",
             ShaderType::Vertex},
            {"./Assets/Shaders/ShadowMap/RecordDepth.fs.glsl",
-            ShaderType::Fragment}})) {
+            ShaderType::Fragment}},
+          DrawList::GetDefines())) {
     return msg;
   }
   if (auto msg = progs_[kShadeWithShadow].CompileAndLink(
           {{"./Assets/Shaders/ShadowMap/PCF/PCF.vs.glsl", ShaderType::Vertex},
            {"./Assets/Shaders/ShadowMap/PCF/PCF.fs.glsl",
-            ShaderType::Fragment}})) {
+            ShaderType::Fragment}},
+          DrawList::GetDefines())) {
     return msg;
   }
   return std::nullopt;
 }
 
-void ScenePCF::SetMatrices() {
-  const glm::mat4 kLightView = lightView_.GetViewMatrix();
-  const glm::mat4 kLightProj = lightView_.GetProjectionMatrix();
-  const glm::mat4 kLightVP = kLightProj * kLightView;
-
-  if (pass_ == kRecordDepth) {
-    const glm::mat4 mvp = kLightVP * model_;
-    progs_[kRecordDepth].SetUniform("MVP", mvp);
-  } else if (pass_ == kShadeWithShadow) {
-    const glm::mat4 mv = view_ * model_;
-    progs_[kShadeWithShadow].SetUniform("ModelViewMatrix", mv);
-    progs_[kShadeWithShadow].SetUniform("NormalMatrix", glm::mat3(mv));
-
-    const glm::mat4 mvp = proj_ * mv;
-    progs_[kShadeWithShadow].SetUniform("MVP", mvp);
-    const glm::mat4 kLightMVP = kShadowBias * kLightVP * model_;
-    progs_[kShadeWithShadow].SetUniform("ShadowMatrix", kLightMVP);
+void ScenePCF::SetupUniforms() {
+  for (const auto &prog : progs_) {
+    prog.BindUniformBlock("FrameBlock", UniformBinding::kFrame);
+    DrawList::BindProgram(prog);
   }
+  depthVP_ = progs_[kRecordDepth].GetUniform<glm::mat4>("ViewProjection");
+}
+
+void ScenePCF::UpdateFrameBlock() {
+  const glm::mat4 kLightVP =
+      lightView_.GetProjectionMatrix() * lightView_.GetViewMatrix();
+
+  FrameBlock frame{};
+  frame.view = camera_.GetViewMatrix();
+  frame.proj = camera_.GetProjectionMatrix();
+  frame.shadow = kShadowBias * kLightVP;
+  frame.lightPosition = frame.view * glm::vec4(lightView_.GetPosition(), 1.0f);
+  frame.lightLa = kLightColor;
+  frame.lightLd = kLightColor;
+  frame.lightLs = kLightColor;
+  frameBlock_.Update(frame);
+}
+
+void ScenePCF::Submit(DrawList &list, const TriangleMesh &mesh,
+                      std::size_t lod) {
+  object_.model = model_;
+  list.Add(mesh, object_, lod);
 }
 
 void ScenePCF::SetupFBO() {
   // シャドウマップの生成を行います。
   glGenTextures(1, &depthTex_);
-  glBindTexture(GL_TEXTURE_2D, depthTex_);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, depthTex_);
   glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, kShadowMapWidth,
                  kShadowMapHeight);
 
@@ -175,7 +196,7 @@ void ScenePCF::SetupFBO() {
 
   // シャドウマップ用の FBO を生成し、デプステクスチャをアタッチします。
   glGenFramebuffers(1, &shadowFBO_);
-  glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
                          depthTex_, 0);
 
@@ -189,20 +210,16 @@ void ScenePCF::SetupFBO() {
     std::cout << "Framebuffer is not complete." << std::endl;
   }
 
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void ScenePCF::SetMaterialUniforms(const glm::vec3 &diff, const glm::vec3 &amb,
                                    const glm::vec3 &spec, float shininess) {
-
-  if (pass_ != kShadeWithShadow) {
-    return;
-  }
-  progs_[kShadeWithShadow].SetUniform("Material.Ka", amb);
-  progs_[kShadeWithShadow].SetUniform("Material.Kd", diff);
-  progs_[kShadeWithShadow].SetUniform("Material.Ks", spec);
-  progs_[kShadeWithShadow].SetUniform("Material.Shininess", shininess);
+  object_.ka = amb;
+  object_.kd = diff;
+  object_.ks = spec;
+  object_.shininess = shininess;
 }
 
 // ********************************************************************************
@@ -213,21 +230,24 @@ void ScenePCF::SetMaterialUniforms(const glm::vec3 &diff, const glm::vec3 &amb,
 void ScenePCF::Pass1() {
   pass_ = RenderPass::kRecordDepth;
 
-  glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
   glClear(GL_DEPTH_BUFFER_BIT);
-  glViewport(0, 0, kShadowMapWidth, kShadowMapHeight);
+  GLState::Get().Viewport(0, 0, kShadowMapWidth, kShadowMapHeight);
 
   glCullFace(GL_FRONT);
-  glEnable(GL_POLYGON_OFFSET_FILL);
+  GLState::Get().Enable(GL_POLYGON_OFFSET_FILL);
   glPolygonOffset(2.5f, 10.0f);
 
   // ライトから見たシーンの描画
   view_ = lightView_.GetViewMatrix();
   proj_ = lightView_.GetProjectionMatrix();
+  // ライトの視錐台から外れるものは描画しません。(Cull は使用中のプログラムを変えます)
+  shadowList_.Cull(proj_ * view_);
   progs_[kRecordDepth].Use();
-  DrawScene();
+  progs_[kRecordDepth].SetUniform(depthVP_, proj_ * view_);
+  shadowList_.Draw();
 
-  glDisable(GL_POLYGON_OFFSET_FILL);
+  GLState::Get().Disable(GL_POLYGON_OFFSET_FILL);
   glCullFace(GL_BACK);
 }
 
@@ -237,37 +257,44 @@ void ScenePCF::Pass2() {
 
   proj_ = camera_.GetProjectionMatrix();
   view_ = camera_.GetViewMatrix();
+  mainList_.Cull(proj_ * view_);
   progs_[kShadeWithShadow].Use();
-  progs_[kShadeWithShadow].SetUniform(
-      "Light.Position", view_ * glm::vec4(lightView_.GetPosition(), 1.0f));
   progs_[kShadeWithShadow].SetUniform("IsPCF", isPCF_);
   progs_[kShadeWithShadow].SetUniform("IsShadowOnly", isShadowOnly_);
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glViewport(0, 0, width_, height_);
+  GLState::Get().Viewport(0, 0, width_, height_);
 
-  DrawScene();
+  mainList_.Draw();
 }
 
-void ScenePCF::DrawScene() {
+/**
+ * @brief パスで描画するオブジェクトを集めて転送します。
+ * @param lodBias 建物の詳細度をいくつ粗くするか
+ */
+void ScenePCF::BuildDrawList(DrawList &list, int lodBias) {
+  list.Clear();
+
   const glm::vec3 diff = glm::vec3(1.0f, 0.85f, 0.55f);
   const glm::vec3 amb = diff * 0.1f;
   const glm::vec3 spec = glm::vec3(0.0f);
 
   // 建物の描画
+  // シャドウマップでもカメラからの距離で詳細度を選び、さらに粗くします。
+  const LodView lodView =
+      LodView::FromCamera(camera_, height_, kLodThreshold, lodBias);
   SetMaterialUniforms(diff, amb, spec, 1.0f);
   model_ = glm::mat4(1.0f);
-  SetMatrices();
-  building_->Render();
+  Submit(list, *building_, building_->SelectLod(lodView, model_));
 
   // 平面の描画
   SetMaterialUniforms(glm::vec3(0.25f, 0.25f, 0.25f),
                       glm::vec3(0.0f, 0.0f, 0.0f),
                       glm::vec3(0.05f, 0.05f, 0.05f), 1.0f);
   model_ = glm::mat4(1.0f);
-  SetMatrices();
-  plane_.Render();
+  Submit(list, plane_);
+  list.Upload();
 }
 
 // ********************************************************************************
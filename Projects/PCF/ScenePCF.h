@@ -2,8 +2,8 @@
  * @brief シャドウマッピングのテストシーン
  */
 
-#ifndef SCENE_SHADOW_MAP_H
-#define SCENE_SHADOW_MAP_H
+#ifndef SCENE_PCF_H
+#define SCENE_PCF_H
 
 #include "Scene/Scene.h"
 
@@ -14,12 +14,16 @@
 #include <string>
 
 #include "Graphics/Shader.h"
+#include "Graphics/UniformBuffer.h"
 #include "Mesh/ObjMesh.h"
 #include "Primitive/Plane.h"
 #include "Primitive/Teapot.h"
 #include "Primitive/Torus.h"
+#include "Scene/DrawList.h"
+#include "Scene/UniformBlocks.h"
 #include "View/Camera.h"
 #include "View/Frustum.h"
+#include "View/LodView.h"
 
 class ScenePCF : public Scene {
 public:
@@ -31,8 +35,10 @@ public:
 
 private:
   std::optional<std::string> CompileAndLinkShader();
+  void SetupUniforms();
   void SetupFBO();
-  void SetMatrices();
+  void UpdateFrameBlock();
+  void Submit(DrawList &list, const TriangleMesh &mesh, std::size_t lod = 0);
   void SetMaterialUniforms(const glm::vec3 &diff, const glm::vec3 &amb,
                            const glm::vec3 &spec, float shininess);
   void SetupCamera();
@@ -41,14 +47,16 @@ private:
   void Pass1();
   void Pass2();
 
-  void DrawScene();
+  void BuildDrawList(DrawList &list, int lodBias);
 
   Camera camera_;
   Camera lightView_;
 
   Plane plane_{20.0f, 20.0f, 1, 1};
   std::unique_ptr<ObjMesh> building_ =
-      std::make_unique<ObjMesh>("./Assets/Models/SDCC/building.obj");
+      std::make_unique<ObjMesh>("./Assets/Models/SDCC/building.obj",
+                                TriangleMesh::kCookOptimize |
+                                    TriangleMesh::kCookLods);
 
   float tPrev_ = 0.0f;
   float angle_ = glm::two_pi<float>() * 0.85f;
@@ -61,6 +69,12 @@ private:
   std::array<ShaderProgram, kPassNum> progs_{};
   RenderPass pass_ = kRecordDepth;
 
+  UniformBlock<FrameBlock> frameBlock_{};
+  DrawList shadowList_{}; // シャドウマップ用 (詳細度を粗くします)
+  DrawList mainList_{};
+  ObjectBlock object_{};
+  Uniform<glm::mat4> depthVP_{};
+
   GLuint depthTex_ = 0;
   GLuint shadowFBO_ = 0;
 
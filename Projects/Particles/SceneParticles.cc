@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "GUI/GUI.h"
+#include "Graphics/GLState.h"
 
 // ********************************************************************************
 // Constant expressions
@@ -24,8 +25,10 @@ static constexpr std::int32_t kParticlesZ = 80;
 static constexpr std::int32_t kTotalParticles =
     kParticlesX * kParticlesY * kParticlesZ;
 
- //!< コンピュートシェーダーの値と同じにする必要があります。
-static constexpr std::int32_t kLocalSizeX = 1000;
+ //!< コンピュートシェーダーには LOCAL_SIZE_X として渡します。(ワープ/ウェーブの倍数にしておきます。)
+static constexpr std::int32_t kLocalSizeX = 256;
+static_assert(kTotalParticles % kLocalSizeX == 0,
+              "Particles must be a multiple of the local size.");
 
 static constexpr glm::vec4 kBlackHole1BasePos{5.0f, 0.0f, 0.0f, 1.0f};
 static constexpr glm::vec4 kBlackHole2BasePos{-5.0f, 0.0f, 0.0f, 1.0f};
@@ -44,9 +47,9 @@ void SceneParticles::OnInit() {
 }
 
 void SceneParticles::OnDestroy() {
-  glDeleteVertexArrays(1, &hBlackHoleVAO_);
+  GLState::DeleteVertexArrays(1, &hBlackHoleVAO_);
   glDeleteBuffers(1, &hBlackHoleBuffer_);
-  glDeleteVertexArrays(1, &hParticlesVAO_);
+  GLState::DeleteVertexArrays(1, &hParticlesVAO_);
   glDeleteBuffers(static_cast<GLsizei>(computeBuffer_.size()), computeBuffer_.data());
 }
 
@@ -58,19 +61,19 @@ void SceneParticles::OnRender() {
   ComputeParticles();
 
   glClearColor(param_.clearColor.r, param_.clearColor.g, param_.clearColor.b, 1.0f);
-  glEnable(GL_BLEND);
+  GLState::Get().Enable(GL_BLEND);
   glBlendFunc(GL_ONE, GL_ONE);
   {
     DrawParticles();
   }
-  glDisable(GL_BLEND);
+  GLState::Get().Disable(GL_BLEND);
 
   GUI::Render();
 }
 
 void SceneParticles::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -87,7 +90,8 @@ std::optional<std::string> SceneParticles::CompileAndLinkShader() {
 #if !defined(__APPLE__)
   if (auto msg = compute_.CompileAndLink(
           {{"./Assets/Shaders/Particles/Particles.cs.glsl",
-            ShaderType::Compute}})) {
+            ShaderType::Compute}},
+          {{"LOCAL_SIZE_X", std::to_string(kLocalSizeX)}})) {
     return msg;
   }
 #endif
@@ -143,11 +147,11 @@ void SceneParticles::InitBuffer() {
 
   // パーティクルのVAOを生成し設定します。
   glGenVertexArrays(1, &hParticlesVAO_);
-  glBindVertexArray(hParticlesVAO_);
+  GLState::Get().BindVertexArray(hParticlesVAO_);
   glBindBuffer(GL_ARRAY_BUFFER, bufPos);
   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
   glEnableVertexAttribArray(0);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 
   // ブラックホール用のVBOとVAOを生成し設定します。
   glGenBuffers(1, &hBlackHoleBuffer_);
@@ -157,11 +161,11 @@ void SceneParticles::InitBuffer() {
                     kBlackHole2BasePos.z, kBlackHole2BasePos.w};
   glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * 8, data, GL_DYNAMIC_DRAW);
   glGenVertexArrays(1, &hBlackHoleVAO_);
-  glBindVertexArray(hBlackHoleVAO_);
+  GLState::Get().BindVertexArray(hBlackHoleVAO_);
   glBindBuffer(GL_ARRAY_BUFFER, hBlackHoleBuffer_);
   glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
   glEnableVertexAttribArray(0);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
 
 // ********************************************************************************
@@ -227,9 +231,9 @@ void SceneParticles::DrawParticles() {
   // パーティクルの描画
   glPointSize(param_.particleSize);
   render_.SetUniform("Color", param_.particleColor);
-  glBindVertexArray(hParticlesVAO_);
+  GLState::Get().BindVertexArray(hParticlesVAO_);
   glDrawArrays(GL_POINTS, 0, kTotalParticles);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 
   /*
   // ブラックホールの描画
@@ -240,8 +244,8 @@ void SceneParticles::DrawParticles() {
   glBindBuffer(GL_ARRAY_BUFFER, hBlackHoleVAO_);
   glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(GLfloat) * 8, data);
   render_.SetUniform("Color", glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
-  glBindVertexArray(hBlackHoleVAO_);
+  GLState::Get().BindVertexArray(hBlackHoleVAO_);
   glDrawArrays(GL_POINTS, 0, 2);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
   */
 }
@@ -13,13 +13,15 @@
 
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "Graphics/GLState.h"
+
 void ScenePhong::OnInit() {
   if (const auto msg = CompileAndLinkShader()) {
     std::cerr << msg.value() << std::endl;
     BOOST_ASSERT_MSG(false, "failed to compile or link!");
   }
 
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
 
   view_ = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f),
                       glm::vec3(0.0f, 1.0f, 0.0f));
@@ -63,7 +65,7 @@ void ScenePhong::OnRender() {
 
 void ScenePhong::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
   proj_ = glm::perspective(glm::radians(70.0f),
                            static_cast<float>(w) / static_cast<float>(h), 0.3f,
                            100.0f);
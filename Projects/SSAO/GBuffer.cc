@@ -2,6 +2,8 @@
 
 #include <iostream>
 
+#include "Graphics/GLState.h"
+
 GBuffer::~GBuffer() { OnDestroy(); }
 
 void GBuffer::OnInit(int w, int h) {
@@ -14,17 +16,17 @@ void GBuffer::OnInit(int w, int h) {
 }
 
 void GBuffer::OnDestroy() {
-  glDeleteTextures(static_cast<GLsizei>(textures_.size()), textures_.data());
+  GLState::DeleteTextures(static_cast<GLsizei>(textures_.size()), textures_.data());
   glDeleteRenderbuffers(static_cast<GLsizei>(rbuffers_.size()),
                         rbuffers_.data());
-  glDeleteFramebuffers(static_cast<GLsizei>(fbuffers_.size()),
+  GLState::DeleteFramebuffers(static_cast<GLsizei>(fbuffers_.size()),
                        fbuffers_.data());
 }
 
 void GBuffer::InitDeferredFBO() {
   // FBOの生成とバインド
   glGenFramebuffers(1, &fbuffers_[DeferredFBO]);
-  glBindFramebuffer(GL_FRAMEBUFFER, fbuffers_[DeferredFBO]);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, fbuffers_[DeferredFBO]);
 
   // 深度バッファの生成とバインド
   glGenRenderbuffers(1, &rbuffers_[Depth]);
@@ -54,13 +56,13 @@ void GBuffer::InitDeferredFBO() {
     std::cerr << "Framebuffer not complete." << std::endl;
   }
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void GBuffer::InitSSAOFBO() {
   // AO用のFBOの生成とバインド
   glGenFramebuffers(1, &fbuffers_[SSAOFBO]);
-  glBindFramebuffer(GL_FRAMEBUFFER, fbuffers_[SSAOFBO]);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, fbuffers_[SSAOFBO]);
 
   // AO用のテクスチャの生成とアタッチ
   textures_[AOTex] = CreateGBufferTexture(GL_R16F);
@@ -70,13 +72,13 @@ void GBuffer::InitSSAOFBO() {
   if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
     std::cerr << "SSAO Framebuffer not complete." << std::endl;
   }
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void GBuffer::InitSSAOBlurFBO() {
   // BlurAO用のFBOの生成とバインド
   glGenFramebuffers(1, &fbuffers_[SSAOBlurFBO]);
-  glBindFramebuffer(GL_FRAMEBUFFER, fbuffers_[SSAOBlurFBO]);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, fbuffers_[SSAOBlurFBO]);
 
   // BlurAO用のテクスチャの生成とアタッチ
   textures_[BlurAOTex] = CreateGBufferTexture(GL_R16F);
@@ -86,14 +88,14 @@ void GBuffer::InitSSAOBlurFBO() {
   if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
     std::cerr << "SSAO blur Framebuffer not complete." << std::endl;
   }
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 GLuint GBuffer::CreateGBufferTexture(GLenum format) const {
   GLuint texId;
 
   glGenTextures(1, &texId);
-  glBindTexture(GL_TEXTURE_2D, texId);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, texId);
 
   glTexStorage2D(GL_TEXTURE_2D, 1, format, width_, height_);
 
@@ -101,7 +103,7 @@ GLuint GBuffer::CreateGBufferTexture(GLenum format) const {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
 
   return texId;
 }
@@ -10,16 +10,12 @@
 // Sampling for SSAO
 // ********************************************************************************
 
-std::vector<float> SSAO::BuildKernel(std::size_t kernelSize) {
-  std::vector<float> kern(3 * kernelSize);
+std::vector<glm::vec3> SSAO::BuildKernel(std::size_t kernelSize) {
+  std::vector<glm::vec3> kern(kernelSize);
   for (size_t i = 0; i < kernelSize; i++) {
     glm::vec3 randDir = dist_.OnHemisphere(engine_);
     const float kScale = static_cast<float>(i * i) / static_cast<float>(kernelSize * kernelSize);
-    randDir *= glm::mix(0.1f, 1.0f, kScale);
-
-    kern[3 * i + 0] = randDir.x;
-    kern[3 * i + 1] = randDir.y;
-    kern[3 * i + 2] = randDir.z;
+    kern[i] = randDir * glm::mix(0.1f, 1.0f, kScale);
   }
   return kern;
 }
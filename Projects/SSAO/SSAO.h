@@ -4,6 +4,7 @@
 #ifndef SSAO_H
 #define SSAO_H
 
+#include <glm/glm.hpp>
 #include <random>
 #include <vector>
 
@@ -17,7 +18,7 @@ public:
   }
   explicit SSAO(std::uint32_t seed) : engine_(seed) {}
 
-  std::vector<float> BuildKernel(std::size_t kernelSize);
+  std::vector<glm::vec3> BuildKernel(std::size_t kernelSize);
   std::vector<float> BuildRandRot(std::size_t rotTexSize);
 
 private:
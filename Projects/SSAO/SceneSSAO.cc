@@ -4,11 +4,15 @@
 
 #include "SceneSSAO.h"
 
+#include <array>
 #include <boost/assert.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
+#include <string>
 
 #include "GUI/GUI.h"
+#include "Graphics/GLState.h"
+#include "Graphics/Sampler.h"
 #include "Graphics/Texture.h"
 #include "HID/KeyInput.h"
 #include "SSAO.h"
@@ -21,8 +25,8 @@ static constexpr float kCameraFOVY = 60.0f;
 
 static constexpr glm::vec4 kLightPos{3.0f, 3.0f, 1.5f, 1.0f};
 
-// NOTE: シェーダーのカーネルサイズと一致させる必要があります。
-static constexpr std::size_t kKernelSize = 64;
+// カーネルサイズは品質の段階として選べます。(シェーダーには KERNEL_SIZE として渡します。)
+static constexpr std::array<int, 3> kKernelSizes{16, 32, 64};
 
 static constexpr std::size_t kRotTexSize = 4; // 4x4 texture
 
@@ -37,26 +41,31 @@ void SceneSSAO::OnInit() {
       glm::radians(kCameraFOVY),
       static_cast<float>(width_) / static_cast<float>(height_), 0.3f, 100.0f);
 
-  if (const auto msg = CompileAndLinkShader()) {
-    std::cerr << msg.value() << std::endl;
-    BOOST_ASSERT_MSG(false, "failed to compile or link!");
-  } else {
-    SetupShaderConfig();
-  }
+  // コンパイルはドライバーに任せ、その間に頂点配列やテクスチャの準備を進めます。
+  auto links = CompileAndLinkShader();
 
   CreateVAO();
   gbuffer_.OnInit(width_, height_);
 
-  SetupSSAO();
-
   textures_[WoodTex] = Texture::Load("./Assets/Textures/Wood/wood.jpeg");
   textures_[BrickTex] =
       Texture::Load("./Assets/Textures/Brick/ruin_wall_01.png");
+
+  if (const auto msg = ShaderProgram::WaitAll(links)) {
+    std::cerr << msg.value() << std::endl;
+    BOOST_ASSERT_MSG(false, "failed to compile or link!");
+  } else {
+    SetupShaderConfig();
+    SetupUniforms();
+  }
+
+  SetupSSAO();
+  SelectSSAOProgram();
 }
 
 void SceneSSAO::OnDestroy() {
-  glDeleteTextures(static_cast<GLsizei>(textures_.size()), textures_.data());
-  glDeleteVertexArrays(1, &quadVAO_);
+  GLState::DeleteTextures(static_cast<GLsizei>(textures_.size()), textures_.data());
+  GLState::DeleteVertexArrays(1, &quadVAO_);
   glDeleteBuffers(1, &quadVBO_);
 }
 
@@ -73,25 +82,56 @@ void SceneSSAO::OnUpdate(float) {
   ImGui::SameLine();
   ImGui::RadioButton("No SSAO", &param_.type,
                      RenderType::RenderNoSSAO);
+  ImGui::Text("Kernel Size:");
+  for (const int size : kKernelSizes) {
+    ImGui::SameLine();
+    ImGui::RadioButton(std::to_string(size).c_str(), &param_.kernelSize, size);
+  }
   ImGui::Checkbox("Use Blur", &param_.useBlur);
   ImGui::SliderFloat("SSAO Sampling Radius", &param_.radius, 0.1f, 1.0f);
   ImGui::SliderFloat("AO Parameterization", &param_.ao, 1.0f, 10.0f);
+  if (SamplerCache::Get().IsAnisotropySupported()) {
+    float anisotropy = SamplerCache::Get().GetAnisotropy();
+    if (ImGui::SliderFloat("Anisotropy", &anisotropy, 1.0f,
+                           SamplerCache::Get().GetMaxAnisotropy())) {
+      SamplerCache::Get().SetAnisotropy(anisotropy);
+    }
+  }
   ImGui::End();
+
+  gpuTimer_.ShowGUI();
+
+  if (ssaoProg_ == nullptr || ssaoKernelSize_ != param_.kernelSize) {
+    SelectSSAOProgram();
+  }
 }
 
 void SceneSSAO::OnRender() {
+  gpuTimer_.BeginFrame();
   {
+    gpuTimer_.Begin("Pass1 (GBuffer)");
     Pass1();
+    gpuTimer_.End();
+
+    gpuTimer_.Begin("Pass2 (SSAO)");
     Pass2();
+    gpuTimer_.End();
+
+    gpuTimer_.Begin("Pass3 (Blur)");
     Pass3();
+    gpuTimer_.End();
+
+    gpuTimer_.Begin("Pass4 (Lighting)");
     Pass4();
+    gpuTimer_.End();
   }
+  gpuTimer_.EndFrame();
   GUI::Render();
 }
 
 void SceneSSAO::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -108,7 +148,7 @@ void SceneSSAO::CreateVAO() {
   // 頂点配列オブジェクトの設定
   glGenVertexArrays(1, &quadVAO_);
   glGenBuffers(1, &quadVBO_);
-  glBindVertexArray(quadVAO_);
+  GLState::Get().BindVertexArray(quadVAO_);
 
   glBindBuffer(GL_ARRAY_BUFFER, quadVBO_);
   glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices,
@@ -119,7 +159,7 @@ void SceneSSAO::CreateVAO() {
   glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float),
                         reinterpret_cast<void *>(3 * sizeof(float)));
 
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
 
 void SceneSSAO::SetMatrices() {
@@ -127,45 +167,34 @@ void SceneSSAO::SetMatrices() {
   const glm::mat4 proj = camera_.GetProjectionMatrix();
   const glm::mat4 mv = view * model_;
 
-  progs_[RecordGBufferPass].SetUniform("ModelViewMatrix", mv);
-  progs_[RecordGBufferPass].SetUniform("NormalMatrix", glm::mat3(mv));
-  progs_[RecordGBufferPass].SetUniform("MVP", proj * mv);
+  progs_[RecordGBufferPass].SetUniform(uniforms_.modelView, mv);
+  progs_[RecordGBufferPass].SetUniform(uniforms_.normal, glm::mat3(mv));
+  progs_[RecordGBufferPass].SetUniform(uniforms_.mvp, proj * mv);
 }
 
-std::optional<std::string> SceneSSAO::CompileAndLinkShader() {
-  // Compile and links
-  if (auto msg = progs_[RecordGBufferPass].CompileAndLink(
-          {{"./Assets/Shaders/SSAO/GBuffer.vs.glsl", ShaderType::Vertex},
-           {"./Assets/Shaders/SSAO/GBuffer.fs.glsl", ShaderType::Fragment}})) {
-    return msg;
-  }
-  if (auto msg = progs_[SSAOPass].CompileAndLink(
-          {{"./Assets/Shaders/SSAO/SSAO.vs.glsl", ShaderType::Vertex},
-           {"./Assets/Shaders/SSAO/SSAO.fs.glsl", ShaderType::Fragment}})) {
-    return msg;
-  }
-  if (auto msg = progs_[BlurPass].CompileAndLink(
-          {{"./Assets/Shaders/SSAO/SSAO.vs.glsl", ShaderType::Vertex},
-           {"./Assets/Shaders/SSAO/Blur.fs.glsl", ShaderType::Fragment}})) {
-    return msg;
-  }
-  if (auto msg = progs_[LightingPass].CompileAndLink(
-          {{"./Assets/Shaders/SSAO/SSAO.vs.glsl", ShaderType::Vertex},
-           {"./Assets/Shaders/SSAO/Lighting.fs.glsl", ShaderType::Fragment}})) {
-    return msg;
-  }
-  return std::nullopt;
+std::vector<ShaderProgram::LinkFuture> SceneSSAO::CompileAndLinkShader() {
+  // Compile and links (全プログラムを発行してから結果を待ちます。)
+  std::vector<ShaderProgram::LinkFuture> links;
+  links.emplace_back(progs_[RecordGBufferPass].CompileAndLinkAsync(
+      {{"./Assets/Shaders/SSAO/GBuffer.vs.glsl", ShaderType::Vertex},
+       {"./Assets/Shaders/SSAO/GBuffer.fs.glsl", ShaderType::Fragment}}));
+  ssaoPrograms_.SetStages(
+      {{"./Assets/Shaders/SSAO/SSAO.vs.glsl", ShaderType::Vertex},
+       {"./Assets/Shaders/SSAO/SSAO.fs.glsl", ShaderType::Fragment}});
+  links.emplace_back(ssaoPrograms_.PrepareAsync(GetSSAODefines()));
+  links.emplace_back(progs_[BlurPass].CompileAndLinkAsync(
+      {{"./Assets/Shaders/SSAO/SSAO.vs.glsl", ShaderType::Vertex},
+       {"./Assets/Shaders/SSAO/Blur.fs.glsl", ShaderType::Fragment}}));
+  links.emplace_back(progs_[LightingPass].CompileAndLinkAsync(
+      {{"./Assets/Shaders/SSAO/SSAO.vs.glsl", ShaderType::Vertex},
+       {"./Assets/Shaders/SSAO/Lighting.fs.glsl", ShaderType::Fragment}}));
+  return links;
 }
 
 void SceneSSAO::SetupShaderConfig() {
   progs_[RecordGBufferPass].Use();
   progs_[RecordGBufferPass].SetUniform("DiffTex", 0);
 
-  progs_[SSAOPass].Use();
-  progs_[SSAOPass].SetUniform("PositionTex", 0);
-  progs_[SSAOPass].SetUniform("NormalTex", 1);
-  progs_[SSAOPass].SetUniform("RandRotTex", 2);
-
   progs_[BlurPass].Use();
   progs_[BlurPass].SetUniform("AOTex", 0);
 
@@ -176,18 +205,28 @@ void SceneSSAO::SetupShaderConfig() {
   progs_[LightingPass].SetUniform("AOTex", 3);
 }
 
+void SceneSSAO::SetupUniforms() {
+  const ShaderProgram &prog = progs_[RecordGBufferPass];
+  uniforms_.modelView = prog.GetUniform<glm::mat4>("ModelViewMatrix");
+  uniforms_.normal = prog.GetUniform<glm::mat3>("NormalMatrix");
+  uniforms_.mvp = prog.GetUniform<glm::mat4>("MVP");
+  uniforms_.materialKd = prog.GetUniform<glm::vec3>("Material.Kd");
+  uniforms_.materialUseTex = prog.GetUniform<bool>("Material.UseTex");
+
+  const ShaderProgram &lighting = progs_[LightingPass];
+  uniforms_.lightPosition = lighting.GetUniform<glm::vec4>("Light.Position");
+  uniforms_.lightL = lighting.GetUniform<glm::vec3>("Light.L");
+  uniforms_.lightLa = lighting.GetUniform<glm::vec3>("Light.La");
+  uniforms_.type = lighting.GetUniform<int>("Type");
+  uniforms_.ao = lighting.GetUniform<float>("AO");
+}
+
 void SceneSSAO::SetupSSAO() {
   SSAO ssao;
 
-  const auto kernel = ssao.BuildKernel(kKernelSize);
-  progs_[SSAOPass].Use();
-  GLuint hProg = progs_[SSAOPass].GetHandle();
-  GLuint loc = glGetUniformLocation(hProg, "SampleKernel");
-  glUniform3fv(loc, kKernelSize, kernel.data());
-
   const auto randDir = ssao.BuildRandRot(kRotTexSize);
   glGenTextures(1, &textures_[RandRotTex]);
-  glBindTexture(GL_TEXTURE_2D, textures_[RandRotTex]);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[RandRotTex]);
   glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGB16F, kRotTexSize, kRotTexSize);
   glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, kRotTexSize, kRotTexSize, GL_RGB,
                   GL_FLOAT, randDir.data());
@@ -195,7 +234,45 @@ void SceneSSAO::SetupSSAO() {
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
 
-  glBindTexture(GL_TEXTURE_2D, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+}
+
+ShaderDefines SceneSSAO::GetSSAODefines() const {
+  return {{"KERNEL_SIZE", std::to_string(param_.kernelSize)}};
+}
+
+bool SceneSSAO::SelectSSAOProgram() {
+  const ShaderDefines defines = GetSSAODefines();
+  // 一度失敗した組み合わせはフレームごとに作り直さず、今のプログラムを使い続けます。
+  if (ssaoPrograms_.IsFailed(defines)) {
+    return false;
+  }
+  if (const auto msg = ssaoPrograms_.Prepare(defines)) {
+    std::cerr << msg.value() << std::endl;
+    return false;
+  }
+  ShaderProgram *prog = ssaoPrograms_.Find(defines);
+  if (prog == ssaoProg_ && ssaoKernelSize_ == param_.kernelSize) {
+    return true;
+  }
+
+  // 切り替えたプログラムにサンプラーとサンプリングカーネルを設定します。
+  SSAO ssao;
+  const auto kernelSize = static_cast<std::size_t>(param_.kernelSize);
+  const auto kernel = ssao.BuildKernel(kernelSize);
+  prog->Use();
+  prog->SetUniform("PositionTex", 0);
+  prog->SetUniform("NormalTex", 1);
+  prog->SetUniform("RandRotTex", 2);
+  prog->SetUniform(prog->GetUniform<glm::vec3>("SampleKernel"), kernel.data(),
+                   kernel.size());
+  uniforms_.ssaoProjection = prog->GetUniform<glm::mat4>("ProjectionMatrix");
+  uniforms_.ssaoRadius = prog->GetUniform<float>("Radius");
+  uniforms_.ssaoRandScale = prog->GetUniform<glm::vec2>("RandScale");
+
+  ssaoProg_ = prog;
+  ssaoKernelSize_ = param_.kernelSize;
+  return true;
 }
 
 // ********************************************************************************
@@ -203,30 +280,37 @@ void SceneSSAO::SetupSSAO() {
 // ********************************************************************************
 
 void SceneSSAO::Pass1() {
-  glBindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetDeferredFBO());
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetDeferredFBO());
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
 
   progs_[RecordGBufferPass].Use();
   DrawScene();
 
-  glDisable(GL_DEPTH_TEST);
+  GLState::Get().Disable(GL_DEPTH_TEST);
 }
 
 void SceneSSAO::Pass2() {
-  glBindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetSSAOFBO());
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetSSAOFBO());
   glClear(GL_COLOR_BUFFER_BIT);
 
-  progs_[SSAOPass].Use();
-  progs_[SSAOPass].SetUniform("ProjectionMatrix",
-                              camera_.GetProjectionMatrix());
-  progs_[SSAOPass].SetUniform("Radius", param_.radius);
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, gbuffer_.GetPosTex());
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, gbuffer_.GetNormTex());
-  glActiveTexture(GL_TEXTURE2);
-  glBindTexture(GL_TEXTURE_2D, textures_[RandRotTex]);
+  if (ssaoProg_ == nullptr) {
+    return;
+  }
+  ssaoProg_->Use();
+  ssaoProg_->SetUniform(uniforms_.ssaoProjection,
+                        camera_.GetProjectionMatrix());
+  ssaoProg_->SetUniform(uniforms_.ssaoRadius, param_.radius);
+  ssaoProg_->SetUniform(
+      uniforms_.ssaoRandScale,
+      glm::vec2(static_cast<float>(width_), static_cast<float>(height_)) /
+          static_cast<float>(kRotTexSize));
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetPosTex());
+  GLState::Get().ActiveTexture(GL_TEXTURE1);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetNormTex());
+  GLState::Get().ActiveTexture(GL_TEXTURE2);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[RandRotTex]);
 
   DrawQuad();
 }
@@ -235,42 +319,42 @@ void SceneSSAO::Pass3() {
   if (!param_.useBlur) {
     return;
   }
-  glBindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetSSAOBlurFBO());
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, gbuffer_.GetSSAOBlurFBO());
   glClear(GL_COLOR_BUFFER_BIT);
 
   progs_[BlurPass].Use();
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, gbuffer_.GetAOTex());
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetAOTex());
 
   DrawQuad();
 }
 
 void SceneSSAO::Pass4() {
   // デフォルトのフレームバッファに戻します
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
   glClear(GL_COLOR_BUFFER_BIT);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, gbuffer_.GetPosTex());
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, gbuffer_.GetNormTex());
-  glActiveTexture(GL_TEXTURE2);
-  glBindTexture(GL_TEXTURE_2D, gbuffer_.GetColorTex());
-  glActiveTexture(GL_TEXTURE3);
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetPosTex());
+  GLState::Get().ActiveTexture(GL_TEXTURE1);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetNormTex());
+  GLState::Get().ActiveTexture(GL_TEXTURE2);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetColorTex());
+  GLState::Get().ActiveTexture(GL_TEXTURE3);
   if (param_.useBlur) {
-    glBindTexture(GL_TEXTURE_2D, gbuffer_.GetBlurAOTex());
+    GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetBlurAOTex());
   } else {
-    glBindTexture(GL_TEXTURE_2D, gbuffer_.GetAOTex());
+    GLState::Get().BindTexture(GL_TEXTURE_2D, gbuffer_.GetAOTex());
   }
 
 
   progs_[LightingPass].Use();
-  progs_[LightingPass].SetUniform("Light.Position",
+  progs_[LightingPass].SetUniform(uniforms_.lightPosition,
                                   camera_.GetViewMatrix() * kLightPos);
-  progs_[LightingPass].SetUniform("Light.L", glm::vec3(0.3f));
-  progs_[LightingPass].SetUniform("Light.La", glm::vec3(0.5f));
-  progs_[LightingPass].SetUniform("Type", param_.type);
-  progs_[LightingPass].SetUniform("AO", param_.ao);
+  progs_[LightingPass].SetUniform(uniforms_.lightL, glm::vec3(0.3f));
+  progs_[LightingPass].SetUniform(uniforms_.lightLa, glm::vec3(0.5f));
+  progs_[LightingPass].SetUniform(uniforms_.type, param_.type);
+  progs_[LightingPass].SetUniform(uniforms_.ao, param_.ao);
 
   DrawQuad();
 }
@@ -282,10 +366,10 @@ void SceneSSAO::Pass4() {
 void SceneSSAO::DrawScene() {
   // 床の描画
   auto DrawFloor = [this]() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textures_[WoodTex]);
+    GLState::Get().ActiveTexture(GL_TEXTURE0);
+    GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[WoodTex]);
 
-    progs_[RecordGBufferPass].SetUniform("Material.UseTex", 1);
+    progs_[RecordGBufferPass].SetUniform(uniforms_.materialUseTex, true);
     model_ = glm::mat4(1.0f);
     SetMatrices();
 
@@ -294,8 +378,8 @@ void SceneSSAO::DrawScene() {
 
   // 壁の描画1
   auto DrawWallL = [this]() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textures_[BrickTex]);
+    GLState::Get().ActiveTexture(GL_TEXTURE0);
+    GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[BrickTex]);
 
     model_ = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -2.0f));
     model_ =
@@ -307,8 +391,8 @@ void SceneSSAO::DrawScene() {
 
   // 壁の描画2
   auto DrawWallR = [this]() {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textures_[BrickTex]);
+    GLState::Get().ActiveTexture(GL_TEXTURE0);
+    GLState::Get().BindTexture(GL_TEXTURE_2D, textures_[BrickTex]);
 
     model_ = glm::translate(glm::mat4(1.0f), glm::vec3(-2.0f, 0.0f, 0.0f));
     model_ =
@@ -322,8 +406,8 @@ void SceneSSAO::DrawScene() {
 
   // メインメッシュの描画
   auto DrawMesh = [this]() {
-    progs_[RecordGBufferPass].SetUniform("Material.UseTex", 0);
-    progs_[RecordGBufferPass].SetUniform("Material.Kd",
+    progs_[RecordGBufferPass].SetUniform(uniforms_.materialUseTex, false);
+    progs_[RecordGBufferPass].SetUniform(uniforms_.materialKd,
                                          glm::vec3(0.9f, 0.5f, 0.2f));
     model_ = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.282958f, 0.0f));
     model_ =
@@ -334,14 +418,18 @@ void SceneSSAO::DrawScene() {
     mesh_->Render();
   };
 
+  // 床と壁のテクスチャは縮小されるため、trilinear と異方性フィルタリングで読みます。
+  // (ユニット 0 は他のパスで縮小レベルの無い GBuffer を読むので、描画後に外します。)
+  GLState::Get().BindSampler(0, SamplerCache::Get().Find(SamplerDesc{}));
   DrawFloor();
   DrawWallL();
   DrawWallR();
+  GLState::Get().BindSampler(0, 0);
   DrawMesh();
 }
 
 void SceneSSAO::DrawQuad() const {
-  glBindVertexArray(quadVAO_);
+  GLState::Get().BindVertexArray(quadVAO_);
   glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-  glBindVertexArray(0);
+  GLState::Get().BindVertexArray(0);
 }
@@ -11,9 +11,12 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "GBuffer.h"
+#include "Graphics/GpuTimer.h"
 #include "Graphics/Shader.h"
+#include "Graphics/ShaderPermutations.h"
 #include "Mesh/ObjMesh.h"
 #include "Primitive/Plane.h"
 #include "Primitive/Teapot.h"
@@ -29,11 +32,14 @@ public:
   void OnResize(int, int) override;
 
 private:
-  std::optional<std::string> CompileAndLinkShader();
+  std::vector<ShaderProgram::LinkFuture> CompileAndLinkShader();
   void SetupShaderConfig();
+  void SetupUniforms();
   void CreateVAO();
   void SetMatrices();
   void SetupSSAO();
+  ShaderDefines GetSSAODefines() const;
+  bool SelectSSAOProgram();
 
   void Pass1();
   void Pass2();
@@ -51,13 +57,37 @@ private:
 
   enum RenderPass {
     RecordGBufferPass,
-    SSAOPass,
     BlurPass,
     LightingPass,
     PassMax,
   };
   std::array<ShaderProgram, PassMax> progs_{};
+
+  // SSAO パスはカーネルサイズごとに特殊化したプログラムを使います。
+  ShaderPermutations ssaoPrograms_{};
+  ShaderProgram *ssaoProg_ = nullptr;
+  int ssaoKernelSize_ = 0;
   GBuffer gbuffer_{};
+  GpuTimer gpuTimer_{};
+
+  struct Uniforms {
+    // RecordGBufferPass
+    Uniform<glm::mat4> modelView;
+    Uniform<glm::mat3> normal;
+    Uniform<glm::mat4> mvp;
+    Uniform<glm::vec3> materialKd;
+    Uniform<bool> materialUseTex;
+    // LightingPass
+    Uniform<glm::vec4> lightPosition;
+    Uniform<glm::vec3> lightL;
+    Uniform<glm::vec3> lightLa;
+    Uniform<int> type;
+    Uniform<float> ao;
+    // SSAO パス (プログラムを切り替えたときに引き直します)
+    Uniform<glm::mat4> ssaoProjection;
+    Uniform<float> ssaoRadius;
+    Uniform<glm::vec2> ssaoRandScale;
+  } uniforms_{};
 
   enum Textures { WoodTex, BrickTex, RandRotTex, TexturesMax };
   std::array<GLuint, TexturesMax> textures_{};
@@ -76,6 +106,7 @@ private:
     float radius = 0.55f;
     float ao = 8.0f;
     bool useBlur = true;
+    int kernelSize = 64;
   } param_{};
 };
 
@@ -10,6 +10,9 @@
 #include <glm/gtc/constants.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
+#include "GUI/GUI.h"
+#include "Graphics/GLState.h"
+
 // ********************************************************************************
 // constexpr variables
 // ********************************************************************************
@@ -38,11 +41,11 @@ void SceneShadowMap::OnInit() {
     BOOST_ASSERT_MSG(false, "failed to compile or link!");
   } else {
     progs_[kShadeWithShadow].Use();
-    progs_[kShadeWithShadow].SetUniform("Light.La", kLightColor);
-    progs_[kShadeWithShadow].SetUniform("Light.Ld", kLightColor);
-    progs_[kShadeWithShadow].SetUniform("Light.Ls", kLightColor);
     progs_[kShadeWithShadow].SetUniform("ShadowMap", 0);
+    SetupUniforms();
   }
+  frameBlock_.OnInit(UniformBinding::kFrame);
+  drawList_.OnInit(kObjectsMax);
 
   // フレームバッファオブジェクトの生成
   SetupFBO();
@@ -50,10 +53,13 @@ void SceneShadowMap::OnInit() {
 
 void SceneShadowMap::OnDestroy() {
   glDeleteBuffers(1, &shadowFBO_);
-  glDeleteTextures(1, &depthTex_);
+  GLState::DeleteTextures(1, &depthTex_);
 }
 
 void SceneShadowMap::OnUpdate(float t) {
+  GUI::NewFrame();
+  gpuTimer_.ShowGUI();
+
   const float deltaT = tPrev_ == 0.0f ? 0.0f : t - tPrev_;
   tPrev_ = t;
 
@@ -70,22 +76,35 @@ void SceneShadowMap::OnUpdate(float t) {
 
 void SceneShadowMap::OnRender() {
   glClearColor(0.9f, 0.9f, 0.9f, 1.0f);
-  glEnable(GL_DEPTH_TEST);
-  glEnable(GL_CULL_FACE);
+  GLState::Get().Enable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_CULL_FACE);
 
   // シャドウマップをチャンネル0に登録します。
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, depthTex_);
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, depthTex_);
+
+  UpdateFrameBlock();
+  BuildDrawList();
+
+  gpuTimer_.BeginFrame();
   {
+    gpuTimer_.Begin("Pass1 (Record Depth)");
     Pass1();
+    gpuTimer_.End();
+
+    gpuTimer_.Begin("Pass2 (Shading)");
     Pass2();
+    gpuTimer_.End();
   }
-  glBindTexture(GL_TEXTURE_2D, 0);
+  gpuTimer_.EndFrame();
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+
+  GUI::Render();
 }
 
 void SceneShadowMap::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
 }
 
 // ********************************************************************************
@@ -98,35 +117,52 @@ std::optional<std::string> SceneShadowMap::CompileAndLinkShader() {
           {{"./Assets/Shaders/ShadowMap/RecordDepth.vs.glsl",
             ShaderType::Vertex},
            {"./Assets/Shaders/ShadowMap/RecordDepth.fs.glsl",
-            ShaderType::Fragment}})) {
+            ShaderType::Fragment}},
+          DrawList::GetDefines())) {
     return msg;
   }
   if (auto msg = progs_[kShadeWithShadow].CompileAndLink(
           {{"./Assets/Shaders/ShadowMap/Simple/ShadowMap.vs.glsl",
             ShaderType::Vertex},
            {"./Assets/Shaders/ShadowMap/Simple/ShadowMap.fs.glsl",
-            ShaderType::Fragment}})) {
+            ShaderType::Fragment}},
+          DrawList::GetDefines())) {
     return msg;
   }
   return std::nullopt;
 }
 
-void SceneShadowMap::SetMatrices() {
-  const glm::mat4 mv = view_ * model_;
-  if (pass_ == kRecordDepth) {
-    progs_[kRecordDepth].SetUniform("MVP", proj_ * mv);
-  } else if (pass_ == kShadeWithShadow) {
-    progs_[kShadeWithShadow].SetUniform("ModelViewMatrix", mv);
-    progs_[kShadeWithShadow].SetUniform("NormalMatrix", glm::mat3(mv));
-    progs_[kShadeWithShadow].SetUniform("MVP", proj_ * mv);
-    progs_[kShadeWithShadow].SetUniform("ShadowMatrix", lightPV_ * model_);
+void SceneShadowMap::SetupUniforms() {
+  for (const auto pass : {kRecordDepth, kShadeWithShadow}) {
+    const ShaderProgram &prog = progs_[pass];
+    prog.BindUniformBlock("FrameBlock", UniformBinding::kFrame);
+    DrawList::BindProgram(prog);
   }
+  depthVP_ = progs_[kRecordDepth].GetUniform<glm::mat4>("ViewProjection");
+}
+
+void SceneShadowMap::UpdateFrameBlock() {
+  FrameBlock frame{};
+  frame.view = camera_.GetViewMatrix();
+  frame.proj = camera_.GetProjectionMatrix();
+  frame.shadow = lightPV_;
+  frame.lightPosition = frame.view * glm::vec4(lightView_.GetPosition(), 1.0f);
+  frame.lightLa = kLightColor;
+  frame.lightLd = kLightColor;
+  frame.lightLs = kLightColor;
+  frameBlock_.Update(frame);
+}
+
+void SceneShadowMap::Submit(const TriangleMesh &mesh) {
+  // 行列の計算はシェーダーに任せ、モデル行列とマテリアルだけを書き込みます。
+  object_.model = model_;
+  drawList_.Add(mesh, object_);
 }
 
 void SceneShadowMap::SetupFBO() {
   // シャドウマップの生成を行います。
   glGenTextures(1, &depthTex_);
-  glBindTexture(GL_TEXTURE_2D, depthTex_);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, depthTex_);
   glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT24, kShadowMapWidth,
                  kShadowMapHeight);
 
@@ -147,7 +183,7 @@ void SceneShadowMap::SetupFBO() {
 
   // シャドウマップ用の FBO を生成し、デプステクスチャをアタッチします。
   glGenFramebuffers(1, &shadowFBO_);
-  glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
   glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D,
                          depthTex_, 0);
 
@@ -161,22 +197,18 @@ void SceneShadowMap::SetupFBO() {
     std::cout << "Framebuffer is not complete." << std::endl;
   }
 
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
 }
 
 void SceneShadowMap::SetMaterialUniforms(const glm::vec3 &diff,
                                          const glm::vec3 &amb,
                                          const glm::vec3 &spec,
                                          float shininess) {
-
-  if (pass_ != kShadeWithShadow) {
-    return;
-  }
-  progs_[kShadeWithShadow].SetUniform("Material.Ka", amb);
-  progs_[kShadeWithShadow].SetUniform("Material.Kd", diff);
-  progs_[kShadeWithShadow].SetUniform("Material.Ks", spec);
-  progs_[kShadeWithShadow].SetUniform("Material.Shininess", shininess);
+  object_.ka = amb;
+  object_.kd = diff;
+  object_.ks = spec;
+  object_.shininess = shininess;
 }
 
 // ********************************************************************************
@@ -187,21 +219,24 @@ void SceneShadowMap::SetMaterialUniforms(const glm::vec3 &diff,
 void SceneShadowMap::Pass1() {
   pass_ = RenderPass::kRecordDepth;
 
-  glBindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, shadowFBO_);
   glClear(GL_DEPTH_BUFFER_BIT);
-  glViewport(0, 0, kShadowMapWidth, kShadowMapHeight);
+  GLState::Get().Viewport(0, 0, kShadowMapWidth, kShadowMapHeight);
 
   glCullFace(GL_FRONT);
-  glEnable(GL_POLYGON_OFFSET_FILL);
+  GLState::Get().Enable(GL_POLYGON_OFFSET_FILL);
   glPolygonOffset(2.5f, 10.0f);
 
   // ライトから見たシーンの描画
   view_ = lightView_.GetViewMatrix();
   proj_ = lightView_.GetProjectionMatrix();
+  // ライトの視錐台から外れるものは描画しません。(Cull は使用中のプログラムを変えます)
+  drawList_.Cull(proj_ * view_);
   progs_[kRecordDepth].Use();
-  DrawScene();
+  progs_[kRecordDepth].SetUniform(depthVP_, proj_ * view_);
+  drawList_.Draw();
 
-  glDisable(GL_POLYGON_OFFSET_FILL);
+  GLState::Get().Disable(GL_POLYGON_OFFSET_FILL);
   glCullFace(GL_BACK);
 }
 
@@ -211,18 +246,22 @@ void SceneShadowMap::Pass2() {
 
   proj_ = camera_.GetProjectionMatrix();
   view_ = camera_.GetViewMatrix();
+  drawList_.Cull(proj_ * view_);
   progs_[kShadeWithShadow].Use();
-  progs_[kShadeWithShadow].SetUniform(
-      "Light.Position", view_ * glm::vec4(lightView_.GetPosition(), 1.0f));
 
-  glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  GLState::Get().BindFramebuffer(GL_FRAMEBUFFER, 0);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-  glViewport(0, 0, width_, height_);
+  GLState::Get().Viewport(0, 0, width_, height_);
 
-  DrawScene();
+  drawList_.Draw();
 }
 
-void SceneShadowMap::DrawScene() {
+/**
+ * @brief 両方のパスで描画するオブジェクトを集めて転送します。
+ */
+void SceneShadowMap::BuildDrawList() {
+  drawList_.Clear();
+
   const glm::vec3 diff = glm::vec3(0.7f, 0.5f, 0.3f);
   const glm::vec3 amb = diff * 0.05f;
   const glm::vec3 spec = glm::vec3(0.9f, 0.9f, 0.9f);
@@ -232,8 +271,7 @@ void SceneShadowMap::DrawScene() {
   model_ = glm::mat4(1.0f);
   model_ =
       glm::rotate(model_, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-  SetMatrices();
-  teapot_.Render();
+  Submit(teapot_);
 
   // トーラスの描画
   SetMaterialUniforms(diff, amb, spec, 150.0f);
@@ -241,32 +279,29 @@ void SceneShadowMap::DrawScene() {
   model_ = glm::translate(model_, glm::vec3(0.0f, 2.0f, 5.0f));
   model_ =
       glm::rotate(model_, glm::radians(-45.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-  SetMatrices();
-  torus_.Render();
+  Submit(torus_);
 
   // 平面の描画
   SetMaterialUniforms(glm::vec3(0.25f, 0.25f, 0.25f),
                       glm::vec3(0.0f, 0.0f, 0.0f),
                       glm::vec3(0.05f, 0.05f, 0.05f), 1.0f);
   model_ = glm::mat4(1.0f);
-  SetMatrices();
-  plane_.Render();
+  Submit(plane_);
 
   model_ = glm::mat4(1.0f);
   model_ = glm::translate(model_, glm::vec3(-5.0f, 5.0f, 0.0f));
   model_ =
       glm::rotate(model_, glm::radians(-90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-  SetMatrices();
-  plane_.Render();
+  Submit(plane_);
 
   model_ = glm::mat4(1.0f);
   model_ = glm::translate(model_, glm::vec3(0.0f, 5.0f, -5.0f));
   model_ =
       glm::rotate(model_, glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
-  SetMatrices();
-  plane_.Render();
+  Submit(plane_);
 
   model_ = glm::mat4(1.0f);
+  drawList_.Upload();
 }
 
 // ********************************************************************************
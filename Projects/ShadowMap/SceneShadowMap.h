@@ -12,10 +12,14 @@
 #include <optional>
 #include <string>
 
+#include "Graphics/GpuTimer.h"
 #include "Graphics/Shader.h"
+#include "Graphics/UniformBuffer.h"
 #include "Primitive/Plane.h"
 #include "Primitive/Teapot.h"
 #include "Primitive/Torus.h"
+#include "Scene/DrawList.h"
+#include "Scene/UniformBlocks.h"
 #include "View/Camera.h"
 #include "View/Frustum.h"
 
@@ -29,8 +33,10 @@ public:
 
 private:
   std::optional<std::string> CompileAndLinkShader();
+  void SetupUniforms();
   void SetupFBO();
-  void SetMatrices();
+  void UpdateFrameBlock();
+  void Submit(const TriangleMesh &mesh);
   void SetMaterialUniforms(const glm::vec3 &diff, const glm::vec3 &amb,
                            const glm::vec3 &spec, float shininess);
   void SetupCamera();
@@ -38,12 +44,13 @@ private:
 
   void Pass1();
   void Pass2();
-  void DrawScene();
+  void BuildDrawList();
 
   static constexpr inline float kFOVY = 50.0f;
   static constexpr inline float kRotSpeed = 0.2f;
   static constexpr inline int kShadowMapWidth = 1024;
   static constexpr inline int kShadowMapHeight = 1024;
+  static constexpr inline std::size_t kObjectsMax = 16;
 
   Camera camera_;
   Camera lightView_;
@@ -65,8 +72,15 @@ private:
   std::array<ShaderProgram, kPassNum> progs_{};
   RenderPass pass_ = kRecordDepth;
 
+  UniformBlock<FrameBlock> frameBlock_{};
+  DrawList drawList_{};
+  ObjectBlock object_{};
+  Uniform<glm::mat4> depthVP_{};
+
   GLuint depthTex_ = 0;
   GLuint shadowFBO_ = 0;
+
+  GpuTimer gpuTimer_{};
 };
 
 #endif
@@ -10,6 +10,8 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <iostream>
 
+#include "Graphics/GLState.h"
+#include "Graphics/Sampler.h"
 #include "Graphics/Texture.h"
 #include "SceneTexture.h"
 
@@ -32,17 +34,18 @@ void SceneTexture::OnInit() {
   tex_ = Texture::Load("./Assets/Textures/Wood/hp_wood.png");
 }
 
-void SceneTexture::OnDestroy() { glDeleteTextures(1, &tex_); }
+void SceneTexture::OnDestroy() { GLState::DeleteTextures(1, &tex_); }
 
 void SceneTexture::OnUpdate(float) {}
 
 void SceneTexture::OnRender() {
 
-  glEnable(GL_DEPTH_TEST);
+  GLState::Get().Enable(GL_DEPTH_TEST);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, tex_);
+  GLState::Get().ActiveTexture(GL_TEXTURE0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, tex_);
+  GLState::Get().BindSampler(0, SamplerCache::Get().Find(SamplerDesc{}));
 
   prog_.Use();
 #ifdef __APPLE__
@@ -63,13 +66,14 @@ void SceneTexture::OnRender() {
   prog_.SetUniform("MVP", proj_ * mv);
   cube_.Render();
 
-  glBindTexture(GL_TEXTURE_2D, 0);
-  glDisable(GL_DEPTH_TEST);
+  GLState::Get().BindSampler(0, 0);
+  GLState::Get().BindTexture(GL_TEXTURE_2D, 0);
+  GLState::Get().Disable(GL_DEPTH_TEST);
 }
 
 void SceneTexture::OnResize(int w, int h) {
   SetDimensions(w, h);
-  glViewport(0, 0, w, h);
+  GLState::Get().Viewport(0, 0, w, h);
   proj_ = glm::perspective(glm::radians(60.0f),
                            static_cast<float>(w) / static_cast<float>(h), 0.3f,
                            100.0f);
@@ -0,0 +1,191 @@
+/**
+ * @brief  視錐台カリングのベンチマーク
+ * @note   FrustumCullBench [--repeat n] [counts...]
+ * 視錐台の周りに乱数で置いた球と AABB を Frustum::CullSpheres, CullAABBs で判定し、
+ * 命令セットごとに一番速かった時間と、スカラー版と結果が一致するかを表示します。
+ */
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "View/Frustum.h"
+
+// ********************************************************************************
+// Constexpr variables
+// ********************************************************************************
+
+static constexpr std::size_t kDefaultCounts[] = {10000, 100000, 1000000};
+static constexpr const char *kSimdNames[] = {"Scalar", "SSE", "AVX2"};
+
+// ********************************************************************************
+// Struct(s)
+// ********************************************************************************
+
+struct Config {
+  int repeat = 10;
+  std::vector<std::size_t> counts{};
+};
+
+/**< @brief 球と AABB の配列 (SoA) の実体 */
+struct Objects {
+  std::vector<float> x, y, z, radius;
+  std::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+
+  SphereArrays GetSpheres() const {
+    return {x.data(), y.data(), z.data(), radius.data(), x.size()};
+  }
+  AABBArrays GetAABBs() const {
+    return {minX.data(), minY.data(), minZ.data(), maxX.data(),
+            maxY.data(), maxZ.data(), minX.size()};
+  }
+};
+
+// ********************************************************************************
+// Functions
+// ********************************************************************************
+
+/**
+ * @brief repeat 回実行して一番速かった時間 [ms] を返します。
+ */
+static double Measure(int repeat, const std::function<void()> &func) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeat; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+/**
+ * @brief 原点から -z を向いたカメラの視錐台を囲む範囲に、大きさの違うものを置きます。
+ */
+static Objects Generate(std::size_t count) {
+  std::mt19937 engine(12345);
+  std::uniform_real_distribution<float> xy(-60.0f, 60.0f);
+  std::uniform_real_distribution<float> depth(-110.0f, 10.0f);
+  std::uniform_real_distribution<float> size(0.1f, 2.0f);
+
+  Objects objects{};
+  for (std::size_t i = 0; i < count; i++) {
+    const float x = xy(engine);
+    const float y = xy(engine);
+    const float z = depth(engine);
+    const float r = size(engine);
+    objects.x.push_back(x);
+    objects.y.push_back(y);
+    objects.z.push_back(z);
+    objects.radius.push_back(r);
+    objects.minX.push_back(x - r);
+    objects.minY.push_back(y - r * 0.5f);
+    objects.minZ.push_back(z - r);
+    objects.maxX.push_back(x + r);
+    objects.maxY.push_back(y + r * 0.5f);
+    objects.maxZ.push_back(z + r);
+  }
+  return objects;
+}
+
+static bool Run(std::size_t count, const Config &config,
+                const Frustum &frustum) {
+  const Objects objects = Generate(count);
+  const SphereArrays spheres = objects.GetSpheres();
+  const AABBArrays boxes = objects.GetAABBs();
+
+  std::vector<std::uint8_t> expectedSpheres(count);
+  std::vector<std::uint8_t> expectedBoxes(count);
+  frustum.CullSpheres(spheres, expectedSpheres.data(), CullSimd::Scalar);
+  frustum.CullAABBs(boxes, expectedBoxes.data(), CullSimd::Scalar);
+
+  std::cout << count << " objects" << std::endl;
+  bool isSucceeded = true;
+  double scalarMs[2] = {0.0, 0.0};
+  for (int s = 0; s < static_cast<int>(CullSimd::Num); s++) {
+    const auto simd = static_cast<CullSimd>(s);
+    if (!Frustum::IsSupported(simd)) {
+      continue;
+    }
+
+    std::vector<std::uint8_t> visible(count);
+    std::size_t visibleSpheres = 0;
+    std::size_t visibleBoxes = 0;
+    const double sphereMs = Measure(config.repeat, [&] {
+      visibleSpheres = frustum.CullSpheres(spheres, visible.data(), simd);
+    });
+    const bool isSameSpheres = visible == expectedSpheres;
+    const double boxMs = Measure(config.repeat, [&] {
+      visibleBoxes = frustum.CullAABBs(boxes, visible.data(), simd);
+    });
+    const bool isSameBoxes = visible == expectedBoxes;
+    if (simd == CullSimd::Scalar) {
+      scalarMs[0] = sphereMs;
+      scalarMs[1] = boxMs;
+    }
+
+    const auto print = [&](const char *kind, double ms, double baseMs,
+                           std::size_t visibleCount, bool isSame) {
+      std::cout << "  " << std::left << std::setw(7) << kSimdNames[s]
+                << std::setw(7) << kind << std::right << ": " << ms << " ms ("
+                << ms * 1e6 / static_cast<double>(count) << " ns/object, "
+                << baseMs / std::max(ms, 1e-6) << "x), visible "
+                << visibleCount << ", "
+                << (isSame ? "identical" : "DIFFERENT") << std::endl;
+    };
+    std::cout << std::fixed << std::setprecision(3);
+    print("sphere", sphereMs, scalarMs[0], visibleSpheres, isSameSpheres);
+    print("AABB", boxMs, scalarMs[1], visibleBoxes, isSameBoxes);
+    isSucceeded &= isSameSpheres && isSameBoxes;
+  }
+  return isSucceeded;
+}
+
+// ********************************************************************************
+// Entry point
+// ********************************************************************************
+
+int main(int argc, char **argv) {
+  Config config{};
+  for (int i = 1; i < argc; i++) {
+    const std::string arg(argv[i]);
+    if (arg == "--repeat" && i + 1 < argc) {
+      config.repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (!arg.empty() && arg[0] != '-') {
+      config.counts.emplace_back(std::strtoull(arg.c_str(), nullptr, 10));
+    } else {
+      std::cerr << "Usage: " << argv[0] << " [--repeat n] [counts...]"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (config.counts.empty()) {
+    config.counts.assign(std::begin(kDefaultCounts), std::end(kDefaultCounts));
+  }
+
+  Frustum frustum;
+  frustum.SetupPerspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  frustum.SetupCorners(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f),
+                       glm::vec3(0.0f, 1.0f, 0.0f));
+
+  bool isSucceeded = true;
+  for (const std::size_t count : config.counts) {
+    isSucceeded &= Run(count, config, frustum);
+  }
+  return isSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,187 @@
+/**
+ * @brief  OBJ パーサーのベンチマーク
+ * @note   ObjParserBench [--repeat n] [--threads n] [inputs...]
+ * 同じファイルを tinyobj::LoadObj と ObjParser (1 スレッド / 指定スレッド) で読み込み、
+ * 一番速かった時間と、三角形の角のインデックスが一致するかを表示します。
+ */
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include <tiny_obj_loader/tiny_obj_loader.h>
+
+#include "Mesh/ObjParser.h"
+
+// ********************************************************************************
+// Constexpr variables
+// ********************************************************************************
+
+static constexpr const char *kDefaultInputs[] = {
+    "./Assets/Models/Bunny/bunny.obj",
+    "./Assets/Models/Dragon/dragon.obj",
+    "./Assets/Models/SDCC/building.obj",
+};
+
+// ********************************************************************************
+// Struct(s)
+// ********************************************************************************
+
+struct Config {
+  int repeat = 3;
+  unsigned threads = 0;
+  std::vector<std::string> inputs{};
+};
+
+// ********************************************************************************
+// Functions
+// ********************************************************************************
+
+/**
+ * @brief repeat 回実行して一番速かった時間 [ms] を返します。
+ */
+static double Measure(int repeat, const std::function<bool()> &func) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeat; i++) {
+    const auto start = std::chrono::steady_clock::now();
+    if (!func()) {
+      return -1.0;
+    }
+    const std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  return best;
+}
+
+/**
+ * @brief 全ての shape の三角形の角を順に並べて比べます。
+ */
+static bool IsSameCorners(const std::vector<tinyobj::shape_t> &shapes,
+                          const ObjParser::Result &result) {
+  std::vector<ObjParser::Index> expected;
+  for (const auto &shape : shapes) {
+    for (const auto &idx : shape.mesh.indices) {
+      expected.push_back({idx.vertex_index, idx.texcoord_index,
+                          idx.normal_index});
+    }
+  }
+  std::size_t i = 0;
+  for (const auto &shape : result.shapes) {
+    for (const auto &idx : shape.indices) {
+      if (i >= expected.size() || expected[i].position != idx.position ||
+          expected[i].texCoord != idx.texCoord ||
+          expected[i].normal != idx.normal) {
+        return false;
+      }
+      i++;
+    }
+  }
+  return i == expected.size();
+}
+
+static bool Run(const std::string &path, const Config &config) {
+  std::error_code ec;
+  const auto bytes = std::filesystem::file_size(path, ec);
+  if (ec) {
+    std::cerr << "Can't open file : " << path << std::endl;
+    return false;
+  }
+
+  tinyobj::attrib_t attrib;
+  std::vector<tinyobj::shape_t> shapes;
+  const double tinyobjMs = Measure(config.repeat, [&] {
+    attrib = tinyobj::attrib_t{};
+    shapes.clear();
+    std::vector<tinyobj::material_t> materials;
+    std::string warn, err;
+    return tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err,
+                            path.c_str());
+  });
+
+  ObjParser::Result result{};
+  const auto parse = [&](unsigned threads) {
+    return Measure(config.repeat, [&] {
+      if (const auto msg = ObjParser::Load(path, result, threads)) {
+        std::cerr << msg.value() << std::endl;
+        return false;
+      }
+      return true;
+    });
+  };
+  const double singleMs = parse(1);
+  const double parallelMs = parse(config.threads);
+  if (tinyobjMs < 0.0 || singleMs < 0.0 || parallelMs < 0.0) {
+    std::cerr << "Failed to load " << path << std::endl;
+    return false;
+  }
+
+  const bool isSame = attrib.vertices == result.positions &&
+                      attrib.normals == result.normals &&
+                      attrib.texcoords == result.texCoords &&
+                      IsSameCorners(shapes, result);
+
+  const double mb = static_cast<double>(bytes) / (1024.0 * 1024.0);
+  const auto print = [&](const std::string &label, double ms) {
+    std::cout << "  " << std::left << std::setw(16) << label << std::right
+              << ": " << ms << " ms (" << tinyobjMs / std::max(ms, 1e-6)
+              << "x, " << mb / std::max(ms, 1e-6) * 1000.0 << " MB/s)"
+              << std::endl;
+  };
+  std::cout << std::fixed << std::setprecision(2) << path << " (" << mb
+            << " MB, " << result.positions.size() / 3 << " vertices)"
+            << std::endl;
+  print("tinyobj", tinyobjMs);
+  print("ObjParser x1", singleMs);
+  print("ObjParser x" + std::to_string(config.threads), parallelMs);
+  std::cout << "  " << std::left << std::setw(16) << "result" << std::right
+            << ": " << (isSame ? "identical" : "DIFFERENT") << std::endl;
+  return isSame;
+}
+
+// ********************************************************************************
+// Entry point
+// ********************************************************************************
+
+int main(int argc, char **argv) {
+  Config config{};
+  for (int i = 1; i < argc; i++) {
+    const std::string arg(argv[i]);
+    if (arg == "--repeat" && i + 1 < argc) {
+      config.repeat = std::max(1, std::atoi(argv[++i]));
+    } else if (arg == "--threads" && i + 1 < argc) {
+      config.threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+    } else if (!arg.empty() && arg[0] != '-') {
+      config.inputs.emplace_back(arg);
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--repeat n] [--threads n] [inputs...]" << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (config.threads == 0) {
+    config.threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  if (config.inputs.empty()) {
+    config.inputs.assign(std::begin(kDefaultInputs), std::end(kDefaultInputs));
+  }
+
+  bool isSucceeded = true;
+  for (const auto &input : config.inputs) {
+    isSucceeded &= Run(input, config);
+  }
+  return isSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}
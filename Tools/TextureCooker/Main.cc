@@ -0,0 +1,242 @@
+/**
+ * @brief  テクスチャクッカー
+ * @note   TextureCooker [--format bc1|bc3|bc5|bc7] [--container ktx2|dds]
+ *                       [--linear] [--no-mipmaps] [--output dir] [--verify]
+ *                       [inputs...]
+ * PNG/JPEG を読み込んで縮小レベルを作り、ブロック圧縮して KTX2 か DDS に書き出します。
+ * GPU を使わないので、GL のコンテキストが無い環境でも実行できます。
+ */
+
+// ********************************************************************************
+// Including files
+// ********************************************************************************
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include "Graphics/Mipmap.h"
+#include "Image/BlockCompression.h"
+#include "Image/TextureContainer.h"
+
+// ********************************************************************************
+// Constexpr variables
+// ********************************************************************************
+
+static constexpr const char *kDefaultInput = "./Assets/Textures";
+
+// ********************************************************************************
+// Struct(s)
+// ********************************************************************************
+
+struct Config {
+  BlockFormat format = BlockFormat::BC7;
+  std::string container = ".ktx2";
+  bool isLinear = false;
+  bool useMipmaps = true;
+  bool verify = false;
+  std::optional<std::filesystem::path> outputDir{};
+  std::vector<std::filesystem::path> inputs{};
+};
+
+// ********************************************************************************
+// Functions
+// ********************************************************************************
+
+static bool IsImagePath(const std::filesystem::path &path) {
+  std::string ext = path.extension().string();
+  std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return ext == ".png" || ext == ".jpg" || ext == ".jpeg";
+}
+
+static std::vector<std::filesystem::path>
+CollectImages(const std::vector<std::filesystem::path> &inputs) {
+  std::vector<std::filesystem::path> images;
+  for (const auto &input : inputs) {
+    if (!std::filesystem::is_directory(input)) {
+      images.emplace_back(input);
+      continue;
+    }
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(input)) {
+      if (entry.is_regular_file() && IsImagePath(entry.path())) {
+        images.emplace_back(entry.path());
+      }
+    }
+  }
+  std::sort(images.begin(), images.end());
+  return images;
+}
+
+/**
+ * @brief ブロックの行を分けて並列に圧縮します。
+ */
+static std::vector<std::uint8_t> EncodeLevel(BlockFormat format,
+                                             const unsigned char *rgba,
+                                             int width, int height) {
+  using namespace BlockCompression;
+  std::vector<std::uint8_t> out(ComputeLevelBytes(format, width, height));
+  const int blocksX = (width + kBlockDim - 1) / kBlockDim;
+  const int blocksY = (height + kBlockDim - 1) / kBlockDim;
+  Mipmap::ParallelFor(blocksY, blocksX * kBlockTexels,
+                      [&](int begin, int end) {
+                        EncodeBlockRows(format, rgba, width, height, begin, end,
+                                        out.data());
+                      });
+  return out;
+}
+
+/**
+ * @brief 元の画像と展開した画像の PSNR を求めます。
+ * @note BC1 と BC5 は圧縮しないチャンネル (アルファ、B) を比べません。
+ */
+static std::optional<double> ComputePSNR(BlockFormat format,
+                                         const unsigned char *rgba, int width,
+                                         int height,
+                                         const std::vector<std::uint8_t> &data) {
+  const auto decoded =
+      BlockCompression::Decode(format, data.data(), width, height);
+  if (!decoded) {
+    return std::nullopt;
+  }
+  const int channels = format == BlockFormat::BC1   ? 3
+                       : format == BlockFormat::BC5 ? 2
+                                                    : 4;
+  double sum = 0.0;
+  const std::size_t texels =
+      static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+  for (std::size_t i = 0; i < texels; i++) {
+    for (int c = 0; c < channels; c++) {
+      const double d = static_cast<double>(rgba[i * 4 + c]) -
+                       static_cast<double>(decoded.value()[i * 4 + c]);
+      sum += d * d;
+    }
+  }
+  const double mse = sum / static_cast<double>(texels * channels);
+  return mse <= 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+static bool Cook(const std::filesystem::path &input, const Config &config) {
+  const auto start = std::chrono::steady_clock::now();
+
+  // Texture::Load と同じく上下を反転して格納します。
+  int w = 0, h = 0, bytesPerPix = 0;
+  stbi_set_flip_vertically_on_load(true);
+  unsigned char *data =
+      stbi_load(input.string().c_str(), &w, &h, &bytesPerPix, 4);
+  if (data == nullptr) {
+    std::cerr << "Failed to load " << input.string() << std::endl;
+    return false;
+  }
+
+  CompressedTexture texture{};
+  texture.format = config.format;
+  texture.isSRGB = !config.isLinear && config.format != BlockFormat::BC5;
+  texture.width = w;
+  texture.height = h;
+  texture.levels.emplace_back(EncodeLevel(config.format, data, w, h));
+  if (config.useMipmaps) {
+    Mipmap::Generate(data, w, h, texture.isSRGB,
+                     [&](int, int lw, int lh, const unsigned char *px) {
+                       texture.levels.emplace_back(
+                           EncodeLevel(config.format, px, lw, lh));
+                     });
+  }
+
+  std::optional<double> psnr{};
+  if (config.verify) {
+    psnr = ComputePSNR(config.format, data, w, h, texture.levels.front());
+  }
+  stbi_image_free(data);
+
+  std::filesystem::path output = input;
+  output.replace_extension(config.container);
+  if (config.outputDir) {
+    output = config.outputDir.value() / output.filename();
+  }
+  if (const auto msg = TextureContainer::Write(output.string(), texture)) {
+    std::cerr << msg.value() << std::endl;
+    return false;
+  }
+
+  std::size_t bytes = 0;
+  for (const auto &level : texture.levels) {
+    bytes += level.size();
+  }
+  const std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << input.string() << " -> " << output.string() << " ("
+            << BlockCompression::ToString(config.format) << ", " << w << "x"
+            << h << ", " << texture.levels.size() << " levels, " << bytes
+            << " bytes, " << elapsed.count() << " ms";
+  if (psnr) {
+    std::cout << ", PSNR " << psnr.value() << " dB";
+  }
+  std::cout << ")" << std::endl;
+  return true;
+}
+
+// ********************************************************************************
+// Entry point
+// ********************************************************************************
+
+int main(int argc, char **argv) {
+  Config config{};
+  for (int i = 1; i < argc; i++) {
+    const std::string arg(argv[i]);
+    if (arg == "--format" && i + 1 < argc) {
+      const auto format = BlockCompression::FromString(argv[++i]);
+      if (!format) {
+        std::cerr << "Unknown format : " << argv[i] << std::endl;
+        return EXIT_FAILURE;
+      }
+      config.format = format.value();
+    } else if (arg == "--container" && i + 1 < argc) {
+      config.container = std::string(".") + argv[++i];
+    } else if (arg == "--linear") {
+      config.isLinear = true;
+    } else if (arg == "--no-mipmaps") {
+      config.useMipmaps = false;
+    } else if (arg == "--verify") {
+      config.verify = true;
+    } else if (arg == "--output" && i + 1 < argc) {
+      config.outputDir = std::filesystem::path(argv[++i]);
+    } else if (!arg.empty() && arg[0] != '-') {
+      config.inputs.emplace_back(arg);
+    } else {
+      std::cerr << "Usage: " << argv[0]
+                << " [--format bc1|bc3|bc5|bc7] [--container ktx2|dds]"
+                   " [--linear] [--no-mipmaps] [--output dir] [--verify]"
+                   " [inputs...]"
+                << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (!TextureContainer::IsSupportedPath("x" + config.container)) {
+    std::cerr << "Unknown container : " << config.container << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (config.inputs.empty()) {
+    config.inputs.emplace_back(kDefaultInput);
+  }
+  if (config.outputDir) {
+    std::filesystem::create_directories(config.outputDir.value());
+  }
+
+  bool isSucceeded = true;
+  for (const auto &image : CollectImages(config.inputs)) {
+    isSucceeded &= Cook(image, config);
+  }
+  return isSucceeded ? EXIT_SUCCESS : EXIT_FAILURE;
+}